@@ -0,0 +1,7 @@
+#version 330 core
+// Flat vertex colors for filled geometry.
+in vec3 vertexColor;
+out vec4 FragColor;
+void main() {
+    FragColor = vec4(vertexColor, 1.0);
+}
@@ -0,0 +1,15 @@
+#version 330 core
+// Transforms scene-relative positions by the camera; shared by all programs.
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aColor;
+
+uniform mat4 uViewMatrix;
+uniform mat4 uProjectionMatrix;
+uniform mat4 uModelMatrix;
+
+out vec3 vertexColor;
+
+void main() {
+    gl_Position = uProjectionMatrix * uViewMatrix * uModelMatrix * vec4(aPos, 1.0);
+    vertexColor = aColor;
+}
@@ -0,0 +1,20 @@
+#version 330 core
+// Line coverage from the distance to the line's center.
+uniform float uLineWidth;
+
+in vec3 lineColor;
+noperspective in float edgeDistance;
+out vec4 FragColor;
+
+void main() {
+    float half_width = 0.5 * max(uLineWidth, 1.0);
+    float distance = abs(edgeDistance);
+#ifdef HARD_EDGES
+    float coverage = step(distance, half_width);
+#else
+    float coverage = clamp(half_width + 0.5 - distance, 0.0, 1.0);
+#endif
+    coverage *= min(uLineWidth, 1.0);
+    if (coverage <= 0.0) discard;
+    FragColor = vec4(lineColor, coverage);
+}
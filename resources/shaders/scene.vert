@@ -0,0 +1,16 @@
+#version 330 core
+// Resident scene geometry, positions relative to the scene origin.
+// The color attribute is disabled and set once per draw.
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aColor;
+
+uniform mat4 uViewMatrix;
+uniform mat4 uProjectionMatrix;
+uniform mat4 uModelMatrix;
+
+out vec3 vertexColor;
+
+void main() {
+    gl_Position = uProjectionMatrix * uViewMatrix * uModelMatrix * vec4(aPos.xy, 0.0, 1.0);
+    vertexColor = aColor;
+}
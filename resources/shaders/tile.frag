@@ -0,0 +1,10 @@
+#version 330 core
+// Tile texels hold premultiplied color; blended with (ONE, ONE_MINUS_SRC_ALPHA).
+uniform sampler2D uTile;
+
+in vec2 tileCoord;
+out vec4 FragColor;
+
+void main() {
+    FragColor = texture(uTile, tileCoord);
+}
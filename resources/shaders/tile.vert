@@ -0,0 +1,16 @@
+#version 330 core
+// Cached plan view tile: a textured quad in scene coordinates. Uses the
+// streamed vertex format; the color slot carries the texture coordinate.
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aTexCoord;
+
+uniform mat4 uViewMatrix;
+uniform mat4 uProjectionMatrix;
+uniform mat4 uModelMatrix;
+
+out vec2 tileCoord;
+
+void main() {
+    gl_Position = uProjectionMatrix * uViewMatrix * uModelMatrix * vec4(aPos, 1.0);
+    tileCoord = aTexCoord.xy;
+}
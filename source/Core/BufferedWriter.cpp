@@ -0,0 +1,97 @@
+/**
+ * @file BufferedWriter.cpp
+ * @brief Implementation of the BufferedWriter class
+ * @author MentalEngine Team
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#include "BufferedWriter.h"
+#include <charconv>
+#include <cstring>
+
+namespace MentalEngine {
+
+namespace {
+
+const size_t MAX_NUMBER_LENGTH = 32;  ///< Longest to_chars output for float/double/long long
+
+} // namespace
+
+BufferedWriter::BufferedWriter(size_t capacity)
+    : buffer(capacity < MAX_NUMBER_LENGTH ? MAX_NUMBER_LENGTH : capacity)
+{
+}
+
+BufferedWriter::~BufferedWriter() {
+    Close();
+}
+
+bool BufferedWriter::Open(const std::string& path) {
+    Close();
+    failed = false;
+    used = 0;
+    file = std::fopen(path.c_str(), "wb");
+    if (!file) failed = true;
+    return file != nullptr;
+}
+
+bool BufferedWriter::Close() {
+    if (!file) return false;
+    Flush();
+    if (std::fclose(file) != 0) failed = true;
+    file = nullptr;
+    return !failed;
+}
+
+nil BufferedWriter::Write(const char* data, size_t size) {
+    if (failed || !file) return;
+    if (size > buffer.size() - used) {
+        Flush();
+        if (size >= buffer.size()) {
+            // Большие блоки пишем напрямую, минуя буфер
+            failed = std::fwrite(data, 1, size, file) != size;
+            return;
+        }
+    }
+    std::memcpy(buffer.data() + used, data, size);
+    used += size;
+}
+
+nil BufferedWriter::Write(const char* text) {
+    Write(text, std::strlen(text));
+}
+
+nil BufferedWriter::WriteFloat(float value) {
+    if (failed || !file) return;
+    if (buffer.size() - used < MAX_NUMBER_LENGTH) Flush();
+    if (value == 0.0f) value = 0.0f;  // drop the sign of -0
+    std::to_chars_result result = std::to_chars(buffer.data() + used, buffer.data() + buffer.size(), value);
+    used = static_cast<size_t>(result.ptr - buffer.data());
+}
+
+nil BufferedWriter::WriteDouble(double value) {
+    if (failed || !file) return;
+    if (buffer.size() - used < MAX_NUMBER_LENGTH) Flush();
+    if (value == 0.0) value = 0.0;  // drop the sign of -0
+    std::to_chars_result result = std::to_chars(buffer.data() + used, buffer.data() + buffer.size(), value);
+    used = static_cast<size_t>(result.ptr - buffer.data());
+}
+
+nil BufferedWriter::WriteInt(long long value) {
+    if (failed || !file) return;
+    if (buffer.size() - used < MAX_NUMBER_LENGTH) Flush();
+    std::to_chars_result result = std::to_chars(buffer.data() + used, buffer.data() + buffer.size(), value);
+    used = static_cast<size_t>(result.ptr - buffer.data());
+}
+
+nil BufferedWriter::Flush() {
+    if (failed || !file || used == 0) {
+        used = 0;
+        return;
+    }
+    failed = std::fwrite(buffer.data(), 1, used, file) != used;
+    used = 0;
+}
+
+} // namespace MentalEngine
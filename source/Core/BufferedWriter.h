@@ -0,0 +1,112 @@
+/**
+ * @file BufferedWriter.h
+ * @brief Buffered text/binary file writer for MentalEngine
+ * @author MentalEngine Team
+ * @version 1.0.0
+ * @date 2024
+ *
+ * This file defines the BufferedWriter class, a small fixed-buffer writer
+ * used by exporters that produce large files piece by piece.
+ */
+
+#ifndef MENTAL_BUFFERED_WRITER_H
+#define MENTAL_BUFFERED_WRITER_H
+
+#include "Types.h"
+#include <cstddef>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace MentalEngine {
+
+/**
+ * @class BufferedWriter
+ * @brief Writes to a file through one fixed-size buffer
+ *
+ * Memory use is the buffer capacity regardless of how much is written.
+ * Numbers are formatted with std::to_chars, which is locale-independent and
+ * produces the shortest text that reads back to the same value.
+ *
+ * Errors are sticky: after a failed write every further call is ignored and
+ * Close() reports the failure.
+ *
+ * @note This class is non-copyable
+ */
+class BufferedWriter {
+private:
+    FILE* file = nullptr;       ///< Destination file
+    std::vector<char> buffer;   ///< Pending bytes
+    size_t used = 0;            ///< Bytes used in buffer
+    bool failed = false;        ///< A write or open failed
+
+public:
+    /**
+     * @brief Constructor
+     * @param capacity Buffer size in bytes
+     */
+    explicit BufferedWriter(size_t capacity = 64 * 1024);
+
+    /**
+     * @brief Destructor - flushes and closes the file
+     */
+    ~BufferedWriter();
+
+    BufferedWriter(const BufferedWriter&) = delete;
+    BufferedWriter& operator=(const BufferedWriter&) = delete;
+
+    /**
+     * @brief Opens a file for writing, truncating it
+     * @param path File path
+     * @return bool False if the file cannot be created
+     */
+    bool Open(const std::string& path);
+
+    /**
+     * @brief Flushes and closes the file
+     * @return bool True if every write succeeded
+     */
+    bool Close();
+
+    /**
+     * @brief Writes raw bytes
+     * @param data Bytes to write
+     * @param size Number of bytes
+     */
+    nil Write(const char* data, size_t size);
+
+    /**
+     * @brief Writes a zero-terminated string
+     * @param text String to write
+     */
+    nil Write(const char* text);
+
+    /**
+     * @brief Writes a float in shortest round-trip form
+     * @param value Value to write; negative zero is written as 0
+     */
+    nil WriteFloat(float value);
+
+    /**
+     * @brief Writes a double in shortest round-trip form
+     * @param value Value to write; negative zero is written as 0
+     */
+    nil WriteDouble(double value);
+
+    /**
+     * @brief Writes an integer
+     * @param value Value to write
+     */
+    nil WriteInt(long long value);
+
+    /**
+     * @brief Writes buffered bytes to the file
+     */
+    nil Flush();
+
+    bool IsOk() const { return file != nullptr && !failed; }
+};
+
+} // namespace MentalEngine
+
+#endif // MENTAL_BUFFERED_WRITER_H
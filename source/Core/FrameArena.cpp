@@ -0,0 +1,66 @@
+/**
+ * @file FrameArena.cpp
+ * @brief Implementation of the per-frame linear allocator
+ * @author MentalEngine Team
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#include "FrameArena.h"
+#include <algorithm>
+
+namespace MentalEngine {
+
+FrameArena::FrameArena(size_t initial_size) {
+    if (initial_size > 0) __grow(initial_size);
+}
+
+void* FrameArena::Allocate(size_t size, size_t alignment) {
+    for (;;) {
+        if (!blocks.empty()) {
+            Block& block = blocks.back();
+            // new[] выравнивает только по max_align_t, поэтому выравниваем сам адрес
+            const uintptr_t base = reinterpret_cast<uintptr_t>(block.data.get());
+            const size_t aligned = static_cast<size_t>(((base + offset + alignment - 1) & ~static_cast<uintptr_t>(alignment - 1)) - base);
+            if (aligned + size <= block.size) {
+                used += aligned - offset + size;
+                offset = aligned + size;
+                return block.data.get() + aligned;
+            }
+        }
+        // Следующий блок не меньше уже занятого, чтобы цепочка росла геометрически
+        __grow(std::max({size + alignment, stats.capacity, DEFAULT_BLOCK_SIZE}));
+    }
+}
+
+nil FrameArena::Reset() {
+    stats.peak = std::max(stats.peak, used);
+    if (blocks.size() > 1) {
+        // Кадр не поместился в один блок - объединяем, чтобы следующий поместился
+        size_t total = stats.capacity;
+        blocks.clear();
+        stats.capacity = 0;
+        __grow(total);
+    }
+    offset = 0;
+    used = 0;
+}
+
+FrameArenaStats FrameArena::GetStats() const {
+    FrameArenaStats result = stats;
+    result.used = used;
+    result.peak = std::max(stats.peak, used);
+    return result;
+}
+
+nil FrameArena::__grow(size_t size) {
+    Block block;
+    block.data.reset(new unsigned char[size]);
+    block.size = size;
+    blocks.push_back(std::move(block));
+    offset = 0;
+    stats.capacity += size;
+    stats.heap_blocks++;
+}
+
+} // namespace MentalEngine
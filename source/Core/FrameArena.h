@@ -0,0 +1,182 @@
+/**
+ * @file FrameArena.h
+ * @brief Per-frame linear allocators for MentalEngine
+ * @author MentalEngine Team
+ * @version 1.0.0
+ * @date 2024
+ *
+ * This file defines FrameArena, a bump allocator for data that lives for one
+ * frame, ArenaAllocator for using it with standard containers, and
+ * DoubleBufferedArena for data that is produced in one frame and consumed
+ * during the next.
+ */
+
+#ifndef MENTAL_FRAME_ARENA_H
+#define MENTAL_FRAME_ARENA_H
+
+#include "Types.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <vector>
+
+namespace MentalEngine {
+
+/**
+ * @struct FrameArenaStats
+ * @brief Usage counters of a FrameArena
+ */
+struct FrameArenaStats {
+    size_t used = 0;              ///< Bytes handed out since the last Reset()
+    size_t peak = 0;              ///< Largest per-frame usage seen
+    size_t capacity = 0;          ///< Bytes reserved from the heap
+    uint64_t heap_blocks = 0;     ///< Blocks ever allocated from the heap
+};
+
+/**
+ * @class FrameArena
+ * @brief Linear allocator reset once per frame
+ *
+ * Allocate() bumps an offset inside the current block; memory is released
+ * all at once by Reset(). When a frame overflows the block, another block is
+ * chained, and the next Reset() merges them into one block big enough for
+ * the whole frame. After a few frames of warm-up the arena therefore stops
+ * touching the heap.
+ *
+ * Destructors of objects placed in the arena are never run, so it is meant
+ * for trivially destructible data or containers using ArenaAllocator.
+ *
+ * @note Not thread-safe; each thread uses its own arena
+ */
+class FrameArena {
+private:
+    /**
+     * @struct Block
+     * @brief One heap allocation carved up by Allocate()
+     */
+    struct Block {
+        std::unique_ptr<unsigned char[]> data;  ///< Storage
+        size_t size = 0;                        ///< Bytes in data
+    };
+
+    std::vector<Block> blocks;  ///< Chained blocks; allocation happens in the last one
+    size_t offset = 0;          ///< Bytes used in the last block
+    size_t used = 0;            ///< Bytes handed out in this frame, all blocks
+    FrameArenaStats stats;      ///< Counters reported by GetStats()
+
+    /**
+     * @brief Chains a block that can hold at least size bytes
+     * @private
+     */
+    nil __grow(size_t size);
+
+public:
+    static constexpr size_t DEFAULT_BLOCK_SIZE = 64 * 1024;  ///< First block size
+
+    /**
+     * @brief Constructor
+     * @param initial_size Bytes reserved up front; 0 defers to the first Allocate()
+     */
+    explicit FrameArena(size_t initial_size = 0);
+    FrameArena(const FrameArena&) = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+
+    /**
+     * @brief Allocates uninitialized memory valid until the next Reset()
+     * @param size Bytes to allocate
+     * @param alignment Power-of-two alignment
+     * @return void* Memory; never null
+     */
+    void* Allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+
+    /**
+     * @brief Allocates an uninitialized array
+     * @tparam T Trivially destructible element type
+     * @param count Number of elements
+     * @return T* First element
+     */
+    template <typename T>
+    T* AllocateArray(size_t count) { return static_cast<T*>(Allocate(count * sizeof(T), alignof(T))); }
+
+    /**
+     * @brief Releases everything allocated since the last Reset()
+     *
+     * Merges chained blocks into a single block sized for the frame that
+     * just ended.
+     */
+    nil Reset();
+
+    /**
+     * @brief Gets usage counters
+     * @return FrameArenaStats Counters; used reflects the current frame
+     */
+    FrameArenaStats GetStats() const;
+};
+
+/**
+ * @class ArenaAllocator
+ * @brief Standard allocator drawing from a FrameArena
+ *
+ * deallocate() does nothing; a container using this allocator must not be
+ * used after its arena has been reset.
+ *
+ * @tparam T Value type
+ */
+template <typename T>
+class ArenaAllocator {
+public:
+    using value_type = T;
+
+    FrameArena* arena;  ///< Source of memory
+
+    explicit ArenaAllocator(FrameArena& arena) noexcept : arena(&arena) {}
+
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) noexcept : arena(other.arena) {}
+
+    T* allocate(size_t count) { return arena->AllocateArray<T>(count); }
+    nil deallocate(T*, size_t) noexcept {}
+
+    template <typename U>
+    bool operator==(const ArenaAllocator<U>& other) const noexcept { return arena == other.arena; }
+    template <typename U>
+    bool operator!=(const ArenaAllocator<U>& other) const noexcept { return arena != other.arena; }
+};
+
+/// Vector whose storage lives in a FrameArena
+template <typename T>
+using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+
+/**
+ * @class DoubleBufferedArena
+ * @brief Two frame arenas used alternately
+ *
+ * Data allocated from Current() in frame N stays valid through frame N+1,
+ * which is what a consumer running one frame behind (e.g. the render
+ * thread) needs. Flip() at the start of each frame resets the arena that
+ * was used two frames ago.
+ */
+class DoubleBufferedArena {
+private:
+    FrameArena arenas[2];  ///< Alternating arenas
+    int current = 0;       ///< Index of the arena for this frame
+
+public:
+    /**
+     * @brief Switches to the other arena and resets it
+     */
+    nil Flip() {
+        current ^= 1;
+        arenas[current].Reset();
+    }
+
+    FrameArena& Current() { return arenas[current]; }
+    FrameArena& Previous() { return arenas[current ^ 1]; }
+    const FrameArena& Current() const { return arenas[current]; }
+    const FrameArena& Previous() const { return arenas[current ^ 1]; }
+};
+
+} // namespace MentalEngine
+
+#endif // MENTAL_FRAME_ARENA_H
@@ -0,0 +1,262 @@
+/**
+ * @file JobSystem.cpp
+ * @brief Implementation of the work-stealing job scheduler
+ * @author MentalEngine Team
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#include "JobSystem.h"
+#include <algorithm>
+#include <chrono>
+#include <iterator>
+
+namespace MentalEngine {
+
+namespace {
+
+thread_local const JobSystem* tls_owner = nullptr;  ///< Pool the current thread works for
+thread_local size_t tls_index = 0;                  ///< Worker index inside that pool
+thread_local const JobSystem* tls_group_owner = nullptr;  ///< Pool of the job the current thread runs
+thread_local uint64_t tls_group = 0;                ///< Group of that job
+
+} // namespace
+
+JobSystem::JobSystem(unsigned worker_count) {
+    if (worker_count == 0) {
+        // Вызывающий поток тоже выполняет задачи в Wait(), поэтому на одно ядро меньше
+        unsigned hardware = std::thread::hardware_concurrency();
+        worker_count = hardware > 1 ? hardware - 1 : 1;
+    }
+    for (unsigned i = 0; i <= worker_count; i++) {
+        queues.push_back(std::make_unique<WorkQueue>());
+        counters.push_back(std::make_unique<WorkerCounters>());
+    }
+    for (unsigned i = 0; i < worker_count; i++) {
+        workers.emplace_back(&JobSystem::__worker_loop, this, static_cast<size_t>(i));
+    }
+}
+
+JobSystem::~JobSystem() {
+    {
+        std::lock_guard<std::mutex> lock(sleep_mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+}
+
+JobSystem& JobSystem::Instance() {
+    static JobSystem instance;
+    return instance;
+}
+
+JobHandle JobSystem::Submit(std::function<nil()> function, const std::vector<JobHandle>& dependencies) {
+    return __submit(std::move(function), dependencies, __current_group());
+}
+
+uint64_t JobSystem::__current_group() {
+    // Внутри задачи - ее группа, иначе новая
+    return tls_group_owner == this ? tls_group : next_group++;
+}
+
+JobHandle JobSystem::__submit(std::function<nil()> function, const std::vector<JobHandle>& dependencies, uint64_t group) {
+    JobHandle job = std::make_shared<Job>();
+    job->function = std::move(function);
+    job->group = group;
+
+    for (const JobHandle& dependency : dependencies) {
+        if (!dependency) continue;
+        std::lock_guard<std::mutex> lock(dependency->successors_mutex);
+        if (dependency->finished) continue;
+        job->unfinished_dependencies++;
+        dependency->successors.push_back(job);
+    }
+
+    // Снимаем "страховочную" единицу: зависимости могли завершиться во время цикла
+    if (job->unfinished_dependencies.fetch_sub(1) == 1) {
+        __schedule(job);
+    }
+    return job;
+}
+
+nil JobSystem::Wait(const JobHandle& job) {
+    if (!job) return;
+    while (!job->IsFinished()) {
+        // Счетчик читается до поиска: задача, поставленная после него, разбудит ожидание
+        const uint64_t seen = scheduled.load();
+        if (__help(job->group)) continue;
+
+        waiters++;
+        {
+            std::unique_lock<std::mutex> lock(sleep_mutex);
+            wake.wait(lock, [this, &job, seen] { return job->IsFinished() || scheduled.load() != seen; });
+        }
+        waiters--;
+    }
+}
+
+nil JobSystem::ParallelFor(size_t begin, size_t end, size_t grain, const std::function<nil(size_t, size_t)>& body) {
+    if (end <= begin) return;
+    const size_t count = end - begin;
+    grain = std::max<size_t>(1, grain);
+
+    // Несколько диапазонов на поток, чтобы кражи выравнивали неравномерную нагрузку
+    const size_t max_ranges = (workers.size() + 1) * 4;
+    const size_t ranges = std::min(std::max<size_t>(1, count / grain), max_ranges);
+    if (ranges == 1) {
+        body(begin, end);
+        return;
+    }
+
+    const size_t step = count / ranges;
+    const size_t remainder = count % ranges;
+    const uint64_t group = __current_group();
+    std::vector<JobHandle> jobs;
+    jobs.reserve(ranges - 1);
+
+    size_t range_begin = begin + step + (remainder > 0 ? 1 : 0);
+    const size_t first_end = range_begin;
+    for (size_t r = 1; r < ranges; r++) {
+        const size_t range_end = range_begin + step + (r < remainder ? 1 : 0);
+        jobs.push_back(__submit([&body, range_begin, range_end] { body(range_begin, range_end); }, {}, group));
+        range_begin = range_end;
+    }
+
+    body(begin, first_end);
+    for (const JobHandle& job : jobs) {
+        Wait(job);
+    }
+}
+
+std::vector<JobWorkerStats> JobSystem::GetStats() const {
+    std::vector<JobWorkerStats> stats;
+    GetStats(stats);
+    return stats;
+}
+
+nil JobSystem::GetStats(std::vector<JobWorkerStats>& stats) const {
+    stats.resize(counters.size());
+    for (size_t i = 0; i < counters.size(); i++) {
+        stats[i].jobs_executed = counters[i]->jobs_executed.load(std::memory_order_relaxed);
+        stats[i].jobs_stolen = counters[i]->jobs_stolen.load(std::memory_order_relaxed);
+        stats[i].busy_ns = counters[i]->busy_ns.load(std::memory_order_relaxed);
+    }
+}
+
+nil JobSystem::__worker_loop(size_t index) {
+    tls_owner = this;
+    tls_index = index;
+
+    for (;;) {
+        bool stolen = false;
+        JobHandle job = __take(index, stolen, 0);
+        if (job) {
+            __execute(job, stolen);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleep_mutex);
+        wake.wait(lock, [this] { return queued.load() > 0 || stopping.load(); });
+        if (stopping && queued.load() == 0) break;
+    }
+}
+
+nil JobSystem::__schedule(JobHandle job) {
+    const size_t own = tls_owner == this ? tls_index : queues.size() - 1;
+    {
+        std::lock_guard<std::mutex> lock(queues[own]->mutex);
+        queues[own]->jobs.push_back(std::move(job));
+    }
+    queued++;
+    scheduled++;
+    {
+        std::lock_guard<std::mutex> lock(sleep_mutex);
+    }
+    // Ждущий поток может не взять задачу чужой группы, поэтому тогда будим всех
+    if (waiters.load() > 0) wake.notify_all();
+    else wake.notify_one();
+}
+
+JobHandle JobSystem::__take(size_t own_queue, bool& stolen, uint64_t group) {
+    if (queued.load() == 0) return nullptr;
+
+    {
+        WorkQueue& queue = *queues[own_queue];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        for (auto it = queue.jobs.rbegin(); it != queue.jobs.rend(); ++it) {
+            if (group != 0 && (*it)->group != group) continue;
+            JobHandle job = std::move(*it);
+            queue.jobs.erase(std::next(it).base());
+            queued--;
+            stolen = false;
+            return job;
+        }
+    }
+
+    // Крадем самые старые задачи: обычно это самые крупные куски работы
+    for (size_t offset = 1; offset < queues.size(); offset++) {
+        WorkQueue& victim = *queues[(own_queue + offset) % queues.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        for (auto it = victim.jobs.begin(); it != victim.jobs.end(); ++it) {
+            if (group != 0 && (*it)->group != group) continue;
+            JobHandle job = std::move(*it);
+            victim.jobs.erase(it);
+            queued--;
+            stolen = true;
+            return job;
+        }
+    }
+    return nullptr;
+}
+
+nil JobSystem::__execute(const JobHandle& job, bool stolen) {
+    WorkerCounters& counter = *counters[tls_owner == this ? tls_index : counters.size() - 1];
+    auto start = std::chrono::steady_clock::now();
+    // Задачи, поставленные изнутри, наследуют группу
+    const JobSystem* previous_owner = tls_group_owner;
+    const uint64_t previous_group = tls_group;
+    tls_group_owner = this;
+    tls_group = job->group;
+    job->function();
+    tls_group_owner = previous_owner;
+    tls_group = previous_group;
+    job->function = nullptr;  // release captures before successors run
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    counter.busy_ns.fetch_add(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()),
+                              std::memory_order_relaxed);
+    counter.jobs_executed.fetch_add(1, std::memory_order_relaxed);
+    if (stolen) counter.jobs_stolen.fetch_add(1, std::memory_order_relaxed);
+
+    std::vector<JobHandle> ready;
+    {
+        std::lock_guard<std::mutex> lock(job->successors_mutex);
+        job->finished = true;
+        ready.swap(job->successors);
+    }
+    for (JobHandle& successor : ready) {
+        if (successor->unfinished_dependencies.fetch_sub(1) == 1) {
+            __schedule(std::move(successor));
+        }
+    }
+
+    if (waiters.load() > 0) {
+        {
+            std::lock_guard<std::mutex> lock(sleep_mutex);
+        }
+        wake.notify_all();
+    }
+}
+
+bool JobSystem::__help(uint64_t group) {
+    const size_t own = tls_owner == this ? tls_index : queues.size() - 1;
+    bool stolen = false;
+    JobHandle job = __take(own, stolen, group);
+    if (!job) return false;
+    __execute(job, stolen);
+    return true;
+}
+
+} // namespace MentalEngine
@@ -0,0 +1,227 @@
+/**
+ * @file JobSystem.h
+ * @brief Work-stealing job scheduler for MentalEngine
+ * @author MentalEngine Team
+ * @version 1.0.0
+ * @date 2024
+ *
+ * This file defines the JobSystem class, a pool of worker threads that run
+ * small jobs. Jobs may depend on other jobs, forming a task graph, and
+ * ParallelFor() splits index ranges across the pool.
+ */
+
+#ifndef MENTAL_JOB_SYSTEM_H
+#define MENTAL_JOB_SYSTEM_H
+
+#include "Types.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace MentalEngine {
+
+class JobSystem;
+
+/**
+ * @class Job
+ * @brief One node of a task graph
+ *
+ * Created by JobSystem::Submit() and referenced through JobHandle. A job is
+ * queued once all of its dependencies have finished.
+ */
+class Job {
+private:
+    friend class JobSystem;
+
+    std::function<nil()> function;                      ///< Work to run
+    uint64_t group = 0;                                 ///< Shared by jobs of one submission and their descendants
+    std::atomic<int> unfinished_dependencies{1};        ///< Dependencies left, plus one while submitting
+    std::atomic<bool> finished{false};                  ///< Set after function returned
+    std::mutex successors_mutex;                        ///< Guards successors and finished hand-off
+    std::vector<std::shared_ptr<Job>> successors;       ///< Jobs waiting for this one
+
+public:
+    /**
+     * @brief Checks whether the job has run
+     * @return bool True once the function has returned
+     */
+    bool IsFinished() const { return finished.load(); }
+};
+
+using JobHandle = std::shared_ptr<Job>;
+
+/**
+ * @struct JobWorkerStats
+ * @brief Cumulative counters of one worker thread
+ */
+struct JobWorkerStats {
+    uint64_t jobs_executed = 0;  ///< Jobs run by the thread
+    uint64_t jobs_stolen = 0;    ///< Jobs taken from another thread's queue
+    uint64_t busy_ns = 0;        ///< Time spent inside job functions
+};
+
+/**
+ * @class JobSystem
+ * @brief Pool of worker threads with per-worker deques and work stealing
+ *
+ * Each worker pushes the jobs it spawns onto its own deque and pops them
+ * from the back (newest first, warm in cache); idle workers steal from the
+ * front of other deques. Jobs submitted from threads outside the pool go to
+ * a shared injection queue that every worker steals from.
+ *
+ * Jobs form groups: a job submitted from outside the pool starts a new
+ * group (ParallelFor() uses one group for all its ranges), and a job
+ * submitted while another runs joins that job's group. Threads that call
+ * Wait() or ParallelFor() run queued jobs of the awaited group while they
+ * wait, so waiting inside a job cannot deadlock the pool, and a frame
+ * waiting for its own ranges never picks up a long unrelated job.
+ *
+ * Job functions must not throw.
+ *
+ * @note This class is non-copyable; the destructor finishes queued jobs and
+ *       joins the workers
+ */
+class JobSystem {
+private:
+    /**
+     * @struct WorkQueue
+     * @brief Deque of ready jobs owned by one thread
+     */
+    struct WorkQueue {
+        std::mutex mutex;                 ///< Guards jobs
+        std::deque<JobHandle> jobs;       ///< Ready jobs; owner uses the back, thieves the front
+    };
+
+    /**
+     * @struct WorkerCounters
+     * @brief Atomic counters behind JobWorkerStats
+     */
+    struct WorkerCounters {
+        std::atomic<uint64_t> jobs_executed{0};
+        std::atomic<uint64_t> jobs_stolen{0};
+        std::atomic<uint64_t> busy_ns{0};
+    };
+
+    std::vector<std::thread> workers;                       ///< Worker threads
+    std::vector<std::unique_ptr<WorkQueue>> queues;         ///< One per worker, plus the injection queue last
+    std::vector<std::unique_ptr<WorkerCounters>> counters;  ///< One per worker, plus external helpers last
+    std::atomic<size_t> queued{0};                          ///< Ready jobs across all queues
+    std::atomic<uint64_t> scheduled{0};                     ///< Jobs made ready so far; wakes waiters that could not help
+    std::atomic<uint64_t> next_group{1};                    ///< Group of the next submission from outside the pool
+    std::atomic<int> waiters{0};                            ///< Threads blocked in Wait()
+    std::atomic<bool> stopping{false};                      ///< Workers exit once the queues are empty
+    std::mutex sleep_mutex;                                 ///< Pairs with wake
+    std::condition_variable wake;                           ///< Signals new jobs or finished jobs
+
+    /**
+     * @brief Worker thread main loop
+     * @private
+     */
+    nil __worker_loop(size_t index);
+
+    /**
+     * @brief Queues a job in a group
+     * @private
+     */
+    JobHandle __submit(std::function<nil()> function, const std::vector<JobHandle>& dependencies, uint64_t group);
+
+    /**
+     * @brief Gets the group new jobs of the calling thread belong to
+     * @private
+     */
+    uint64_t __current_group();
+
+    /**
+     * @brief Puts a ready job on the calling thread's queue
+     * @private
+     */
+    nil __schedule(JobHandle job);
+
+    /**
+     * @brief Takes a job from the own queue or steals one
+     * @param group Only jobs of this group; 0 takes any
+     * @private
+     */
+    JobHandle __take(size_t own_queue, bool& stolen, uint64_t group);
+
+    /**
+     * @brief Runs a job and releases its successors
+     * @private
+     */
+    nil __execute(const JobHandle& job, bool stolen);
+
+    /**
+     * @brief Runs one queued job of a group on the calling thread, if any
+     * @private
+     */
+    bool __help(uint64_t group);
+
+public:
+    /**
+     * @brief Constructor - starts the workers
+     * @param worker_count Worker threads; 0 uses one per core minus the calling thread
+     */
+    explicit JobSystem(unsigned worker_count = 0);
+    ~JobSystem();
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    /**
+     * @brief Gets the process-wide scheduler shared by all subsystems
+     * @return JobSystem& Scheduler, created on first use
+     */
+    static JobSystem& Instance();
+
+    /**
+     * @brief Queues a job
+     * @param function Work to run
+     * @param dependencies Jobs that must finish first
+     * @return JobHandle Handle for Wait() or as a dependency of later jobs
+     */
+    JobHandle Submit(std::function<nil()> function, const std::vector<JobHandle>& dependencies = {});
+
+    /**
+     * @brief Blocks until a job has finished, running jobs of its group meanwhile
+     * @param job Job to wait for; null handles return immediately
+     */
+    nil Wait(const JobHandle& job);
+
+    /**
+     * @brief Runs body over [begin, end) split into ranges of at least grain indices
+     *
+     * Returns when every range is done. The calling thread takes part, and
+     * small ranges run inline without touching the queues.
+     *
+     * @param begin First index
+     * @param end One past the last index
+     * @param grain Minimum indices per range
+     * @param body Called as body(range_begin, range_end)
+     */
+    nil ParallelFor(size_t begin, size_t end, size_t grain, const std::function<nil(size_t, size_t)>& body);
+
+    size_t GetWorkerCount() const { return workers.size(); }
+
+    /**
+     * @brief Gets counters for every worker, plus one entry for external threads
+     * @return std::vector<JobWorkerStats> Cumulative counters; the last entry covers
+     *         jobs run by threads that helped in Wait()/ParallelFor()
+     */
+    std::vector<JobWorkerStats> GetStats() const;
+
+    /**
+     * @brief Fills counters for every worker into a caller-owned buffer
+     * @param stats Receives the same entries as GetStats(); capacity is reused
+     */
+    nil GetStats(std::vector<JobWorkerStats>& stats) const;
+};
+
+} // namespace MentalEngine
+
+#endif // MENTAL_JOB_SYSTEM_H
@@ -0,0 +1,119 @@
+/**
+ * @file MappedFile.cpp
+ * @brief Implementation of the MappedFile class
+ * @author MentalEngine Team
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#include "MappedFile.h"
+#include <cstdio>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define MENTAL_HAS_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#define MENTAL_HAS_MMAP 0
+#endif
+
+namespace MentalEngine {
+
+MappedFile::~MappedFile() {
+    __release();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept {
+    *this = std::move(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        __release();
+        data = other.data;
+        size = other.size;
+        mapped = other.mapped;
+        is_open = other.is_open;
+        fallback = std::move(other.fallback);
+        if (!mapped && !fallback.empty()) data = fallback.data();
+        other.data = nullptr;
+        other.size = 0;
+        other.mapped = false;
+        other.is_open = false;
+    }
+    return *this;
+}
+
+bool MappedFile::Open(const std::string& path) {
+    __release();
+
+#if MENTAL_HAS_MMAP
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat info;
+    if (::fstat(fd, &info) != 0) {
+        ::close(fd);
+        return false;
+    }
+
+    size = static_cast<size_t>(info.st_size);
+    if (size > 0) {
+        void* address = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (address == MAP_FAILED) {
+            ::close(fd);
+            size = 0;
+            return false;
+        }
+        data = static_cast<const uint8_t*>(address);
+        mapped = true;
+    }
+    // Отображение остается валидным после закрытия дескриптора
+    ::close(fd);
+#else
+    FILE* file = std::fopen(path.c_str(), "rb");
+    if (!file) return false;
+    std::fseek(file, 0, SEEK_END);
+    long length = std::ftell(file);
+    std::fseek(file, 0, SEEK_SET);
+    if (length < 0) {
+        std::fclose(file);
+        return false;
+    }
+    fallback.resize(static_cast<size_t>(length));
+    size_t read = fallback.empty() ? 0 : std::fread(fallback.data(), 1, fallback.size(), file);
+    std::fclose(file);
+    if (read != fallback.size()) {
+        fallback.clear();
+        return false;
+    }
+    data = fallback.data();
+    size = fallback.size();
+#endif
+
+    is_open = true;
+    return true;
+}
+
+nil MappedFile::AdviseSequential() const {
+#if MENTAL_HAS_MMAP
+    if (mapped) ::madvise(const_cast<uint8_t*>(data), size, MADV_SEQUENTIAL);
+#endif
+}
+
+nil MappedFile::__release() {
+#if MENTAL_HAS_MMAP
+    if (mapped) ::munmap(const_cast<uint8_t*>(data), size);
+#endif
+    fallback.clear();
+    fallback.shrink_to_fit();
+    data = nullptr;
+    size = 0;
+    mapped = false;
+    is_open = false;
+}
+
+} // namespace MentalEngine
@@ -0,0 +1,81 @@
+/**
+ * @file MappedFile.h
+ * @brief Read-only memory-mapped file for MentalEngine
+ * @author MentalEngine Team
+ * @version 1.0.0
+ * @date 2024
+ *
+ * This file defines the MappedFile class, which maps a whole file into the
+ * address space so loaders can read it in place instead of copying it
+ * through stream buffers.
+ */
+
+#ifndef MENTAL_MAPPED_FILE_H
+#define MENTAL_MAPPED_FILE_H
+
+#include "Types.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace MentalEngine {
+
+/**
+ * @class MappedFile
+ * @brief RAII wrapper around a read-only file mapping
+ *
+ * On POSIX systems the file is mapped with mmap() and pages are faulted in
+ * on first access. Elsewhere the file is read into a heap buffer, which
+ * keeps the interface identical at the cost of one copy.
+ *
+ * @note This class is movable but not copyable
+ */
+class MappedFile {
+private:
+    const uint8_t* data = nullptr;  ///< Start of the mapping
+    size_t size = 0;                ///< Mapping size in bytes
+    bool mapped = false;            ///< True if data comes from mmap()
+    bool is_open = false;           ///< Set after a successful Open()
+    std::vector<uint8_t> fallback;  ///< Heap copy when mapping is unavailable
+
+    /**
+     * @brief Releases the mapping
+     * @private
+     */
+    nil __release();
+
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /**
+     * @brief Maps a file
+     * @param path File path
+     * @return bool False if the file cannot be opened or mapped
+     */
+    bool Open(const std::string& path);
+
+    /**
+     * @brief Unmaps the file
+     */
+    nil Close() { __release(); }
+
+    /**
+     * @brief Hints that the mapping will be read front to back
+     */
+    nil AdviseSequential() const;
+
+    const uint8_t* GetData() const { return data; }
+    size_t GetSize() const { return size; }
+    bool IsOpen() const { return is_open; }
+};
+
+} // namespace MentalEngine
+
+#endif // MENTAL_MAPPED_FILE_H
@@ -108,13 +108,100 @@ Matrix4 orthographic(float left, float right, float bottom, float top, float nea
     result.m[0][0] = 2.0f / (right - left);
     result.m[1][1] = 2.0f / (top - bottom);
     result.m[2][2] = -2.0f / (far - near);
-    result.m[0][3] = -(right + left) / (right - left);
-    result.m[1][3] = -(top + bottom) / (top - bottom);
-    result.m[2][3] = -(far + near) / (far - near);
+    // Column-major like lookAt/perspective: translation lives in column 3
+    result.m[3][0] = -(right + left) / (right - left);
+    result.m[3][1] = -(top + bottom) / (top - bottom);
+    result.m[3][2] = -(far + near) / (far - near);
     
     return result;
 }
 
+Matrix4 inverse(const Matrix4& matrix) {
+    const float* a = matrix.data();
+    float inv[16];
+    
+    inv[0] = a[5] * a[10] * a[15] - a[5] * a[11] * a[14] - a[9] * a[6] * a[15]
+           + a[9] * a[7] * a[14] + a[13] * a[6] * a[11] - a[13] * a[7] * a[10];
+    inv[4] = -a[4] * a[10] * a[15] + a[4] * a[11] * a[14] + a[8] * a[6] * a[15]
+           - a[8] * a[7] * a[14] - a[12] * a[6] * a[11] + a[12] * a[7] * a[10];
+    inv[8] = a[4] * a[9] * a[15] - a[4] * a[11] * a[13] - a[8] * a[5] * a[15]
+           + a[8] * a[7] * a[13] + a[12] * a[5] * a[11] - a[12] * a[7] * a[9];
+    inv[12] = -a[4] * a[9] * a[14] + a[4] * a[10] * a[13] + a[8] * a[5] * a[14]
+            - a[8] * a[6] * a[13] - a[12] * a[5] * a[10] + a[12] * a[6] * a[9];
+    inv[1] = -a[1] * a[10] * a[15] + a[1] * a[11] * a[14] + a[9] * a[2] * a[15]
+           - a[9] * a[3] * a[14] - a[13] * a[2] * a[11] + a[13] * a[3] * a[10];
+    inv[5] = a[0] * a[10] * a[15] - a[0] * a[11] * a[14] - a[8] * a[2] * a[15]
+           + a[8] * a[3] * a[14] + a[12] * a[2] * a[11] - a[12] * a[3] * a[10];
+    inv[9] = -a[0] * a[9] * a[15] + a[0] * a[11] * a[13] + a[8] * a[1] * a[15]
+           - a[8] * a[3] * a[13] - a[12] * a[1] * a[11] + a[12] * a[3] * a[9];
+    inv[13] = a[0] * a[9] * a[14] - a[0] * a[10] * a[13] - a[8] * a[1] * a[14]
+            + a[8] * a[2] * a[13] + a[12] * a[1] * a[10] - a[12] * a[2] * a[9];
+    inv[2] = a[1] * a[6] * a[15] - a[1] * a[7] * a[14] - a[5] * a[2] * a[15]
+           + a[5] * a[3] * a[14] + a[13] * a[2] * a[7] - a[13] * a[3] * a[6];
+    inv[6] = -a[0] * a[6] * a[15] + a[0] * a[7] * a[14] + a[4] * a[2] * a[15]
+           - a[4] * a[3] * a[14] - a[12] * a[2] * a[7] + a[12] * a[3] * a[6];
+    inv[10] = a[0] * a[5] * a[15] - a[0] * a[7] * a[13] - a[4] * a[1] * a[15]
+            + a[4] * a[3] * a[13] + a[12] * a[1] * a[7] - a[12] * a[3] * a[5];
+    inv[14] = -a[0] * a[5] * a[14] + a[0] * a[6] * a[13] + a[4] * a[1] * a[14]
+            - a[4] * a[2] * a[13] - a[12] * a[1] * a[6] + a[12] * a[2] * a[5];
+    inv[3] = -a[1] * a[6] * a[11] + a[1] * a[7] * a[10] + a[5] * a[2] * a[11]
+           - a[5] * a[3] * a[10] - a[9] * a[2] * a[7] + a[9] * a[3] * a[6];
+    inv[7] = a[0] * a[6] * a[11] - a[0] * a[7] * a[10] - a[4] * a[2] * a[11]
+           + a[4] * a[3] * a[10] + a[8] * a[2] * a[7] - a[8] * a[3] * a[6];
+    inv[11] = -a[0] * a[5] * a[11] + a[0] * a[7] * a[9] + a[4] * a[1] * a[11]
+            - a[4] * a[3] * a[9] - a[8] * a[1] * a[7] + a[8] * a[3] * a[5];
+    inv[15] = a[0] * a[5] * a[10] - a[0] * a[6] * a[9] - a[4] * a[1] * a[10]
+            + a[4] * a[2] * a[9] + a[8] * a[1] * a[6] - a[8] * a[2] * a[5];
+    
+    float det = a[0] * inv[0] + a[1] * inv[4] + a[2] * inv[8] + a[3] * inv[12];
+    
+    Matrix4 result;
+    if (det == 0.0f) return result;
+    
+    float inv_det = 1.0f / det;
+    for (int i = 0; i < 16; i++) {
+        result.m[i / 4][i % 4] = inv[i] * inv_det;
+    }
+    return result;
+}
+
+Vector4 transformColumnMajor(const Matrix4& matrix, const Vector4& v) {
+    const auto& m = matrix.m;
+    return Vector4(
+        m[0][0] * v.x + m[1][0] * v.y + m[2][0] * v.z + m[3][0] * v.w,
+        m[0][1] * v.x + m[1][1] * v.y + m[2][1] * v.z + m[3][1] * v.w,
+        m[0][2] * v.x + m[1][2] * v.y + m[2][2] * v.z + m[3][2] * v.w,
+        m[0][3] * v.x + m[1][3] * v.y + m[2][3] * v.z + m[3][3] * v.w
+    );
+}
+
+Quaternion angleAxis(float angle, const Vector3& axis) {
+    Vector3 n = axis.normalized();
+    float s = std::sin(angle * 0.5f);
+    return Quaternion(std::cos(angle * 0.5f), n.x * s, n.y * s, n.z * s);
+}
+
+Quaternion slerp(const Quaternion& from, const Quaternion& to, float t) {
+    // q и -q задают один поворот - идем по короткой дуге
+    float cos_theta = from.dot(to);
+    Quaternion end = to;
+    if (cos_theta < 0.0f) {
+        cos_theta = -cos_theta;
+        end = Quaternion(-to.w, -to.x, -to.y, -to.z);
+    }
+    
+    float a = 1.0f - t;
+    float b = t;
+    if (cos_theta < 0.9995f) {
+        float theta = std::acos(cos_theta);
+        float inv_sin = 1.0f / std::sin(theta);
+        a = std::sin(a * theta) * inv_sin;
+        b = std::sin(b * theta) * inv_sin;
+    }
+    return Quaternion(from.w * a + end.w * b, from.x * a + end.x * b,
+                      from.y * a + end.y * b, from.z * a + end.z * b).normalized();
+}
+
 float radians(float degrees) {
     return degrees * M_PI / 180.0f;
 }
@@ -120,6 +120,108 @@ struct Vector4 {
     Vector4(const Vector3& v, float w) : x(v.x), y(v.y), z(v.z), w(w) {}
 };
 
+/**
+ * @struct Vector2d
+ * @brief Double-precision 2D vector for world positions
+ * 
+ * Used where coordinates can be far from zero (site plans in survey
+ * coordinates). Geometry itself stays in float, relative to such a point.
+ */
+struct Vector2d {
+    double x, y;
+    
+    Vector2d() : x(0.0), y(0.0) {}
+    Vector2d(double x, double y) : x(x), y(y) {}
+    explicit Vector2d(const Vector2& v) : x(v.x), y(v.y) {}
+    
+    Vector2d operator+(const Vector2d& other) const {
+        return Vector2d(x + other.x, y + other.y);
+    }
+    
+    Vector2d operator-(const Vector2d& other) const {
+        return Vector2d(x - other.x, y - other.y);
+    }
+    
+    bool operator==(const Vector2d& other) const { return x == other.x && y == other.y; }
+    bool operator!=(const Vector2d& other) const { return !(*this == other); }
+    
+    Vector2 toFloat() const {
+        return Vector2(static_cast<float>(x), static_cast<float>(y));
+    }
+};
+
+/**
+ * @struct Vector3d
+ * @brief Double-precision 3D vector for world positions
+ */
+struct Vector3d {
+    double x, y, z;
+    
+    Vector3d() : x(0.0), y(0.0), z(0.0) {}
+    Vector3d(double x, double y, double z) : x(x), y(y), z(z) {}
+    explicit Vector3d(const Vector3& v) : x(v.x), y(v.y), z(v.z) {}
+    
+    Vector3d operator+(const Vector3d& other) const {
+        return Vector3d(x + other.x, y + other.y, z + other.z);
+    }
+    
+    Vector3d operator-(const Vector3d& other) const {
+        return Vector3d(x - other.x, y - other.y, z - other.z);
+    }
+    
+    double length() const {
+        return std::sqrt(x * x + y * y + z * z);
+    }
+    
+    Vector3 toFloat() const {
+        return Vector3(static_cast<float>(x), static_cast<float>(y), static_cast<float>(z));
+    }
+};
+
+/**
+ * @struct Quaternion
+ * @brief Rotation stored as a unit quaternion
+ * 
+ * Products compose rotations right to left: (a * b).rotate(v) applies b
+ * first, then a.
+ */
+struct Quaternion {
+    float w, x, y, z;
+    
+    Quaternion() : w(1.0f), x(0.0f), y(0.0f), z(0.0f) {}
+    Quaternion(float w, float x, float y, float z) : w(w), x(x), y(y), z(z) {}
+    
+    Quaternion operator*(const Quaternion& other) const {
+        return Quaternion(
+            w * other.w - x * other.x - y * other.y - z * other.z,
+            w * other.x + x * other.w + y * other.z - z * other.y,
+            w * other.y - x * other.z + y * other.w + z * other.x,
+            w * other.z + x * other.y - y * other.x + z * other.w
+        );
+    }
+    
+    float dot(const Quaternion& other) const {
+        return w * other.w + x * other.x + y * other.y + z * other.z;
+    }
+    
+    Quaternion conjugate() const {
+        return Quaternion(w, -x, -y, -z);
+    }
+    
+    Quaternion normalized() const {
+        float len = std::sqrt(dot(*this));
+        if (len == 0.0f) return Quaternion();
+        return Quaternion(w / len, x / len, y / len, z / len);
+    }
+    
+    Vector3 rotate(const Vector3& v) const {
+        // v + 2w(q x v) + 2 q x (q x v), без построения матрицы
+        Vector3 q(x, y, z);
+        Vector3 t = q.cross(v) * 2.0f;
+        return v + t * w + q.cross(t);
+    }
+};
+
 /**
  * @struct Matrix4
  * @brief 4x4 matrix representation
@@ -230,6 +332,45 @@ Matrix4 perspective(float fov, float aspect, float near, float far);
  */
 Matrix4 orthographic(float left, float right, float bottom, float top, float near, float far);
 
+/**
+ * @brief Compute the inverse of a 4x4 matrix
+ * @param matrix Matrix to invert
+ * @return Matrix4 Inverse matrix, or identity if the matrix is singular
+ * 
+ * Works on the raw element array, so the result keeps the storage layout
+ * of the input (column-major matrices stay column-major).
+ */
+Matrix4 inverse(const Matrix4& matrix);
+
+/**
+ * @brief Transform a vector by a matrix stored in OpenGL (column-major) layout
+ * @param matrix Matrix with m[column][row] storage, as uploaded to shaders
+ * @param v Vector to transform
+ * @return Vector4 Transformed vector
+ */
+Vector4 transformColumnMajor(const Matrix4& matrix, const Vector4& v);
+
+/**
+ * @brief Create a rotation around an axis
+ * @param angle Angle in radians, counter-clockwise looking down the axis
+ * @param axis Rotation axis; need not be normalized
+ * @return Quaternion Unit quaternion
+ */
+Quaternion angleAxis(float angle, const Vector3& axis);
+
+/**
+ * @brief Spherical interpolation between two rotations
+ * 
+ * Takes the shorter arc. Nearly equal rotations fall back to normalized
+ * linear interpolation, which is cheaper and avoids dividing by a tiny sine.
+ * 
+ * @param from Rotation at t = 0
+ * @param to Rotation at t = 1
+ * @param t Interpolation factor (0 to 1)
+ * @return Quaternion Unit quaternion
+ */
+Quaternion slerp(const Quaternion& from, const Quaternion& to, float t);
+
 /**
  * @brief Convert degrees to radians
  * @param degrees Angle in degrees
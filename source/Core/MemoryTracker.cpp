@@ -0,0 +1,265 @@
+/**
+ * @file MemoryTracker.cpp
+ * @brief Allocation counters and, with MENTAL_MEMORY_TRACKING, the tracking operator new/delete
+ * @author MentalEngine Team
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#include "MemoryTracker.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+constexpr size_t TAG_COUNT = static_cast<size_t>(MentalEngine::MemoryTag::Count);
+constexpr size_t GPU_KIND_COUNT = static_cast<size_t>(MentalEngine::GpuMemoryKind::Count);
+
+/**
+ * @struct TagCounters
+ * @brief Atomic counters behind MemoryTagStats
+ */
+struct TagCounters {
+    std::atomic<int64_t> live_bytes{0};
+    std::atomic<int64_t> peak_bytes{0};
+    std::atomic<uint64_t> allocations{0};
+    std::atomic<uint64_t> frees{0};
+};
+
+// Все счетчики инициализируются константно: operator new может вызываться до main()
+std::atomic<uint64_t> allocation_count{0};                  ///< Heap allocations since startup
+TagCounters tag_counters[TAG_COUNT];                        ///< Per-tag heap counters
+TagCounters total_counters;                                 ///< Heap counters of all tags
+std::atomic<int64_t> gpu_bytes[GPU_KIND_COUNT];             ///< Resident GPU memory per kind
+std::atomic<uint64_t> gpu_uploaded_bytes{0};                ///< Bytes uploaded since startup
+thread_local MentalEngine::MemoryTag current_tag = MentalEngine::MemoryTag::General;
+
+const char* const TAG_NAMES[TAG_COUNT] = {"General", "Renderer", "UI", "Scene", "Console"};
+
+#ifdef MENTAL_MEMORY_TRACKING
+
+/**
+ * @struct AllocationHeader
+ * @brief Stored just before every tracked block
+ */
+struct AllocationHeader {
+    uint64_t size;    ///< Requested bytes
+    uint32_t offset;  ///< Distance from the malloc'ed pointer to the user pointer
+    uint8_t tag;      ///< MemoryTag the block is charged to
+    uint8_t padding[3];
+};
+static_assert(sizeof(AllocationHeader) == 16, "header must keep 16-byte alignment");
+
+constexpr size_t HEADER_SIZE = sizeof(AllocationHeader);
+
+nil RaisePeak(std::atomic<int64_t>& peak, int64_t value) {
+    int64_t seen = peak.load(std::memory_order_relaxed);
+    while (value > seen && !peak.compare_exchange_weak(seen, value, std::memory_order_relaxed)) {
+    }
+}
+
+nil Account(TagCounters& counters, int64_t bytes) {
+    const int64_t live = counters.live_bytes.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+    if (bytes > 0) {
+        counters.allocations.fetch_add(1, std::memory_order_relaxed);
+        RaisePeak(counters.peak_bytes, live);
+    } else {
+        counters.frees.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void* AllocateTracked(size_t size, size_t alignment, MentalEngine::MemoryTag tag) {
+    // Заголовок перед блоком; большие выравнивания делаются запасом из malloc, aligned_alloc нет в MSVC
+    const size_t align = std::max(alignment, alignof(std::max_align_t));
+    const size_t slack = align > alignof(std::max_align_t) ? align - 1 : 0;
+    unsigned char* raw = static_cast<unsigned char*>(std::malloc(size + HEADER_SIZE + slack));
+    if (!raw) return nullptr;
+
+    const uintptr_t start = reinterpret_cast<uintptr_t>(raw) + HEADER_SIZE + slack;
+    const size_t offset = static_cast<size_t>((start & ~static_cast<uintptr_t>(align - 1)) - reinterpret_cast<uintptr_t>(raw));
+
+    AllocationHeader* header = reinterpret_cast<AllocationHeader*>(raw + offset - HEADER_SIZE);
+    header->size = size;
+    header->offset = static_cast<uint32_t>(offset);
+    header->tag = static_cast<uint8_t>(tag);
+
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+    Account(tag_counters[header->tag], static_cast<int64_t>(size));
+    Account(total_counters, static_cast<int64_t>(size));
+    return raw + offset;
+}
+
+nil FreeTracked(void* memory) {
+    if (!memory) return;
+    unsigned char* user = static_cast<unsigned char*>(memory);
+    const AllocationHeader* header = reinterpret_cast<const AllocationHeader*>(user - HEADER_SIZE);
+    Account(tag_counters[header->tag], -static_cast<int64_t>(header->size));
+    Account(total_counters, -static_cast<int64_t>(header->size));
+    std::free(user - header->offset);
+}
+
+/**
+ * @brief Allocates like the default operator new, retrying through the new-handler
+ */
+void* Allocate(size_t size, size_t alignment) {
+    if (size == 0) size = 1;
+    for (;;) {
+        void* memory = AllocateTracked(size, alignment, current_tag);
+        if (memory) return memory;
+        std::new_handler handler = std::get_new_handler();
+        if (!handler) return nullptr;
+        handler();
+    }
+}
+
+void* AllocateOrThrow(size_t size, size_t alignment) {
+    void* memory = Allocate(size, alignment);
+    if (!memory) throw std::bad_alloc();
+    return memory;
+}
+
+#else
+
+// Без отслеживания операторы не заменяются; Allocate() для ImGui идет прямо в malloc
+void* AllocateTracked(size_t size, size_t, MentalEngine::MemoryTag) {
+    return std::malloc(size);
+}
+
+nil FreeTracked(void* memory) {
+    std::free(memory);
+}
+
+#endif
+
+MentalEngine::MemoryTagStats Snapshot(const TagCounters& counters) {
+    MentalEngine::MemoryTagStats stats;
+    stats.live_bytes = counters.live_bytes.load(std::memory_order_relaxed);
+    stats.peak_bytes = counters.peak_bytes.load(std::memory_order_relaxed);
+    stats.allocations = counters.allocations.load(std::memory_order_relaxed);
+    stats.frees = counters.frees.load(std::memory_order_relaxed);
+    return stats;
+}
+
+} // namespace
+
+namespace MentalEngine {
+
+bool MemoryTracker::IsEnabled() {
+#ifdef MENTAL_MEMORY_TRACKING
+    return true;
+#else
+    return false;
+#endif
+}
+
+uint64_t MemoryTracker::GetAllocationCount() {
+    return allocation_count.load(std::memory_order_relaxed);
+}
+
+MemoryTag MemoryTracker::GetCurrentTag() {
+    return current_tag;
+}
+
+nil MemoryTracker::SetCurrentTag(MemoryTag tag) {
+    current_tag = tag;
+}
+
+const char* MemoryTracker::GetTagName(MemoryTag tag) {
+    const size_t index = static_cast<size_t>(tag);
+    return index < TAG_COUNT ? TAG_NAMES[index] : "?";
+}
+
+MemoryTagStats MemoryTracker::GetTagStats(MemoryTag tag) {
+    const size_t index = static_cast<size_t>(tag);
+    return index < TAG_COUNT ? Snapshot(tag_counters[index]) : MemoryTagStats();
+}
+
+MemoryTagStats MemoryTracker::GetTotalStats() {
+    return Snapshot(total_counters);
+}
+
+void* MemoryTracker::Allocate(size_t size, MemoryTag tag) {
+    return AllocateTracked(size == 0 ? 1 : size, 0, tag);
+}
+
+nil MemoryTracker::Free(void* memory) {
+    FreeTracked(memory);
+}
+
+nil MemoryTracker::AddGpuMemory(GpuMemoryKind kind, int64_t bytes) {
+    const size_t index = static_cast<size_t>(kind);
+    if (index < GPU_KIND_COUNT) gpu_bytes[index].fetch_add(bytes, std::memory_order_relaxed);
+}
+
+nil MemoryTracker::AddGpuUpload(size_t bytes) {
+    gpu_uploaded_bytes.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+GpuMemoryStats MemoryTracker::GetGpuStats() {
+    GpuMemoryStats stats;
+    stats.texture_bytes = gpu_bytes[static_cast<size_t>(GpuMemoryKind::Texture)].load(std::memory_order_relaxed);
+    stats.renderbuffer_bytes = gpu_bytes[static_cast<size_t>(GpuMemoryKind::Renderbuffer)].load(std::memory_order_relaxed);
+    stats.buffer_bytes = gpu_bytes[static_cast<size_t>(GpuMemoryKind::Buffer)].load(std::memory_order_relaxed);
+    stats.uploaded_bytes = gpu_uploaded_bytes.load(std::memory_order_relaxed);
+    return stats;
+}
+
+std::string MemoryTracker::FormatReport() {
+    std::string report;
+    char line[160];
+    if (!IsEnabled()) {
+        std::snprintf(line, sizeof(line), "Heap tracking disabled (build with -Dmemory_tracking=true); %llu allocations\n",
+                      static_cast<unsigned long long>(GetAllocationCount()));
+        report += line;
+    } else {
+        std::snprintf(line, sizeof(line), "%-10s %14s %14s %12s %12s\n", "tag", "live bytes", "peak bytes", "allocs", "frees");
+        report += line;
+        for (size_t i = 0; i <= TAG_COUNT; i++) {
+            const bool total = i == TAG_COUNT;
+            MemoryTagStats stats = total ? GetTotalStats() : Snapshot(tag_counters[i]);
+            std::snprintf(line, sizeof(line), "%-10s %14lld %14lld %12llu %12llu\n", total ? "Total" : TAG_NAMES[i],
+                          static_cast<long long>(stats.live_bytes), static_cast<long long>(stats.peak_bytes),
+                          static_cast<unsigned long long>(stats.allocations), static_cast<unsigned long long>(stats.frees));
+            report += line;
+        }
+    }
+
+    GpuMemoryStats gpu = GetGpuStats();
+    std::snprintf(line, sizeof(line), "GPU textures %lld, renderbuffers %lld, buffers %lld bytes; uploaded %llu bytes\n",
+                  static_cast<long long>(gpu.texture_bytes), static_cast<long long>(gpu.renderbuffer_bytes),
+                  static_cast<long long>(gpu.buffer_bytes), static_cast<unsigned long long>(gpu.uploaded_bytes));
+    report += line;
+    return report;
+}
+
+} // namespace MentalEngine
+
+#ifdef MENTAL_MEMORY_TRACKING
+
+// Замена глобальных операторов: все формы, чтобы ни одна не ушла мимо счетчика
+void* operator new(size_t size) { return AllocateOrThrow(size, 0); }
+void* operator new[](size_t size) { return AllocateOrThrow(size, 0); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return Allocate(size, 0); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return Allocate(size, 0); }
+void* operator new(size_t size, std::align_val_t alignment) { return AllocateOrThrow(size, static_cast<size_t>(alignment)); }
+void* operator new[](size_t size, std::align_val_t alignment) { return AllocateOrThrow(size, static_cast<size_t>(alignment)); }
+void* operator new(size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept { return Allocate(size, static_cast<size_t>(alignment)); }
+void* operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept { return Allocate(size, static_cast<size_t>(alignment)); }
+
+void operator delete(void* memory) noexcept { FreeTracked(memory); }
+void operator delete[](void* memory) noexcept { FreeTracked(memory); }
+void operator delete(void* memory, size_t) noexcept { FreeTracked(memory); }
+void operator delete[](void* memory, size_t) noexcept { FreeTracked(memory); }
+void operator delete(void* memory, const std::nothrow_t&) noexcept { FreeTracked(memory); }
+void operator delete[](void* memory, const std::nothrow_t&) noexcept { FreeTracked(memory); }
+void operator delete(void* memory, std::align_val_t) noexcept { FreeTracked(memory); }
+void operator delete[](void* memory, std::align_val_t) noexcept { FreeTracked(memory); }
+void operator delete(void* memory, size_t, std::align_val_t) noexcept { FreeTracked(memory); }
+void operator delete[](void* memory, size_t, std::align_val_t) noexcept { FreeTracked(memory); }
+void operator delete(void* memory, std::align_val_t, const std::nothrow_t&) noexcept { FreeTracked(memory); }
+void operator delete[](void* memory, std::align_val_t, const std::nothrow_t&) noexcept { FreeTracked(memory); }
+
+#endif // MENTAL_MEMORY_TRACKING
@@ -0,0 +1,191 @@
+/**
+ * @file MemoryTracker.h
+ * @brief Heap and GPU memory accounting for MentalEngine
+ * @author MentalEngine Team
+ * @version 1.0.0
+ * @date 2024
+ *
+ * This file defines the MemoryTracker class. When built with
+ * MENTAL_MEMORY_TRACKING (the memory_tracking meson option),
+ * MemoryTracker.cpp replaces the global operator new/delete, so every C++
+ * heap allocation of the process is counted and charged to a subsystem tag.
+ * Without it the allocator is left alone and only the GPU counters work.
+ */
+
+#ifndef MENTAL_MEMORY_TRACKER_H
+#define MENTAL_MEMORY_TRACKER_H
+
+#include "Types.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace MentalEngine {
+
+/**
+ * @enum MemoryTag
+ * @brief Subsystem an allocation is charged to
+ */
+enum class MemoryTag : uint8_t {
+    General = 0,  ///< Anything outside a MemoryTagScope
+    Renderer,     ///< Frame recording, GL-side staging, render thread
+    UI,           ///< ImGui and the panels
+    Scene,        ///< Scene edits, loading and import
+    Console,      ///< Console lines
+    Count
+};
+
+/**
+ * @enum GpuMemoryKind
+ * @brief Category of GPU memory reported by the renderer
+ */
+enum class GpuMemoryKind : uint8_t {
+    Texture = 0,   ///< Texture storage
+    Renderbuffer,  ///< Renderbuffer storage
+    Buffer,        ///< Resident buffer objects
+    Count
+};
+
+/**
+ * @struct MemoryTagStats
+ * @brief Heap counters of one tag, or of all tags together
+ */
+struct MemoryTagStats {
+    int64_t live_bytes = 0;    ///< Bytes allocated and not yet freed
+    int64_t peak_bytes = 0;    ///< Highest live_bytes seen
+    uint64_t allocations = 0;  ///< Allocations since startup
+    uint64_t frees = 0;        ///< Frees since startup
+};
+
+/**
+ * @struct GpuMemoryStats
+ * @brief GPU memory created through the renderer
+ *
+ * Sizes are computed from formats and dimensions, so they are estimates of
+ * what the driver actually reserves.
+ */
+struct GpuMemoryStats {
+    int64_t texture_bytes = 0;       ///< Resident texture storage
+    int64_t renderbuffer_bytes = 0;  ///< Resident renderbuffer storage
+    int64_t buffer_bytes = 0;        ///< Resident buffer storage
+    uint64_t uploaded_bytes = 0;     ///< Bytes passed to glBufferData since startup
+};
+
+/**
+ * @class MemoryTracker
+ * @brief Access to the global allocation counters
+ *
+ * Allocations are charged to the calling thread's current tag, set with
+ * MemoryTagScope, and freed against the tag they were allocated with, even
+ * from another thread. Counters are relaxed atomics, so a snapshot taken
+ * while other threads allocate may be slightly inconsistent.
+ */
+class MemoryTracker {
+public:
+    MemoryTracker() = delete;
+
+    /**
+     * @brief Checks whether per-tag tracking was compiled in
+     * @return bool True when built with MENTAL_MEMORY_TRACKING
+     */
+    static bool IsEnabled();
+
+    /**
+     * @brief Gets the number of heap allocations since startup
+     * @return uint64_t Allocation count, all threads and tags; zero unless IsEnabled()
+     */
+    static uint64_t GetAllocationCount();
+
+    /**
+     * @brief Gets the calling thread's tag
+     * @return MemoryTag Tag new allocations are charged to
+     */
+    static MemoryTag GetCurrentTag();
+
+    /**
+     * @brief Sets the calling thread's tag
+     * @param tag Tag new allocations are charged to
+     */
+    static nil SetCurrentTag(MemoryTag tag);
+
+    /**
+     * @brief Gets a display name
+     * @param tag Tag
+     * @return const char* Static name, e.g. "Renderer"
+     */
+    static const char* GetTagName(MemoryTag tag);
+
+    /**
+     * @brief Gets counters of one tag
+     * @param tag Tag
+     * @return MemoryTagStats Counters; zero unless IsEnabled()
+     */
+    static MemoryTagStats GetTagStats(MemoryTag tag);
+
+    /**
+     * @brief Gets counters summed over all tags
+     * @return MemoryTagStats Counters; peak is the peak of the sum
+     */
+    static MemoryTagStats GetTotalStats();
+
+    /**
+     * @brief Allocates tracked memory for a specific tag
+     *
+     * For libraries with their own allocator hooks, such as ImGui.
+     *
+     * @param size Bytes to allocate
+     * @param tag Tag to charge
+     * @return void* Memory, or nullptr on failure
+     */
+    static void* Allocate(size_t size, MemoryTag tag);
+
+    /**
+     * @brief Frees memory from Allocate()
+     * @param memory Memory, may be nullptr
+     */
+    static nil Free(void* memory);
+
+    /**
+     * @brief Records GPU memory created or destroyed
+     * @param kind Category
+     * @param bytes Size change; negative when memory is released
+     */
+    static nil AddGpuMemory(GpuMemoryKind kind, int64_t bytes);
+
+    /**
+     * @brief Records a buffer upload
+     * @param bytes Bytes passed to the driver
+     */
+    static nil AddGpuUpload(size_t bytes);
+
+    /**
+     * @brief Gets GPU memory counters
+     * @return GpuMemoryStats Counters
+     */
+    static GpuMemoryStats GetGpuStats();
+
+    /**
+     * @brief Formats all counters as text
+     * @return std::string Multi-line report, one line per tag plus GPU totals
+     */
+    static std::string FormatReport();
+};
+
+/**
+ * @class MemoryTagScope
+ * @brief Charges the calling thread's allocations to a tag until destroyed
+ */
+class MemoryTagScope {
+private:
+    MemoryTag previous;  ///< Tag restored by the destructor
+
+public:
+    explicit MemoryTagScope(MemoryTag tag) : previous(MemoryTracker::GetCurrentTag()) { MemoryTracker::SetCurrentTag(tag); }
+    ~MemoryTagScope() { MemoryTracker::SetCurrentTag(previous); }
+    MemoryTagScope(const MemoryTagScope&) = delete;
+    MemoryTagScope& operator=(const MemoryTagScope&) = delete;
+};
+
+} // namespace MentalEngine
+
+#endif // MENTAL_MEMORY_TRACKER_H
@@ -7,13 +7,70 @@
  */
 
 #include "Camera.h"
+#include <algorithm>
+#include <cmath>
 
 namespace MentalEngine {
 
+namespace {
+
+constexpr float ORBIT_RADIANS_PER_PIXEL = 0.01f;  ///< Orbit speed of mouse drags
+constexpr float AXES_FORWARD_RATIO = 0.5f;        ///< Forward share of Ctrl-drag vertical motion
+constexpr float MIN_ORTHO_SIZE = 0.1f;            ///< Smallest orthographic view size
+constexpr float REST_RADIANS = 1e-5f;             ///< Remaining orbit travel treated as stopped
+constexpr float REST_PIXELS = 0.01f;              ///< Remaining pan travel treated as stopped
+constexpr float REST_ZOOM = 1e-5f;                ///< Remaining zoom travel treated as stopped
+constexpr float MAX_ADVANCE_SECONDS = 0.25f;      ///< Longest frame integrated in one Advance()
+constexpr float RESTART_SECONDS = 1.0f / 60.0f;   ///< Longest first frame after rest
+constexpr float HALF_PI = 1.57079632679f;
+constexpr float ROLL_RADIANS_PER_SECOND = 1.5f;   ///< Roll speed while Q or E is held
+constexpr float FLY_DISTANCES_PER_SECOND = 1.0f;  ///< Fly speed in orbit distances per second
+
+/// Bits of Camera::held_keys
+enum HeldKey : unsigned {
+    HELD_FORWARD = 1u << 0,
+    HELD_BACK = 1u << 1,
+    HELD_LEFT = 1u << 2,
+    HELD_RIGHT = 1u << 3,
+    HELD_ROLL_LEFT = 1u << 4,
+    HELD_ROLL_RIGHT = 1u << 5,
+    HELD_FLY_MASK = HELD_FORWARD | HELD_BACK | HELD_LEFT | HELD_RIGHT
+};
+
+const Math::Vector3 AXIS_X(1.0f, 0.0f, 0.0f);
+const Math::Vector3 AXIS_Y(0.0f, 1.0f, 0.0f);
+const Math::Vector3 AXIS_Z(0.0f, 0.0f, 1.0f);
+
+/**
+ * @brief Fraction of a decaying velocity travelled during one step
+ * 
+ * A velocity v decaying as v * e^(-rate * t) travels v * (1 - e^(-rate * h)) / rate
+ * in a step h and v / rate in total, so input added as delta * rate moves
+ * the camera by exactly delta no matter how the frames are timed.
+ */
+float StepTravel(float rate, float seconds) {
+    return (1.0f - std::exp(-rate * seconds)) / rate;
+}
+
+float EaseInOut(float t) {
+    return t * t * (3.0f - 2.0f * t);
+}
+
+float LerpLog(float from, float to, float t) {
+    if (from <= 0.0f || to <= 0.0f) return from + (to - from) * t;
+    return from * std::pow(to / from, t);
+}
+
+} // namespace
+
 Camera::Camera() 
-    : position(0.0f, 0.0f, 5.0f)
+    : origin(0.0, 0.0, 0.0)
+    , home(0.0, 0.0, 0.0)
+    , position(0.0f, 0.0f, 5.0f)
     , target(0.0f, 0.0f, 0.0f)
     , up(0.0f, 1.0f, 0.0f)
+    , orientation()  // identity matches position (0, 0, 5): facing the Z = 0 drawing plane
+    , rotation_mode(CameraRotationMode::Orbit)
     , projection(CameraProjection::Perspective)
     , fov(45.0f)
     , aspect_ratio(16.0f / 9.0f)
@@ -27,13 +84,23 @@ Camera::Camera()
     , last_mouse_pos(0.0f, 0.0f)
     , mouse_delta(0.0f, 0.0f)
     , orbit_distance(5.0f)
-    , orbit_angle_x(0.0f)
-    , orbit_angle_y(0.0f)
     , min_orbit_distance(0.1f)
     , max_orbit_distance(1000.0f)
     , pan_speed(1.0f, 1.0f, 1.0f)
     , zoom_speed(0.1f)
     , zoom_factor(1.0f)
+    , viewport_height(0)
+    , smoothing_rate(DEFAULT_SMOOTHING_RATE)
+    , damping_rate(DEFAULT_DAMPING_RATE)
+    , orbit_velocity(0.0f, 0.0f)
+    , pan_velocity(0.0f, 0.0f, 0.0f)
+    , zoom_velocity(0.0f)
+    , step_accumulator(0.0f)
+    , at_rest(true)
+    , held_keys(0)
+    , transition_elapsed(0.0f)
+    , transition_duration(0.0f)
+    , transition_active(false)
 {
     __update_orbit_position();
 }
@@ -60,13 +127,38 @@ nil Camera::SetPosition(const Math::Vector3& pos) {
     // Update orbit parameters based on new position
     Math::Vector3 direction = (position - target).normalized();
     orbit_distance = (position - target).length();
-    orbit_angle_y = std::asin(direction.y);
-    orbit_angle_x = std::atan2(direction.z, direction.x);
+    orientation = OrientationFromAngles(std::atan2(direction.z, direction.x),
+                                        std::asin(std::max(-1.0f, std::min(1.0f, direction.y))));
+    up = orientation.rotate(AXIS_Y);
 }
 
 nil Camera::SetTarget(const Math::Vector3& new_target) {
     target = new_target;
     __update_orbit_position();
+    __recenter();
+}
+
+nil Camera::SetOrigin(const Math::Vector3d& world) {
+    // Пересчет в double: мировые координаты камеры не меняются
+    Math::Vector3d shift = world - origin;
+    auto rebase = [&shift](Math::Vector3& local) { local = (Math::Vector3d(local) - shift).toFloat(); };
+    origin = world;
+    rebase(position);
+    rebase(target);
+    rebase(transition_start.target);
+    rebase(transition_end.target);
+}
+
+nil Camera::TranslateOrigin(const Math::Vector3d& offset) {
+    origin = origin + offset;
+    home = home + offset;
+}
+
+nil Camera::SetWorldTarget(const Math::Vector3d& world) {
+    transition_active = false;
+    origin = world;
+    target = Math::Vector3(0.0f, 0.0f, 0.0f);
+    __update_orbit_position();
 }
 
 nil Camera::SetOrbitDistance(float distance) {
@@ -75,57 +167,48 @@ nil Camera::SetOrbitDistance(float distance) {
 }
 
 nil Camera::SetOrbitAngles(float angle_x, float angle_y) {
-    orbit_angle_x = angle_x;
-    orbit_angle_y = angle_y;
-    __constrain_orbit_angles();
+    orientation = OrientationFromAngles(angle_x, std::max(-HALF_PI, std::min(HALF_PI, angle_y)));
     __update_orbit_position();
 }
 
-nil Camera::Orbit(float delta_x, float delta_y) {
-    orbit_angle_x += delta_x * 0.01f;
-    orbit_angle_y += delta_y * 0.01f;
-    __constrain_orbit_angles();
+Math::Quaternion Camera::OrientationFromAngles(float angle_x, float angle_y) {
+    // Рыскание вокруг мировой Y, затем наклон вокруг локальной X; angle_x = 90° - тождество
+    return Math::angleAxis(HALF_PI - angle_x, AXIS_Y) * Math::angleAxis(-angle_y, AXIS_X);
+}
+
+nil Camera::SetOrientation(const Math::Quaternion& rotation) {
+    orientation = rotation.normalized();
     __update_orbit_position();
 }
 
+nil Camera::Roll(float radians) {
+    // Поворот вокруг оси взгляда: позиция и цель не меняются
+    orientation = (orientation * Math::angleAxis(radians, AXIS_Z)).normalized();
+    up = orientation.rotate(AXIS_Y);
+}
+
+nil Camera::SetRotationMode(CameraRotationMode mode) {
+    rotation_mode = mode;
+    held_keys &= ~static_cast<unsigned>(HELD_FLY_MASK);
+    orbit_velocity = Math::Vector2(0.0f, 0.0f);
+}
+
+nil Camera::Orbit(float delta_x, float delta_y) {
+    __apply_orbit(delta_x * ORBIT_RADIANS_PER_PIXEL, delta_y * ORBIT_RADIANS_PER_PIXEL);
+}
+
 nil Camera::Pan(float delta_x, float delta_y) {
-    Math::Vector3 right = GetRight();
-    Math::Vector3 up = GetUp();
-    
-    Math::Vector3 pan_delta = (right * delta_x + up * delta_y) * pan_speed.x * 0.01f;
-    position = position + pan_delta;
-    target = target + pan_delta;
+    __apply_pan(__pan_offset(delta_x, delta_y));
+    __recenter();
 }
 
 nil Camera::MoveAlongAxes(float delta_x, float delta_y) {
-    Math::Vector3 right = GetRight();
-    Math::Vector3 up = GetUp();
-    Math::Vector3 forward = GetForward();
-    
-    // Движение по осям:
-    // delta_x - движение влево/вправо (по оси X)
-    // delta_y - движение вверх/вниз (по оси Y)
-    // Дополнительно: движение вперед/назад по оси Z при движении мыши вверх/вниз
-    
-    Math::Vector3 move_delta = (right * delta_x + up * delta_y) * pan_speed.x * 0.01f;
-    
-    // Добавляем небольшое движение вперед/назад для более интуитивного управления
-    Math::Vector3 forward_delta = forward * delta_y * pan_speed.z * 0.005f;
-    
-    position = position + move_delta + forward_delta;
-    target = target + move_delta + forward_delta;
+    __apply_pan(__axes_offset(delta_x, delta_y));
+    __recenter();
 }
 
 nil Camera::Zoom(float delta) {
-    if (projection == CameraProjection::Perspective) {
-        orbit_distance *= (1.0f - delta * zoom_speed);
-        orbit_distance = std::max(min_orbit_distance, std::min(max_orbit_distance, orbit_distance));
-        __update_orbit_position();
-    } else {
-        // Orthographic zoom
-        ortho_size *= (1.0f - delta * zoom_speed);
-        ortho_size = std::max(0.1f, ortho_size);
-    }
+    __apply_zoom(delta * zoom_speed);
 }
 
 nil Camera::SetZoomFactor(float factor) {
@@ -146,28 +229,50 @@ nil Camera::HandleMouseButton(int button, int action, float x, float y) {
     
     if (action == GLFW_PRESS) {
         last_mouse_pos = Math::Vector2(x, y);
+        // Новое нажатие останавливает анимацию и инерцию там, где они сейчас
+        transition_active = false;
+        orbit_velocity = Math::Vector2(0.0f, 0.0f);
+        pan_velocity = Math::Vector3(0.0f, 0.0f, 0.0f);
     }
 }
 
 nil Camera::HandleMouseMove(float x, float y) {
     mouse_delta = Math::Vector2(x - last_mouse_pos.x, last_mouse_pos.y - y);
     last_mouse_pos = Math::Vector2(x, y);
+    if (!is_rotating && !is_panning) return;
+    
+    if (smoothing_rate <= 0.0f) {
+        if (is_ctrl_pressed && is_rotating) {
+            MoveAlongAxes(mouse_delta.x, mouse_delta.y);
+        } else if (is_rotating) {
+            Orbit(mouse_delta.x, mouse_delta.y);
+        } else {
+            Pan(mouse_delta.x, mouse_delta.y);
+        }
+        return;
+    }
     
+    // Ввод добавляет скорость; Advance() проходит ровно mouse_delta, пока кнопка нажата
     if (is_ctrl_pressed && is_rotating) {
         // Ctrl + левая кнопка мыши = перемещение по осям
-        MoveAlongAxes(mouse_delta.x, mouse_delta.y);
+        pan_velocity = pan_velocity + __axes_offset(mouse_delta.x, mouse_delta.y) * smoothing_rate;
     } else if (is_rotating) {
         // Обычное вращение камеры
-        Orbit(mouse_delta.x, mouse_delta.y);
-    } else if (is_panning) {
+        orbit_velocity = orbit_velocity + mouse_delta * (ORBIT_RADIANS_PER_PIXEL * smoothing_rate);
+    } else {
         // Панорамирование
-        Pan(mouse_delta.x, mouse_delta.y);
+        pan_velocity = pan_velocity + __pan_offset(mouse_delta.x, mouse_delta.y) * smoothing_rate;
     }
 }
 
 nil Camera::HandleMouseScroll(float xoffset, float yoffset) {
     (void)xoffset; // Suppress unused parameter warning
-    Zoom(yoffset);
+    transition_active = false;
+    if (smoothing_rate <= 0.0f) {
+        Zoom(yoffset);
+    } else {
+        zoom_velocity += yoffset * zoom_speed * smoothing_rate;
+    }
 }
 
 nil Camera::HandleKey(int key, int action) {
@@ -176,10 +281,31 @@ nil Camera::HandleKey(int key, int action) {
         is_ctrl_pressed = (action == GLFW_PRESS);
     }
     
+    unsigned held = 0;
+    switch (key) {
+        case GLFW_KEY_Q: held = HELD_ROLL_LEFT; break;
+        case GLFW_KEY_E: held = HELD_ROLL_RIGHT; break;
+        case GLFW_KEY_W: held = HELD_FORWARD; break;
+        case GLFW_KEY_S: held = HELD_BACK; break;
+        case GLFW_KEY_A: held = HELD_LEFT; break;
+        case GLFW_KEY_D: held = HELD_RIGHT; break;
+    }
+    if (action == GLFW_PRESS && held != 0) {
+        // Полет только в FreeFly; крен в любом режиме
+        if (rotation_mode == CameraRotationMode::FreeFly || !(held & HELD_FLY_MASK)) {
+            transition_active = false;
+            held_keys |= held;
+        }
+    } else if (action == GLFW_RELEASE) {
+        held_keys &= ~held;
+    }
+    
     if (action == GLFW_PRESS) {
         switch (key) {
             case GLFW_KEY_R:
-                Reset();
+                // Вид по умолчанию задан относительно дома, а не текущего origin
+                SetOrigin(home);
+                AnimateTo(CameraState(), DEFAULT_TRANSITION_SECONDS);
                 break;
             case GLFW_KEY_P:
                 SetProjection(projection == CameraProjection::Perspective ? 
@@ -193,6 +319,16 @@ Math::Matrix4 Camera::GetViewMatrix() const {
     return Math::lookAt(position, target, up);
 }
 
+Math::Matrix4 Camera::GetViewMatrix(const Math::Vector3d& frame_origin) const {
+    // V * T(d): d мал, если камера рядом с геометрией, и точен, потому что разность взята в double
+    Math::Matrix4 view = GetViewMatrix();
+    Math::Vector3 d = (frame_origin - origin).toFloat();
+    for (int row = 0; row < 3; row++) {
+        view.m[3][row] += view.m[0][row] * d.x + view.m[1][row] * d.y + view.m[2][row] * d.z;
+    }
+    return view;
+}
+
 Math::Matrix4 Camera::GetProjectionMatrix() const {
     if (projection == CameraProjection::Perspective) {
         return Math::perspective(Math::radians(fov), aspect_ratio, near_plane, far_plane);
@@ -203,32 +339,120 @@ Math::Matrix4 Camera::GetProjectionMatrix() const {
     }
 }
 
+Math::Matrix4 Camera::GetViewProjectionMatrix() const {
+    // Matrices are stored column-major, so P * V in GL terms is V * P here
+    return GetViewMatrix() * GetProjectionMatrix();
+}
+
+Math::Matrix4 Camera::GetViewProjectionMatrix(const Math::Vector3d& frame_origin) const {
+    return GetViewMatrix(frame_origin) * GetProjectionMatrix();
+}
+
+bool Camera::ScreenToPlane(const Math::Vector2& ndc, float plane_z, Math::Vector3& out) const {
+    return UnprojectToPlane(Math::inverse(GetViewProjectionMatrix()), ndc, plane_z, out);
+}
+
+bool Camera::UnprojectToPlane(const Math::Matrix4& inverse_view_projection, const Math::Vector2& ndc, float plane_z, Math::Vector3& out) {
+    Math::Vector4 near_point = Math::transformColumnMajor(inverse_view_projection, Math::Vector4(ndc.x, ndc.y, -1.0f, 1.0f));
+    Math::Vector4 far_point = Math::transformColumnMajor(inverse_view_projection, Math::Vector4(ndc.x, ndc.y, 1.0f, 1.0f));
+    if (near_point.w == 0.0f || far_point.w == 0.0f) return false;
+    
+    Math::Vector3 origin(near_point.x / near_point.w, near_point.y / near_point.w, near_point.z / near_point.w);
+    Math::Vector3 end(far_point.x / far_point.w, far_point.y / far_point.w, far_point.z / far_point.w);
+    Math::Vector3 direction = end - origin;
+    if (std::fabs(direction.z) < 1e-8f) return false;
+    
+    float t = (plane_z - origin.z) / direction.z;
+    out = origin + direction * t;
+    return true;
+}
+
 nil Camera::Update(int width, int height) {
     __update_aspect_ratio(width, height);
+    viewport_height = height;
+}
+
+nil Camera::Advance(float delta_seconds) {
+    if (!IsAnimating()) {
+        at_rest = true;
+        step_accumulator = 0.0f;
+        return;
+    }
+    
+    // После простоя delta включает время ожидания событий - не прыгаем
+    float seconds = std::min(std::max(delta_seconds, 0.0f), at_rest ? RESTART_SECONDS : MAX_ADVANCE_SECONDS);
+    at_rest = false;
+    step_accumulator += seconds;
+    while (step_accumulator >= STEP_SECONDS) {
+        __step(STEP_SECONDS);
+        step_accumulator -= STEP_SECONDS;
+    }
+    __recenter();
+    
+    // Движение закончилось - следующий кадр может прийти после долгого ожидания
+    if (!IsAnimating()) {
+        at_rest = true;
+        step_accumulator = 0.0f;
+    }
+}
+
+bool Camera::IsAnimating() const {
+    return transition_active || held_keys != 0 || orbit_velocity.x != 0.0f || orbit_velocity.y != 0.0f ||
+           pan_velocity.x != 0.0f || pan_velocity.y != 0.0f || pan_velocity.z != 0.0f || zoom_velocity != 0.0f;
+}
+
+nil Camera::SetMotionSmoothing(float smoothing, float damping) {
+    smoothing_rate = std::max(0.0f, smoothing);
+    damping_rate = std::max(0.0f, damping);
+    if (smoothing_rate <= 0.0f) {
+        orbit_velocity = Math::Vector2(0.0f, 0.0f);
+        pan_velocity = Math::Vector3(0.0f, 0.0f, 0.0f);
+        zoom_velocity = 0.0f;
+    }
+}
+
+CameraState Camera::GetState() const {
+    CameraState state;
+    state.target = target;
+    state.orbit_distance = orbit_distance;
+    state.orientation = orientation;
+    state.ortho_size = ortho_size;
+    return state;
+}
+
+nil Camera::AnimateTo(const CameraState& state, float duration) {
+    orbit_velocity = Math::Vector2(0.0f, 0.0f);
+    pan_velocity = Math::Vector3(0.0f, 0.0f, 0.0f);
+    zoom_velocity = 0.0f;
+    
+    transition_start = GetState();
+    transition_end = state;
+    transition_end.orbit_distance = std::max(min_orbit_distance, std::min(max_orbit_distance, state.orbit_distance));
+    transition_end.ortho_size = std::max(MIN_ORTHO_SIZE, state.ortho_size);
+    transition_end.orientation = state.orientation.normalized();
+    transition_elapsed = 0.0f;
+    transition_duration = duration;
+    transition_active = duration > 0.0f;
+    if (!transition_active) __apply_state(transition_end);
 }
 
 nil Camera::Reset() {
-    position = Math::Vector3(0.0f, 0.0f, 5.0f);
-    target = Math::Vector3(0.0f, 0.0f, 0.0f);
-    up = Math::Vector3(0.0f, 1.0f, 0.0f);
-    orbit_distance = 5.0f;
-    orbit_angle_x = 0.0f;
-    orbit_angle_y = 0.0f;
-    ortho_size = 10.0f;
     zoom_factor = 1.0f;
     is_ctrl_pressed = false;
-    __update_orbit_position();
+    SetOrigin(home);
+    AnimateTo(CameraState(), 0.0f);
 }
 
-nil Camera::FitToBounds(const Math::Vector3& min_bounds, const Math::Vector3& max_bounds) {
+nil Camera::FitToBounds(const Math::Vector3& min_bounds, const Math::Vector3& max_bounds, float duration) {
     Math::Vector3 center = (min_bounds + max_bounds) * 0.5f;
     Math::Vector3 size = max_bounds - min_bounds;
     float max_size = std::max({size.x, size.y, size.z});
     
-    target = center;
-    orbit_distance = max_size * 2.0f;
-    ortho_size = max_size;
-    __update_orbit_position();
+    CameraState state = GetState();
+    state.target = center;
+    state.orbit_distance = max_size * 2.0f;
+    state.ortho_size = max_size;
+    AnimateTo(state, duration);
 }
 
 Math::Vector3 Camera::GetForward() const {
@@ -244,14 +468,14 @@ Math::Vector3 Camera::GetUp() const {
 }
 
 nil Camera::__update_orbit_position() {
-    float cos_y = std::cos(orbit_angle_y);
-    position.x = target.x + orbit_distance * cos_y * std::cos(orbit_angle_x);
-    position.y = target.y + orbit_distance * std::sin(orbit_angle_y);
-    position.z = target.z + orbit_distance * cos_y * std::sin(orbit_angle_x);
+    // Камера смотрит вдоль своей -Z, значит стоит на +Z от цели
+    position = target + orientation.rotate(AXIS_Z * orbit_distance);
+    up = orientation.rotate(AXIS_Y);
 }
 
-nil Camera::__constrain_orbit_angles() {
-    orbit_angle_y = std::max(-Math::radians(89.0f), std::min(Math::radians(89.0f), orbit_angle_y));
+nil Camera::__update_target_from_position() {
+    target = position - orientation.rotate(AXIS_Z * orbit_distance);
+    up = orientation.rotate(AXIS_Y);
 }
 
 nil Camera::__update_aspect_ratio(int width, int height) {
@@ -260,4 +484,140 @@ nil Camera::__update_aspect_ratio(int width, int height) {
     }
 }
 
+float Camera::__world_per_pixel() const {
+    // Высота видимой области на расстоянии цели, деленная на высоту viewport
+    float visible = projection == CameraProjection::Perspective
+        ? 2.0f * orbit_distance * std::tan(Math::radians(fov) * 0.5f)
+        : ortho_size;
+    return visible / static_cast<float>(std::max(viewport_height, 1));
+}
+
+Math::Vector3 Camera::__pan_offset(float delta_x, float delta_y) const {
+    return (GetRight() * delta_x + GetUp() * delta_y) * (__world_per_pixel() * pan_speed.x);
+}
+
+Math::Vector3 Camera::__axes_offset(float delta_x, float delta_y) const {
+    // Дополнительно: движение вперед/назад при движении мыши вверх/вниз
+    Math::Vector3 forward = GetForward() * (delta_y * __world_per_pixel() * pan_speed.z * AXES_FORWARD_RATIO);
+    return __pan_offset(delta_x, delta_y) + forward;
+}
+
+nil Camera::__apply_orbit(float radians_x, float radians_y) {
+    // Угол вокруг локальной X; в FreeFly мышь вверх поднимает взгляд, иначе камеру
+    float pitch = rotation_mode == CameraRotationMode::FreeFly ? radians_y : -radians_y;
+    
+    if (rotation_mode == CameraRotationMode::Orbit || rotation_mode == CameraRotationMode::FreeFly) {
+        // Высота камеры над целью упирается ровно в ±90°: вид сверху без переворота
+        Math::Vector3 backward = orientation.rotate(AXIS_Z);
+        float elevation = std::asin(std::max(-1.0f, std::min(1.0f, backward.y)));
+        pitch = elevation - std::max(-HALF_PI, std::min(HALF_PI, elevation - pitch));
+    }
+    
+    if (rotation_mode == CameraRotationMode::Trackball) {
+        // Вращение вокруг собственных осей камеры; крен накапливается
+        orientation = orientation * Math::angleAxis(-radians_x, AXIS_Y) * Math::angleAxis(pitch, AXIS_X);
+    } else {
+        orientation = Math::angleAxis(-radians_x, AXIS_Y) * orientation * Math::angleAxis(pitch, AXIS_X);
+    }
+    orientation = orientation.normalized();
+    
+    if (rotation_mode == CameraRotationMode::FreeFly) {
+        __update_target_from_position();
+    } else {
+        __update_orbit_position();
+    }
+}
+
+nil Camera::__apply_pan(const Math::Vector3& offset) {
+    position = position + offset;
+    target = target + offset;
+}
+
+nil Camera::__apply_zoom(float amount) {
+    float scale = std::exp(-amount);
+    if (projection == CameraProjection::Perspective) {
+        orbit_distance = std::max(min_orbit_distance, std::min(max_orbit_distance, orbit_distance * scale));
+        __update_orbit_position();
+    } else {
+        ortho_size = std::max(MIN_ORTHO_SIZE, ortho_size * scale);
+    }
+}
+
+nil Camera::__apply_state(const CameraState& state) {
+    target = state.target;
+    orbit_distance = state.orbit_distance;
+    orientation = state.orientation;
+    ortho_size = state.ortho_size;
+    __update_orbit_position();
+}
+
+nil Camera::__recenter() {
+    if (target.length() < RECENTER_DISTANCE) return;
+    // Целое число единиц: сдвиг точно представим и в float, и в double
+    Math::Vector3 shift(std::round(target.x), std::round(target.y), std::round(target.z));
+    SetOrigin(origin + Math::Vector3d(shift));
+}
+
+nil Camera::__step(float seconds) {
+    if (transition_active) {
+        transition_elapsed += seconds;
+        float t = std::min(1.0f, transition_elapsed / transition_duration);
+        float eased = EaseInOut(t);
+        CameraState state;
+        state.target = transition_start.target + (transition_end.target - transition_start.target) * eased;
+        // Расстояние и масштаб меняются геометрически, чтобы приближение шло равномерно
+        state.orbit_distance = LerpLog(transition_start.orbit_distance, transition_end.orbit_distance, eased);
+        state.ortho_size = LerpLog(transition_start.ortho_size, transition_end.ortho_size, eased);
+        state.orientation = Math::slerp(transition_start.orientation, transition_end.orientation, eased);
+        __apply_state(state);
+        if (t >= 1.0f) transition_active = false;
+    }
+    
+    if (held_keys != 0) {
+        float roll = ((held_keys & HELD_ROLL_LEFT) ? 1.0f : 0.0f) - ((held_keys & HELD_ROLL_RIGHT) ? 1.0f : 0.0f);
+        if (roll != 0.0f) Roll(roll * ROLL_RADIANS_PER_SECOND * seconds);
+        if (held_keys & HELD_FLY_MASK) {
+            // Скорость полета пропорциональна расстоянию до цели - работает в любом масштабе модели
+            float forward = ((held_keys & HELD_FORWARD) ? 1.0f : 0.0f) - ((held_keys & HELD_BACK) ? 1.0f : 0.0f);
+            float right = ((held_keys & HELD_RIGHT) ? 1.0f : 0.0f) - ((held_keys & HELD_LEFT) ? 1.0f : 0.0f);
+            Math::Vector3 direction = orientation.rotate(AXIS_Z) * -forward + orientation.rotate(AXIS_X) * right;
+            __apply_pan(direction * (orbit_distance * FLY_DISTANCES_PER_SECOND * seconds));
+        }
+    }
+    
+    // Пока кнопка нажата, скорость гаснет быстро; после отпускания - медленно (инерция)
+    const bool dragging = is_rotating || is_panning;
+    const float drag_rate = dragging || damping_rate <= 0.0f ? smoothing_rate : damping_rate;
+    
+    if (orbit_velocity.x != 0.0f || orbit_velocity.y != 0.0f) {
+        if (!dragging && damping_rate <= 0.0f) {
+            orbit_velocity = Math::Vector2(0.0f, 0.0f);
+        } else {
+            Math::Vector2 travel = orbit_velocity * StepTravel(drag_rate, seconds);
+            orbit_velocity = orbit_velocity * std::exp(-drag_rate * seconds);
+            __apply_orbit(travel.x, travel.y);
+            if (orbit_velocity.length() < REST_RADIANS * drag_rate) orbit_velocity = Math::Vector2(0.0f, 0.0f);
+        }
+    }
+    
+    if (pan_velocity.x != 0.0f || pan_velocity.y != 0.0f || pan_velocity.z != 0.0f) {
+        if (!dragging && damping_rate <= 0.0f) {
+            pan_velocity = Math::Vector3(0.0f, 0.0f, 0.0f);
+        } else {
+            Math::Vector3 travel = pan_velocity * StepTravel(drag_rate, seconds);
+            pan_velocity = pan_velocity * std::exp(-drag_rate * seconds);
+            __apply_pan(travel);
+            if (pan_velocity.length() < REST_PIXELS * __world_per_pixel() * drag_rate) pan_velocity = Math::Vector3(0.0f, 0.0f, 0.0f);
+        }
+    }
+    
+    // Колесо не дает инерции: каждый шаг приближает ровно на zoom_speed
+    if (zoom_velocity != 0.0f) {
+        float travel = zoom_velocity * StepTravel(smoothing_rate, seconds);
+        zoom_velocity *= std::exp(-smoothing_rate * seconds);
+        __apply_zoom(travel);
+        if (std::fabs(zoom_velocity) < REST_ZOOM * smoothing_rate) zoom_velocity = 0.0f;
+    }
+}
+
 } // namespace MentalEngine
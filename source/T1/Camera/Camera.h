@@ -37,6 +37,31 @@ enum class CameraMode {
     Zoom        // Zoom in/out
 };
 
+/**
+ * @enum CameraRotationMode
+ * @brief How rotation drags turn the camera
+ */
+enum class CameraRotationMode {
+    Orbit,      // Yaw around world up, pitch up to straight down/up, around the target
+    Turntable,  // Like Orbit, but the pitch may pass over the poles
+    Trackball,  // Rotate around the camera's own axes; roll accumulates
+    FreeFly     // Turn in place around the camera position; W/A/S/D move
+};
+
+/**
+ * @struct CameraState
+ * @brief Orbit parameters a camera transition animates between
+ *
+ * Defaults describe the view restored by Camera::Reset(), relative to the
+ * camera's home point.
+ */
+struct CameraState {
+    Math::Vector3 target = Math::Vector3(0.0f, 0.0f, 0.0f);  ///< Point the camera orbits
+    float orbit_distance = 5.0f;                             ///< Distance from target
+    Math::Quaternion orientation;                            ///< Camera to world rotation; identity looks down -Z
+    float ortho_size = 10.0f;                                ///< Orthographic view size
+};
+
 /**
  * @class Camera
  * @brief CAD-style camera system
@@ -47,17 +72,37 @@ enum class CameraMode {
  * 
  * Key features:
  * - Orbit around target point
+ * - Quaternion orientation with orbit, turntable, trackball and free-fly
+ *   rotation, and roll
  * - Pan and zoom functionality
  * - Perspective and orthographic projections
  * - Smooth camera transitions
  * - Configurable field of view and clipping planes
+ * 
+ * Mouse input does not move the camera directly: it adds velocity that
+ * Advance() integrates in fixed time steps. While a button is held the
+ * velocity decays at the smoothing rate, so the camera follows the cursor
+ * with a short lag and travels exactly the dragged distance; after release
+ * it decays at the slower damping rate, which gives inertia. Animated
+ * transitions (FitToBounds(), AnimateTo()) run on the same clock.
+ * 
+ * Position and target are float, relative to a double-precision origin.
+ * The origin follows the target once it drifts RECENTER_DISTANCE away, so
+ * the float part stays small at any world coordinate. Geometry stored
+ * relative to another double-precision point is drawn with
+ * GetViewMatrix(frame_origin), which folds the small difference between
+ * the two origins into the view matrix.
  */
 class Camera {
 private:
     // Camera properties
-    Math::Vector3 position;           ///< Camera position in world space
-    Math::Vector3 target;             ///< Target point to look at
-    Math::Vector3 up;                 ///< Up vector
+    Math::Vector3d origin;            ///< World position of camera-local (0, 0, 0)
+    Math::Vector3d home;              ///< World point the default view of Reset() looks at
+    Math::Vector3 position;           ///< Camera position, relative to origin
+    Math::Vector3 target;             ///< Target point to look at, relative to origin
+    Math::Vector3 up;                 ///< Up vector, derived from orientation
+    Math::Quaternion orientation;     ///< Camera to world rotation; the camera looks down its -Z
+    CameraRotationMode rotation_mode; ///< How rotation drags turn the camera
     CameraProjection projection;      ///< Current projection type
     
     // Projection parameters
@@ -79,8 +124,6 @@ private:
     
     // Orbit parameters
     float orbit_distance;             ///< Distance from target
-    float orbit_angle_x;              ///< Horizontal orbit angle
-    float orbit_angle_y;              ///< Vertical orbit angle
     float min_orbit_distance;         ///< Minimum orbit distance
     float max_orbit_distance;         ///< Maximum orbit distance
     
@@ -91,25 +134,106 @@ private:
     float zoom_speed;                 ///< Zoom speed
     float zoom_factor;                ///< Current zoom factor
     
-    /**
-     * @brief Updates camera position based on orbit parameters
+    // Smoothing and inertia
+    int viewport_height;              ///< Viewport height in pixels, for pixel to world scale
+    float smoothing_rate;             ///< Velocity decay while dragging, 1/s; 0 applies input at once
+    float damping_rate;               ///< Velocity decay after release, 1/s; 0 disables inertia
+    Math::Vector2 orbit_velocity;     ///< Orbit rate in radians per second
+    Math::Vector3 pan_velocity;       ///< Pan rate in world units per second
+    float zoom_velocity;              ///< Zoom rate in log scale per second
+    float step_accumulator;           ///< Time not yet integrated, less than one step
+    bool at_rest;                     ///< Advance() found nothing to integrate last time
+    unsigned held_keys;               ///< Movement and roll keys held down, one bit per key
+    
+    // Animated transition
+    CameraState transition_start;     ///< State when the transition started
+    CameraState transition_end;       ///< State the transition ends in
+    float transition_elapsed;         ///< Seconds since the transition started
+    float transition_duration;        ///< Transition length in seconds
+    bool transition_active;           ///< A transition is running
+    
+    /**
+     * @brief Updates camera position and up vector from target, distance and orientation
      * @private
      */
     nil __update_orbit_position();
     
     /**
-     * @brief Constrains orbit angles to valid ranges
+     * @brief Moves the target in front of the camera after it turned in place
      * @private
      */
-    nil __constrain_orbit_angles();
+    nil __update_target_from_position();
     
     /**
      * @brief Updates aspect ratio based on viewport size
      * @private
      */
     nil __update_aspect_ratio(int width, int height);
+    
+    /**
+     * @brief Gets the world distance covered by one viewport pixel at the target
+     * @private
+     */
+    float __world_per_pixel() const;
+    
+    /**
+     * @brief Converts a mouse delta in pixels to a world-space pan offset
+     * @private
+     */
+    Math::Vector3 __pan_offset(float delta_x, float delta_y) const;
+    
+    /**
+     * @brief Converts a Ctrl-drag delta in pixels to a world-space offset
+     * @private
+     */
+    Math::Vector3 __axes_offset(float delta_x, float delta_y) const;
+    
+    /**
+     * @brief Rotates immediately according to rotation_mode
+     * @param radians_x Horizontal drag angle; positive for a drag to the right
+     * @param radians_y Vertical drag angle; positive for a drag upwards
+     * @private
+     */
+    nil __apply_orbit(float radians_x, float radians_y);
+    
+    /**
+     * @brief Moves position and target immediately
+     * @private
+     */
+    nil __apply_pan(const Math::Vector3& offset);
+    
+    /**
+     * @brief Scales distance or orthographic size immediately
+     * @param amount Natural log of the shrink factor; positive zooms in
+     * @private
+     */
+    nil __apply_zoom(float amount);
+    
+    /**
+     * @brief Applies orbit parameters and recomputes the position
+     * @private
+     */
+    nil __apply_state(const CameraState& state);
+    
+    /**
+     * @brief Integrates velocities and the transition over one fixed step
+     * @private
+     */
+    nil __step(float seconds);
+    
+    /**
+     * @brief Moves the origin to the target once the target drifts too far from it
+     * @private
+     */
+    nil __recenter();
 
 public:
+    static constexpr float STEP_SECONDS = 1.0f / 240.0f;             ///< Fixed integration step
+    static constexpr float DEFAULT_TRANSITION_SECONDS = 0.2f;        ///< Length of FitToBounds() and reset animations
+    static constexpr float DEFAULT_SMOOTHING_RATE = 25.0f;           ///< Default smoothing_rate, 1/s
+    static constexpr float DEFAULT_DAMPING_RATE = 4.0f;              ///< Default damping_rate, 1/s
+    static constexpr float RECENTER_DISTANCE = 1024.0f;              ///< Target offset that moves the origin
+    
     /**
      * @brief Constructor
      * 
@@ -170,16 +294,69 @@ public:
     
     /**
      * @brief Gets camera position
-     * @return Math::Vector3 Current camera position
+     * @return Math::Vector3 Current camera position, relative to GetOrigin()
      */
     Math::Vector3 GetPosition() const { return position; }
     
     /**
      * @brief Gets target point
-     * @return Math::Vector3 Current target point
+     * @return Math::Vector3 Current target point, relative to GetOrigin()
      */
     Math::Vector3 GetTarget() const { return target; }
     
+    // World coordinates
+    /**
+     * @brief Gets the origin of the camera's float coordinates
+     * @return Math::Vector3d World position of camera-local (0, 0, 0)
+     */
+    Math::Vector3d GetOrigin() const { return origin; }
+    
+    /**
+     * @brief Moves the origin, keeping the camera's world position
+     * @param world New world position of camera-local (0, 0, 0)
+     */
+    nil SetOrigin(const Math::Vector3d& world);
+    
+    /**
+     * @brief Moves the origin and the camera with it
+     * 
+     * The camera keeps looking at the same local coordinates, which is what
+     * a view of geometry stored relative to a moved point needs.
+     * 
+     * @param offset World offset
+     */
+    nil TranslateOrigin(const Math::Vector3d& offset);
+    
+    /**
+     * @brief Gets the world point Reset() returns to
+     * @return Math::Vector3d Home point; moves with TranslateOrigin()
+     */
+    Math::Vector3d GetHome() const { return home; }
+    
+    /**
+     * @brief Sets the world point Reset() returns to
+     * @param world Home point in world space, usually the scene origin
+     */
+    nil SetHome(const Math::Vector3d& world) { home = world; }
+    
+    /**
+     * @brief Gets camera position in world space
+     * @return Math::Vector3d Position in double precision
+     */
+    Math::Vector3d GetWorldPosition() const { return origin + Math::Vector3d(position); }
+    
+    /**
+     * @brief Gets target point in world space
+     * @return Math::Vector3d Target in double precision
+     */
+    Math::Vector3d GetWorldTarget() const { return origin + Math::Vector3d(target); }
+    
+    /**
+     * @brief Looks at a world point, keeping distance and orientation
+     * @param world Target in world space
+     */
+    nil SetWorldTarget(const Math::Vector3d& world);
+    
     // Orbit controls
     /**
      * @brief Sets orbit distance
@@ -189,37 +366,82 @@ public:
     
     /**
      * @brief Sets orbit angles
-     * @param angle_x Horizontal angle in degrees
-     * @param angle_y Vertical angle in degrees
+     * 
+     * Replaces the orientation, removing any roll.
+     * 
+     * @param angle_x Horizontal angle in radians
+     * @param angle_y Vertical angle in radians, -pi/2 (below) to pi/2 (above)
      */
     nil SetOrbitAngles(float angle_x, float angle_y);
     
     /**
-     * @brief Orbits around target point
-     * @param delta_x Horizontal rotation delta
-     * @param delta_y Vertical rotation delta
+     * @brief Builds the orientation of a camera at the given orbit angles
+     * 
+     * The camera sits at target + distance * (cos y cos x, sin y, cos y sin x),
+     * looks at the target and keeps world Y up.
+     * 
+     * @param angle_x Horizontal angle in radians
+     * @param angle_y Vertical angle in radians
+     * @return Math::Quaternion Orientation
+     */
+    static Math::Quaternion OrientationFromAngles(float angle_x, float angle_y);
+    
+    /**
+     * @brief Sets the orientation
+     * @param rotation Camera to world rotation
+     */
+    nil SetOrientation(const Math::Quaternion& rotation);
+    
+    /**
+     * @brief Gets the orientation
+     * @return Math::Quaternion Camera to world rotation
+     */
+    Math::Quaternion GetOrientation() const { return orientation; }
+    
+    /**
+     * @brief Rolls the camera around its view direction
+     * @param radians Angle, counter-clockwise as seen by the camera
+     */
+    nil Roll(float radians);
+    
+    /**
+     * @brief Sets how rotation drags turn the camera
+     * @param mode Rotation mode
+     */
+    nil SetRotationMode(CameraRotationMode mode);
+    
+    /**
+     * @brief Gets the rotation mode
+     * @return CameraRotationMode Current mode
+     */
+    CameraRotationMode GetRotationMode() const { return rotation_mode; }
+    
+    /**
+     * @brief Orbits around target point immediately, without smoothing
+     * @param delta_x Horizontal rotation delta in pixels
+     * @param delta_y Vertical rotation delta in pixels
      */
     nil Orbit(float delta_x, float delta_y);
     
     // Pan controls
     /**
-     * @brief Pans the camera
-     * @param delta_x Horizontal pan delta
-     * @param delta_y Vertical pan delta
+     * @brief Pans the camera immediately, without smoothing
+     * @param delta_x Horizontal pan delta in pixels
+     * @param delta_y Vertical pan delta in pixels
      */
     nil Pan(float delta_x, float delta_y);
     
     /**
-     * @brief Moves camera along axes (Ctrl + mouse movement)
-     * @param delta_x Horizontal movement delta
-     * @param delta_y Vertical movement delta
+     * @brief Moves camera along axes (Ctrl + mouse movement) immediately
+     * @param delta_x Horizontal movement delta in pixels
+     * @param delta_y Vertical movement delta in pixels
      */
     nil MoveAlongAxes(float delta_x, float delta_y);
     
     // Zoom controls
     /**
-     * @brief Zooms the camera
-     * @param delta Zoom delta (positive = zoom in, negative = zoom out)
+     * @brief Zooms the camera immediately, without smoothing
+     * @param delta Zoom delta in wheel steps (positive = zoom in, negative = zoom out)
      */
     nil Zoom(float delta);
     
@@ -255,6 +477,10 @@ public:
     
     /**
      * @brief Handles keyboard input
+     * 
+     * R resets the view and P toggles the projection. Q and E roll while
+     * held; in FreeFly mode W, A, S and D fly.
+     * 
      * @param key Key code
      * @param action Key action (press/release)
      */
@@ -263,16 +489,65 @@ public:
     // Matrix generation
     /**
      * @brief Gets view matrix
-     * @return Math::Matrix4 View matrix
+     * @return Math::Matrix4 View matrix for coordinates relative to GetOrigin()
      */
     Math::Matrix4 GetViewMatrix() const;
     
+    /**
+     * @brief Gets the view matrix for geometry stored relative to a world point
+     * 
+     * The difference between frame_origin and the camera origin is taken in
+     * double precision and becomes a small translation of the view matrix,
+     * so vertices are transformed relative to the camera in float without
+     * ever holding large world coordinates.
+     * 
+     * @param frame_origin World position of the geometry's (0, 0, 0)
+     * @return Math::Matrix4 View matrix in OpenGL (column-major) layout
+     */
+    Math::Matrix4 GetViewMatrix(const Math::Vector3d& frame_origin) const;
+    
     /**
      * @brief Gets projection matrix
      * @return Math::Matrix4 Projection matrix
      */
     Math::Matrix4 GetProjectionMatrix() const;
     
+    /**
+     * @brief Gets combined view-projection matrix
+     * @return Math::Matrix4 Projection * View in OpenGL (column-major) layout
+     */
+    Math::Matrix4 GetViewProjectionMatrix() const;
+    
+    /**
+     * @brief Gets combined view-projection matrix for geometry stored relative to a world point
+     * @param frame_origin World position of the geometry's (0, 0, 0)
+     * @return Math::Matrix4 Projection * View in OpenGL (column-major) layout
+     */
+    Math::Matrix4 GetViewProjectionMatrix(const Math::Vector3d& frame_origin) const;
+    
+    /**
+     * @brief Unprojects a point in normalized device coordinates onto a Z plane
+     * @param ndc Point in normalized device coordinates (-1 to 1)
+     * @param plane_z World Z of the drawing plane
+     * @param out Intersection point on the plane
+     * @return bool False if the view ray is parallel to the plane
+     */
+    bool ScreenToPlane(const Math::Vector2& ndc, float plane_z, Math::Vector3& out) const;
+    
+    /**
+     * @brief Unprojects a point using a precomputed inverse view-projection
+     * 
+     * Lets callers compute the inverse once per frame and map many cursor
+     * positions without re-inverting the matrix.
+     * 
+     * @param inverse_view_projection Inverse of GetViewProjectionMatrix()
+     * @param ndc Point in normalized device coordinates (-1 to 1)
+     * @param plane_z World Z of the drawing plane
+     * @param out Intersection point on the plane
+     * @return bool False if the view ray is parallel to the plane
+     */
+    static bool UnprojectToPlane(const Math::Matrix4& inverse_view_projection, const Math::Vector2& ndc, float plane_z, Math::Vector3& out);
+    
     /**
      * @brief Updates camera (call each frame)
      * @param width Viewport width
@@ -280,9 +555,64 @@ public:
      */
     nil Update(int width, int height);
     
+    // Motion
+    /**
+     * @brief Advances smoothing, inertia and transitions (call each frame)
+     * 
+     * Time is integrated in steps of STEP_SECONDS; the remainder carries
+     * over to the next call. A frame after a period of rest advances at
+     * most one nominal frame, so an idle wait does not show up as a jump.
+     * 
+     * @param delta_seconds Time since the previous frame
+     */
+    nil Advance(float delta_seconds);
+    
+    /**
+     * @brief Checks whether the camera is still moving on its own
+     * @return bool True while velocity remains or a transition runs; the
+     *         caller should keep producing frames
+     */
+    bool IsAnimating() const;
+    
+    /**
+     * @brief Checks whether a drag or a held key is in progress
+     * @return bool True until the matching release reaches this camera
+     */
+    bool IsCapturingInput() const { return is_rotating || is_panning || is_zooming || held_keys != 0; }
+    
+    /**
+     * @brief Sets how input is smoothed
+     * @param smoothing Velocity decay while dragging, 1/s; 0 moves the camera at once
+     * @param damping Velocity decay after release, 1/s; 0 stops on release
+     */
+    nil SetMotionSmoothing(float smoothing, float damping);
+    
+    float GetSmoothingRate() const { return smoothing_rate; }
+    float GetDampingRate() const { return damping_rate; }
+    
+    /**
+     * @brief Gets the current orbit parameters
+     * @return CameraState Current state
+     */
+    CameraState GetState() const;
+    
+    /**
+     * @brief Animates to a state with ease-in-out
+     * 
+     * The orientation is interpolated with slerp. Stops any inertia. A mouse press or scroll cancels the transition
+     * where it is.
+     * 
+     * @param state State to end in
+     * @param duration Seconds; 0 or less jumps immediately
+     */
+    nil AnimateTo(const CameraState& state, float duration);
+    
     // Utility methods
     /**
      * @brief Resets camera to default position
+     * 
+     * The origin moves to the home point first, so the default view is at
+     * the same world place however far the camera has recentered.
      */
     nil Reset();
     
@@ -290,8 +620,10 @@ public:
      * @brief Fits view to show all objects
      * @param min_bounds Minimum bounding box
      * @param max_bounds Maximum bounding box
+     * @param duration Animation length in seconds; 0 jumps immediately
      */
-    nil FitToBounds(const Math::Vector3& min_bounds, const Math::Vector3& max_bounds);
+    nil FitToBounds(const Math::Vector3& min_bounds, const Math::Vector3& max_bounds,
+                    float duration = DEFAULT_TRANSITION_SECONDS);
     
     /**
      * @brief Gets camera forward direction
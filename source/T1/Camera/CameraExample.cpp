@@ -60,13 +60,14 @@ nil CameraExample::SetupForArchitecturalViz() {
 nil CameraExample::AnimateCamera(float time) {
     // Simple camera animation - circular orbit
     float radius = 10.0f;
+    float height = 5.0f;
     float speed = 0.5f;
     
-    float x = radius * std::cos(time * speed);
-    float z = radius * std::sin(time * speed);
-    
-    camera->SetPosition(Math::Vector3(x, 5.0f, z));
-    camera->SetTarget(Math::Vector3(0.0f, 0.0f, 0.0f));
+    CameraState state = camera->GetState();
+    state.target = Math::Vector3(0.0f, 0.0f, 0.0f);
+    state.orbit_distance = std::sqrt(radius * radius + height * height);
+    state.orientation = Camera::OrientationFromAngles(time * speed, std::atan2(height, radius));
+    camera->AnimateTo(state, Camera::DEFAULT_TRANSITION_SECONDS);
 }
 
 nil CameraExample::FitToObject(const Math::Vector3& object_center, const Math::Vector3& object_size) {
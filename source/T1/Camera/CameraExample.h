@@ -13,6 +13,7 @@
 
 #include "Camera.h"
 #include "../../Core/Math.h"
+#include <memory>
 
 namespace MentalEngine {
 
@@ -61,6 +62,10 @@ public:
     
     /**
      * @brief Demonstrates camera animation
+     * 
+     * Retargets an eased transition toward the point of a circular orbit,
+     * so Camera::Advance() moves the camera smoothly between calls.
+     * 
      * @param time Current time in seconds
      */
     nil AnimateCamera(float time);
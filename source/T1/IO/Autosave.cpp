@@ -0,0 +1,364 @@
+/**
+ * @file Autosave.cpp
+ * @brief Implementation of the incremental autosave
+ * @author MentalEngine Team
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#include "Autosave.h"
+#include "DrawingFile.h"
+#include "../../Core/MappedFile.h"
+#include "../Scene/SceneDelta.h"
+#include <cstring>
+
+namespace MentalEngine {
+
+namespace {
+
+bool FileExists(const std::string& path) {
+    FILE* file = std::fopen(path.c_str(), "rb");
+    if (!file) return false;
+    std::fclose(file);
+    return true;
+}
+
+bool ReplaceFile(const std::string& from, const std::string& to) {
+    if (std::rename(from.c_str(), to.c_str()) == 0) return true;
+    // Windows не заменяет существующий файл при rename
+    std::remove(to.c_str());
+    return std::rename(from.c_str(), to.c_str()) == 0;
+}
+
+} // namespace
+
+Autosave::~Autosave() {
+    Stop(false);
+}
+
+nil Autosave::Start(const std::string& path_prefix) {
+    Stop(false);
+    prefix = path_prefix;
+
+    // Файлы остались от сессии, завершившейся аварийно
+    const std::string recovery = RecoveryPrefix(prefix);
+    if (FileExists(BasePath(prefix))) {
+        std::remove(JournalPath(recovery).c_str());
+        ReplaceFile(BasePath(prefix), BasePath(recovery));
+        if (FileExists(JournalPath(prefix))) ReplaceFile(JournalPath(prefix), JournalPath(recovery));
+    }
+    std::remove(JournalPath(prefix).c_str());
+
+    stop_requested = false;
+    compacting = false;
+    base_lost = false;
+    mirror_lost = false;
+    mirror_valid = false;
+    writer_error.clear();
+    running = true;
+    accepting = false;
+    compaction_requested = true;  // the journal needs a base before the first edit
+    snapshot_file.clear();
+    has_changes = false;
+    pending.clear();
+    journaled_bytes = 0;
+    last_compaction = std::chrono::steady_clock::now();
+    writer = std::thread(&Autosave::__writer_loop, this);
+}
+
+nil Autosave::Stop(bool discard) {
+    if (!running) return;
+    {
+        std::lock_guard<std::mutex> lock(jobs_mutex);
+        if (discard) {
+            jobs.clear();
+        } else if (!pending.empty()) {
+            Job job;
+            job.delta.swap(pending);
+            jobs.push_back(std::move(job));
+        }
+        stop_requested = true;
+    }
+    jobs_ready.notify_one();
+    writer.join();
+
+    if (journal) {
+        std::fclose(journal);
+        journal = nullptr;
+    }
+    if (discard) {
+        std::remove(BasePath(prefix).c_str());
+        std::remove(JournalPath(prefix).c_str());
+    }
+    pending.clear();
+    running = false;
+}
+
+nil Autosave::Record(const SceneCommand& command, bool forward) {
+    if (!running) return;
+    has_changes = true;
+    if (!accepting) {
+        // Правка после загрузки: файл уже не совпадает со сценой
+        snapshot_file.clear();
+        return;
+    }
+
+    const size_t mark = pending.size();
+    SceneDeltaWriter out(pending);
+    if (!command.EncodeDelta(out, forward)) {
+        pending.resize(mark);
+        RequestCompaction();
+    }
+}
+
+nil Autosave::RequestCompaction() {
+    accepting = false;
+    compaction_requested = true;
+    has_changes = true;
+    snapshot_file.clear();
+}
+
+nil Autosave::RequestCompactionFromFile(const std::string& path) {
+    RequestCompaction();
+    snapshot_file = path;
+}
+
+nil Autosave::Update(const Scene& scene) {
+    if (!running) return;
+
+    if (!pending.empty()) {
+        journaled_bytes += pending.size() + sizeof(AutosaveRecordHeader);
+        Job job;
+        job.delta.swap(pending);
+        __push(std::move(job));
+    }
+    // Записи журнала заданы относительно origin базы; новый origin требует новой базы
+    if (scene.GetOrigin() != snapshot_origin) RequestCompaction();
+
+    {
+        std::lock_guard<std::mutex> lock(jobs_mutex);
+        if (base_lost) {
+            // Повторяем по расписанию, а не каждый кадр: ошибка диска обычно не проходит сразу
+            // Записи без журнала продолжают попадать в копию сцены писателя
+            base_lost = false;
+            has_changes = true;
+        }
+        if (mirror_lost) {
+            mirror_lost = false;
+            RequestCompaction();
+        }
+        if (compacting) return;
+    }
+
+    const auto now = std::chrono::steady_clock::now();
+    const double elapsed = std::chrono::duration<double>(now - last_compaction).count();
+    const bool due = compaction_requested || journaled_bytes >= COMPACT_JOURNAL_SIZE ||
+                     (has_changes && elapsed >= COMPACT_INTERVAL_SECONDS);
+    if (!due) return;
+
+    Job job;
+    job.origin = scene.GetOrigin();
+    if (!compaction_requested) {
+        // Копия сцены у писателя уже содержит все записи журнала
+        job.kind = JobKind::Compact;
+    } else if (!snapshot_file.empty()) {
+        job.kind = JobKind::LoadFile;
+        job.path = snapshot_file;
+    } else {
+        // Only the columns are copied; the writer never needs the spatial index
+        job.kind = JobKind::Snapshot;
+        job.lines = scene.GetLines();
+        job.arcs = scene.GetArcs();
+    }
+    snapshot_file.clear();
+    snapshot_origin = job.origin;
+    {
+        std::lock_guard<std::mutex> lock(jobs_mutex);
+        compacting = true;
+    }
+    __push(std::move(job));
+
+    accepting = true;
+    compaction_requested = false;
+    has_changes = false;
+    journaled_bytes = 0;
+    last_compaction = now;
+}
+
+std::string Autosave::TakeError() {
+    std::lock_guard<std::mutex> lock(jobs_mutex);
+    std::string error;
+    error.swap(writer_error);
+    return error;
+}
+
+nil Autosave::__push(Job&& job) {
+    {
+        std::lock_guard<std::mutex> lock(jobs_mutex);
+        jobs.push_back(std::move(job));
+    }
+    jobs_ready.notify_one();
+}
+
+nil Autosave::__writer_loop() {
+    std::unique_lock<std::mutex> lock(jobs_mutex);
+    for (;;) {
+        jobs_ready.wait(lock, [this] { return stop_requested || !jobs.empty(); });
+        if (jobs.empty()) break;
+
+        std::deque<Job> batch;
+        batch.swap(jobs);
+        lock.unlock();
+
+        std::string error;
+        bool compacted = false;
+        bool failed = false;
+        bool replay_failed = false;
+        for (Job& job : batch) {
+            if (job.kind != JobKind::Record) {
+                compacted = true;
+                failed = !__compact(job, error) || failed;
+                continue;
+            }
+            if (mirror_valid && !SceneDelta::Replay(job.delta.data(), job.delta.size(), mirror)) {
+                mirror_valid = false;
+                replay_failed = true;
+            }
+            if (journal && !__append(job.delta, error)) failed = true;
+        }
+        // Один fflush на пачку записей, а не на каждую
+        if (journal && std::fflush(journal) != 0) {
+            error = "Failed to flush " + JournalPath(prefix);
+            failed = true;
+        }
+        if (failed && journal) {
+            std::fclose(journal);
+            journal = nullptr;
+        }
+
+        lock.lock();
+        if (compacted) compacting = false;
+        if (replay_failed || (compacted && !mirror_valid)) mirror_lost = true;
+        if (failed) {
+            writer_error = error;
+            base_lost = true;
+        }
+    }
+}
+
+bool Autosave::__compact(Job& job, std::string& error) {
+    if (journal) {
+        std::fclose(journal);
+        journal = nullptr;
+    }
+
+    if (job.kind == JobKind::LoadFile) {
+        Math::Vector2d origin;
+        mirror_valid = DrawingFile::Read(job.path, job.lines, job.arcs, origin, error) && origin == job.origin;
+        if (!mirror_valid) {
+            if (error.empty()) error = job.path + " changed after it was opened";
+            return false;
+        }
+    }
+    if (job.kind != JobKind::Compact) {
+        mirror.SetOrigin(job.origin);
+        mirror.PutAll(std::move(job.lines), std::move(job.arcs));
+        mirror_valid = true;
+    }
+    if (!mirror_valid) {
+        error = "Autosave lost track of the scene";
+        return false;
+    }
+    return __write_base(error);
+}
+
+bool Autosave::__write_base(std::string& error) {
+    const std::string base_path = BasePath(prefix);
+    if (!DrawingFile::Save(mirror, base_path, error)) return false;
+
+    DrawingFileView base;
+    if (!base.Open(base_path, error)) return false;
+
+    // Until the rename the old journal stays in place; its base checksum no
+    // longer matches, so a crash here recovers the new base alone
+    AutosaveJournalHeader header = {};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.base_checksum = base.GetHeaderChecksum();
+
+    const std::string journal_path = JournalPath(prefix);
+    const std::string temp_path = journal_path + ".tmp";
+    FILE* file = std::fopen(temp_path.c_str(), "wb");
+    bool ok = file && std::fwrite(&header, sizeof(header), 1, file) == 1;
+    if (file) ok = std::fclose(file) == 0 && ok;
+    if (!ok || !ReplaceFile(temp_path, journal_path)) {
+        std::remove(temp_path.c_str());
+        error = "Cannot write " + journal_path;
+        return false;
+    }
+
+    journal = std::fopen(journal_path.c_str(), "ab");
+    if (!journal) {
+        error = "Cannot open " + journal_path;
+        return false;
+    }
+    return true;
+}
+
+bool Autosave::__append(const std::vector<uint8_t>& delta, std::string& error) {
+    AutosaveRecordHeader record = {};
+    record.size = static_cast<uint32_t>(delta.size());
+    record.checksum = DrawingFile::Checksum(delta.data(), delta.size());
+    if (std::fwrite(&record, sizeof(record), 1, journal) != 1 ||
+        std::fwrite(delta.data(), 1, delta.size(), journal) != delta.size()) {
+        error = "Failed to write " + JournalPath(prefix);
+        return false;
+    }
+    return true;
+}
+
+bool Autosave::HasRecovery(const std::string& prefix) {
+    return FileExists(BasePath(RecoveryPrefix(prefix)));
+}
+
+bool Autosave::Recover(const std::string& prefix, Scene& scene, std::string& error, size_t* records) {
+    if (records) *records = 0;
+
+    Scene recovered;
+    if (!DrawingFile::Load(BasePath(prefix), recovered, error)) return false;
+    DrawingFileView base;
+    if (!base.Open(BasePath(prefix), error)) return false;
+
+    MappedFile journal;
+    if (journal.Open(JournalPath(prefix)) && journal.GetSize() >= sizeof(AutosaveJournalHeader)) {
+        const uint8_t* data = journal.GetData();
+        const size_t size = journal.GetSize();
+
+        AutosaveJournalHeader header;
+        std::memcpy(&header, data, sizeof(header));
+        const bool matches = std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) == 0 &&
+                             header.version == VERSION && header.base_checksum == base.GetHeaderChecksum();
+
+        size_t offset = sizeof(header);
+        while (matches && size - offset >= sizeof(AutosaveRecordHeader)) {
+            AutosaveRecordHeader record;
+            std::memcpy(&record, data + offset, sizeof(record));
+            offset += sizeof(record);
+            // Оборванная или поврежденная запись - конец журнала
+            if (record.size > size - offset) break;
+            if (record.checksum != DrawingFile::Checksum(data + offset, record.size)) break;
+            if (!SceneDelta::Replay(data + offset, record.size, recovered)) break;
+            offset += record.size;
+            if (records) (*records)++;
+        }
+    }
+
+    LineStorage lines;
+    ArcStorage arcs;
+    recovered.TakeAll(lines, arcs);
+    scene.SetOrigin(recovered.GetOrigin());
+    scene.PutAll(std::move(lines), std::move(arcs));
+    return true;
+}
+
+} // namespace MentalEngine
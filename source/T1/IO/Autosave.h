@@ -0,0 +1,264 @@
+/**
+ * @file Autosave.h
+ * @brief Incremental autosave with an append-only journal for MentalEngine
+ * @author MentalEngine Team
+ * @version 1.0.0
+ * @date 2024
+ *
+ * This file defines the Autosave class. Edits are journaled as compact scene
+ * deltas next to a base drawing in the native format; the journal is folded
+ * into a new base from time to time. All disk I/O runs on a background
+ * thread, so the UI never waits for the file system.
+ *
+ * Files (for a prefix P):
+ * @code
+ *   P.mdrw             base drawing (DrawingFile format)
+ *   P.mjnl             journal: AutosaveJournalHeader, then records
+ *   record             AutosaveRecordHeader followed by a SceneDelta stream
+ * @endcode
+ */
+
+#ifndef MENTAL_AUTOSAVE_H
+#define MENTAL_AUTOSAVE_H
+
+#include "../../Core/Types.h"
+#include "../Scene/Scene.h"
+#include "../Scene/SceneCommand.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace MentalEngine {
+
+/**
+ * @struct AutosaveJournalHeader
+ * @brief Fixed-size journal header
+ */
+struct AutosaveJournalHeader {
+    char magic[8];           ///< "MENTJNL" followed by a zero byte
+    uint32_t version;        ///< Format version
+    uint32_t reserved;       ///< Zero
+    uint64_t base_checksum;  ///< header_checksum of the base drawing the journal applies to
+};
+
+/**
+ * @struct AutosaveRecordHeader
+ * @brief Header preceding every journal record
+ */
+struct AutosaveRecordHeader {
+    uint32_t size;       ///< Payload bytes
+    uint32_t reserved;   ///< Zero
+    uint64_t checksum;   ///< DrawingFile::Checksum of the payload
+};
+
+static_assert(sizeof(AutosaveJournalHeader) == 24, "AutosaveJournalHeader must stay 24 bytes");
+static_assert(sizeof(AutosaveRecordHeader) == 16, "AutosaveRecordHeader must stay 16 bytes");
+
+/**
+ * @class Autosave
+ * @brief Background journal of scene edits with periodic compaction
+ *
+ * Record() is fed from the CommandHistory listener and only encodes the edit
+ * into memory. Update(), called once per frame, hands the frame's edits to
+ * the writer thread as one record. The writer replays every record into its
+ * own copy of the scene (columns only, no index), so a periodic compaction
+ * saves that copy as the new base and costs the main thread nothing.
+ *
+ * Edits that have no compact delta (undoing Clear All) and changes made
+ * outside the history (DXF import, a new origin) request a snapshot
+ * instead: the main thread copies the scene's columns once and the writer
+ * takes them over. An opened drawing is re-read from its file by the
+ * writer (see RequestCompactionFromFile()). Until the snapshot is taken
+ * edits are not journaled, since the snapshot will contain them anyway.
+ *
+ * Each record carries a checksum, so a record torn by a crash ends replay
+ * cleanly. A journal whose base checksum does not match the base file is
+ * ignored.
+ *
+ * @note This class is non-copyable; the destructor stops the writer thread
+ */
+class Autosave {
+public:
+    static constexpr char MAGIC[8] = {'M', 'E', 'N', 'T', 'J', 'N', 'L', '\0'};
+    static constexpr uint32_t VERSION = 1;
+    static constexpr size_t COMPACT_JOURNAL_SIZE = 32 * 1024 * 1024;  ///< Journal size that triggers compaction
+    static constexpr double COMPACT_INTERVAL_SECONDS = 300.0;         ///< Compaction period while edits keep coming
+
+private:
+    /**
+     * @enum JobKind
+     * @brief What a writer job does
+     */
+    enum class JobKind : uint8_t {
+        Record = 0,   ///< Append a record to the journal and replay it into the writer's scene
+        Snapshot,     ///< Replace the writer's scene with the job's columns, then compact
+        LoadFile,     ///< Replace the writer's scene with a drawing file, then compact
+        Compact       ///< Save the writer's scene as the new base
+    };
+
+    /**
+     * @struct Job
+     * @brief Unit of work for the writer thread
+     */
+    struct Job {
+        JobKind kind = JobKind::Record;  ///< Work to do
+        std::vector<uint8_t> delta;      ///< Record payload
+        LineStorage lines;               ///< Snapshot columns
+        ArcStorage arcs;                 ///< Snapshot columns
+        Math::Vector2d origin;           ///< Scene origin of the snapshot
+        std::string path;                ///< Drawing to load for LoadFile
+    };
+
+    std::string prefix;                       ///< Path prefix of the autosave files
+    std::thread writer;                       ///< Writer thread
+    std::mutex jobs_mutex;                    ///< Guards jobs, stop_requested, compacting, writer_error, base_lost, mirror_lost
+    std::condition_variable jobs_ready;       ///< Signals new jobs or stop
+    std::deque<Job> jobs;                     ///< Pending jobs, in order
+    bool stop_requested = false;              ///< Asks the writer to drain and exit
+    bool compacting = false;                  ///< A compaction job is queued or running
+    std::string writer_error;                 ///< Last error reported by the writer
+    bool base_lost = false;                   ///< Writer failed; journal is closed until the next base
+    bool mirror_lost = false;                 ///< The writer's scene no longer matches; a snapshot is needed
+    FILE* journal = nullptr;                  ///< Open journal (writer thread only)
+    Scene mirror;                             ///< Base plus journal as replayed (writer thread only)
+    bool mirror_valid = false;                ///< mirror holds a snapshot (writer thread only)
+
+    // Main thread state
+    bool running = false;                     ///< Between Start() and Stop()
+    bool accepting = false;                   ///< Edits are journaled (a base is queued)
+    bool compaction_requested = false;        ///< Take a snapshot on the next Update()
+    std::string snapshot_file;                ///< The scene equals this drawing file; the writer reads it instead of a copy
+    bool has_changes = false;                 ///< Edits since the last snapshot
+    std::vector<uint8_t> pending;             ///< Edits of the current frame
+    size_t journaled_bytes = 0;               ///< Bytes queued since the last snapshot
+    Math::Vector2d snapshot_origin;           ///< Scene origin the journal records are relative to
+    std::chrono::steady_clock::time_point last_compaction;  ///< Time of the last snapshot
+
+    /**
+     * @brief Writer thread main loop
+     * @private
+     */
+    nil __writer_loop();
+
+    /**
+     * @brief Brings the writer's scene up to date with a job, then saves it as a base
+     * @private
+     */
+    bool __compact(Job& job, std::string& error);
+
+    /**
+     * @brief Saves the writer's scene as a base and starts a fresh journal for it
+     * @private
+     */
+    bool __write_base(std::string& error);
+
+    /**
+     * @brief Appends one record to the journal
+     * @private
+     */
+    bool __append(const std::vector<uint8_t>& delta, std::string& error);
+
+    /**
+     * @brief Queues a job for the writer thread
+     * @private
+     */
+    nil __push(Job&& job);
+
+public:
+    Autosave() = default;
+    ~Autosave();
+    Autosave(const Autosave&) = delete;
+    Autosave& operator=(const Autosave&) = delete;
+
+    /**
+     * @brief Starts autosaving
+     *
+     * Files left by a session that did not exit cleanly are renamed to the
+     * recovery names first, so Recover() can still load them.
+     *
+     * @param path_prefix Prefix of the autosave files
+     */
+    nil Start(const std::string& path_prefix);
+
+    /**
+     * @brief Stops the writer after it has flushed everything
+     * @param discard Delete the autosave files (clean exit)
+     */
+    nil Stop(bool discard);
+
+    /**
+     * @brief Journals an edit that was just applied or reverted
+     * @param command Command that touched the scene
+     * @param forward True for Apply(), false for Revert()
+     */
+    nil Record(const SceneCommand& command, bool forward);
+
+    /**
+     * @brief Requests a new base, e.g. after the whole scene was replaced
+     */
+    nil RequestCompaction();
+
+    /**
+     * @brief Requests a new base after the scene was loaded from a drawing file
+     *
+     * The writer reads the file itself, so the main thread copies nothing.
+     * Falls back to a snapshot if the scene is edited before the next
+     * Update().
+     *
+     * @param path Drawing the scene was just loaded from, unchanged since
+     */
+    nil RequestCompactionFromFile(const std::string& path);
+
+    /**
+     * @brief Flushes the frame's edits and compacts when due
+     *
+     * Call once per frame, while the scene is not being modified elsewhere.
+     *
+     * @param scene Current scene
+     */
+    nil Update(const Scene& scene);
+
+    bool IsRunning() const { return running; }
+    size_t GetJournaledBytes() const { return journaled_bytes; }
+
+    /**
+     * @brief Gets and clears the last writer error
+     * @return std::string Error message, empty if none
+     */
+    std::string TakeError();
+
+    static std::string BasePath(const std::string& prefix) { return prefix + ".mdrw"; }
+    static std::string JournalPath(const std::string& prefix) { return prefix + ".mjnl"; }
+    static std::string RecoveryPrefix(const std::string& prefix) { return prefix + ".recovered"; }
+
+    /**
+     * @brief Checks whether files from an unclean exit are available
+     * @param prefix Prefix passed to Start()
+     * @return bool True if a recovery base exists
+     */
+    static bool HasRecovery(const std::string& prefix);
+
+    /**
+     * @brief Loads a base drawing and replays its journal
+     *
+     * Replay stops at the first damaged record; everything before it is kept.
+     *
+     * @param prefix Prefix of the files to load (e.g. RecoveryPrefix())
+     * @param scene Scene to fill; left untouched on failure
+     * @param error Receives a message on failure
+     * @param records Receives the number of records replayed
+     * @return bool True if the base loaded
+     */
+    static bool Recover(const std::string& prefix, Scene& scene, std::string& error, size_t* records = nullptr);
+};
+
+} // namespace MentalEngine
+
+#endif // MENTAL_AUTOSAVE_H
@@ -0,0 +1,390 @@
+/**
+ * @file DrawingFile.cpp
+ * @brief Implementation of the native binary drawing format
+ * @author MentalEngine Team
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#include "DrawingFile.h"
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+namespace MentalEngine {
+
+constexpr char DrawingFile::MAGIC[8];
+
+namespace {
+
+/**
+ * @brief Column description used when writing
+ */
+struct ColumnSource {
+    DrawingSectionTag tag;
+    const std::vector<float>* values;
+};
+
+uint64_t __align_up(uint64_t value, uint64_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+/**
+ * @brief Buffered sequential writer that tracks the file position
+ */
+class SectionWriter {
+private:
+    FILE* file;
+    uint64_t position = 0;
+    bool ok = true;
+
+public:
+    explicit SectionWriter(FILE* file) : file(file) {}
+
+    nil Write(const void* data, size_t size) {
+        if (!ok || size == 0) return;
+        ok = std::fwrite(data, 1, size, file) == size;
+        position += size;
+    }
+
+    nil PadTo(uint64_t alignment) {
+        static const uint8_t zeros[64] = {};
+        uint64_t padding = __align_up(position, alignment) - position;
+        while (padding > 0) {
+            size_t chunk = static_cast<size_t>(padding < sizeof(zeros) ? padding : sizeof(zeros));
+            Write(zeros, chunk);
+            padding -= chunk;
+        }
+    }
+
+    uint64_t GetPosition() const { return position; }
+    bool IsOk() const { return ok; }
+};
+
+} // namespace
+
+uint64_t DrawingFile::Checksum(const void* data, size_t size) {
+    // Fletcher-64: два накопителя по модулю 2^32 - 1, редукция раз в блок
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    const uint64_t MOD = 0xFFFFFFFFull;
+    const size_t BLOCK_WORDS = 65536;  // b stays below 2^64 within a block
+
+    uint64_t a = 0, b = 0;
+    size_t words = size / 4;
+    while (words > 0) {
+        size_t block = words < BLOCK_WORDS ? words : BLOCK_WORDS;
+        for (size_t i = 0; i < block; i++) {
+            uint32_t word;
+            std::memcpy(&word, bytes, 4);
+            bytes += 4;
+            a += word;
+            b += a;
+        }
+        a %= MOD;
+        b %= MOD;
+        words -= block;
+    }
+
+    size_t tail = size % 4;
+    if (tail > 0) {
+        uint32_t word = 0;
+        std::memcpy(&word, bytes, tail);
+        a = (a + word) % MOD;
+        b = (b + a) % MOD;
+    }
+    return (b << 32) | a;
+}
+
+bool DrawingFile::Save(const Scene& scene, const std::string& path, std::string& error) {
+    const LineStorage& lines = scene.GetLines();
+    const ArcStorage& arcs = scene.GetArcs();
+    const ColumnSource columns[] = {
+        {DrawingSectionTag::LineX0, &lines.x0},
+        {DrawingSectionTag::LineY0, &lines.y0},
+        {DrawingSectionTag::LineX1, &lines.x1},
+        {DrawingSectionTag::LineY1, &lines.y1},
+        {DrawingSectionTag::ArcCX, &arcs.cx},
+        {DrawingSectionTag::ArcCY, &arcs.cy},
+        {DrawingSectionTag::ArcRadius, &arcs.radius},
+        {DrawingSectionTag::ArcStart, &arcs.start_angle},
+        {DrawingSectionTag::ArcSweep, &arcs.sweep_angle},
+    };
+    const uint32_t column_count = static_cast<uint32_t>(sizeof(columns) / sizeof(columns[0]));
+    const uint32_t section_count = column_count + 1;
+
+    const std::string temp_path = path + ".tmp";
+    FILE* file = std::fopen(temp_path.c_str(), "wb");
+    if (!file) {
+        error = "Cannot create " + temp_path;
+        return false;
+    }
+    std::vector<char> buffer(1 << 20);
+    std::setvbuf(file, buffer.data(), _IOFBF, buffer.size());
+
+    SectionWriter writer(file);
+    DrawingFileHeader header = {};
+    writer.Write(&header, sizeof(header));  // placeholder, rewritten at the end
+
+    std::vector<DrawingSectionEntry> table(section_count);
+    for (uint32_t i = 0; i < column_count; i++) {
+        const std::vector<float>& values = *columns[i].values;
+        writer.PadTo(SECTION_ALIGNMENT);
+
+        DrawingSectionEntry& entry = table[i];
+        entry.tag = static_cast<uint32_t>(columns[i].tag);
+        entry.element_size = sizeof(float);
+        entry.offset = writer.GetPosition();
+        entry.count = values.size();
+        entry.checksum = Checksum(values.data(), values.size() * sizeof(float));
+        writer.Write(values.data(), values.size() * sizeof(float));
+    }
+
+    // Координаты в колонках - float относительно origin; сам origin хранится в double
+    const double origin[2] = {scene.GetOrigin().x, scene.GetOrigin().y};
+    writer.PadTo(SECTION_ALIGNMENT);
+    DrawingSectionEntry& origin_entry = table[column_count];
+    origin_entry.tag = static_cast<uint32_t>(DrawingSectionTag::Origin);
+    origin_entry.element_size = sizeof(double);
+    origin_entry.offset = writer.GetPosition();
+    origin_entry.count = 2;
+    origin_entry.checksum = Checksum(origin, sizeof(origin));
+    writer.Write(origin, sizeof(origin));
+
+    writer.PadTo(SECTION_ALIGNMENT);
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.byte_order = BYTE_ORDER_MARK;
+    header.header_size = sizeof(DrawingFileHeader);
+    header.section_count = section_count;
+    header.section_table_offset = writer.GetPosition();
+    header.section_table_checksum = Checksum(table.data(), table.size() * sizeof(DrawingSectionEntry));
+    writer.Write(table.data(), table.size() * sizeof(DrawingSectionEntry));
+    header.file_size = writer.GetPosition();
+    header.header_checksum = Checksum(&header, offsetof(DrawingFileHeader, header_checksum));
+
+    bool ok = writer.IsOk() && std::fseek(file, 0, SEEK_SET) == 0 &&
+              std::fwrite(&header, sizeof(header), 1, file) == 1;
+    ok = std::fclose(file) == 0 && ok;
+    if (!ok) {
+        std::remove(temp_path.c_str());
+        error = "Failed to write " + temp_path;
+        return false;
+    }
+
+    if (std::rename(temp_path.c_str(), path.c_str()) != 0) {
+        // Windows не заменяет существующий файл при rename
+        std::remove(path.c_str());
+        if (std::rename(temp_path.c_str(), path.c_str()) != 0) {
+            std::remove(temp_path.c_str());
+            error = "Cannot replace " + path;
+            return false;
+        }
+    }
+    return true;
+}
+
+bool DrawingFile::Read(const std::string& path, LineStorage& lines, ArcStorage& arcs, Math::Vector2d& origin,
+                       std::string& error, bool verify_checksums) {
+    DrawingFileView view;
+    if (!view.Open(path, error)) return false;
+    if (verify_checksums && !view.VerifyChecksums(error)) return false;
+
+    const size_t line_count = view.GetLineCount();
+    const size_t arc_count = view.GetArcCount();
+
+    // Все колонки одного типа примитива должны иметь одинаковую длину
+    auto copy_column = [&](DrawingSectionTag tag, size_t expected, std::vector<float>& out) {
+        size_t count = 0;
+        const float* values = view.GetColumn(tag, count);
+        if (!values || count != expected) return false;
+        out.assign(values, values + count);
+        return true;
+    };
+
+    bool complete =
+        copy_column(DrawingSectionTag::LineX0, line_count, lines.x0) &&
+        copy_column(DrawingSectionTag::LineY0, line_count, lines.y0) &&
+        copy_column(DrawingSectionTag::LineX1, line_count, lines.x1) &&
+        copy_column(DrawingSectionTag::LineY1, line_count, lines.y1) &&
+        copy_column(DrawingSectionTag::ArcCX, arc_count, arcs.cx) &&
+        copy_column(DrawingSectionTag::ArcCY, arc_count, arcs.cy) &&
+        copy_column(DrawingSectionTag::ArcRadius, arc_count, arcs.radius) &&
+        copy_column(DrawingSectionTag::ArcStart, arc_count, arcs.start_angle) &&
+        copy_column(DrawingSectionTag::ArcSweep, arc_count, arcs.sweep_angle);
+    if (!complete) {
+        error = "Drawing is missing geometry columns";
+        return false;
+    }
+    if (!view.GetOrigin(origin)) {
+        error = "Drawing has a malformed origin section";
+        return false;
+    }
+    return true;
+}
+
+bool DrawingFile::Load(const std::string& path, Scene& scene, std::string& error, bool verify_checksums) {
+    LineStorage lines;
+    ArcStorage arcs;
+    Math::Vector2d origin;
+    if (!Read(path, lines, arcs, origin, error, verify_checksums)) return false;
+    scene.SetOrigin(origin);
+    scene.PutAll(std::move(lines), std::move(arcs));
+    return true;
+}
+
+// DrawingFileLoader
+
+nil DrawingFileLoader::Start(const std::string& file_path) {
+    Cancel();
+    path = file_path;
+    state = std::make_shared<State>();
+    // Задача держит свое состояние сама: отмена не ждет ее завершения
+    std::shared_ptr<State> result = state;
+    job = JobSystem::Instance().Submit([result, file_path] {
+        result->succeeded = DrawingFile::Read(file_path, result->lines, result->arcs, result->origin, result->error);
+    });
+}
+
+bool DrawingFileLoader::Poll(Scene& scene, std::string& error) {
+    if (!job || !job->IsFinished()) return false;
+    job.reset();
+    std::shared_ptr<State> result = std::move(state);
+    if (!result->succeeded) {
+        error = result->error;
+        return true;
+    }
+    error.clear();
+    // Только перенос векторов: копирование уже сделано задачей
+    scene.SetOrigin(result->origin);
+    scene.PutAll(std::move(result->lines), std::move(result->arcs));
+    return true;
+}
+
+nil DrawingFileLoader::Cancel() {
+    job.reset();
+    state.reset();
+}
+
+// DrawingFileView
+
+bool DrawingFileView::Open(const std::string& path, std::string& error) {
+    header = nullptr;
+    sections = nullptr;
+    if (!file.Open(path)) {
+        error = "Cannot open " + path;
+        return false;
+    }
+
+    const uint8_t* base = file.GetData();
+    const uint64_t size = file.GetSize();
+    if (size < sizeof(DrawingFileHeader)) {
+        error = "File is too small to be a drawing";
+        return false;
+    }
+
+    const DrawingFileHeader* candidate = reinterpret_cast<const DrawingFileHeader*>(base);
+    if (std::memcmp(candidate->magic, DrawingFile::MAGIC, sizeof(DrawingFile::MAGIC)) != 0) {
+        error = "Not a MentalEngine drawing";
+        return false;
+    }
+    if (candidate->byte_order != DrawingFile::BYTE_ORDER_MARK) {
+        error = "Drawing was written with a different byte order";
+        return false;
+    }
+    if (candidate->version != DrawingFile::VERSION) {
+        error = "Unsupported drawing version " + std::to_string(candidate->version);
+        return false;
+    }
+    if (candidate->header_checksum != DrawingFile::Checksum(candidate, offsetof(DrawingFileHeader, header_checksum))) {
+        error = "Header checksum mismatch";
+        return false;
+    }
+    if (candidate->header_size != sizeof(DrawingFileHeader) || candidate->file_size != size) {
+        error = "Drawing is truncated or has trailing data";
+        return false;
+    }
+
+    const uint64_t table_offset = candidate->section_table_offset;
+    const uint64_t table_bytes = static_cast<uint64_t>(candidate->section_count) * sizeof(DrawingSectionEntry);
+    if (table_offset % alignof(DrawingSectionEntry) != 0 || table_offset > size || table_bytes > size - table_offset) {
+        error = "Section table lies outside the file";
+        return false;
+    }
+    if (candidate->section_table_checksum != DrawingFile::Checksum(base + table_offset, static_cast<size_t>(table_bytes))) {
+        error = "Section table checksum mismatch";
+        return false;
+    }
+
+    const DrawingSectionEntry* table = reinterpret_cast<const DrawingSectionEntry*>(base + table_offset);
+    for (uint32_t i = 0; i < candidate->section_count; i++) {
+        const DrawingSectionEntry& entry = table[i];
+        if (entry.element_size == 0 || entry.offset % alignof(float) != 0 || entry.offset > size ||
+            entry.count > (size - entry.offset) / entry.element_size) {
+            error = "Section " + std::to_string(i) + " lies outside the file";
+            return false;
+        }
+    }
+
+    header = candidate;
+    sections = table;
+    return true;
+}
+
+bool DrawingFileView::VerifyChecksums(std::string& error) const {
+    if (!header) {
+        error = "No drawing is open";
+        return false;
+    }
+    const uint8_t* base = file.GetData();
+    for (uint32_t i = 0; i < header->section_count; i++) {
+        const DrawingSectionEntry& entry = sections[i];
+        if (DrawingFile::Checksum(base + entry.offset, static_cast<size_t>(entry.count * entry.element_size)) != entry.checksum) {
+            error = "Checksum mismatch in section " + std::to_string(i);
+            return false;
+        }
+    }
+    return true;
+}
+
+const DrawingSectionEntry* DrawingFileView::__find(DrawingSectionTag tag) const {
+    if (!header) return nullptr;
+    for (uint32_t i = 0; i < header->section_count; i++) {
+        if (sections[i].tag == static_cast<uint32_t>(tag)) return &sections[i];
+    }
+    return nullptr;
+}
+
+const float* DrawingFileView::GetColumn(DrawingSectionTag tag, size_t& count) const {
+    const DrawingSectionEntry* entry = __find(tag);
+    if (!entry || entry->element_size != sizeof(float)) {
+        count = 0;
+        return nullptr;
+    }
+    count = static_cast<size_t>(entry->count);
+    return reinterpret_cast<const float*>(file.GetData() + entry->offset);
+}
+
+bool DrawingFileView::GetOrigin(Math::Vector2d& origin) const {
+    origin = Math::Vector2d();
+    const DrawingSectionEntry* entry = __find(DrawingSectionTag::Origin);
+    if (!entry) return true;
+    if (entry->element_size != sizeof(double) || entry->count != 2) return false;
+    double values[2];
+    std::memcpy(values, file.GetData() + entry->offset, sizeof(values));
+    origin = Math::Vector2d(values[0], values[1]);
+    return true;
+}
+
+size_t DrawingFileView::GetLineCount() const {
+    const DrawingSectionEntry* entry = __find(DrawingSectionTag::LineX0);
+    return entry ? static_cast<size_t>(entry->count) : 0;
+}
+
+size_t DrawingFileView::GetArcCount() const {
+    const DrawingSectionEntry* entry = __find(DrawingSectionTag::ArcCX);
+    return entry ? static_cast<size_t>(entry->count) : 0;
+}
+
+} // namespace MentalEngine
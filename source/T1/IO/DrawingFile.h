@@ -0,0 +1,261 @@
+/**
+ * @file DrawingFile.h
+ * @brief Native binary drawing format for MentalEngine
+ * @author MentalEngine Team
+ * @version 1.0.0
+ * @date 2024
+ *
+ * This file defines the on-disk layout of .mdrw drawings and the classes that
+ * read and write them. The layout mirrors the Scene's structure-of-arrays
+ * storage so a file can be memory-mapped and its columns used in place.
+ * Loading into a Scene still verifies and copies every column, which is
+ * O(file size); DrawingFileLoader does that work on a worker thread.
+ *
+ * Layout (little-endian):
+ * @code
+ *   DrawingFileHeader                 64 bytes at offset 0
+ *   section data                      each block 64-byte aligned, raw float arrays
+ *   DrawingSectionEntry[count]        section table, 64-byte aligned
+ * @endcode
+ */
+
+#ifndef MENTAL_DRAWING_FILE_H
+#define MENTAL_DRAWING_FILE_H
+
+#include "../../Core/Types.h"
+#include "../../Core/MappedFile.h"
+#include "../../Core/JobSystem.h"
+#include "../Scene/Scene.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace MentalEngine {
+
+/**
+ * @enum DrawingSectionTag
+ * @brief Identifies the column stored in a section (four-character code)
+ */
+enum class DrawingSectionTag : uint32_t {
+    LineX0     = 0x3058454C,  ///< "LEX0" line start X
+    LineY0     = 0x3059454C,  ///< "LEY0" line start Y
+    LineX1     = 0x3158454C,  ///< "LEX1" line end X
+    LineY1     = 0x3159454C,  ///< "LEY1" line end Y
+    ArcCX      = 0x58435241,  ///< "ARCX" arc center X
+    ArcCY      = 0x59435241,  ///< "ARCY" arc center Y
+    ArcRadius  = 0x52435241,  ///< "ARCR" arc radius
+    ArcStart   = 0x53435241,  ///< "ARCS" arc start angle
+    ArcSweep   = 0x57435241,  ///< "ARCW" arc sweep angle
+    Origin     = 0x4E47524F   ///< "ORGN" scene origin, two doubles (x, y)
+};
+
+/**
+ * @struct DrawingFileHeader
+ * @brief Fixed-size file header
+ */
+struct DrawingFileHeader {
+    char magic[8];                   ///< "MENTDRW" followed by a zero byte
+    uint32_t version;                ///< Format version
+    uint32_t byte_order;             ///< BYTE_ORDER_MARK as written by the producer
+    uint32_t header_size;            ///< sizeof(DrawingFileHeader)
+    uint32_t section_count;          ///< Entries in the section table
+    uint64_t section_table_offset;   ///< Byte offset of the section table
+    uint64_t file_size;              ///< Total file size in bytes
+    uint64_t section_table_checksum; ///< Checksum of the section table
+    uint64_t reserved;               ///< Zero
+    uint64_t header_checksum;        ///< Checksum of all preceding header bytes
+};
+
+/**
+ * @struct DrawingSectionEntry
+ * @brief Section table entry describing one data block
+ */
+struct DrawingSectionEntry {
+    uint32_t tag;           ///< DrawingSectionTag value
+    uint32_t element_size;  ///< Bytes per element
+    uint64_t offset;        ///< Byte offset of the block
+    uint64_t count;         ///< Number of elements
+    uint64_t checksum;      ///< Checksum of the block
+};
+
+static_assert(sizeof(DrawingFileHeader) == 64, "DrawingFileHeader must stay 64 bytes");
+static_assert(sizeof(DrawingSectionEntry) == 32, "DrawingSectionEntry must stay 32 bytes");
+
+/**
+ * @class DrawingFileView
+ * @brief Validated, memory-mapped view of a drawing file
+ *
+ * Open() checks the header, the section table and that every block lies
+ * inside the file, touching only those few bytes. Column pointers refer
+ * straight into the mapping; data checksums are verified on request, so
+ * callers that trust the file pay nothing for them.
+ */
+class DrawingFileView {
+private:
+    MappedFile file;                                 ///< Underlying mapping
+    const DrawingFileHeader* header = nullptr;       ///< Header inside the mapping
+    const DrawingSectionEntry* sections = nullptr;   ///< Section table inside the mapping
+
+    /**
+     * @brief Finds a section by tag
+     * @private
+     */
+    const DrawingSectionEntry* __find(DrawingSectionTag tag) const;
+
+public:
+    /**
+     * @brief Maps and validates a drawing file
+     * @param path File path
+     * @param error Receives a message on failure
+     * @return bool True if the file is structurally valid
+     */
+    bool Open(const std::string& path, std::string& error);
+
+    /**
+     * @brief Verifies the checksum of every data section
+     * @param error Receives a message on failure
+     * @return bool True if all sections match
+     */
+    bool VerifyChecksums(std::string& error) const;
+
+    /**
+     * @brief Gets a float column in place
+     * @param tag Column to look up
+     * @param count Receives the number of elements
+     * @return const float* Column data, or nullptr if absent
+     */
+    const float* GetColumn(DrawingSectionTag tag, size_t& count) const;
+
+    /**
+     * @brief Gets the world position of the scene's local origin
+     * @param origin Receives the origin; (0, 0) if the file has none
+     * @return bool False if the section exists but is malformed
+     */
+    bool GetOrigin(Math::Vector2d& origin) const;
+
+    size_t GetLineCount() const;
+    size_t GetArcCount() const;
+    uint32_t GetSectionCount() const { return header ? header->section_count : 0; }
+    uint64_t GetHeaderChecksum() const { return header ? header->header_checksum : 0; }
+    const DrawingSectionEntry& GetSection(uint32_t i) const { return sections[i]; }
+};
+
+/**
+ * @class DrawingFile
+ * @brief Loads and saves scenes in the native format
+ */
+class DrawingFile {
+public:
+    static constexpr char MAGIC[8] = {'M', 'E', 'N', 'T', 'D', 'R', 'W', '\0'};
+    static constexpr uint32_t VERSION = 1;
+    static constexpr uint32_t BYTE_ORDER_MARK = 0x01020304;
+    static constexpr uint64_t SECTION_ALIGNMENT = 64;  ///< Cache-line alignment of every block
+
+    /**
+     * @brief Writes a scene
+     *
+     * The file is written next to the target and renamed over it, so a
+     * failed save never leaves a truncated drawing behind.
+     *
+     * @param scene Scene to save
+     * @param path Destination path
+     * @param error Receives a message on failure
+     * @return bool True on success
+     */
+    static bool Save(const Scene& scene, const std::string& path, std::string& error);
+
+    /**
+     * @brief Reads a file's geometry into storage the caller owns
+     *
+     * Costs O(file size): one pass over the data for the checksums, if
+     * verified, and one copy of every column, since Scene owns its columns
+     * as vectors and cannot adopt the mapping. Safe to call on any thread.
+     *
+     * @param path Source path
+     * @param lines Receives the line columns
+     * @param arcs Receives the arc columns
+     * @param origin Receives the scene origin
+     * @param error Receives a message on failure
+     * @param verify_checksums Check data checksums before copying
+     * @return bool True on success
+     */
+    static bool Read(const std::string& path, LineStorage& lines, ArcStorage& arcs, Math::Vector2d& origin,
+                     std::string& error, bool verify_checksums = true);
+
+    /**
+     * @brief Replaces a scene's geometry with the contents of a file
+     *
+     * Blocks for the whole Read(); interactive code uses DrawingFileLoader.
+     *
+     * @param path Source path
+     * @param scene Scene to fill; left untouched on failure
+     * @param error Receives a message on failure
+     * @param verify_checksums Check data checksums before loading
+     * @return bool True on success
+     */
+    static bool Load(const std::string& path, Scene& scene, std::string& error, bool verify_checksums = true);
+
+    /**
+     * @brief Computes the format checksum (Fletcher-64 over 32-bit words)
+     * @param data Bytes to checksum
+     * @param size Number of bytes; a trailing partial word is zero-padded
+     * @return uint64_t Checksum
+     */
+    static uint64_t Checksum(const void* data, size_t size);
+};
+
+/**
+ * @class DrawingFileLoader
+ * @brief Reads a drawing on a worker thread and hands it to the scene in O(1)
+ *
+ * Checksum verification and the column copies run as one job; the thread
+ * that polls only moves the finished vectors into the scene, so opening a
+ * large drawing never stalls a frame. The job owns everything it writes,
+ * so Cancel() returns at once and a cancelled read finishes unobserved.
+ */
+class DrawingFileLoader {
+private:
+    /**
+     * @struct State
+     * @brief Result of one read, shared with its job
+     */
+    struct State {
+        LineStorage lines;       ///< Line columns read
+        ArcStorage arcs;         ///< Arc columns read
+        Math::Vector2d origin;   ///< Scene origin read
+        std::string error;       ///< Message on failure
+        bool succeeded = false;  ///< Read() returned true
+    };
+
+    JobHandle job;                  ///< Read in progress
+    std::shared_ptr<State> state;   ///< Its result
+    std::string path;               ///< File being read
+
+public:
+    /**
+     * @brief Starts reading a drawing, cancelling a read in progress
+     * @param file_path Source path
+     */
+    nil Start(const std::string& file_path);
+
+    /**
+     * @brief Replaces the scene's geometry once the read has finished
+     * @param scene Scene to fill; untouched if the read failed
+     * @param error Receives a message if the read failed, cleared otherwise
+     * @return bool True when the read finished during this call
+     */
+    bool Poll(Scene& scene, std::string& error);
+
+    /**
+     * @brief Abandons the read in progress without waiting for it
+     */
+    nil Cancel();
+
+    bool IsRunning() const { return job != nullptr; }
+    const std::string& GetPath() const { return path; }
+};
+
+} // namespace MentalEngine
+
+#endif // MENTAL_DRAWING_FILE_H
@@ -0,0 +1,824 @@
+/**
+ * @file DxfImporter.cpp
+ * @brief Implementation of the DxfImporter class
+ * @author MentalEngine Team
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#include "DxfImporter.h"
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cmath>
+#include <cstring>
+#include <utility>
+
+namespace MentalEngine {
+
+namespace {
+
+const double PI = 3.14159265358979323846;
+const double TWO_PI = 2.0 * PI;
+const double DEG_TO_RAD = PI / 180.0;
+
+const char BINARY_SENTINEL[] = "AutoCAD Binary DXF\r\n\x1a";  // 22 bytes with the terminating zero
+const size_t BINARY_SENTINEL_SIZE = sizeof(BINARY_SENTINEL);
+
+/**
+ * @brief One trimmed line of an ASCII DXF
+ */
+struct TextLine {
+    const char* begin = nullptr;
+    const char* end = nullptr;
+};
+
+/**
+ * @brief Reads the line at cursor and advances past its terminator
+ */
+bool __next_line(const char*& cursor, const char* limit, TextLine& line) {
+    if (cursor >= limit) return false;
+    const char* start = cursor;
+    const char* newline = static_cast<const char*>(std::memchr(cursor, '\n', static_cast<size_t>(limit - cursor)));
+    const char* stop = newline ? newline : limit;
+    cursor = newline ? newline + 1 : limit;
+
+    while (start < stop && (*start == ' ' || *start == '\t')) start++;
+    while (stop > start && (stop[-1] == '\r' || stop[-1] == ' ' || stop[-1] == '\t')) stop--;
+    line.begin = start;
+    line.end = stop;
+    return true;
+}
+
+bool __equals(const TextLine& line, const char* literal) {
+    size_t length = std::strlen(literal);
+    return static_cast<size_t>(line.end - line.begin) == length && std::memcmp(line.begin, literal, length) == 0;
+}
+
+bool __parse_int(const TextLine& line, int& out) {
+    const char* p = line.begin;
+    bool negative = false;
+    if (p < line.end && *p == '-') {
+        negative = true;
+        p++;
+    }
+    if (p == line.end) return false;
+    int value = 0;
+    for (; p < line.end; p++) {
+        if (*p < '0' || *p > '9') return false;
+        // Файл недоверенный: слишком длинное число - ошибка, а не переполнение
+        const int digit = *p - '0';
+        if (value > (INT_MAX - digit) / 10) return false;
+        value = value * 10 + digit;
+    }
+    out = negative ? -value : value;
+    return true;
+}
+
+/**
+ * @brief Locale-independent decimal parser for DXF numbers
+ *
+ * Mantissas up to 19 digits with exponents within +-22 are converted with a
+ * single correctly rounded multiply or divide, which covers what CAD
+ * programs write.
+ */
+double __parse_double(const char* p, const char* end) {
+    static const double POWERS[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                                    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+')) negative = *p++ == '-';
+
+    uint64_t mantissa = 0;
+    int digits = 0;
+    int exponent = 0;
+    for (; p < end && *p >= '0' && *p <= '9'; p++) {
+        if (digits < 19) {
+            mantissa = mantissa * 10 + static_cast<uint64_t>(*p - '0');
+            if (mantissa > 0) digits++;
+        } else {
+            exponent++;
+        }
+    }
+    if (p < end && *p == '.') {
+        for (p++; p < end && *p >= '0' && *p <= '9'; p++) {
+            if (digits < 19) {
+                mantissa = mantissa * 10 + static_cast<uint64_t>(*p - '0');
+                if (mantissa > 0) digits++;
+                exponent--;
+            }
+        }
+    }
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        p++;
+        bool negative_exponent = false;
+        if (p < end && (*p == '-' || *p == '+')) negative_exponent = *p++ == '-';
+        int value = 0;
+        for (; p < end && *p >= '0' && *p <= '9'; p++) {
+            if (value < 10000) value = value * 10 + (*p - '0');
+        }
+        exponent += negative_exponent ? -value : value;
+    }
+
+    double result = static_cast<double>(mantissa);
+    if (exponent > 0) result *= exponent <= 22 ? POWERS[exponent] : std::pow(10.0, exponent);
+    else if (exponent < 0) result /= -exponent <= 22 ? POWERS[-exponent] : std::pow(10.0, -exponent);
+    return negative ? -result : result;
+}
+
+/**
+ * @brief Finds the first entity start ("0" line followed by a type name) at or after p
+ *
+ * A "0" line followed by a line starting with a letter can only be a group
+ * code 0 and its entity name, because value lines are always followed by a
+ * numeric group code line.
+ */
+const char* __next_entity(const char* base, const char* p, const char* end) {
+    if (p > base && p[-1] != '\n') {
+        const char* newline = static_cast<const char*>(std::memchr(p, '\n', static_cast<size_t>(end - p)));
+        if (!newline) return end;
+        p = newline + 1;
+    }
+    while (p < end) {
+        const char* cursor = p;
+        TextLine first, second;
+        if (!__next_line(cursor, end, first)) break;
+        const char* after_first = cursor;
+        if (__equals(first, "0") && __next_line(cursor, end, second) &&
+            second.begin < second.end && *second.begin >= 'A' && *second.begin <= 'Z') {
+            return p;
+        }
+        p = after_first;
+    }
+    return end;
+}
+
+/**
+ * @brief Gets the start of the line containing p
+ */
+const char* __line_start(const char* base, const char* p) {
+    while (p > base && p[-1] != '\n') p--;
+    return p;
+}
+
+/**
+ * @brief Checks that the line starting at line_start is exactly literal and follows a line equal to code
+ */
+bool __is_group(const char* base, const char* limit, const char* line_start, const char* code, const char* literal) {
+    if (line_start <= base) return false;
+    const char* cursor = line_start;
+    TextLine value;
+    if (!__next_line(cursor, limit, value) || !__equals(value, literal)) return false;
+    const char* code_start = __line_start(base, line_start - 1);
+    cursor = code_start;
+    TextLine code_line;
+    return __next_line(cursor, line_start, code_line) && __equals(code_line, code);
+}
+
+/**
+ * @brief Locates the ENTITIES section body of an ASCII DXF
+ * @return bool True with [begin, end) spanning from the first entity to the ENDSEC code line
+ */
+bool __find_ascii_entities(const char* base, size_t size, const char*& begin, const char*& end) {
+    const char* limit = base + size;
+    auto find_group = [&](const char* from, const char* code, const char* literal) -> const char* {
+        const size_t length = std::strlen(literal);
+        while (from < limit) {
+            const char* hit = std::search(from, limit, literal, literal + length);
+            if (hit == limit) return nullptr;
+            const char* line_start = __line_start(base, hit);
+            if (__is_group(base, limit, line_start, code, literal)) return line_start;
+            from = hit + length;
+        }
+        return nullptr;
+    };
+
+    const char* name = find_group(base, "2", "ENTITIES");
+    if (!name) return false;
+    const char* cursor = name;
+    TextLine skip;
+    __next_line(cursor, limit, skip);
+    begin = cursor;
+
+    const char* endsec = find_group(begin, "0", "ENDSEC");
+    if (!endsec) return false;
+    end = __line_start(base, endsec - 1);
+    return true;
+}
+
+/**
+ * @brief Moves a batch's coordinates by an offset computed in double
+ */
+nil __rebase(DxfBatch& batch, const Math::Vector2d& offset) {
+    if (offset.x == 0.0 && offset.y == 0.0) return;
+    const float dx = static_cast<float>(offset.x);
+    const float dy = static_cast<float>(offset.y);
+    LineStorage& lines = batch.lines;
+    for (size_t i = 0; i < lines.x0.size(); i++) {
+        lines.x0[i] += dx;
+        lines.y0[i] += dy;
+        lines.x1[i] += dx;
+        lines.y1[i] += dy;
+    }
+    ArcStorage& arcs = batch.arcs;
+    for (size_t i = 0; i < arcs.cx.size(); i++) {
+        arcs.cx[i] += dx;
+        arcs.cy[i] += dy;
+    }
+}
+
+/**
+ * @brief Accumulates group values of one entity and emits primitives
+ */
+class EntityBuilder {
+private:
+    enum class Kind { None, Line, Circle, Arc, Polyline };
+
+    DxfBatch* batch;
+    Kind kind = Kind::None;
+    double x0 = 0.0, y0 = 0.0, x1 = 0.0, y1 = 0.0;
+    double radius = 0.0, start_angle = 0.0, end_angle = 0.0;
+    double extrusion_z = 1.0;
+    int flags = 0;
+    std::vector<double> vertex_x, vertex_y, vertex_bulge;
+
+    nil __anchor(double x, double y) {
+        // Целое начало координат: сдвиг между батчами складывается без ошибок округления
+        if (batch->has_origin) return;
+        batch->origin = Math::Vector2d(std::floor(x), std::floor(y));
+        batch->has_origin = true;
+    }
+
+    nil __line(double ax, double ay, double bx, double by) {
+        __anchor(ax, ay);
+        const Math::Vector2d& o = batch->origin;
+        LineStorage& lines = batch->lines;
+        lines.x0.push_back(static_cast<float>(ax - o.x));
+        lines.y0.push_back(static_cast<float>(ay - o.y));
+        lines.x1.push_back(static_cast<float>(bx - o.x));
+        lines.y1.push_back(static_cast<float>(by - o.y));
+    }
+
+    nil __arc(double cx, double cy, double r, double start, double sweep) {
+        __anchor(cx, cy);
+        const Math::Vector2d& o = batch->origin;
+        ArcStorage& arcs = batch->arcs;
+        arcs.cx.push_back(static_cast<float>(cx - o.x));
+        arcs.cy.push_back(static_cast<float>(cy - o.y));
+        arcs.radius.push_back(static_cast<float>(std::fabs(r)));
+        arcs.start_angle.push_back(static_cast<float>(start));
+        arcs.sweep_angle.push_back(static_cast<float>(sweep));
+    }
+
+    /**
+     * @brief Emits one polyline segment, as an arc when it has a bulge
+     */
+    nil __segment(double ax, double ay, double bx, double by, double bulge) {
+        double dx = bx - ax, dy = by - ay;
+        double chord = std::sqrt(dx * dx + dy * dy);
+        if (std::fabs(bulge) < 1e-9 || chord < 1e-12) {
+            __line(ax, ay, bx, by);
+            return;
+        }
+        // bulge = tan(theta / 4); the center lies off the chord midpoint by
+        // (chord / 2) * cot(theta / 2) = (chord / 2) * (1 - b^2) / (2b)
+        double theta = 4.0 * std::atan(bulge);
+        double offset = 0.5 * (1.0 - bulge * bulge) / (2.0 * bulge);
+        double cx = (ax + bx) * 0.5 - dy * offset;
+        double cy = (ay + by) * 0.5 + dx * offset;
+        double r = chord / (2.0 * std::sin(std::fabs(theta) * 0.5));
+        // Arcs are stored counter-clockwise; a negative bulge runs from b back to a
+        double start = bulge > 0.0 ? std::atan2(ay - cy, ax - cx) : std::atan2(by - cy, bx - cx);
+        __arc(cx, cy, r, start, std::fabs(theta));
+    }
+
+    nil __flush() {
+        // Mirrored OCS (extrusion 0,0,-1) maps (x, y) to (-x, y) in world space
+        const bool mirrored = extrusion_z < 0.0;
+        switch (kind) {
+            case Kind::Line:
+                __line(x0, y0, x1, y1);
+                batch->stats.lines++;
+                break;
+            case Kind::Circle:
+                __arc(mirrored ? -x0 : x0, y0, radius, 0.0, TWO_PI);
+                batch->stats.circles++;
+                break;
+            case Kind::Arc: {
+                double sweep = std::fmod(end_angle - start_angle, 360.0);
+                if (sweep <= 0.0) sweep += 360.0;
+                double start = start_angle * DEG_TO_RAD;
+                if (mirrored) start = PI - end_angle * DEG_TO_RAD;
+                __arc(mirrored ? -x0 : x0, y0, radius, start, sweep * DEG_TO_RAD);
+                batch->stats.arcs++;
+                break;
+            }
+            case Kind::Polyline: {
+                const size_t count = vertex_x.size();
+                const bool closed = (flags & 1) != 0;
+                const double sign = mirrored ? -1.0 : 1.0;
+                const size_t segments = closed ? count : (count > 0 ? count - 1 : 0);
+                for (size_t i = 0; i < segments && count > 1; i++) {
+                    size_t j = (i + 1) % count;
+                    __segment(sign * vertex_x[i], vertex_y[i], sign * vertex_x[j], vertex_y[j], sign * vertex_bulge[i]);
+                }
+                batch->stats.polylines++;
+                break;
+            }
+            case Kind::None:
+                break;
+        }
+        kind = Kind::None;
+    }
+
+public:
+    explicit EntityBuilder(DxfBatch* batch) : batch(batch) {}
+
+    /**
+     * @brief Finishes the current entity and starts a new one
+     * @return bool False at the end of the section
+     */
+    bool Begin(const char* name, size_t length) {
+        __flush();
+        auto is = [&](const char* literal) {
+            return std::strlen(literal) == length && std::memcmp(name, literal, length) == 0;
+        };
+        if (is("ENDSEC") || is("EOF")) return false;
+
+        x0 = y0 = x1 = y1 = radius = start_angle = end_angle = 0.0;
+        extrusion_z = 1.0;
+        flags = 0;
+        if (is("LINE")) kind = Kind::Line;
+        else if (is("CIRCLE")) kind = Kind::Circle;
+        else if (is("ARC")) kind = Kind::Arc;
+        else if (is("LWPOLYLINE")) {
+            kind = Kind::Polyline;
+            vertex_x.clear();
+            vertex_y.clear();
+            vertex_bulge.clear();
+        } else {
+            kind = Kind::None;
+            batch->stats.skipped++;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Checks whether the current entity uses a group code
+     */
+    bool Wants(int code) const {
+        switch (kind) {
+            case Kind::Line: return code == 10 || code == 20 || code == 11 || code == 21;
+            case Kind::Circle: return code == 10 || code == 20 || code == 40 || code == 230;
+            case Kind::Arc: return code == 10 || code == 20 || code == 40 || code == 50 || code == 51 || code == 230;
+            case Kind::Polyline: return code == 10 || code == 20 || code == 42 || code == 70 || code == 230;
+            case Kind::None: return false;
+        }
+        return false;
+    }
+
+    /**
+     * @brief Stores a numeric group value
+     */
+    nil Value(int code, double value) {
+        if (kind == Kind::Polyline) {
+            switch (code) {
+                case 10:
+                    vertex_x.push_back(value);
+                    vertex_y.push_back(0.0);
+                    vertex_bulge.push_back(0.0);
+                    break;
+                case 20: if (!vertex_y.empty()) vertex_y.back() = value; break;
+                case 42: if (!vertex_bulge.empty()) vertex_bulge.back() = value; break;
+                case 70: flags = static_cast<int>(value); break;
+                case 230: extrusion_z = value; break;
+                default: break;
+            }
+            return;
+        }
+        switch (code) {
+            case 10: x0 = value; break;
+            case 20: y0 = value; break;
+            case 11: x1 = value; break;
+            case 21: y1 = value; break;
+            case 40: radius = value; break;
+            case 50: start_angle = value; break;
+            case 51: end_angle = value; break;
+            case 230: extrusion_z = value; break;
+            default: break;
+        }
+    }
+
+    /**
+     * @brief Emits the pending entity
+     */
+    nil Finish() { __flush(); }
+};
+
+/**
+ * @brief Parses ASCII groups from begin until an entity starts at or after stop
+ */
+nil __parse_ascii_range(const char* begin, const char* stop, const char* limit, DxfBatch& batch) {
+    EntityBuilder builder(&batch);
+    const char* cursor = begin;
+    TextLine code_line, value_line;
+    while (true) {
+        const char* code_start = cursor;
+        if (!__next_line(cursor, limit, code_line) || !__next_line(cursor, limit, value_line)) break;
+        int code = 0;
+        if (!__parse_int(code_line, code)) break;  // desynchronized, give up on this chunk
+        if (code == 0) {
+            if (code_start >= stop) break;
+            if (!builder.Begin(value_line.begin, static_cast<size_t>(value_line.end - value_line.begin))) break;
+        } else if (builder.Wants(code)) {
+            builder.Value(code, __parse_double(value_line.begin, value_line.end));
+        }
+    }
+    builder.Finish();
+}
+
+/**
+ * @brief Value encodings of binary DXF groups
+ */
+enum class BinaryValue { String, Double, Int16, Int32, Int64, Bool, Chunk, Unknown };
+
+BinaryValue __binary_value_type(int code) {
+    if (code >= 0 && code <= 9) return BinaryValue::String;
+    if (code >= 10 && code <= 59) return BinaryValue::Double;
+    if (code >= 60 && code <= 79) return BinaryValue::Int16;
+    if (code >= 90 && code <= 99) return BinaryValue::Int32;
+    if (code == 100 || code == 102 || code == 105) return BinaryValue::String;
+    if (code >= 110 && code <= 149) return BinaryValue::Double;
+    if (code >= 160 && code <= 169) return BinaryValue::Int64;
+    if (code >= 170 && code <= 179) return BinaryValue::Int16;
+    if (code >= 210 && code <= 239) return BinaryValue::Double;
+    if (code >= 270 && code <= 289) return BinaryValue::Int16;
+    if (code >= 290 && code <= 299) return BinaryValue::Bool;
+    if (code >= 300 && code <= 309) return BinaryValue::String;
+    if (code >= 310 && code <= 319) return BinaryValue::Chunk;
+    if (code >= 320 && code <= 369) return BinaryValue::String;
+    if (code >= 370 && code <= 389) return BinaryValue::Int16;
+    if (code >= 390 && code <= 399) return BinaryValue::String;
+    if (code >= 400 && code <= 409) return BinaryValue::Int16;
+    if (code >= 410 && code <= 419) return BinaryValue::String;
+    if (code >= 420 && code <= 429) return BinaryValue::Int32;
+    if (code >= 430 && code <= 439) return BinaryValue::String;
+    if (code >= 440 && code <= 459) return BinaryValue::Int32;
+    if (code >= 460 && code <= 469) return BinaryValue::Double;
+    if (code >= 470 && code <= 481) return BinaryValue::String;
+    if (code == 999) return BinaryValue::String;
+    if (code >= 1000 && code <= 1003) return BinaryValue::String;
+    if (code == 1004) return BinaryValue::Chunk;
+    if (code >= 1005 && code <= 1009) return BinaryValue::String;
+    if (code >= 1010 && code <= 1059) return BinaryValue::Double;
+    if (code >= 1060 && code <= 1070) return BinaryValue::Int16;
+    if (code == 1071) return BinaryValue::Int32;
+    return BinaryValue::Unknown;
+}
+
+/**
+ * @brief Sequential reader of binary DXF groups
+ */
+struct BinaryReader {
+    const uint8_t* p;
+    const uint8_t* end;
+    bool wide_codes;  ///< R13+ files use 2-byte group codes, R12 uses 1 byte with a 255 escape
+
+    bool Code(int& code) {
+        if (wide_codes) {
+            if (end - p < 2) return false;
+            code = static_cast<int>(static_cast<uint16_t>(p[0] | (p[1] << 8)));
+            p += 2;
+            return true;
+        }
+        if (p >= end) return false;
+        code = *p++;
+        if (code == 255) {
+            if (end - p < 2) return false;
+            code = static_cast<int>(static_cast<uint16_t>(p[0] | (p[1] << 8)));
+            p += 2;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Reads the value of a group
+     * @return bool False on truncated or unknown data
+     */
+    bool Value(int code, const char*& text, size_t& length, double& number) {
+        text = nullptr;
+        length = 0;
+        number = 0.0;
+        switch (__binary_value_type(code)) {
+            case BinaryValue::String: {
+                const uint8_t* zero = static_cast<const uint8_t*>(std::memchr(p, 0, static_cast<size_t>(end - p)));
+                if (!zero) return false;
+                text = reinterpret_cast<const char*>(p);
+                length = static_cast<size_t>(zero - p);
+                p = zero + 1;
+                return true;
+            }
+            case BinaryValue::Double: {
+                if (end - p < 8) return false;
+                std::memcpy(&number, p, 8);
+                p += 8;
+                return true;
+            }
+            case BinaryValue::Int16: {
+                if (end - p < 2) return false;
+                int16_t value;
+                std::memcpy(&value, p, 2);
+                number = value;
+                p += 2;
+                return true;
+            }
+            case BinaryValue::Int32: {
+                if (end - p < 4) return false;
+                int32_t value;
+                std::memcpy(&value, p, 4);
+                number = value;
+                p += 4;
+                return true;
+            }
+            case BinaryValue::Int64: {
+                if (end - p < 8) return false;
+                p += 8;
+                return true;
+            }
+            case BinaryValue::Bool: {
+                if (end - p < 1) return false;
+                number = *p++;
+                return true;
+            }
+            case BinaryValue::Chunk: {
+                if (end - p < 1) return false;
+                size_t size = *p++;
+                if (static_cast<size_t>(end - p) < size) return false;
+                p += size;
+                return true;
+            }
+            case BinaryValue::Unknown:
+                break;
+        }
+        return false;
+    }
+};
+
+} // namespace
+
+/**
+ * @brief Binary parsing state kept between batch jobs
+ */
+struct DxfImporter::BinaryParse {
+    BinaryReader reader;
+    DxfBatch batch;
+    EntityBuilder builder{&batch};  ///< An entity begun in one job is emitted by the next
+    size_t sequence = 0;
+    bool in_section = false;
+    bool in_entities = false;
+
+    explicit BinaryParse(const BinaryReader& reader) : reader(reader) {}
+};
+
+DxfImporter::DxfImporter() = default;
+
+DxfImporter::~DxfImporter() {
+    Cancel();
+}
+
+bool DxfImporter::Start(const std::string& path, std::string& error_message, unsigned thread_count) {
+    Cancel();
+    finished_batches.clear();
+    chunk_starts.clear();
+    next_sequence = 0;
+    next_chunk = 0;
+    batch_total = 0;
+    bytes_parsed = 0;
+    binary.reset();
+    cancel_requested = false;
+    origin_chosen = false;
+    stats = DxfImportStats();
+    error.clear();
+
+    if (!file.Open(path)) {
+        error_message = "Cannot open " + path;
+        return false;
+    }
+
+    const char* base = reinterpret_cast<const char*>(file.GetData());
+    const size_t size = file.GetSize();
+
+    if (size >= BINARY_SENTINEL_SIZE && std::memcmp(base, BINARY_SENTINEL, BINARY_SENTINEL_SIZE) == 0) {
+        const uint8_t* data = file.GetData();
+        BinaryReader reader{data + BINARY_SENTINEL_SIZE, data + size, false};
+        // R13+: code 0 is written as two zero bytes before "SECTION"
+        reader.wide_codes = size > BINARY_SENTINEL_SIZE + 2 &&
+                            reader.p[0] == 0 && reader.p[1] == 0 && reader.p[2] == 'S';
+        binary.reset(new BinaryParse(reader));
+        bytes_total = size;
+        file.AdviseSequential();
+        running = true;
+        __submit([this] { __parse_binary_batch(); });
+        return true;
+    }
+
+    const char* begin = nullptr;
+    const char* end = nullptr;
+    if (!__find_ascii_entities(base, size, begin, end)) {
+        file.Close();
+        error_message = "No ENTITIES section in " + path;
+        return false;
+    }
+
+    // Режем секцию на куски по границам сущностей
+    bytes_total = static_cast<size_t>(end - begin);
+    size_t chunk_count = std::max<size_t>(1, bytes_total / ASCII_CHUNK_SIZE);
+    chunk_starts.push_back(static_cast<size_t>(begin - base));
+    for (size_t i = 1; i < chunk_count; i++) {
+        const char* split = __next_entity(base, begin + i * (bytes_total / chunk_count), end);
+        chunk_starts.push_back(static_cast<size_t>(split - base));
+    }
+    chunk_starts.push_back(static_cast<size_t>(end - base));
+    batch_total = chunk_count;
+
+    // Один воркер остается кадру: цепочки импорта его не занимают
+    const size_t workers = JobSystem::Instance().GetWorkerCount();
+    size_t lanes = thread_count > 0 ? thread_count : std::max<size_t>(1, workers > 0 ? workers - 1 : 0);
+    lanes = std::min(lanes, chunk_count);
+
+    running = true;
+    for (size_t i = 0; i < lanes; i++) {
+        const size_t chunk = next_chunk++;
+        __submit([this, chunk] { __parse_chunk(chunk); });
+    }
+    return true;
+}
+
+size_t DxfImporter::Poll(Scene& scene) {
+    if (!running) return 0;
+
+    size_t added = 0;
+    while (true) {
+        DxfBatch batch;
+        {
+            std::lock_guard<std::mutex> lock(batches_mutex);
+            auto it = finished_batches.find(next_sequence);
+            if (it == finished_batches.end()) break;
+            batch = std::move(it->second);
+            finished_batches.erase(it);
+        }
+        next_sequence++;
+        added += batch.lines.size() + batch.arcs.size();
+        stats.Merge(batch.stats);
+        if (batch.has_origin) {
+            // Пустая сцена принимает начало координат файла, иначе файл ложится в ее систему
+            if (!origin_chosen && scene.GetPrimitiveCount() == 0) scene.SetOrigin(batch.origin);
+            origin_chosen = true;
+            __rebase(batch, batch.origin - scene.GetOrigin());
+        }
+        scene.AppendAll(std::move(batch.lines), std::move(batch.arcs));
+    }
+
+    // Батчи и следующие задачи публикуются до того, как задача завершится
+    if (!__jobs_pending() && next_sequence >= batch_total) {
+        __join();
+        file.Close();
+        running = false;
+    }
+    return added;
+}
+
+nil DxfImporter::Cancel() {
+    cancel_requested = true;
+    __join();
+    {
+        std::lock_guard<std::mutex> lock(batches_mutex);
+        finished_batches.clear();
+    }
+    file.Close();
+    running = false;
+}
+
+float DxfImporter::GetProgress() const {
+    if (!running) return 1.0f;
+    if (bytes_total == 0) return 0.0f;
+    return std::min(1.0f, static_cast<float>(static_cast<double>(bytes_parsed) / static_cast<double>(bytes_total)));
+}
+
+bool DxfImporter::Import(const std::string& path, Scene& scene, std::string& error_message) {
+    DxfImporter importer;
+    if (!importer.Start(path, error_message)) return false;
+    while (importer.IsRunning()) {
+        if (importer.Poll(scene) == 0) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    if (!importer.GetError().empty()) {
+        error_message = importer.GetError();
+        return false;
+    }
+    return true;
+}
+
+nil DxfImporter::__parse_chunk(size_t chunk) {
+    if (cancel_requested) return;
+
+    const char* base = reinterpret_cast<const char*>(file.GetData());
+    const char* limit = base + chunk_starts.back();
+    const char* begin = base + chunk_starts[chunk];
+    const char* stop = base + chunk_starts[chunk + 1];
+    DxfBatch batch;
+    if (begin < stop) __parse_ascii_range(begin, stop, limit, batch);
+    __publish(chunk, std::move(batch));
+    bytes_parsed += static_cast<size_t>(stop - begin);
+
+    if (cancel_requested) return;
+    const size_t next = next_chunk++;
+    if (next < chunk_starts.size() - 1) __submit([this, next] { __parse_chunk(next); });
+}
+
+nil DxfImporter::__parse_binary_batch() {
+    if (cancel_requested) return;
+
+    BinaryParse& state = *binary;
+    BinaryReader& reader = state.reader;
+    const uint8_t* base = file.GetData();
+    size_t entities_in_batch = 0;
+    bool finished = false;
+    std::string failure;
+
+    int code = 0;
+    const char* text = nullptr;
+    size_t length = 0;
+    double number = 0.0;
+    while (!finished) {
+        if (!reader.Code(code)) break;
+        if (!reader.Value(code, text, length, number)) {
+            failure = "Malformed binary DXF near offset " + std::to_string(reader.p - base);
+            break;
+        }
+
+        if (!state.in_entities) {
+            // Ищем "0 SECTION / 2 ENTITIES"
+            if (code == 0) state.in_section = length == 7 && std::memcmp(text, "SECTION", 7) == 0;
+            else if (code == 2 && state.in_section) state.in_entities = length == 8 && std::memcmp(text, "ENTITIES", 8) == 0;
+            continue;
+        }
+
+        if (code == 0) {
+            if (!state.builder.Begin(text, length)) finished = true;
+            if (++entities_in_batch >= BINARY_BATCH_ENTITIES && !finished) {
+                // The entity just begun is emitted on its flush, into the fresh batch
+                __publish(state.sequence++, std::move(state.batch));
+                state.batch = DxfBatch();
+                bytes_parsed = static_cast<size_t>(reader.p - base);
+                if (!cancel_requested) __submit([this] { __parse_binary_batch(); });
+                return;
+            }
+        } else if (state.builder.Wants(code)) {
+            state.builder.Value(code, number);
+        }
+    }
+    state.builder.Finish();
+
+    if (!state.in_entities && failure.empty()) failure = "No ENTITIES section in binary DXF";
+    if (!failure.empty()) {
+        std::lock_guard<std::mutex> lock(batches_mutex);
+        error = failure;
+    }
+    __publish(state.sequence++, std::move(state.batch));
+    bytes_parsed = bytes_total;
+    batch_total = state.sequence;
+}
+
+nil DxfImporter::__publish(size_t sequence, DxfBatch&& batch) {
+    std::lock_guard<std::mutex> lock(batches_mutex);
+    finished_batches.emplace(sequence, std::move(batch));
+}
+
+nil DxfImporter::__submit(std::function<nil()> function) {
+    JobHandle job = JobSystem::Instance().Submit(std::move(function));
+    std::lock_guard<std::mutex> lock(jobs_mutex);
+    jobs.erase(std::remove_if(jobs.begin(), jobs.end(), [](const JobHandle& done) { return done->IsFinished(); }), jobs.end());
+    jobs.push_back(std::move(job));
+}
+
+bool DxfImporter::__jobs_pending() {
+    std::lock_guard<std::mutex> lock(jobs_mutex);
+    jobs.erase(std::remove_if(jobs.begin(), jobs.end(), [](const JobHandle& done) { return done->IsFinished(); }), jobs.end());
+    return !jobs.empty();
+}
+
+nil DxfImporter::__join() {
+    // Задача ставит следующую до своего завершения, поэтому пустой список значит конец
+    while (true) {
+        std::vector<JobHandle> pending;
+        {
+            std::lock_guard<std::mutex> lock(jobs_mutex);
+            pending.swap(jobs);
+        }
+        if (pending.empty()) break;
+        for (const JobHandle& job : pending) {
+            JobSystem::Instance().Wait(job);
+        }
+    }
+}
+
+} // namespace MentalEngine
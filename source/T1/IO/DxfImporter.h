@@ -0,0 +1,209 @@
+/**
+ * @file DxfImporter.h
+ * @brief Streaming DXF importer for MentalEngine
+ * @author MentalEngine Team
+ * @version 1.0.0
+ * @date 2024
+ *
+ * This file defines the DxfImporter class, which reads ASCII and binary DXF
+ * drawings into a Scene. Parsing runs on worker threads while the UI keeps
+ * drawing; finished batches are handed to the scene from the main thread.
+ */
+
+#ifndef MENTAL_DXF_IMPORTER_H
+#define MENTAL_DXF_IMPORTER_H
+
+#include "../../Core/Types.h"
+#include "../../Core/MappedFile.h"
+#include "../../Core/JobSystem.h"
+#include "../Scene/Scene.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace MentalEngine {
+
+/**
+ * @struct DxfImportStats
+ * @brief Entity counters collected during an import
+ */
+struct DxfImportStats {
+    size_t lines = 0;        ///< LINE entities
+    size_t polylines = 0;    ///< LWPOLYLINE entities
+    size_t circles = 0;      ///< CIRCLE entities
+    size_t arcs = 0;         ///< ARC entities
+    size_t skipped = 0;      ///< Entities of unsupported types
+
+    /**
+     * @brief Adds another set of counters
+     * @param other Counters to add
+     */
+    nil Merge(const DxfImportStats& other) {
+        lines += other.lines;
+        polylines += other.polylines;
+        circles += other.circles;
+        arcs += other.arcs;
+        skipped += other.skipped;
+    }
+};
+
+/**
+ * @struct DxfBatch
+ * @brief Geometry produced by one unit of parsing work
+ */
+struct DxfBatch {
+    LineStorage lines;        ///< Parsed line segments (polylines included), relative to origin
+    ArcStorage arcs;          ///< Parsed arcs and circles, relative to origin
+    DxfImportStats stats;     ///< Entity counters for this batch
+    Math::Vector2d origin;    ///< File coordinates of the batch's (0, 0)
+    bool has_origin = false;  ///< Origin was taken from the batch's first point
+};
+
+/**
+ * @class DxfImporter
+ * @brief Background DXF reader that streams geometry into a Scene
+ *
+ * The file is memory-mapped. For ASCII files the ENTITIES section is cut into
+ * chunks at entity boundaries and the chunks are parsed in parallel; binary
+ * files cannot be split without a sequential scan, so they are parsed in
+ * order, one batch of a few thousand entities per job.
+ *
+ * Supported entities: LINE, LWPOLYLINE (including bulges), CIRCLE, ARC.
+ * Mirrored object coordinate systems (extrusion Z = -1) are handled; other
+ * extrusions are imported as if they were the default.
+ *
+ * Usage: Start() once, then call Poll() every frame until IsRunning() turns
+ * false. Batches are appended in file order.
+ *
+ * File coordinates are read as doubles and stored relative to a per-batch
+ * origin, so survey coordinates keep their precision. When the import goes
+ * into an empty scene, the first batch's origin becomes the scene origin.
+ *
+ * Parsing runs on JobSystem::Instance(), so the import shares the engine's
+ * worker threads instead of starting its own. Every job parses one chunk or
+ * one binary batch and queues the next one when it finishes, and fewer
+ * chains run than there are workers, so frame work always finds a free
+ * thread and never waits behind a whole import.
+ *
+ * @note This class is non-copyable; the destructor cancels and waits for its jobs
+ */
+class DxfImporter {
+private:
+    struct BinaryParse;
+
+    MappedFile file;                                  ///< Mapped source file
+    std::mutex jobs_mutex;                            ///< Guards jobs
+    std::vector<JobHandle> jobs;                      ///< Queued or running parsing jobs on the shared JobSystem
+    std::vector<size_t> chunk_starts;                 ///< ASCII chunk boundaries (entity starts), plus end
+    std::unique_ptr<BinaryParse> binary;              ///< Binary reader state carried from one job to the next
+
+    std::mutex batches_mutex;                         ///< Guards finished_batches
+    std::map<size_t, DxfBatch> finished_batches;      ///< Parsed batches keyed by sequence number
+    size_t next_sequence = 0;                         ///< Next batch Poll() will append
+    std::atomic<size_t> next_chunk{0};                ///< Next ASCII chunk to claim
+    std::atomic<size_t> batch_total{0};               ///< Total batches, known once parsing ends
+    std::atomic<size_t> bytes_parsed{0};              ///< Bytes of the entities section processed
+    std::atomic<bool> cancel_requested{false};        ///< Asks jobs to stop early
+    size_t bytes_total = 0;                           ///< Size of the entities section
+
+    bool running = false;                             ///< Between Start() and the last Poll()
+    bool origin_chosen = false;                       ///< Scene origin was considered for this import
+    DxfImportStats stats;                             ///< Counters of appended batches
+    std::string error;                                ///< Error reported by a parsing job
+
+    /**
+     * @brief Parses one ASCII chunk and queues the next unclaimed one
+     * @private
+     */
+    nil __parse_chunk(size_t chunk);
+
+    /**
+     * @brief Parses one binary batch and queues the next one
+     * @private
+     */
+    nil __parse_binary_batch();
+
+    /**
+     * @brief Queues a parsing job
+     * @private
+     */
+    nil __submit(std::function<nil()> function);
+
+    /**
+     * @brief Checks whether parsing jobs are queued or running
+     * @private
+     */
+    bool __jobs_pending();
+
+    /**
+     * @brief Hands a finished batch to Poll()
+     * @private
+     */
+    nil __publish(size_t sequence, DxfBatch&& batch);
+
+    /**
+     * @brief Waits for the parsing jobs
+     * @private
+     */
+    nil __join();
+
+public:
+    static constexpr size_t ASCII_CHUNK_SIZE = 4 * 1024 * 1024;  ///< Target bytes per ASCII chunk
+    static constexpr size_t BINARY_BATCH_ENTITIES = 65536;      ///< Entities per binary batch
+
+    DxfImporter();
+    ~DxfImporter();
+    DxfImporter(const DxfImporter&) = delete;
+    DxfImporter& operator=(const DxfImporter&) = delete;
+
+    /**
+     * @brief Maps a DXF file and starts parsing it in the background
+     * @param path File path
+     * @param error_message Receives a message on failure
+     * @param thread_count Parallel jobs for ASCII files; 0 leaves one JobSystem worker free
+     * @return bool False if the file cannot be read or has no ENTITIES section
+     */
+    bool Start(const std::string& path, std::string& error_message, unsigned thread_count = 0);
+
+    /**
+     * @brief Appends batches that are ready, in file order
+     * @param scene Scene receiving the geometry
+     * @return size_t Number of primitives appended by this call
+     */
+    size_t Poll(Scene& scene);
+
+    /**
+     * @brief Stops the import; batches not yet appended are discarded
+     */
+    nil Cancel();
+
+    bool IsRunning() const { return running; }
+    const DxfImportStats& GetStats() const { return stats; }
+    const std::string& GetError() const { return error; }
+
+    /**
+     * @brief Gets the fraction of the entities section parsed so far
+     * @return float Progress in [0, 1]
+     */
+    float GetProgress() const;
+
+    /**
+     * @brief Imports a file synchronously
+     * @param path File path
+     * @param scene Scene receiving the geometry
+     * @param error_message Receives a message on failure
+     * @return bool True on success
+     */
+    static bool Import(const std::string& path, Scene& scene, std::string& error_message);
+};
+
+} // namespace MentalEngine
+
+#endif // MENTAL_DXF_IMPORTER_H
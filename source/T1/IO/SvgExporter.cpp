@@ -0,0 +1,157 @@
+/**
+ * @file SvgExporter.cpp
+ * @brief Implementation of the SvgExporter class
+ * @author MentalEngine Team
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#include "SvgExporter.h"
+#include "../../Core/BufferedWriter.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace MentalEngine {
+
+namespace {
+
+const float PI = 3.14159265358979323846f;
+const float TWO_PI = 2.0f * PI;
+
+/**
+ * @brief Writes "x y" in world coordinates with Y flipped into SVG orientation
+ *
+ * Scene geometry is stored in float relative to the scene origin; the origin
+ * is added in double so far-from-zero drawings keep their precision.
+ */
+nil __write_point(BufferedWriter& out, const Math::Vector2d& origin, float x, float y) {
+    out.WriteDouble(origin.x + static_cast<double>(x));
+    out.Write(" ", 1);
+    out.WriteDouble(-(origin.y + static_cast<double>(y)));
+}
+
+/**
+ * @brief Computes the bounding box of the whole scene
+ */
+Bounds2D __scene_bounds(const Scene& scene) {
+    const LineStorage& lines = scene.GetLines();
+    const ArcStorage& arcs = scene.GetArcs();
+    const float inf = std::numeric_limits<float>::max();
+    Bounds2D bounds(inf, inf, -inf, -inf);
+
+    for (size_t i = 0; i < lines.size(); i++) {
+        bounds.min_x = std::min(bounds.min_x, std::min(lines.x0[i], lines.x1[i]));
+        bounds.min_y = std::min(bounds.min_y, std::min(lines.y0[i], lines.y1[i]));
+        bounds.max_x = std::max(bounds.max_x, std::max(lines.x0[i], lines.x1[i]));
+        bounds.max_y = std::max(bounds.max_y, std::max(lines.y0[i], lines.y1[i]));
+    }
+    for (size_t i = 0; i < arcs.size(); i++) {
+        bounds.min_x = std::min(bounds.min_x, arcs.cx[i] - arcs.radius[i]);
+        bounds.min_y = std::min(bounds.min_y, arcs.cy[i] - arcs.radius[i]);
+        bounds.max_x = std::max(bounds.max_x, arcs.cx[i] + arcs.radius[i]);
+        bounds.max_y = std::max(bounds.max_y, arcs.cy[i] + arcs.radius[i]);
+    }
+    if (bounds.min_x > bounds.max_x) bounds = Bounds2D(0.0f, 0.0f, 1.0f, 1.0f);
+    return bounds;
+}
+
+} // namespace
+
+bool SvgExporter::Export(const Scene& scene, const std::string& path, std::string& error,
+                         const SvgExportOptions& options) {
+    BufferedWriter out;
+    if (!out.Open(path)) {
+        error = "Cannot create " + path;
+        return false;
+    }
+
+    const Bounds2D bounds = __scene_bounds(scene);
+    const float size = std::max(std::max(bounds.max_x - bounds.min_x, bounds.max_y - bounds.min_y), 1e-6f);
+    const float margin = size * options.margin;
+    const float stroke_width = options.stroke_width > 0.0f ? options.stroke_width : size * 0.001f;
+    const size_t per_path = std::max<size_t>(1, options.elements_per_path);
+    const Math::Vector2d origin = scene.GetOrigin();
+
+    // Заголовок документа; viewBox уже в перевернутой по Y системе
+    out.Write("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n");
+    out.Write("<svg xmlns=\"http://www.w3.org/2000/svg\" viewBox=\"");
+    out.WriteDouble(origin.x + static_cast<double>(bounds.min_x - margin));
+    out.Write(" ");
+    out.WriteDouble(-(origin.y + static_cast<double>(bounds.max_y)) - margin);
+    out.Write(" ");
+    out.WriteFloat(bounds.max_x - bounds.min_x + 2.0f * margin);
+    out.Write(" ");
+    out.WriteFloat(bounds.max_y - bounds.min_y + 2.0f * margin);
+    out.Write("\">\n<g fill=\"none\" stroke=\"");
+    out.Write(options.stroke.c_str());
+    out.Write("\" stroke-width=\"");
+    out.WriteFloat(stroke_width);
+    out.Write("\" stroke-linecap=\"round\">\n");
+
+    // Lines: consecutive segments sharing an endpoint continue the subpath
+    const LineStorage& lines = scene.GetLines();
+    for (size_t begin = 0; begin < lines.size(); begin += per_path) {
+        const size_t end = std::min(lines.size(), begin + per_path);
+        out.Write("<path d=\"");
+        for (size_t i = begin; i < end; i++) {
+            const bool continues = i > begin && lines.x0[i] == lines.x1[i - 1] && lines.y0[i] == lines.y1[i - 1];
+            if (!continues) {
+                out.Write("M", 1);
+                __write_point(out, origin, lines.x0[i], lines.y0[i]);
+            }
+            out.Write("L", 1);
+            __write_point(out, origin, lines.x1[i], lines.y1[i]);
+        }
+        out.Write("\"/>\n");
+    }
+
+    // Arcs: full circles become <circle>, the rest elliptical-arc commands
+    const ArcStorage& arcs = scene.GetArcs();
+    for (size_t begin = 0; begin < arcs.size(); begin += per_path) {
+        const size_t end = std::min(arcs.size(), begin + per_path);
+        bool path_open = false;
+        for (size_t i = begin; i < end; i++) {
+            const float cx = arcs.cx[i], cy = arcs.cy[i], r = arcs.radius[i];
+            if (arcs.sweep_angle[i] >= TWO_PI) {
+                if (path_open) {
+                    out.Write("\"/>\n");
+                    path_open = false;
+                }
+                out.Write("<circle cx=\"");
+                out.WriteDouble(origin.x + static_cast<double>(cx));
+                out.Write("\" cy=\"");
+                out.WriteDouble(-(origin.y + static_cast<double>(cy)));
+                out.Write("\" r=\"");
+                out.WriteFloat(r);
+                out.Write("\"/>\n");
+                continue;
+            }
+            if (!path_open) {
+                out.Write("<path d=\"");
+                path_open = true;
+            }
+            const float start = arcs.start_angle[i];
+            const float stop = start + arcs.sweep_angle[i];
+            out.Write("M", 1);
+            __write_point(out, origin, cx + r * std::cos(start), cy + r * std::sin(start));
+            out.Write("A", 1);
+            out.WriteFloat(r);
+            out.Write(" ", 1);
+            out.WriteFloat(r);
+            // Counter-clockwise in world space is sweep-flag 0 once Y is flipped
+            out.Write(arcs.sweep_angle[i] > PI ? " 0 1 0 " : " 0 0 0 ");
+            __write_point(out, origin, cx + r * std::cos(stop), cy + r * std::sin(stop));
+        }
+        if (path_open) out.Write("\"/>\n");
+    }
+
+    out.Write("</g>\n</svg>\n");
+    if (!out.Close()) {
+        error = "Failed to write " + path;
+        return false;
+    }
+    return true;
+}
+
+} // namespace MentalEngine
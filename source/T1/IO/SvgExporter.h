@@ -0,0 +1,59 @@
+/**
+ * @file SvgExporter.h
+ * @brief Streaming SVG export for MentalEngine
+ * @author MentalEngine Team
+ * @version 1.0.0
+ * @date 2024
+ *
+ * This file defines the SvgExporter class, which writes scene geometry as SVG
+ * directly from the scene's column storage.
+ */
+
+#ifndef MENTAL_SVG_EXPORTER_H
+#define MENTAL_SVG_EXPORTER_H
+
+#include "../../Core/Types.h"
+#include "../Scene/Scene.h"
+#include <cstddef>
+#include <string>
+
+namespace MentalEngine {
+
+/**
+ * @struct SvgExportOptions
+ * @brief Appearance and batching settings for SVG export
+ */
+struct SvgExportOptions {
+    std::string stroke = "#000000";   ///< Stroke color
+    float stroke_width = 0.0f;        ///< Stroke width in world units; 0 picks 1/1000 of the drawing size
+    float margin = 0.02f;             ///< Margin around the drawing as a fraction of its size
+    size_t elements_per_path = 4096;  ///< Primitives merged into one <path> element
+};
+
+/**
+ * @class SvgExporter
+ * @brief Writes a scene as SVG without building a document in memory
+ *
+ * Geometry is read straight from the scene's arrays in chunks; every chunk
+ * becomes one <path> element written through a BufferedWriter, so memory use
+ * is constant in the size of the drawing. Coordinates are written in world
+ * space: the scene origin is added in double precision. World Y points up and
+ * SVG Y points down, so Y is negated on output.
+ */
+class SvgExporter {
+public:
+    /**
+     * @brief Exports a scene
+     * @param scene Scene to export
+     * @param path Destination path
+     * @param error Receives a message on failure
+     * @param options Appearance and batching settings
+     * @return bool True on success
+     */
+    static bool Export(const Scene& scene, const std::string& path, std::string& error,
+                       const SvgExportOptions& options = SvgExportOptions());
+};
+
+} // namespace MentalEngine
+
+#endif // MENTAL_SVG_EXPORTER_H
@@ -0,0 +1,133 @@
+/**
+ * @file FramePacket.cpp
+ * @brief Implementation of the frame packet
+ * @author MentalEngine Team
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#include "FramePacket.h"
+#include "imgui_impl_opengl3.h"
+#include <cstring>
+#include <utility>
+
+namespace {
+
+/**
+ * @brief Copies an ImVector, reusing the destination's capacity
+ */
+template <typename V>
+nil CopyImVector(ImVector<V>& destination, const ImVector<V>& source) {
+    destination.resize(source.Size);
+    if (source.Size > 0) std::memcpy(destination.Data, source.Data, source.size_in_bytes());
+}
+
+} // namespace
+
+FramePacket& FramePacket::operator=(FramePacket&& other) noexcept {
+    if (this == &other) return *this;
+    passes.swap(other.passes);
+    pass_count = other.pass_count;
+    released_viewports = other.released_viewports;
+    batches.swap(other.batches);
+    batch_count = other.batch_count;
+    commands.swap(other.commands);
+    scene_geometry = other.scene_geometry;
+    scene_patches.swap(other.scene_patches);
+    command_scratch.swap(other.command_scratch);
+    tile_renders.swap(other.tile_renders);
+    tile_draws.swap(other.tile_draws);
+    arena = other.arena;
+    // Обмен, а не перенос: списки другой стороны переиспользуются или освобождаются ею
+    ui_lists.swap(other.ui_lists);
+    ui_list_count = other.ui_list_count;
+    ui_display_pos = other.ui_display_pos;
+    ui_display_size = other.ui_display_size;
+    ui_framebuffer_scale = other.ui_framebuffer_scale;
+    other.pass_count = 0;
+    other.released_viewports = 0;
+    other.batch_count = 0;
+    other.commands.clear();
+    other.scene_geometry = SceneGeometry();
+    other.scene_patches.clear();
+    other.tile_renders.clear();
+    other.tile_draws.clear();
+    other.ui_list_count = 0;
+    return *this;
+}
+
+nil FramePacket::Clear() {
+    pass_count = 0;
+    released_viewports = 0;
+    batch_count = 0;
+    commands.clear();
+    scene_geometry = SceneGeometry();
+    scene_patches.clear();
+    tile_renders.clear();
+    tile_draws.clear();
+    ui_list_count = 0;
+}
+
+LineBatch& FramePacket::NextBatch(size_t point_count) {
+    if (batch_count == batches.size()) batches.emplace_back();
+    LineBatch& batch = batches[batch_count++];
+    batch.points = arena->AllocateArray<MentalEngine::Math::Vector2>(point_count);
+    batch.count = point_count;
+    batch.content_hash = 0;
+    batch.resident = false;
+    return batch;
+}
+
+ViewportPass& FramePacket::NextPass() {
+    if (pass_count == passes.size()) passes.emplace_back();
+    ViewportPass& pass = passes[pass_count++];
+    pass.first_command = commands.size();
+    pass.command_count = 0;
+    pass.first_tile = tile_draws.size();
+    pass.tile_count = 0;
+    pass.redraw = true;
+    return pass;
+}
+
+nil FramePacket::CaptureDrawData(const ImDrawData* draw_data) {
+    ui_list_count = 0;
+    if (!draw_data) return;
+    ui_display_pos = draw_data->DisplayPos;
+    ui_display_size = draw_data->DisplaySize;
+    ui_framebuffer_scale = draw_data->FramebufferScale;
+    for (const ImDrawList* list : draw_data->CmdLists) {
+        if (ui_list_count == ui_lists.size()) {
+            ui_lists.push_back(IM_NEW(ImDrawList)(list->_Data));
+        }
+        ImDrawList* copy = ui_lists[ui_list_count++];
+        CopyImVector(copy->CmdBuffer, list->CmdBuffer);
+        CopyImVector(copy->IdxBuffer, list->IdxBuffer);
+        CopyImVector(copy->VtxBuffer, list->VtxBuffer);
+    }
+}
+
+nil FramePacket::RenderDrawData(ImDrawData& draw_data) {
+    if (ui_list_count == 0) return;
+    draw_data.Clear();
+    draw_data.Valid = true;
+    draw_data.DisplayPos = ui_display_pos;
+    draw_data.DisplaySize = ui_display_size;
+    draw_data.FramebufferScale = ui_framebuffer_scale;
+    for (size_t i = 0; i < ui_list_count; i++) {
+        draw_data.AddDrawList(ui_lists[i]);
+    }
+    ImGui_ImplOpenGL3_RenderDrawData(&draw_data);
+}
+
+nil FramePacket::GetFramebufferSize(int& width, int& height) const {
+    width = static_cast<int>(ui_display_size.x * ui_framebuffer_scale.x);
+    height = static_cast<int>(ui_display_size.y * ui_framebuffer_scale.y);
+}
+
+nil FramePacket::__release_ui() {
+    for (ImDrawList* list : ui_lists) {
+        IM_DELETE(list);
+    }
+    ui_lists.clear();
+    ui_list_count = 0;
+}
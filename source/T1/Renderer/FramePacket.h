@@ -0,0 +1,239 @@
+/**
+ * @file FramePacket.h
+ * @brief Self-contained description of one frame for MentalEngine
+ * @author MentalEngine Team
+ * @version 1.0.0
+ * @date 2024
+ *
+ * This file defines the FramePacket struct. The UI records a frame into a
+ * packet on the main thread; the renderer turns it into GL calls later,
+ * possibly on another thread, without touching any main-thread state.
+ */
+
+#ifndef MENTAL_FRAME_PACKET_H
+#define MENTAL_FRAME_PACKET_H
+
+#include "../../Core/Types.h"
+#include "../../Core/Math.h"
+#include "../../Core/FrameArena.h"
+#include "RenderCommand.h"
+#include "imgui.h"
+#include <cstdint>
+#include <vector>
+
+/**
+ * @struct LineBatch
+ * @brief Line segments drawn with one color and width
+ */
+struct LineBatch {
+    MentalEngine::Math::Vector2* points = nullptr;    ///< Start/end pairs in world units, in the packet's arena
+    size_t count = 0;                                 ///< Number of points
+    MentalEngine::Math::Vector3 color;                ///< Line color (RGB)
+    float width = 1.0f;                               ///< Line width in pixels
+    uint64_t content_hash = 0;                        ///< Identifies what the batch draws, for redraw checks
+    bool resident = false;                            ///< Drawn from the renderer's resident scene buffers; points unused
+};
+
+/**
+ * @struct SceneVertex
+ * @brief Vertex of resident scene geometry
+ */
+struct SceneVertex {
+    float x = 0.0f;  ///< Position relative to the scene origin
+    float y = 0.0f;
+};
+
+/**
+ * @struct SceneDrawCommand
+ * @brief Indexed draw of one object
+ *
+ * Same layout as OpenGL's DrawElementsIndirectCommand, so an array of
+ * these is the indirect buffer's contents.
+ */
+struct SceneDrawCommand {
+    uint32_t count = 0;           ///< Indices of the object
+    uint32_t instance_count = 1;  ///< Always 1
+    uint32_t first_index = 0;     ///< Offset in the index buffer
+    int32_t base_vertex = 0;      ///< Added to every index
+    uint32_t base_instance = 0;   ///< Unused
+};
+
+/**
+ * @struct SceneGeometry
+ * @brief Scene geometry to make resident on the GPU, tessellated while recording
+ *
+ * Objects are the scene's primitives: lines first, then arcs, in storage
+ * order. A line is two vertices; an arc is a strip of vertices indexed as
+ * segments, so neighbouring segments share their vertex.
+ */
+struct SceneGeometry {
+    SceneVertex* vertices = nullptr;         ///< In the packet's arena
+    size_t vertex_count = 0;
+    uint32_t* indices = nullptr;             ///< GL_LINES indices into vertices
+    size_t index_count = 0;
+    SceneDrawCommand* commands = nullptr;    ///< One per object
+    size_t object_count = 0;
+    uint64_t geometry_hash = 0;              ///< Scene and revision; 0 when the packet carries no upload
+};
+
+/**
+ * @struct SceneVertexPatch
+ * @brief Resident vertices of edited objects, rewritten in place
+ */
+struct SceneVertexPatch {
+    size_t first_vertex = 0;            ///< Offset in the resident vertex buffer
+    size_t vertex_count = 0;
+    SceneVertex* vertices = nullptr;    ///< In the packet's arena
+};
+
+/**
+ * @struct TileRender
+ * @brief Scene geometry rendered into a cached plan view tile
+ */
+struct TileRender {
+    uint32_t slot = 0;         ///< TileCache texture slot
+    float min_x = 0.0f;        ///< Tile area relative to the scene origin
+    float min_y = 0.0f;
+    float max_x = 0.0f;
+    float max_y = 0.0f;
+    size_t batch = 0;          ///< Index in FramePacket::batches of the lines overlapping the tile
+    bool smooth_lines = true;  ///< Lines get analytically anti-aliased edges
+};
+
+/**
+ * @struct TileDraw
+ * @brief A cached tile composited into a viewport pass
+ *
+ * The texture region may be a quarter (or smaller) of a coarser tile
+ * standing in while the tile of the pass's zoom level is not rendered yet.
+ */
+struct TileDraw {
+    uint32_t slot = 0;    ///< TileCache texture slot
+    uint64_t content_hash = 0;  ///< Changes when the tile is rendered again, for redraw checks
+    float min_x = 0.0f;   ///< Area covered, relative to the scene origin
+    float min_y = 0.0f;
+    float max_x = 0.0f;
+    float max_y = 0.0f;
+    float u0 = 0.0f;      ///< Texture region shown
+    float v0 = 0.0f;
+    float u1 = 1.0f;
+    float v1 = 1.0f;
+};
+
+/**
+ * @struct ViewportPass
+ * @brief One viewport drawn into its own render target
+ *
+ * Batches are referenced by index through the packet's commands, so
+ * geometry recorded once (the scene) can be drawn by several passes without
+ * being copied.
+ */
+struct ViewportPass {
+    size_t viewport = 0;                           ///< Renderer viewport the pass draws into
+    int width = 0;                                 ///< Drawn width in pixels, from the target's left edge
+    int height = 0;                                ///< Drawn height in pixels, from the target's bottom edge
+    int target_width = 0;                          ///< Allocated (bucketed) target width in pixels
+    int target_height = 0;                         ///< Allocated (bucketed) target height in pixels
+    MentalEngine::Math::Matrix4 view;              ///< Camera view matrix
+    MentalEngine::Math::Matrix4 projection;        ///< Camera projection matrix
+    bool show_grid = false;                        ///< Grid visibility
+    float grid_line_width = 1.0f;                  ///< Grid line thickness
+    float grid_color[3] = {1.0f, 1.0f, 1.0f};      ///< Grid line color (RGB)
+    int samples = 0;                               ///< MSAA samples per pixel; 0 or 1 draws straight into the target
+    bool smooth_lines = true;                      ///< Lines get analytically anti-aliased edges
+    size_t first_command = 0;                      ///< First of the pass's FramePacket::commands
+    size_t command_count = 0;                      ///< Commands of the pass; contiguous while recording and after sorting
+    size_t first_tile = 0;                         ///< First of the pass's FramePacket::tile_draws
+    size_t tile_count = 0;                         ///< Cached tiles composited under the pass's commands
+    bool redraw = true;                            ///< False when the target already shows this content
+};
+
+/**
+ * @struct FramePacket
+ * @brief Everything the GL side needs to draw one frame
+ *
+ * Camera matrices and grid settings of every viewport are copied in when
+ * the frame is recorded, and ImGui draw lists are copied, so the packet stays valid
+ * while the main thread builds the next frame. Line points live in a frame
+ * arena that must outlive the packet's execution (see Renderer's
+ * double-buffered packet arenas); batch and draw list objects are recycled
+ * by Clear(), so a steady-state frame records without heap allocations.
+ *
+ * @note Movable but not copyable; owns the cloned ImGui draw lists
+ */
+struct FramePacket {
+    // Viewport passes
+    std::vector<ViewportPass> passes;              ///< Viewports drawn this frame
+    size_t pass_count = 0;                         ///< Passes in use; the rest are recycled
+    uint32_t released_viewports = 0;               ///< Bit per viewport whose target storage can be freed
+    std::vector<LineBatch> batches;                ///< Geometry referenced by the passes
+    size_t batch_count = 0;                        ///< Batches in use; the rest are recycled
+    std::vector<RenderCommand> commands;           ///< Draws of all passes; sorted by key when recording ends
+    std::vector<RenderCommand> command_scratch;    ///< Radix sort buffer, kept for its capacity
+    SceneGeometry scene_geometry;                  ///< New resident scene geometry, uploaded before the passes
+    std::vector<SceneVertexPatch> scene_patches;   ///< Edits of the resident geometry, applied after scene_geometry
+    std::vector<TileRender> tile_renders;          ///< Plan view tiles to render before the passes
+    std::vector<TileDraw> tile_draws;              ///< Tiles composited by the passes
+    MentalEngine::FrameArena* arena = nullptr;     ///< Storage for batch points
+
+    // ImGui pass
+    std::vector<ImDrawList*> ui_lists;             ///< Copies of the main viewport's draw lists, owned
+    size_t ui_list_count = 0;                      ///< Lists in use; the rest are recycled
+    ImVec2 ui_display_pos;                         ///< ImDrawData::DisplayPos
+    ImVec2 ui_display_size;                        ///< ImDrawData::DisplaySize
+    ImVec2 ui_framebuffer_scale;                   ///< ImDrawData::FramebufferScale
+
+    FramePacket() = default;
+    ~FramePacket() { __release_ui(); }
+    FramePacket(FramePacket&& other) noexcept { *this = std::move(other); }
+    FramePacket& operator=(FramePacket&& other) noexcept;
+    FramePacket(const FramePacket&) = delete;
+    FramePacket& operator=(const FramePacket&) = delete;
+
+    /**
+     * @brief Resets the packet for recording, keeping allocations
+     */
+    nil Clear();
+
+    /**
+     * @brief Adds a batch with room for point_count points
+     * @param point_count Number of points the caller will write
+     * @return LineBatch& Batch whose points are uninitialized arena memory
+     */
+    LineBatch& NextBatch(size_t point_count);
+
+    /**
+     * @brief Adds a viewport pass
+     * @return ViewportPass& Pass with no commands, drawn unless redraw is cleared
+     */
+    ViewportPass& NextPass();
+
+    /**
+     * @brief Copies the ImGui draw data of the frame
+     * @param draw_data Result of ImGui::GetDrawData() after ImGui::Render()
+     */
+    nil CaptureDrawData(const ImDrawData* draw_data);
+
+    /**
+     * @brief Draws the captured ImGui lists with the OpenGL3 backend
+     * @param draw_data Scratch ImDrawData kept by the caller across frames
+     * @note Must run on the thread that owns the GL context
+     */
+    nil RenderDrawData(ImDrawData& draw_data);
+
+    /**
+     * @brief Gets the main framebuffer size the UI was laid out for
+     * @param width Receives the width in pixels
+     * @param height Receives the height in pixels
+     */
+    nil GetFramebufferSize(int& width, int& height) const;
+
+private:
+    /**
+     * @brief Frees the copied draw lists
+     * @private
+     */
+    nil __release_ui();
+};
+
+#endif // MENTAL_FRAME_PACKET_H
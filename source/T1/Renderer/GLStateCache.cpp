@@ -0,0 +1,143 @@
+/**
+ * @file GLStateCache.cpp
+ * @brief Implementation of the GL state cache
+ * @author MentalEngine Team
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#include "GLStateCache.h"
+
+namespace {
+
+const GLenum TRACKED_CAPABILITIES[] = {GL_BLEND, GL_DEPTH_TEST, GL_CULL_FACE, GL_SCISSOR_TEST};
+
+} // namespace
+
+int GLStateCache::__capability_index(GLenum capability) {
+    for (size_t i = 0; i < CAPABILITY_COUNT; i++) {
+        if (TRACKED_CAPABILITIES[i] == capability) return static_cast<int>(i);
+    }
+    return -1;
+}
+
+nil GLStateCache::Invalidate() {
+    program = UNKNOWN_NAME;
+    vertex_array = UNKNOWN_NAME;
+    array_buffer = UNKNOWN_NAME;
+    element_buffer = UNKNOWN_NAME;
+    indirect_buffer = UNKNOWN_NAME;
+    read_framebuffer = UNKNOWN_NAME;
+    draw_framebuffer = UNKNOWN_NAME;
+    texture_2d = UNKNOWN_NAME;
+    viewport[2] = -1;
+    viewport[3] = -1;
+    blend_source = 0;
+    blend_destination = 0;
+    blend_source_alpha = 0;
+    blend_destination_alpha = 0;
+    clear_color_known = false;
+    for (Toggle& toggle : capabilities) toggle = Toggle::Unknown;
+}
+
+nil GLStateCache::BeginFrame() {
+    Invalidate();
+    frame = GLStateStats();
+}
+
+nil GLStateCache::EndFrame() {
+    last_issued.store(frame.issued, std::memory_order_relaxed);
+    last_elided.store(frame.elided, std::memory_order_relaxed);
+    last_draws.store(frame.draws, std::memory_order_relaxed);
+}
+
+GLStateStats GLStateCache::GetLastFrameStats() const {
+    GLStateStats stats;
+    stats.issued = last_issued.load(std::memory_order_relaxed);
+    stats.elided = last_elided.load(std::memory_order_relaxed);
+    stats.draws = last_draws.load(std::memory_order_relaxed);
+    return stats;
+}
+
+nil GLStateCache::UseProgram(GLuint name) {
+    if (!__changes(program != name)) return;
+    program = name;
+    glUseProgram(name);
+}
+
+nil GLStateCache::BindVertexArray(GLuint name) {
+    if (!__changes(vertex_array != name)) return;
+    vertex_array = name;
+    // Привязка element buffer хранится в VAO
+    element_buffer = UNKNOWN_NAME;
+    glBindVertexArray(name);
+}
+
+nil GLStateCache::BindBuffer(GLenum target, GLuint name) {
+    GLuint* bound = nullptr;
+    switch (target) {
+        case GL_ARRAY_BUFFER: bound = &array_buffer; break;
+        case GL_ELEMENT_ARRAY_BUFFER: bound = &element_buffer; break;
+        case GL_DRAW_INDIRECT_BUFFER: bound = &indirect_buffer; break;
+        default: break;
+    }
+    if (!__changes(!bound || *bound != name)) return;
+    if (bound) *bound = name;
+    glBindBuffer(target, name);
+}
+
+nil GLStateCache::BindFramebuffer(GLenum target, GLuint name) {
+    const bool read = target == GL_FRAMEBUFFER || target == GL_READ_FRAMEBUFFER;
+    const bool draw = target == GL_FRAMEBUFFER || target == GL_DRAW_FRAMEBUFFER;
+    if (!__changes((read && read_framebuffer != name) || (draw && draw_framebuffer != name))) return;
+    if (read) read_framebuffer = name;
+    if (draw) draw_framebuffer = name;
+    glBindFramebuffer(target, name);
+}
+
+nil GLStateCache::BindTexture2D(GLuint name) {
+    if (!__changes(texture_2d != name)) return;
+    texture_2d = name;
+    glBindTexture(GL_TEXTURE_2D, name);
+}
+
+nil GLStateCache::Viewport(GLint x, GLint y, GLsizei width, GLsizei height) {
+    if (!__changes(viewport[0] != x || viewport[1] != y || viewport[2] != width || viewport[3] != height)) return;
+    viewport[0] = x;
+    viewport[1] = y;
+    viewport[2] = width;
+    viewport[3] = height;
+    glViewport(x, y, width, height);
+}
+
+nil GLStateCache::BlendFuncSeparate(GLenum source, GLenum destination, GLenum source_alpha, GLenum destination_alpha) {
+    if (!__changes(blend_source != source || blend_destination != destination ||
+                   blend_source_alpha != source_alpha || blend_destination_alpha != destination_alpha)) return;
+    blend_source = source;
+    blend_destination = destination;
+    blend_source_alpha = source_alpha;
+    blend_destination_alpha = destination_alpha;
+    glBlendFuncSeparate(source, destination, source_alpha, destination_alpha);
+}
+
+nil GLStateCache::ClearColor(GLfloat r, GLfloat g, GLfloat b, GLfloat a) {
+    if (!__changes(!clear_color_known || clear_color[0] != r || clear_color[1] != g || clear_color[2] != b || clear_color[3] != a)) return;
+    clear_color[0] = r;
+    clear_color[1] = g;
+    clear_color[2] = b;
+    clear_color[3] = a;
+    clear_color_known = true;
+    glClearColor(r, g, b, a);
+}
+
+nil GLStateCache::SetEnabled(GLenum capability, bool enabled) {
+    const int index = __capability_index(capability);
+    const Toggle wanted = enabled ? Toggle::On : Toggle::Off;
+    if (!__changes(index < 0 || capabilities[index] != wanted)) return;
+    if (index >= 0) capabilities[index] = wanted;
+    if (enabled) {
+        glEnable(capability);
+    } else {
+        glDisable(capability);
+    }
+}
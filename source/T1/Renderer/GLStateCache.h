@@ -0,0 +1,183 @@
+/**
+ * @file GLStateCache.h
+ * @brief Redundant OpenGL state change elimination for MentalEngine
+ * @author MentalEngine Team
+ * @version 1.0.0
+ * @date 2024
+ *
+ * This file defines the GLStateCache class, a thin layer over the GL calls
+ * the renderer uses for binding and fixed-function state. It remembers what
+ * is bound, skips calls that would not change anything, and counts issued
+ * and skipped calls per frame.
+ */
+
+#ifndef MENTAL_GL_STATE_CACHE_H
+#define MENTAL_GL_STATE_CACHE_H
+
+#define GL_SILENCE_DEPRECATION
+#include <GL/glew.h>
+#include "../../Core/Types.h"
+#include <atomic>
+#include <cstdint>
+
+/**
+ * @struct GLStateStats
+ * @brief GL call counters of one frame
+ */
+struct GLStateStats {
+    uint32_t issued = 0;   ///< State calls passed to the driver
+    uint32_t elided = 0;   ///< State calls skipped because nothing would change
+    uint32_t draws = 0;    ///< Draw calls
+};
+
+/**
+ * @class GLStateCache
+ * @brief Tracks bound objects and toggled capabilities of one GL context
+ *
+ * Every value starts out unknown, so the first call after Invalidate()
+ * always reaches the driver. Code that changes state behind the cache's
+ * back (ImGui's backend, RenderTargetPool) must be followed by
+ * Invalidate(). The element array binding belongs to the vertex array, so
+ * it becomes unknown whenever another vertex array is bound.
+ *
+ * @note GL thread only, except GetLastFrameStats()
+ */
+class GLStateCache {
+private:
+    static constexpr GLuint UNKNOWN_NAME = 0xFFFFFFFFu;  ///< Never a valid object name
+    static constexpr size_t CAPABILITY_COUNT = 4;        ///< Tracked glEnable() capabilities
+
+    /**
+     * @enum Toggle
+     * @brief Known state of a capability
+     */
+    enum class Toggle : int8_t {
+        Unknown = -1,
+        Off = 0,
+        On = 1
+    };
+
+    GLuint program = UNKNOWN_NAME;          ///< glUseProgram()
+    GLuint vertex_array = UNKNOWN_NAME;     ///< glBindVertexArray()
+    GLuint array_buffer = UNKNOWN_NAME;     ///< GL_ARRAY_BUFFER binding
+    GLuint element_buffer = UNKNOWN_NAME;   ///< GL_ELEMENT_ARRAY_BUFFER binding of the bound vertex array
+    GLuint indirect_buffer = UNKNOWN_NAME;  ///< GL_DRAW_INDIRECT_BUFFER binding
+    GLuint read_framebuffer = UNKNOWN_NAME; ///< GL_READ_FRAMEBUFFER binding
+    GLuint draw_framebuffer = UNKNOWN_NAME; ///< GL_DRAW_FRAMEBUFFER binding
+    GLuint texture_2d = UNKNOWN_NAME;       ///< GL_TEXTURE_2D binding of the active unit
+    GLint viewport[4] = {0, 0, -1, -1};     ///< glViewport(); negative size while unknown
+    GLenum blend_source = 0;                ///< Color source factor; 0 while unknown
+    GLenum blend_destination = 0;           ///< Color destination factor
+    GLenum blend_source_alpha = 0;          ///< Alpha source factor
+    GLenum blend_destination_alpha = 0;     ///< Alpha destination factor
+    GLfloat clear_color[4] = {0.0f, 0.0f, 0.0f, 0.0f};  ///< glClearColor()
+    bool clear_color_known = false;         ///< clear_color is valid
+    Toggle capabilities[CAPABILITY_COUNT];  ///< GL_BLEND, GL_DEPTH_TEST, GL_CULL_FACE, GL_SCISSOR_TEST
+
+    GLStateStats frame;                     ///< Counters of the frame in progress
+    std::atomic<uint32_t> last_issued{0};   ///< Counters of the last finished frame, read by other threads
+    std::atomic<uint32_t> last_elided{0};
+    std::atomic<uint32_t> last_draws{0};
+
+    /**
+     * @brief Counts a call and reports whether it must be issued
+     * @private
+     */
+    bool __changes(bool differs) {
+        if (differs) {
+            frame.issued++;
+        } else {
+            frame.elided++;
+        }
+        return differs;
+    }
+
+    /**
+     * @brief Maps a capability to its slot
+     * @private
+     */
+    static int __capability_index(GLenum capability);
+
+public:
+    GLStateCache() { Invalidate(); }
+    GLStateCache(const GLStateCache&) = delete;
+    GLStateCache& operator=(const GLStateCache&) = delete;
+
+    /**
+     * @brief Forgets all tracked state, so the next call of each kind is issued
+     */
+    nil Invalidate();
+
+    /**
+     * @brief Starts counting a frame; also invalidates, as other code ran since the last frame
+     */
+    nil BeginFrame();
+
+    /**
+     * @brief Publishes the frame's counters for GetLastFrameStats()
+     */
+    nil EndFrame();
+
+    /**
+     * @brief Gets the counters of the last finished frame; safe from any thread
+     * @return GLStateStats Counters
+     */
+    GLStateStats GetLastFrameStats() const;
+
+    nil UseProgram(GLuint name);
+    nil BindVertexArray(GLuint name);
+
+    /**
+     * @brief Binds a buffer
+     * @param target GL_ARRAY_BUFFER, GL_ELEMENT_ARRAY_BUFFER or GL_DRAW_INDIRECT_BUFFER; other targets are passed through
+     * @param name Buffer object
+     */
+    nil BindBuffer(GLenum target, GLuint name);
+
+    /**
+     * @brief Binds a framebuffer
+     * @param target GL_FRAMEBUFFER, GL_READ_FRAMEBUFFER or GL_DRAW_FRAMEBUFFER
+     * @param name Framebuffer object
+     */
+    nil BindFramebuffer(GLenum target, GLuint name);
+
+    nil BindTexture2D(GLuint name);
+    nil Viewport(GLint x, GLint y, GLsizei width, GLsizei height);
+    nil BlendFunc(GLenum source, GLenum destination) { BlendFuncSeparate(source, destination, source, destination); }
+    nil BlendFuncSeparate(GLenum source, GLenum destination, GLenum source_alpha, GLenum destination_alpha);
+    nil ClearColor(GLfloat r, GLfloat g, GLfloat b, GLfloat a);
+
+    /**
+     * @brief Enables or disables a capability
+     * @param capability GL_BLEND, GL_DEPTH_TEST, GL_CULL_FACE or GL_SCISSOR_TEST are tracked; others are passed through
+     * @param enabled True for glEnable()
+     */
+    nil SetEnabled(GLenum capability, bool enabled);
+
+    /**
+     * @brief Issues and counts a draw call
+     */
+    nil DrawArrays(GLenum mode, GLint first, GLsizei count) {
+        frame.draws++;
+        glDrawArrays(mode, first, count);
+    }
+    
+    /**
+     * @brief Issues and counts an indexed draw call
+     * @param offset Byte offset of the first index in the bound element buffer
+     */
+    nil DrawElements(GLenum mode, GLsizei count, GLenum type, size_t offset) {
+        frame.draws++;
+        glDrawElements(mode, count, type, reinterpret_cast<const void*>(offset));
+    }
+    
+    /**
+     * @brief Issues the commands of the bound indirect buffer; counted as one draw call
+     */
+    nil MultiDrawElementsIndirect(GLenum mode, GLenum type, GLsizei draw_count) {
+        frame.draws++;
+        glMultiDrawElementsIndirect(mode, type, nullptr, draw_count, 0);
+    }
+};
+
+#endif // MENTAL_GL_STATE_CACHE_H
@@ -0,0 +1,91 @@
+/**
+ * @file GpuScene.cpp
+ * @brief Implementation of the GPU-resident scene
+ * @author MentalEngine Team
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#include "GpuScene.h"
+#include "../../Core/MemoryTracker.h"
+#include <cstddef>
+
+nil GpuScene::__init() {
+    multi_draw_indirect = GLEW_VERSION_4_3 || GLEW_ARB_multi_draw_indirect;
+    glGenVertexArrays(1, &vertex_array);
+    glGenBuffers(1, &vertex_buffer);
+    glGenBuffers(1, &index_buffer);
+    if (multi_draw_indirect) glGenBuffers(1, &command_buffer);
+
+    // Атрибут 1 (цвет) выключен: его значение задает glVertexAttrib3f() на весь вызов
+    state.BindVertexArray(vertex_array);
+    state.BindBuffer(GL_ARRAY_BUFFER, vertex_buffer);
+    state.BindBuffer(GL_ELEMENT_ARRAY_BUFFER, index_buffer);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, static_cast<GLsizei>(sizeof(SceneVertex)), (void*)offsetof(SceneVertex, x));
+    initialized = true;
+}
+
+nil GpuScene::__upload(GLenum target, size_t size, const void* data) {
+    glBufferData(target, static_cast<GLsizeiptr>(size), data, GL_STATIC_DRAW);
+    MentalEngine::MemoryTracker::AddGpuUpload(size);
+}
+
+nil GpuScene::Upload(const SceneGeometry& geometry) {
+    if (!initialized) __init();
+
+    object_count = geometry.object_count;
+    vertex_count = geometry.vertex_count;
+    index_count = geometry.index_count;
+
+    state.BindBuffer(GL_ARRAY_BUFFER, vertex_buffer);
+    __upload(GL_ARRAY_BUFFER, vertex_count * sizeof(SceneVertex), geometry.vertices);
+    state.BindVertexArray(vertex_array);
+    __upload(GL_ELEMENT_ARRAY_BUFFER, index_count * sizeof(uint32_t), geometry.indices);
+    // Без multi-draw indirect команды не нужны: объекты лежат подряд в index buffer
+    const size_t command_bytes = multi_draw_indirect ? object_count * sizeof(SceneDrawCommand) : 0;
+    if (multi_draw_indirect) {
+        state.BindBuffer(GL_DRAW_INDIRECT_BUFFER, command_buffer);
+        __upload(GL_DRAW_INDIRECT_BUFFER, command_bytes, geometry.commands);
+    }
+
+    const int64_t bytes = static_cast<int64_t>(vertex_count * sizeof(SceneVertex) + index_count * sizeof(uint32_t) + command_bytes);
+    MentalEngine::MemoryTracker::AddGpuMemory(MentalEngine::GpuMemoryKind::Buffer, bytes - resident_bytes);
+    resident_bytes = bytes;
+}
+
+nil GpuScene::UpdateVertices(size_t first, size_t count, const SceneVertex* vertices) {
+    if (count == 0 || first + count > vertex_count) return;
+    state.BindBuffer(GL_ARRAY_BUFFER, vertex_buffer);
+    glBufferSubData(GL_ARRAY_BUFFER, static_cast<GLintptr>(first * sizeof(SceneVertex)),
+                    static_cast<GLsizeiptr>(count * sizeof(SceneVertex)), vertices);
+    MentalEngine::MemoryTracker::AddGpuUpload(count * sizeof(SceneVertex));
+}
+
+nil GpuScene::Draw() {
+    if (object_count == 0) return;
+    state.BindVertexArray(vertex_array);
+
+    if (multi_draw_indirect) {
+        // Один вызов на всю сцену: команды читаются из буфера на GPU
+        state.BindBuffer(GL_DRAW_INDIRECT_BUFFER, command_buffer);
+        state.MultiDrawElementsIndirect(GL_LINES, GL_UNSIGNED_INT, static_cast<GLsizei>(object_count));
+        return;
+    }
+    state.DrawElements(GL_LINES, static_cast<GLsizei>(index_count), GL_UNSIGNED_INT, 0);
+}
+
+nil GpuScene::Clear() {
+    if (initialized) {
+        glDeleteVertexArrays(1, &vertex_array);
+        GLuint buffers[] = {vertex_buffer, index_buffer, command_buffer};
+        glDeleteBuffers(3, buffers);
+        MentalEngine::MemoryTracker::AddGpuMemory(MentalEngine::GpuMemoryKind::Buffer, -resident_bytes);
+    }
+    vertex_array = vertex_buffer = index_buffer = command_buffer = 0;
+    object_count = 0;
+    vertex_count = 0;
+    index_count = 0;
+    resident_bytes = 0;
+    initialized = false;
+}
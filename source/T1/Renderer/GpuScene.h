@@ -0,0 +1,103 @@
+/**
+ * @file GpuScene.h
+ * @brief GPU-resident scene geometry drawn with multi-draw indirect for MentalEngine
+ * @author MentalEngine Team
+ * @version 1.0.0
+ * @date 2024
+ *
+ * This file defines the GpuScene class, which keeps the tessellated scene
+ * and one indexed draw command per object in GPU buffers, so drawing the
+ * scene costs the CPU the same for ten objects as for a hundred thousand.
+ */
+
+#ifndef MENTAL_GPU_SCENE_H
+#define MENTAL_GPU_SCENE_H
+
+#define GL_SILENCE_DEPRECATION
+#include <GL/glew.h>
+#include "../../Core/Types.h"
+#include "FramePacket.h"
+#include "GLStateCache.h"
+#include <cstdint>
+
+/**
+ * @class GpuScene
+ * @brief Resident vertex, index and indirect command buffers of one scene
+ *
+ * Objects are laid out back to back in the index buffer. With GL 4.3 or
+ * ARB_multi_draw_indirect the whole scene is one glMultiDrawElementsIndirect
+ * call reading the commands from the GPU; otherwise it is one glDrawElements
+ * over all indices. Edits that keep object sizes rewrite vertices in place
+ * (UpdateVertices()); anything else is a new Upload().
+ *
+ * @note GL thread only
+ */
+class GpuScene {
+private:
+    GLuint vertex_array = 0;       ///< Layout of vertex_buffer; index_buffer bound
+    GLuint vertex_buffer = 0;      ///< SceneVertex array
+    GLuint index_buffer = 0;       ///< GL_LINES indices
+    GLuint command_buffer = 0;     ///< SceneDrawCommand array, GL_DRAW_INDIRECT_BUFFER; 0 without multi-draw indirect
+    size_t object_count = 0;       ///< Draw commands in command_buffer
+    size_t vertex_count = 0;       ///< Vertices in vertex_buffer
+    size_t index_count = 0;        ///< Indices in index_buffer
+    int64_t resident_bytes = 0;    ///< Size of all buffers, for GPU memory accounting
+    bool multi_draw_indirect = false;  ///< glMultiDrawElementsIndirect is available
+    bool initialized = false;      ///< __init() ran
+    GLStateCache& state;           ///< Binds go through the renderer's state cache
+
+    /**
+     * @brief Creates the GL objects and the vertex layout
+     * @private
+     */
+    nil __init();
+
+    /**
+     * @brief Re-specifies a buffer and records the upload
+     * @private
+     */
+    nil __upload(GLenum target, size_t size, const void* data);
+
+public:
+    /**
+     * @brief Constructor
+     * @param state State cache of the context the buffers are used in
+     */
+    explicit GpuScene(GLStateCache& state) : state(state) {}
+    ~GpuScene() = default;
+    GpuScene(const GpuScene&) = delete;
+    GpuScene& operator=(const GpuScene&) = delete;
+
+    /**
+     * @brief Replaces the resident geometry
+     * @param geometry Tessellated scene
+     */
+    nil Upload(const SceneGeometry& geometry);
+
+    /**
+     * @brief Rewrites vertices of the resident geometry
+     *
+     * For edits that keep every object's vertex count, so draw commands and
+     * indices stay valid.
+     *
+     * @param first First vertex to replace
+     * @param count Number of vertices
+     * @param vertices New vertices
+     */
+    nil UpdateVertices(size_t first, size_t count, const SceneVertex* vertices);
+
+    /**
+     * @brief Draws every visible object
+     *
+     * Expects a program using scene.vert to be bound.
+     */
+    nil Draw();
+
+    /**
+     * @brief Deletes the GL objects
+     */
+    nil Clear();
+
+};
+
+#endif // MENTAL_GPU_SCENE_H
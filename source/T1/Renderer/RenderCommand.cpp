@@ -0,0 +1,73 @@
+/**
+ * @file RenderCommand.cpp
+ * @brief Implementation of render command keys, sorting and lists
+ * @author MentalEngine Team
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#include "RenderCommand.h"
+#include <algorithm>
+
+namespace {
+
+constexpr int KEY_BYTES = 8;       ///< Radix passes of a full key
+constexpr size_t RADIX = 256;      ///< Buckets per pass
+
+} // namespace
+
+uint64_t RenderCommand::MakeKey(size_t viewport, RenderLayer layer, RenderStage stage, RenderProgram program, uint16_t material, float depth) {
+    const float clamped = std::min(std::max(depth, 0.0f), 1.0f);
+    const uint64_t depth_bits = static_cast<uint64_t>(clamped * DEPTH_MAX);
+    return (static_cast<uint64_t>(viewport & 0xF) << VIEWPORT_SHIFT) |
+           (static_cast<uint64_t>(layer) << LAYER_SHIFT) |
+           (static_cast<uint64_t>(static_cast<uint8_t>(stage) & 0xF) << STAGE_SHIFT) |
+           (static_cast<uint64_t>(program) << PROGRAM_SHIFT) |
+           (static_cast<uint64_t>(material) << MATERIAL_SHIFT) |
+           depth_bits;
+}
+
+nil RenderCommand::Sort(std::vector<RenderCommand>& commands, std::vector<RenderCommand>& scratch) {
+    const size_t count = commands.size();
+    if (count < 2) return;
+    scratch.resize(count);
+
+    // Гистограммы всех байтов за один проход по ключам
+    size_t histograms[KEY_BYTES][RADIX] = {};
+    for (const RenderCommand& command : commands) {
+        for (int byte = 0; byte < KEY_BYTES; byte++) {
+            histograms[byte][(command.key >> (8 * byte)) & 0xFF]++;
+        }
+    }
+
+    for (int byte = 0; byte < KEY_BYTES; byte++) {
+        size_t* histogram = histograms[byte];
+        // Все ключи совпадают в этом байте - проход ничего не переставит
+        if (histogram[(commands[0].key >> (8 * byte)) & 0xFF] == count) continue;
+
+        size_t offset = 0;
+        for (size_t bucket = 0; bucket < RADIX; bucket++) {
+            const size_t size = histogram[bucket];
+            histogram[bucket] = offset;
+            offset += size;
+        }
+        for (const RenderCommand& command : commands) {
+            scratch[histogram[(command.key >> (8 * byte)) & 0xFF]++] = command;
+        }
+        commands.swap(scratch);
+    }
+}
+
+nil RenderCommandList::AddLines(const MentalEngine::Math::Vector2* line_points, size_t count, const MentalEngine::Math::Vector3& color,
+                                float width, RenderLayer layer, float depth) {
+    if (count == 0 || count % 2 != 0) return;
+    Entry entry;
+    entry.first_point = points.size();
+    entry.point_count = count;
+    entry.color = color;
+    entry.width = width;
+    entry.layer = layer;
+    entry.depth = depth;
+    points.insert(points.end(), line_points, line_points + count);
+    entries.push_back(entry);
+}
@@ -0,0 +1,160 @@
+/**
+ * @file RenderCommand.h
+ * @brief Sortable draw commands for MentalEngine
+ * @author MentalEngine Team
+ * @version 1.0.0
+ * @date 2024
+ *
+ * This file defines the RenderCommand struct, a draw reference with a
+ * 64-bit sort key, and RenderCommandList, which lets any thread prepare
+ * draws that are later submitted into a frame.
+ */
+
+#ifndef MENTAL_RENDER_COMMAND_H
+#define MENTAL_RENDER_COMMAND_H
+
+#include "../../Core/Types.h"
+#include "../../Core/Math.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @enum RenderLayer
+ * @brief Draw order of commands within a viewport; later layers draw on top
+ */
+enum class RenderLayer : uint8_t {
+    Scene = 0,   ///< Document geometry
+    Highlight,   ///< Selection and hover feedback
+    Tool,        ///< Geometry of the tool in use
+    Overlay      ///< Markers drawn over everything
+};
+
+/**
+ * @enum RenderStage
+ * @brief Draw order within a layer: opaque geometry before blended geometry
+ */
+enum class RenderStage : uint8_t {
+    Opaque = 0,   ///< Written without blending
+    Translucent   ///< Blended over what is already drawn, e.g. anti-aliased lines
+};
+
+/**
+ * @enum RenderProgram
+ * @brief Shader program a command is drawn with
+ */
+enum class RenderProgram : uint8_t {
+    Basic = 0,  ///< Filled geometry
+    Lines,      ///< Lines expanded to screen-space quads
+    SceneLines, ///< Resident scene geometry drawn as lines (scene.vert)
+    Tiles       ///< Cached plan view tiles composited as textured quads
+};
+
+/**
+ * @struct RenderCommand
+ * @brief One draw of a frame, ordered by its key
+ *
+ * From the most significant bits down the key holds the viewport (4 bits),
+ * layer (8), stage (4), program (8), material (16) and depth (24). Sorting
+ * by key therefore groups each viewport's draws, keeps layers in order,
+ * and within a layer puts draws sharing a program and material next to
+ * each other so the state between them does not change. Sorting is
+ * stable, so draws with equal keys keep their submission order.
+ */
+struct RenderCommand {
+    static constexpr int VIEWPORT_SHIFT = 60;  ///< Bits 60-63
+    static constexpr int LAYER_SHIFT = 52;     ///< Bits 52-59
+    static constexpr int STAGE_SHIFT = 48;     ///< Bits 48-51
+    static constexpr int PROGRAM_SHIFT = 40;   ///< Bits 40-47
+    static constexpr int MATERIAL_SHIFT = 24;  ///< Bits 24-39
+    static constexpr uint32_t DEPTH_MAX = 0xFFFFFF;  ///< Depth field range, bits 0-23
+    static constexpr size_t MAX_VIEWPORTS = 16;      ///< Viewports the key can address
+
+    uint64_t key = 0;    ///< Sort key
+    uint32_t batch = 0;  ///< Index into FramePacket::batches
+
+    /**
+     * @brief Builds a sort key
+     * @param viewport Viewport index, below MAX_VIEWPORTS
+     * @param layer Draw layer
+     * @param stage Stage within the layer
+     * @param program Shader program
+     * @param material Identifies the program state the draw needs
+     * @param depth Normalized depth in [0, 1]; smaller draws first, clamped
+     * @return uint64_t Key
+     */
+    static uint64_t MakeKey(size_t viewport, RenderLayer layer, RenderStage stage, RenderProgram program, uint16_t material, float depth);
+
+    static size_t GetViewport(uint64_t key) { return static_cast<size_t>(key >> VIEWPORT_SHIFT); }
+    static RenderProgram GetProgram(uint64_t key) { return static_cast<RenderProgram>((key >> PROGRAM_SHIFT) & 0xFF); }
+    static uint16_t GetMaterial(uint64_t key) { return static_cast<uint16_t>(key >> MATERIAL_SHIFT); }
+
+    /**
+     * @brief Sorts commands by key with a stable LSD radix sort
+     *
+     * Byte positions in which all keys agree are skipped, so a frame whose
+     * keys differ only in a few fields costs only a few passes.
+     *
+     * @param commands Commands to sort
+     * @param scratch Buffer of the same type, reused across frames; may be swapped with commands
+     */
+    static nil Sort(std::vector<RenderCommand>& commands, std::vector<RenderCommand>& scratch);
+};
+
+/**
+ * @class RenderCommandList
+ * @brief Line draws prepared away from the recording thread
+ *
+ * Holds its own copy of the points, so a worker thread can fill a list
+ * while the UI thread records the frame; Renderer::Submit() then adds the
+ * draws to the current viewport pass. Lists keep their allocations across
+ * Clear().
+ *
+ * @note Not thread-safe; use one list per thread
+ */
+class RenderCommandList {
+public:
+    /**
+     * @struct Entry
+     * @brief One prepared line draw
+     */
+    struct Entry {
+        size_t first_point = 0;             ///< Index of the first point in the list's points
+        size_t point_count = 0;             ///< Number of points, two per segment
+        MentalEngine::Math::Vector3 color;  ///< Line color (RGB)
+        float width = 1.0f;                 ///< Line width in pixels
+        RenderLayer layer = RenderLayer::Scene;  ///< Draw layer
+        float depth = 0.0f;                 ///< Normalized depth within the layer
+    };
+
+private:
+    std::vector<MentalEngine::Math::Vector2> points;  ///< Points of all entries
+    std::vector<Entry> entries;                       ///< Prepared draws, in submission order
+
+public:
+    /**
+     * @brief Removes all draws, keeping allocations
+     */
+    nil Clear() {
+        points.clear();
+        entries.clear();
+    }
+
+    /**
+     * @brief Adds a line draw
+     * @param line_points Start/end pairs; an odd or zero count is ignored
+     * @param count Number of points
+     * @param color Line color (RGB)
+     * @param width Line width in pixels
+     * @param layer Draw layer
+     * @param depth Normalized depth within the layer
+     */
+    nil AddLines(const MentalEngine::Math::Vector2* line_points, size_t count, const MentalEngine::Math::Vector3& color,
+                 float width, RenderLayer layer = RenderLayer::Scene, float depth = 0.0f);
+
+    size_t GetEntryCount() const { return entries.size(); }
+    const Entry& GetEntry(size_t index) const { return entries[index]; }
+    const MentalEngine::Math::Vector2* GetPoints(const Entry& entry) const { return points.data() + entry.first_point; }
+};
+
+#endif // MENTAL_RENDER_COMMAND_H
@@ -0,0 +1,129 @@
+/**
+ * @file RenderTargetPool.cpp
+ * @brief Implementation of the render target pool
+ * @author MentalEngine Team
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#include "RenderTargetPool.h"
+#include "../../Core/MemoryTracker.h"
+
+namespace {
+
+constexpr int64_t DEPTH_BYTES_PER_PIXEL = 4;  ///< DEPTH24_STENCIL8
+constexpr int64_t COLOR_BYTES_PER_PIXEL = 3;  ///< RGB8
+
+/**
+ * @brief Estimates the storage of a multisampled color and depth pair
+ */
+int64_t MultisampleBytes(int width, int height, int samples) {
+    return (COLOR_BYTES_PER_PIXEL + DEPTH_BYTES_PER_PIXEL) * width * height * samples;
+}
+
+} // namespace
+
+GLuint RenderTargetPool::AcquireDepth(int width, int height) {
+    for (DepthBuffer& buffer : depth_buffers) {
+        if (buffer.width == width && buffer.height == height) {
+            buffer.last_used = frame;
+            return buffer.renderbuffer;
+        }
+    }
+
+    DepthBuffer buffer;
+    buffer.width = width;
+    buffer.height = height;
+    buffer.last_used = frame;
+    glGenRenderbuffers(1, &buffer.renderbuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, buffer.renderbuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+    MentalEngine::MemoryTracker::AddGpuMemory(MentalEngine::GpuMemoryKind::Renderbuffer,
+                                              DEPTH_BYTES_PER_PIXEL * width * height);
+    created++;
+    depth_buffers.push_back(buffer);
+    return buffer.renderbuffer;
+}
+
+GLuint RenderTargetPool::AcquireMultisample(int width, int height, int samples) {
+    for (MultisampleTarget& target : multisample_targets) {
+        if (target.width == width && target.height == height && target.samples == samples) {
+            target.last_used = frame;
+            return target.complete ? target.framebuffer : 0;
+        }
+    }
+
+    MultisampleTarget target;
+    target.width = width;
+    target.height = height;
+    target.samples = samples;
+    target.last_used = frame;
+    glGenRenderbuffers(1, &target.color);
+    glBindRenderbuffer(GL_RENDERBUFFER, target.color);
+    glRenderbufferStorageMultisample(GL_RENDERBUFFER, samples, GL_RGB8, width, height);
+    glGenRenderbuffers(1, &target.depth);
+    glBindRenderbuffer(GL_RENDERBUFFER, target.depth);
+    glRenderbufferStorageMultisample(GL_RENDERBUFFER, samples, GL_DEPTH24_STENCIL8, width, height);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    glGenFramebuffers(1, &target.framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, target.framebuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, target.color);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, target.depth);
+    target.complete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    MentalEngine::MemoryTracker::AddGpuMemory(MentalEngine::GpuMemoryKind::Renderbuffer, MultisampleBytes(width, height, samples));
+    created += 2;
+    multisample_targets.push_back(target);
+
+    // Неполный framebuffer тоже держим в пуле, чтобы не пересоздавать его каждый кадр
+    return target.complete ? target.framebuffer : 0;
+}
+
+nil RenderTargetPool::EndFrame() {
+    frame++;
+    for (size_t i = 0; i < depth_buffers.size();) {
+        DepthBuffer& buffer = depth_buffers[i];
+        if (frame - buffer.last_used <= TRIM_FRAMES) {
+            i++;
+            continue;
+        }
+        // Буфер давно не нужен ни одному viewport - отдаем память драйверу
+        glDeleteRenderbuffers(1, &buffer.renderbuffer);
+        MentalEngine::MemoryTracker::AddGpuMemory(MentalEngine::GpuMemoryKind::Renderbuffer,
+                                                  -DEPTH_BYTES_PER_PIXEL * buffer.width * buffer.height);
+        buffer = depth_buffers.back();
+        depth_buffers.pop_back();
+    }
+    for (size_t i = 0; i < multisample_targets.size();) {
+        if (frame - multisample_targets[i].last_used <= TRIM_FRAMES) {
+            i++;
+            continue;
+        }
+        __release(multisample_targets[i]);
+        multisample_targets[i] = multisample_targets.back();
+        multisample_targets.pop_back();
+    }
+}
+
+nil RenderTargetPool::Clear() {
+    for (DepthBuffer& buffer : depth_buffers) {
+        glDeleteRenderbuffers(1, &buffer.renderbuffer);
+        MentalEngine::MemoryTracker::AddGpuMemory(MentalEngine::GpuMemoryKind::Renderbuffer,
+                                                  -DEPTH_BYTES_PER_PIXEL * buffer.width * buffer.height);
+    }
+    depth_buffers.clear();
+    for (MultisampleTarget& target : multisample_targets) {
+        __release(target);
+    }
+    multisample_targets.clear();
+}
+
+nil RenderTargetPool::__release(MultisampleTarget& target) {
+    glDeleteFramebuffers(1, &target.framebuffer);
+    glDeleteRenderbuffers(1, &target.color);
+    glDeleteRenderbuffers(1, &target.depth);
+    MentalEngine::MemoryTracker::AddGpuMemory(MentalEngine::GpuMemoryKind::Renderbuffer,
+                                              -MultisampleBytes(target.width, target.height, target.samples));
+}
@@ -0,0 +1,148 @@
+/**
+ * @file RenderTargetPool.h
+ * @brief Pooled render target storage for MentalEngine
+ * @author MentalEngine Team
+ * @version 1.0.0
+ * @date 2024
+ *
+ * This file defines the RenderTargetPool class, which hands out
+ * depth/stencil renderbuffers and multisampled framebuffers in size buckets
+ * so viewports of similar size share them and resizing a viewport does not
+ * create GL objects.
+ */
+
+#ifndef MENTAL_RENDER_TARGET_POOL_H
+#define MENTAL_RENDER_TARGET_POOL_H
+
+#define GL_SILENCE_DEPRECATION
+#include <GL/glew.h>
+#include "../../Core/Types.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @class RenderTargetPool
+ * @brief Bucketed pool of depth/stencil renderbuffers and MSAA framebuffers
+ *
+ * Sizes are rounded up to multiples of BUCKET_SIZE, and a viewport renders
+ * into the lower-left sub-rectangle of its bucket-sized target. Passes run
+ * one after another and clear depth first, so every viewport in the same
+ * bucket can share one renderbuffer. Multisampled passes are resolved into
+ * their viewport's texture right after drawing, so the multisampled
+ * framebuffer of a bucket is shared the same way. Buffers not acquired for
+ * TRIM_FRAMES frames are deleted, so callers acquire the depth buffer of
+ * every framebuffer that still has it attached each frame, even when that
+ * framebuffer is not drawn.
+ *
+ * @note All methods except BucketSize() need the GL context; Clear() must
+ *       run before the context is destroyed
+ */
+class RenderTargetPool {
+private:
+    /**
+     * @struct DepthBuffer
+     * @brief One pooled renderbuffer
+     */
+    struct DepthBuffer {
+        GLuint renderbuffer = 0;  ///< DEPTH24_STENCIL8 renderbuffer
+        int width = 0;            ///< Bucketed width in pixels
+        int height = 0;           ///< Bucketed height in pixels
+        uint64_t last_used = 0;   ///< Frame of the last AcquireDepth()
+    };
+
+    /**
+     * @struct MultisampleTarget
+     * @brief One pooled multisampled framebuffer
+     */
+    struct MultisampleTarget {
+        GLuint framebuffer = 0;   ///< Framebuffer with color and depth attached
+        GLuint color = 0;         ///< Multisampled RGB8 renderbuffer
+        GLuint depth = 0;         ///< Multisampled DEPTH24_STENCIL8 renderbuffer
+        int width = 0;            ///< Bucketed width in pixels
+        int height = 0;           ///< Bucketed height in pixels
+        int samples = 0;          ///< Samples per pixel
+        bool complete = false;    ///< Framebuffer status was complete when created
+        uint64_t last_used = 0;   ///< Frame of the last AcquireMultisample()
+    };
+
+    std::vector<DepthBuffer> depth_buffers;  ///< Live buffers, at most one per bucket
+    std::vector<MultisampleTarget> multisample_targets;  ///< Live framebuffers, at most one per bucket and sample count
+    uint64_t frame = 0;                      ///< Frames ended since startup
+    uint64_t created = 0;                    ///< Renderbuffers created since startup
+
+    /**
+     * @brief Deletes the GL objects of a multisampled framebuffer
+     * @private
+     */
+    nil __release(MultisampleTarget& target);
+
+public:
+    static constexpr int BUCKET_SIZE = 256;         ///< Size granularity in pixels
+    static constexpr uint64_t TRIM_FRAMES = 300;    ///< Idle frames before a buffer is deleted
+
+    RenderTargetPool() = default;
+    ~RenderTargetPool() = default;
+    RenderTargetPool(const RenderTargetPool&) = delete;
+    RenderTargetPool& operator=(const RenderTargetPool&) = delete;
+
+    /**
+     * @brief Rounds a size up to its bucket
+     * @param size Size in pixels
+     * @return int Multiple of BUCKET_SIZE; 0 for sizes <= 0
+     */
+    static int BucketSize(int size) {
+        return size <= 0 ? 0 : (size + BUCKET_SIZE - 1) / BUCKET_SIZE * BUCKET_SIZE;
+    }
+
+    /**
+     * @brief Gets the depth/stencil buffer of a bucket, creating it on first use
+     * @param width Bucketed width in pixels
+     * @param height Bucketed height in pixels
+     * @return GLuint Renderbuffer shared by all targets of this bucket
+     */
+    GLuint AcquireDepth(int width, int height);
+
+    /**
+     * @brief Gets the multisampled framebuffer of a bucket, creating it on first use
+     *
+     * The color format is RGB8, matching viewport textures, so the
+     * framebuffer can be resolved into them with glBlitFramebuffer().
+     *
+     * @param width Bucketed width in pixels
+     * @param height Bucketed height in pixels
+     * @param samples Samples per pixel, at most GL_MAX_SAMPLES
+     * @return GLuint Framebuffer shared by all targets of this bucket; 0 if incomplete
+     */
+    GLuint AcquireMultisample(int width, int height, int samples);
+
+    /**
+     * @brief Ends a frame and deletes buffers that have been idle too long
+     */
+    nil EndFrame();
+
+    /**
+     * @brief Deletes every pooled buffer
+     */
+    nil Clear();
+
+    /**
+     * @brief Gets the number of live buffers
+     * @return size_t Pooled renderbuffers
+     */
+    size_t GetDepthBufferCount() const { return depth_buffers.size(); }
+
+    /**
+     * @brief Gets the number of live multisampled framebuffers
+     * @return size_t Pooled framebuffers
+     */
+    size_t GetMultisampleCount() const { return multisample_targets.size(); }
+
+    /**
+     * @brief Gets the number of renderbuffers ever created
+     * @return uint64_t Creations since startup; stays flat while resizing within a bucket
+     */
+    uint64_t GetCreatedCount() const { return created; }
+};
+
+#endif // MENTAL_RENDER_TARGET_POOL_H
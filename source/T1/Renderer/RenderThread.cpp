@@ -0,0 +1,77 @@
+/**
+ * @file RenderThread.cpp
+ * @brief Implementation of the dedicated OpenGL thread
+ * @author MentalEngine Team
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#include "RenderThread.h"
+#include "../../Core/MemoryTracker.h"
+#include <chrono>
+#include <utility>
+
+nil RenderThread::Start(GLFWwindow* window, std::function<nil(FramePacket&)> execute) {
+    if (IsRunning()) return;
+    this->window = window;
+    this->execute = std::move(execute);
+    stopping = false;
+    pending_full = false;
+
+    // Контекст может быть текущим только в одном потоке
+    glfwMakeContextCurrent(nullptr);
+    thread = std::thread(&RenderThread::__loop, this);
+}
+
+nil RenderThread::Stop() {
+    if (!IsRunning()) return;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    ready.notify_one();
+    thread.join();
+    glfwMakeContextCurrent(window);
+}
+
+bool RenderThread::CanSubmit() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return !pending_full;
+}
+
+bool RenderThread::Submit(FramePacket& packet) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (pending_full) return false;
+        std::swap(pending, packet);
+        pending_full = true;
+    }
+    ready.notify_one();
+    return true;
+}
+
+nil RenderThread::__loop() {
+    MentalEngine::MemoryTracker::SetCurrentTag(MentalEngine::MemoryTag::Renderer);
+    glfwMakeContextCurrent(window);
+
+    FramePacket current;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            ready.wait(lock, [this] { return pending_full || stopping; });
+            if (stopping) break;
+            std::swap(current, pending);
+            pending_full = false;
+        }
+        // Слот свободен - будим главный поток, если он ждет в glfwWaitEvents()
+        glfwPostEmptyEvent();
+
+        auto start = std::chrono::steady_clock::now();
+        execute(current);
+        glfwSwapBuffers(window);
+        std::chrono::duration<float, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        frame_ms.store(elapsed.count(), std::memory_order_relaxed);
+    }
+
+    glfwMakeContextCurrent(nullptr);
+}
@@ -0,0 +1,112 @@
+/**
+ * @file RenderThread.h
+ * @brief Dedicated OpenGL thread for MentalEngine
+ * @author MentalEngine Team
+ * @version 1.0.0
+ * @date 2024
+ *
+ * This file defines the RenderThread class, which owns the window's GL
+ * context and executes recorded frames while the main thread keeps polling
+ * events and building the next frame.
+ */
+
+#ifndef MENTAL_RENDER_THREAD_H
+#define MENTAL_RENDER_THREAD_H
+
+#define GL_SILENCE_DEPRECATION
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+#include "../../Core/Types.h"
+#include "FramePacket.h"
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+/**
+ * @class RenderThread
+ * @brief Executes frame packets and swaps buffers on its own thread
+ *
+ * Frames are handed over through a single pending slot: the main thread may
+ * record frame N+1 while frame N is drawn, and Submit() only succeeds once
+ * the previous submission has been picked up. This bounds the latency to
+ * one frame and never lets input handling wait on GPU work or vsync.
+ *
+ * After every pick-up the thread posts an empty GLFW event, so a main loop
+ * blocked in glfwWaitEvents() wakes as soon as the slot is free.
+ *
+ * @note This class is non-copyable; Stop() must be called before the window
+ *       is destroyed
+ */
+class RenderThread {
+private:
+    std::thread thread;                              ///< Thread owning the GL context
+    GLFWwindow* window = nullptr;                    ///< Window whose context and buffers are used
+    std::function<nil(FramePacket&)> execute;        ///< Draws one packet, e.g. Renderer::ExecutePacket
+    std::mutex mutex;                                ///< Guards pending, pending_full and stopping
+    std::condition_variable ready;                   ///< Signals a new packet or a stop request
+    FramePacket pending;                             ///< Submitted packet not yet picked up
+    bool pending_full = false;                       ///< pending holds a frame
+    bool stopping = false;                           ///< Thread exits after the current frame
+    std::atomic<float> frame_ms{0.0f};               ///< Time of the last execute + swap
+
+    /**
+     * @brief Render thread main loop
+     * @private
+     */
+    nil __loop();
+
+public:
+    RenderThread() = default;
+    ~RenderThread() { Stop(); }
+    RenderThread(const RenderThread&) = delete;
+    RenderThread& operator=(const RenderThread&) = delete;
+
+    /**
+     * @brief Moves the window's context to a new render thread
+     *
+     * Releases the context on the calling thread before the render thread
+     * makes it current.
+     *
+     * @param window Window whose context is current on the calling thread
+     * @param execute Function that draws a packet with GL calls
+     */
+    nil Start(GLFWwindow* window, std::function<nil(FramePacket&)> execute);
+
+    /**
+     * @brief Stops the thread and makes the context current on the caller again
+     */
+    nil Stop();
+
+    /**
+     * @brief Checks whether the thread is running
+     * @return bool True between Start() and Stop()
+     */
+    bool IsRunning() const { return thread.joinable(); }
+
+    /**
+     * @brief Checks whether Submit() would accept a frame
+     * @return bool True if the pending slot is free
+     */
+    bool CanSubmit();
+
+    /**
+     * @brief Hands a recorded frame to the render thread
+     *
+     * Swaps the packet into the pending slot; on return the argument holds
+     * an older packet whose allocations can be reused for recording.
+     *
+     * @param packet Recorded frame
+     * @return bool False if the previous frame has not been picked up yet
+     */
+    bool Submit(FramePacket& packet);
+
+    /**
+     * @brief Gets the GPU-side frame time
+     * @return float Milliseconds spent executing and swapping the last frame
+     */
+    float GetFrameTime() const { return frame_ms.load(std::memory_order_relaxed); }
+};
+
+#endif // MENTAL_RENDER_THREAD_H
@@ -10,242 +10,821 @@
  */
 
 #include "Renderer.h"
+#include "../../Core/JobSystem.h"
+#include "../../Core/MemoryTracker.h"
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 #include <vector>
 #include <memory>
 
+namespace {
+
+constexpr uint64_t FNV_OFFSET = 14695981039346656037ull;  ///< FNV-1a offset basis
+constexpr uint64_t FNV_PRIME = 1099511628211ull;          ///< FNV-1a prime
+
+/**
+ * @brief Continues an FNV-1a hash over a block of bytes
+ */
+uint64_t __hash_bytes(uint64_t hash, const void* data, size_t size) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; i++) {
+        hash = (hash ^ bytes[i]) * FNV_PRIME;
+    }
+    return hash;
+}
+
+template <typename V>
+uint64_t __hash_value(uint64_t hash, const V& value) {
+    return __hash_bytes(hash, &value, sizeof(value));
+}
+
+/**
+ * @brief Hashes the look of a batch: color and width
+ */
+uint64_t __hash_style(const MentalEngine::Math::Vector3& color, float width) {
+    uint64_t hash = __hash_value(FNV_OFFSET, color.x);
+    hash = __hash_value(hash, color.y);
+    hash = __hash_value(hash, color.z);
+    return __hash_value(hash, width);
+}
+
+/**
+ * @brief Material of a line draw: its width in 1/16 pixel, the only uniform that varies
+ */
+uint16_t __line_material(float width) {
+    return static_cast<uint16_t>(std::min(std::max(width, 0.0f) * 16.0f, 65535.0f));
+}
+
+/**
+ * @brief Writes the vertex strip of a resident arc: k segments, k + 1 vertices
+ */
+nil __write_arc_vertices(const MentalEngine::Scene& scene, uint32_t arc, size_t segments,
+                         MentalEngine::Math::Vector2* pairs, SceneVertex* vertices) {
+    scene.WriteArcSegments(arc, pairs);
+    for (size_t k = 0; k < segments; k++) {
+        vertices[k] = SceneVertex{pairs[2 * k].x, pairs[2 * k].y};
+    }
+    if (segments > 0) {
+        vertices[segments] = SceneVertex{pairs[2 * segments - 1].x, pairs[2 * segments - 1].y};
+    } else {
+        vertices[0] = SceneVertex{0.0f, 0.0f};
+    }
+}
+
+} // namespace
+
 /**
- * @brief Initializes the viewport with specified dimensions
+ * @brief Draws a recorded frame
  * 
- * Creates and configures the OpenGL framebuffer for viewport rendering
- * with the given width and height. If a viewport was previously initialized,
- * it will be cleaned up before creating the new one.
+ * Frees the storage of released viewports and renders each pass that needs
+ * it into the lower-left corner of its viewport framebuffer. Color storage
+ * is only re-specified when the pass asks for another size bucket, so a
+ * drag-resize inside a bucket touches no GL objects. Multisampled passes
+ * are drawn into a pooled MSAA framebuffer and resolved into the viewport's
+ * texture; if the driver cannot provide one the pass is drawn without MSAA.
+ * Every target keeps its pooled depth buffer in use, drawn this frame or
+ * not, so the pool only trims buffers no framebuffer has attached.
+ * Then clears the window
+ * framebuffer and draws the captured ImGui lists on top. Skipped passes
+ * leave the previous image in their texture. Plan view tiles the packet
+ * renders are drawn first, since the passes composite them.
  * 
- * @param width Viewport width in pixels
- * @param height Viewport height in pixels
+ * Binds and state changes go through gl_state, which drops the redundant
+ * ones and counts what reached the driver.
+ * 
+ * @param packet Recorded frame
  */
-nil Renderer::InitViewport(int width, int height) {
-    std::cout << "InitViewport called with size: " << width << "x" << height << std::endl;
-    
-    viewport_width = width;
-    viewport_height = height;
+nil Renderer::ExecutePacket(FramePacket& packet) {
+    MentalEngine::MemoryTagScope tag(MentalEngine::MemoryTag::Renderer);
+    gl_arena.Reset();
+    gl_state.BeginFrame();
+    if (shaders_requested) __reload_shaders();
+    shader_cache.Poll();
+    if (packet.scene_geometry.geometry_hash != 0) gpu_scene.Upload(packet.scene_geometry);
+    for (const SceneVertexPatch& patch : packet.scene_patches) {
+        gpu_scene.UpdateVertices(patch.first_vertex, patch.vertex_count, patch.vertices);
+    }
     
-    // Очищаем предыдущий viewport если он был
-    if (viewport_initialized) {
-        __cleanup_viewport();
+    for (size_t i = 0; i < targets.size(); i++) {
+        if (packet.released_viewports & (1u << i)) {
+            __resize_viewport(targets[i], 0, 0);
+            __attach_depth(targets[i]);
+        }
     }
     
-    // Инициализируем шейдеры перед viewport
-    if (shader_program == 0) {
-        __init_shaders();
+    if (!packet.tile_renders.empty()) {
+        __prepare_drawing();
+        for (const TileRender& render : packet.tile_renders) __render_tile(render, packet);
     }
     
-    __init_viewport();
-    viewport_initialized = true;
+    for (size_t i = 0; i < packet.pass_count; i++) {
+        const ViewportPass& pass = packet.passes[i];
+        if (!pass.redraw || pass.width <= 0 || pass.height <= 0 || pass.viewport >= targets.size()) continue;
+        __prepare_drawing();
+        
+        ViewportTarget& target = targets[pass.viewport];
+        if (pass.target_width != target.width || pass.target_height != target.height) {
+            __resize_viewport(target, pass.target_width, pass.target_height);
+        }
+        __attach_depth(target);
+        
+        // MSAA: рисуем в общий multisample framebuffer корзины, затем resolve в текстуру
+        const int samples = std::min(pass.samples, static_cast<int>(max_samples));
+        const size_t pooled = target_pool.GetMultisampleCount();
+        const GLuint multisample = samples > 1 ? target_pool.AcquireMultisample(target.width, target.height, samples) : 0;
+        // Новый framebuffer пула создается со сбросом привязки мимо gl_state
+        if (target_pool.GetMultisampleCount() != pooled) gl_state.Invalidate();
+        
+        // Рендерим содержимое в угол framebuffer размером с panel
+        gl_state.BindFramebuffer(GL_FRAMEBUFFER, multisample ? multisample : target.framebuffer);
+        gl_state.Viewport(0, 0, pass.width, pass.height);
+        __render_viewport_content(pass, packet);
+        if (multisample) {
+            gl_state.BindFramebuffer(GL_READ_FRAMEBUFFER, multisample);
+            gl_state.BindFramebuffer(GL_DRAW_FRAMEBUFFER, target.framebuffer);
+            glBlitFramebuffer(0, 0, pass.width, pass.height, 0, 0, pass.width, pass.height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+        }
+    }
+    // Пропущенные viewport держат свой буфер: пул не удалит то, что еще прикреплено
+    for (ViewportTarget& target : targets) {
+        if (target.depth != 0) __attach_depth(target);
+    }
+    target_pool.EndFrame();
+    
+    int display_w = 0, display_h = 0;
+    packet.GetFramebufferSize(display_w, display_h);
+    gl_state.BindFramebuffer(GL_FRAMEBUFFER, 0);
+    gl_state.Viewport(0, 0, display_w, display_h);
+    gl_state.ClearColor(0.5f, 0.5f, 0.5f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+    
+    // ImGui backend сохраняет и восстанавливает состояние сам
+    gl_state.EndFrame();
+    packet.RenderDrawData(ui_draw_data);
 }
 
 /**
- * @brief Renders the viewport content
+ * @brief Stops recording
  * 
- * Renders the current viewport content to the framebuffer. If the dimensions
- * have changed or the viewport is not initialized, it will be reinitialized.
- * Shaders are initialized on first call if not already done.
+ * Closes the last pass, then tessellates the scene geometry the drawn
+ * passes refer to.
+ */
+nil Renderer::EndPacket() {
+    MentalEngine::MemoryTagScope tag(MentalEngine::MemoryTag::Renderer);
+    if (recording) {
+        __finish_pass();
+        __tessellate_scenes();
+        __sort_commands();
+        recorded_passes = recording->pass_count;
+        redrawn_passes = 0;
+        for (size_t i = 0; i < recording->pass_count; i++) {
+            if (recording->passes[i].redraw) redrawn_passes++;
+        }
+    }
+    recording = nullptr;
+}
+
+/**
+ * @brief Creates a viewport with its own camera and render target
+ * 
+ * The slot's framebuffer objects already exist; storage is allocated when
+ * its first pass is executed.
  * 
+ * @param camera Camera of the new viewport
+ * @return size_t Viewport index, or INVALID_VIEWPORT if all slots are used
+ */
+size_t Renderer::CreateViewport(std::shared_ptr<MentalEngine::Camera> camera) {
+    if (!camera) return INVALID_VIEWPORT;
+    for (size_t i = 1; i < slots.size(); i++) {
+        if (slots[i].camera) continue;
+        slots[i] = ViewportSlot();
+        slots[i].camera = std::move(camera);
+        return i;
+    }
+    return INVALID_VIEWPORT;
+}
+
+/**
+ * @brief Frees a viewport slot
+ * 
+ * The camera is dropped at once; the target's storage is released when the
+ * next packet is executed, since the GL context may live on another thread.
+ * 
+ * @param index Viewport index; the main viewport (0) cannot be released
+ */
+nil Renderer::ReleaseViewport(size_t index) {
+    if (index == 0 || !IsViewportInUse(index)) return;
+    slots[index] = ViewportSlot();
+    pending_releases |= 1u << index;
+    if (active_viewport == index) active_viewport = 0;
+}
+
+/**
+ * @brief Advances the motion of every viewport camera
+ * @param delta_seconds Time since the last call
+ */
+nil Renderer::AdvanceCameras(float delta_seconds) {
+    for (ViewportSlot& slot : slots) {
+        if (slot.camera) slot.camera->Advance(delta_seconds);
+    }
+}
+
+/**
+ * @brief Checks whether any viewport camera is still moving
+ * @return bool True while a camera needs further frames
+ */
+bool Renderer::AreCamerasAnimating() const {
+    for (const ViewportSlot& slot : slots) {
+        if (slot.camera && slot.camera->IsAnimating()) return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Records a viewport pass
+ * 
+ * Updates the viewport's camera for the requested size and copies its
+ * matrices, the grid settings and the quality tier into a new pass of the
+ * recording packet.
+ * No GL calls are made here; the framebuffer follows the new size when the
+ * packet is executed.
+ * 
+ * @param index Viewport index
  * @param width Desired viewport width in pixels
  * @param height Desired viewport height in pixels
  */
-nil Renderer::RenderViewport(int width, int height) {
-    // Обновляем размер если изменился
-    if (width != viewport_width || height != viewport_height) {
-        InitViewport(width, height);
+nil Renderer::RenderViewport(size_t index, int width, int height) {
+    MentalEngine::MemoryTagScope tag(MentalEngine::MemoryTag::Renderer);
+    if (!IsViewportInUse(index)) return;
+    ViewportSlot& slot = slots[index];
+    slot.width = width;
+    slot.height = height;
+    if (!recording) return;
+    
+    __finish_pass();
+    __choose_target_size(slot);
+    ViewportPass& pass = recording->NextPass();
+    slot.camera->Update(width, height);
+    pass.viewport = index;
+    pass.width = width;
+    pass.height = height;
+    pass.target_width = slot.target_width;
+    pass.target_height = slot.target_height;
+    pass.view = slot.camera->GetViewMatrix(scene_origin);
+    pass.projection = slot.camera->GetProjectionMatrix();
+    // Размер пикселя на плоскости цели камеры; для перспективы - на ее расстоянии
+    const float pixels = static_cast<float>(std::max(height, 1));
+    const float depth = slot.camera->GetProjection() == MentalEngine::CameraProjection::Orthographic
+                            ? 1.0f : (slot.camera->GetPosition() - slot.camera->GetTarget()).length();
+    pass_pixel_size = 2.0f * depth / (pass.projection.m[1][1] * pixels);
+    pass.show_grid = show_grid;
+    pass.grid_line_width = grid_line_width;
+    for (int i = 0; i < 3; i++) pass.grid_color[i] = grid_color[i];
+    pass.samples = quality == RenderQuality::High ? HIGH_QUALITY_SAMPLES : 0;
+    pass.smooth_lines = quality != RenderQuality::Fast;
+    // Вид сверху без поворота: тайлы в мировых осях ложатся на экран без искажений
+    pass_plan_view = slot.camera->GetProjection() == MentalEngine::CameraProjection::Orthographic &&
+                     std::fabs(pass.view.m[2][2]) > 0.9999f && std::fabs(pass.view.m[0][0]) > 0.9999f;
+    current_pass = &pass;
+}
+
+/**
+ * @brief Picks the bucketed target size for a requested viewport size
+ * @private
+ * 
+ * Grows at once when the viewport no longer fits. Shrinks only after the
+ * viewport has asked for the same smaller bucket for SHRINK_DELAY_SECONDS,
+ * so dragging a splitter back and forth does not reallocate.
+ * 
+ * @param slot Viewport whose width and height were just requested
+ */
+nil Renderer::__choose_target_size(ViewportSlot& slot) {
+    const int wanted_width = RenderTargetPool::BucketSize(slot.width);
+    const int wanted_height = RenderTargetPool::BucketSize(slot.height);
+    if (wanted_width > slot.target_width || wanted_height > slot.target_height) {
+        // Второе измерение не уменьшаем сразу - это решит отложенное сжатие
+        slot.target_width = std::max(wanted_width, slot.target_width);
+        slot.target_height = std::max(wanted_height, slot.target_height);
+        slot.shrink_width = 0;
+        slot.shrink_height = 0;
+        return;
     }
-    
-    if (!viewport_initialized) {
-        InitViewport(width, height);
+    if (wanted_width == slot.target_width && wanted_height == slot.target_height) {
+        slot.shrink_width = 0;
+        slot.shrink_height = 0;
+        return;
     }
     
-    // Инициализируем шейдеры только один раз
-    if (shader_program == 0) {
-        std::cout << "Initializing shaders for the first time..." << std::endl;
-        __init_shaders();
+    const auto now = std::chrono::steady_clock::now();
+    if (wanted_width != slot.shrink_width || wanted_height != slot.shrink_height) {
+        slot.shrink_width = wanted_width;
+        slot.shrink_height = wanted_height;
+        slot.shrink_since = now;
+    } else if (std::chrono::duration<double>(now - slot.shrink_since).count() >= SHRINK_DELAY_SECONDS) {
+        slot.target_width = wanted_width;
+        slot.target_height = wanted_height;
+        slot.shrink_width = 0;
+        slot.shrink_height = 0;
+    }
+}
+
+/**
+ * @brief Gets a display name
+ * @param tier Quality tier
+ * @return const char* Static name, e.g. "Balanced"
+ */
+const char* Renderer::GetQualityName(RenderQuality tier) {
+    switch (tier) {
+        case RenderQuality::Fast: return "Fast";
+        case RenderQuality::Balanced: return "Balanced";
+        case RenderQuality::High: return "High (MSAA)";
+    }
+    return "?";
+}
+
+/**
+ * @brief Gets the part of a viewport's texture holding the image
+ * @param index Viewport index
+ * @param u Receives the used fraction of the texture width
+ * @param v Receives the used fraction of the texture height
+ */
+nil Renderer::GetViewportUV(size_t index, float& u, float& v) const {
+    u = 1.0f;
+    v = 1.0f;
+    if (index >= slots.size()) return;
+    const ViewportSlot& slot = slots[index];
+    if (slot.target_width > 0) u = static_cast<float>(slot.width) / slot.target_width;
+    if (slot.target_height > 0) v = static_cast<float>(slot.height) / slot.target_height;
+}
+
+/**
+ * @brief Decides whether the current pass must be drawn and closes it
+ * @private
+ * 
+ * Hashes everything the pass draws: size, matrices, shader generation,
+ * quality, grid settings, the composited tiles and the content hash of
+ * each batch. If the viewport's target already shows the
+ * same hash the pass is skipped. Every recorded packet is executed in
+ * order, so the hash of the last drawn pass describes the target exactly.
+ */
+nil Renderer::__finish_pass() {
+    if (!current_pass) return;
+    ViewportPass& pass = *current_pass;
+    current_pass = nullptr;
+    
+    uint64_t hash = __hash_value(FNV_OFFSET, pass.width);
+    hash = __hash_value(hash, pass.height);
+    hash = __hash_value(hash, pass.target_width);
+    hash = __hash_value(hash, pass.target_height);
+    hash = __hash_bytes(hash, pass.view.data(), 16 * sizeof(float));
+    hash = __hash_bytes(hash, pass.projection.data(), 16 * sizeof(float));
+    hash = __hash_value(hash, shader_generation.load(std::memory_order_relaxed));
+    hash = __hash_value(hash, pass.samples);
+    hash = __hash_value(hash, pass.smooth_lines);
+    hash = __hash_value(hash, pass.show_grid);
+    if (pass.show_grid) {
+        hash = __hash_value(hash, pass.grid_line_width);
+        hash = __hash_bytes(hash, pass.grid_color, sizeof(pass.grid_color));
+    }
+    for (size_t i = pass.first_tile; i < pass.first_tile + pass.tile_count; i++) {
+        const TileDraw& tile = recording->tile_draws[i];
+        hash = __hash_value(hash, tile.slot);
+        hash = __hash_value(hash, tile.content_hash);
+        // Поля по отдельности: байты выравнивания структуры не инициализированы
+        hash = __hash_bytes(hash, &tile.min_x, 8 * sizeof(float));
+    }
+    pass.command_count = recording->commands.size() - pass.first_command;
+    for (size_t i = pass.first_command; i < recording->commands.size(); i++) {
+        const RenderCommand& command = recording->commands[i];
+        hash = __hash_value(hash, command.key);
+        hash = __hash_value(hash, recording->batches[command.batch].content_hash);
     }
     
-    // Рендерим содержимое в framebuffer
-    glBindFramebuffer(GL_FRAMEBUFFER, viewport_framebuffer);
-    glViewport(0, 0, viewport_width, viewport_height);
-    __render_viewport_content();
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    ViewportSlot& slot = slots[pass.viewport];
+    pass.redraw = !slot.presented || slot.presented_hash != hash;
+    slot.presented_hash = hash;
+    slot.presented = true;
 }
 
 /**
- * @brief Initializes the OpenGL viewport framebuffer
+ * @brief Adds a command drawing a recorded batch to the current pass
  * @private
  * 
- * Creates and configures the OpenGL framebuffer, texture, and renderbuffer
- * objects needed for viewport rendering. Sets up proper texture parameters
- * and framebuffer attachments.
+ * Batches are lines: they use the line program (the scene variant for
+ * resident batches), are blended when the pass draws smooth lines, and
+ * their material is the line width.
+ * 
+ * @param batch Index in the packet's batches
+ * @param layer Draw layer
+ * @param depth Normalized depth within the layer
  */
-nil Renderer::__init_viewport() {
-    // Создаем framebuffer
-    glGenFramebuffers(1, &viewport_framebuffer);
-    glBindFramebuffer(GL_FRAMEBUFFER, viewport_framebuffer);
+nil Renderer::__add_to_pass(size_t batch, RenderLayer layer, float depth) {
+    if (!current_pass) return;
+    const RenderStage stage = current_pass->smooth_lines ? RenderStage::Translucent : RenderStage::Opaque;
+    const LineBatch& recorded = recording->batches[batch];
+    const RenderProgram program = recorded.resident ? RenderProgram::SceneLines : RenderProgram::Lines;
+    RenderCommand command;
+    command.key = RenderCommand::MakeKey(current_pass->viewport, layer, stage, program, __line_material(recorded.width), depth);
+    command.batch = static_cast<uint32_t>(batch);
+    recording->commands.push_back(command);
+}
+
+/**
+ * @brief Drops commands of skipped passes and sorts the rest by key
+ * @private
+ * 
+ * A viewport has one pass per frame, so after sorting its commands are
+ * contiguous again; each pass's range is updated to the sorted position.
+ */
+nil Renderer::__sort_commands() {
+    std::vector<RenderCommand>& commands = recording->commands;
+    ViewportPass* passes[RenderCommand::MAX_VIEWPORTS] = {};
+    for (size_t i = 0; i < recording->pass_count; i++) {
+        ViewportPass& pass = recording->passes[i];
+        pass.command_count = 0;
+        if (pass.redraw) passes[pass.viewport] = &pass;
+    }
     
-    // Создаем texture для цвета
-    glGenTextures(1, &viewport_texture);
-    glBindTexture(GL_TEXTURE_2D, viewport_texture);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, viewport_width, viewport_height, 0, GL_RGB, GL_UNSIGNED_BYTE, nullptr);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, viewport_texture, 0);
+    // Команды пропущенных проходов не рисуются - не сортируем их
+    commands.erase(std::remove_if(commands.begin(), commands.end(), [&](const RenderCommand& command) {
+        return passes[RenderCommand::GetViewport(command.key)] == nullptr;
+    }), commands.end());
+    RenderCommand::Sort(commands, recording->command_scratch);
+    
+    for (size_t i = 0; i < commands.size(); i++) {
+        ViewportPass& pass = *passes[RenderCommand::GetViewport(commands[i].key)];
+        if (pass.command_count == 0) pass.first_command = i;
+        pass.command_count++;
+    }
+}
+
+/**
+ * @brief Creates the OpenGL framebuffer objects of every viewport slot
+ * @private
+ * 
+ * Creates the framebuffer and color texture of each slot. The names stay
+ * the same for the renderer's lifetime; color storage is specified when a
+ * viewport is first drawn and when its size bucket changes, and depth comes
+ * from the target pool.
+ */
+nil Renderer::__init_viewports() {
+    for (ViewportTarget& target : targets) {
+        glGenFramebuffers(1, &target.framebuffer);
+        glGenTextures(1, &target.texture);
+        
+        glBindTexture(GL_TEXTURE_2D, target.texture);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+/**
+ * @brief Reallocates a target's color storage, keeping the object names
+ * @private
+ * 
+ * @param target Viewport target
+ * @param width New bucketed width in pixels; 0 releases the storage
+ * @param height New bucketed height in pixels; 0 releases the storage
+ */
+nil Renderer::__resize_viewport(ViewportTarget& target, int width, int height) {
+    // Учет видеопамяти: RGB8 цвет; глубину учитывает пул
+    const int64_t old_pixels = static_cast<int64_t>(target.width) * target.height;
+    const int64_t new_pixels = static_cast<int64_t>(width) * height;
+    MentalEngine::MemoryTracker::AddGpuMemory(MentalEngine::GpuMemoryKind::Texture, 3 * (new_pixels - old_pixels));
+    target.width = width;
+    target.height = height;
+    
+    gl_state.BindFramebuffer(GL_FRAMEBUFFER, target.framebuffer);
+    
+    // Texture для цвета
+    gl_state.BindTexture2D(target.texture);
+    // Формат задан явно (RGB8), resolve из MSAA требует совпадения форматов
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB8, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, nullptr);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, target.texture, 0);
+}
+
+/**
+ * @brief Attaches the pooled depth buffer matching the target's size
+ * @private
+ * 
+ * Does nothing if the right buffer is already attached, which is the
+ * common case; targets without storage get no depth buffer.
+ * 
+ * @param target Viewport target
+ */
+nil Renderer::__attach_depth(ViewportTarget& target) {
+    const GLuint depth = target.width > 0 && target.height > 0 ? target_pool.AcquireDepth(target.width, target.height) : 0;
+    if (depth == target.depth) return;
+    target.depth = depth;
     
-    // Создаем renderbuffer для глубины
-    glGenRenderbuffers(1, &viewport_renderbuffer);
-    glBindRenderbuffer(GL_RENDERBUFFER, viewport_renderbuffer);
-    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, viewport_width, viewport_height);
-    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, viewport_renderbuffer);
+    gl_state.BindFramebuffer(GL_FRAMEBUFFER, target.framebuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, depth);
     
-    // Проверяем статус framebuffer
-    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+    // Проверяем статус framebuffer; пустой target неполон намеренно
+    if (depth != 0 && glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
         std::cerr << "Ошибка: Framebuffer не завершен!" << std::endl;
     }
-    
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
 }
 
 /**
  * @brief Cleans up viewport OpenGL resources
  * @private
  * 
- * Deletes all OpenGL objects associated with the viewport including
- * framebuffer, texture, and renderbuffer objects.
+ * Deletes the framebuffer and texture objects of every viewport slot and
+ * the pooled depth buffers.
  */
-nil Renderer::__cleanup_viewport() {
-    if (viewport_framebuffer) {
-        glDeleteFramebuffers(1, &viewport_framebuffer);
-        viewport_framebuffer = 0;
+nil Renderer::__cleanup_viewports() {
+    for (ViewportTarget& target : targets) {
+        if (target.framebuffer) glDeleteFramebuffers(1, &target.framebuffer);
+        if (target.texture) glDeleteTextures(1, &target.texture);
+        const int64_t pixels = static_cast<int64_t>(target.width) * target.height;
+        MentalEngine::MemoryTracker::AddGpuMemory(MentalEngine::GpuMemoryKind::Texture, -3 * pixels);
+        target = ViewportTarget();
     }
-    if (viewport_texture) {
-        glDeleteTextures(1, &viewport_texture);
-        viewport_texture = 0;
-    }
-    if (viewport_renderbuffer) {
-        glDeleteRenderbuffers(1, &viewport_renderbuffer);
-        viewport_renderbuffer = 0;
-    }
-    viewport_initialized = false;
+    target_pool.Clear();
 }
 
 /**
  * @brief Initializes and compiles OpenGL shaders
  * @private
  * 
- * Creates, compiles, and links vertex and fragment shaders for basic
- * rendering operations. Includes error checking and logging for shader
- * compilation and linking.
+ * Loads the shader files from shader_directory and requests the programs
+ * from the shader cache. They share the vertex stage (basic.vert): one is
+ * for filled geometry, and one has a geometry shader (line.geom) expanding
+ * each line segment into a screen-space quad. The quad is widened by a
+ * one-pixel feather and carries the signed distance from the line's center
+ * in pixels, so the fragment shader (line.frag) can compute edge coverage
+ * analytically instead of relying on glLineWidth(), which core profiles may
+ * clamp to 1.0. The hard-edged variant (HARD_EDGES) drops the feather.
+ * 
+ * Nothing waits here: programs load from disk binaries or build in the
+ * background, and __use_program() waits only for the ones a pass draws
+ * with. Also starts the file watcher and queries the sample limit for MSAA.
  */
 nil Renderer::__init_shaders() {
     std::cout << "Initializing shaders..." << std::endl;
     
-    // Vertex shader with camera support
-    const char* vertex_shader_source = R"(
-        #version 330 core
-        layout (location = 0) in vec3 aPos;
-        layout (location = 1) in vec3 aColor;
+    basic_shader = ShaderBinding();
+    basic_shader.name = "BASIC";
+    basic_shader.stage_files[0] = "basic.vert";
+    basic_shader.stage_files[2] = "basic.frag";
+    
+    // Оба варианта линий строятся сразу: переключение качества не ждет компиляции
+    for (int smooth = 0; smooth < 2; smooth++) {
+        ShaderBinding& binding = line_shaders[smooth];
+        binding = ShaderBinding();
+        binding.name = smooth ? "LINE" : "LINE_HARD";
+        binding.stage_files[0] = "basic.vert";
+        binding.stage_files[1] = "line.geom";
+        binding.stage_files[2] = "line.frag";
+        binding.defines = smooth ? "" : "#define HARD_EDGES\n";
         
-        uniform mat4 uViewMatrix;
-        uniform mat4 uProjectionMatrix;
-        uniform mat4 uModelMatrix;
-        
-        out vec3 vertexColor;
-        
-        void main() {
-            gl_Position = uProjectionMatrix * uViewMatrix * uModelMatrix * vec4(aPos, 1.0);
-            vertexColor = aColor;
+        ShaderBinding& scene_binding = scene_line_shaders[smooth];
+        scene_binding = binding;
+        scene_binding.name = smooth ? "SCENE_LINE" : "SCENE_LINE_HARD";
+        scene_binding.stage_files[0] = "scene.vert";
+    }
+    
+    tile_shader = ShaderBinding();
+    tile_shader.name = "TILE";
+    tile_shader.stage_files[0] = "tile.vert";
+    tile_shader.stage_files[2] = "tile.frag";
+    
+    // Исходники читаются из файлов, чтобы шейдеры можно было править без пересборки
+    ShaderBinding* bindings[] = {&basic_shader, &line_shaders[0], &line_shaders[1], &scene_line_shaders[0], &scene_line_shaders[1], &tile_shader};
+    shader_files.clear();
+    for (ShaderBinding* binding : bindings) {
+        for (const char* file : binding->stage_files) {
+            if (!file || shader_files.count(file)) continue;
+            std::string text;
+            if (!ShaderWatcher::ReadFile(shader_directory + "/" + file, text)) {
+                std::cerr << "Ошибка: не удалось прочитать шейдер " << shader_directory << "/" << file << std::endl;
+                continue;
+            }
+            shader_files.emplace(file, std::move(text));
         }
-    )";
-    
-    // Простой fragment shader
-    const char* fragment_shader_source = R"(
-        #version 330 core
-        in vec3 vertexColor;
-        out vec4 FragColor;
-        void main() {
-            FragColor = vec4(vertexColor, 1.0);
+    }
+    
+    shader_cache.Init(shader_cache_directory);
+    for (ShaderBinding* binding : bindings) {
+        binding->handle = __request_program(*binding);
+    }
+    
+    if (shader_hot_reload && !shader_watcher.Start(shader_directory, [] { glfwPostEmptyEvent(); })) {
+        std::cerr << "Предупреждение: не удалось следить за " << shader_directory << ", hot reload отключен" << std::endl;
+    }
+    
+    glGetIntegerv(GL_MAX_SAMPLES, &max_samples);
+    shaders_requested = true;
+}
+
+/**
+ * @brief Requests a binding's program from the shader cache with the current file sources
+ * @private
+ * 
+ * @param binding Program description
+ * @return ShaderCache::Handle Handle, INVALID_HANDLE if a stage file could not be read
+ */
+ShaderCache::Handle Renderer::__request_program(const ShaderBinding& binding) {
+    const char* sources[3] = {nullptr, nullptr, nullptr};
+    for (int i = 0; i < 3; i++) {
+        if (!binding.stage_files[i]) continue;
+        auto file = shader_files.find(binding.stage_files[i]);
+        if (file == shader_files.end()) return ShaderCache::INVALID_HANDLE;
+        sources[i] = file->second.c_str();
+    }
+    return shader_cache.Request(binding.name, ShaderSource{sources[0], sources[1], sources[2]}, binding.defines);
+}
+
+/**
+ * @brief Applies edited shader files and swaps in programs that finished building
+ * @private
+ * 
+ * Runs at the start of every executed packet. Programs using an edited file
+ * are requested again and build in the background; a pass keeps drawing
+ * with the old program until the new one has linked, and the swap happens
+ * here, between frames. A build that fails is logged and dropped, and the
+ * old program stays in use.
+ */
+nil Renderer::__reload_shaders() {
+    ShaderBinding* bindings[] = {&basic_shader, &line_shaders[0], &line_shaders[1], &scene_line_shaders[0], &scene_line_shaders[1], &tile_shader};
+    if (shader_watcher.TakeChanges(shader_changes)) {
+        bool changed = false;
+        for (ShaderFileChange& change : shader_changes) {
+            // Файлы, которые не использует ни одна программа (временные файлы редактора), пропускаем
+            auto file = shader_files.find(change.name);
+            if (file == shader_files.end() || file->second == change.text) continue;
+            file->second = std::move(change.text);
+            changed = true;
+            std::cout << "Shader file changed: " << change.name << std::endl;
         }
-    )";
-    
-    // Создаем vertex shader
-    vertex_shader = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vertex_shader, 1, &vertex_shader_source, nullptr);
-    glCompileShader(vertex_shader);
-    
-    // Проверяем ошибки компиляции vertex shader
-    GLint success;
-    glGetShaderiv(vertex_shader, GL_COMPILE_STATUS, &success);
-    if (!success) {
-        char infoLog[512];
-        glGetShaderInfoLog(vertex_shader, 512, nullptr, infoLog);
-        std::cout << "ERROR::SHADER::VERTEX::COMPILATION_FAILED\n" << infoLog << std::endl;
-    }
-    
-    // Создаем fragment shader
-    fragment_shader = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(fragment_shader, 1, &fragment_shader_source, nullptr);
-    glCompileShader(fragment_shader);
-    
-    // Проверяем ошибки компиляции fragment shader
-    glGetShaderiv(fragment_shader, GL_COMPILE_STATUS, &success);
-    if (!success) {
-        char infoLog[512];
-        glGetShaderInfoLog(fragment_shader, 512, nullptr, infoLog);
-        std::cout << "ERROR::SHADER::FRAGMENT::COMPILATION_FAILED\n" << infoLog << std::endl;
-    }
-    
-    // Создаем shader program
-    shader_program = glCreateProgram();
-    glAttachShader(shader_program, vertex_shader);
-    glAttachShader(shader_program, fragment_shader);
-    glLinkProgram(shader_program);
-    
-    // Проверяем ошибки линковки
-    glGetProgramiv(shader_program, GL_LINK_STATUS, &success);
-    if (!success) {
-        char infoLog[512];
-        glGetProgramInfoLog(shader_program, 512, nullptr, infoLog);
-        std::cout << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n" << infoLog << std::endl;
-    }
-    
-    // Удаляем shader'ы, так как они уже связаны с program
-    glDeleteShader(vertex_shader);
-    glDeleteShader(fragment_shader);
-    
-    if (shader_program == 0) {
-        std::cout << "ERROR: Failed to create shader program!" << std::endl;
-    } else {
-        std::cout << "Shaders initialized successfully, program ID: " << shader_program << std::endl;
-        
-        // Get uniform locations
-        view_matrix_location = glGetUniformLocation(shader_program, "uViewMatrix");
-        projection_matrix_location = glGetUniformLocation(shader_program, "uProjectionMatrix");
-        model_matrix_location = glGetUniformLocation(shader_program, "uModelMatrix");
-        
-        if (view_matrix_location == -1 || projection_matrix_location == -1 || model_matrix_location == -1) {
-            std::cout << "Warning: Some uniform locations not found!" << std::endl;
+        for (ShaderBinding* binding : bindings) {
+            if (!changed) break;
+            bool uses_changed = false;
+            for (const ShaderFileChange& change : shader_changes) {
+                for (const char* file : binding->stage_files) {
+                    if (file && change.name == file) uses_changed = true;
+                }
+            }
+            if (!uses_changed) continue;
+            const ShaderCache::Handle handle = __request_program(*binding);
+            if (handle == binding->pending) continue;
+            // Более новая правка заменяет еще не собранную
+            if (binding->pending != ShaderCache::INVALID_HANDLE) shader_cache.Release(binding->pending);
+            // Правка вернула текущий исходник - пересобирать нечего
+            binding->pending = handle == binding->handle ? ShaderCache::INVALID_HANDLE : handle;
         }
     }
+    
+    bool reloading = false;
+    for (ShaderBinding* binding : bindings) {
+        if (binding->pending == ShaderCache::INVALID_HANDLE) continue;
+        if (!shader_cache.IsReady(binding->pending)) {
+            reloading = true;
+            continue;
+        }
+        if (shader_cache.Get(binding->pending) == 0) {
+            std::cerr << "Shader " << binding->name << " failed to rebuild, keeping the previous program" << std::endl;
+            shader_cache.Release(binding->pending);
+        } else {
+            // Подмена между кадрами: проход никогда не видит полусобранную программу
+            shader_cache.Release(binding->handle);
+            binding->handle = binding->pending;
+            binding->resolved = false;
+            shader_generation.fetch_add(1, std::memory_order_relaxed);
+            std::cout << "Shader " << binding->name << " reloaded" << std::endl;
+        }
+        binding->pending = ShaderCache::INVALID_HANDLE;
+    }
+    shaders_reloading.store(reloading, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Binds a program, waiting for the shader cache if it is still building
+ * @private
+ * 
+ * Looks the uniform locations up the first time the program is used.
+ * 
+ * @param binding Requested program
+ * @return const ProgramUniforms& Locations in the bound program; all -1 if it failed to build
+ */
+const Renderer::ProgramUniforms& Renderer::__use_program(ShaderBinding& binding) {
+    if (!binding.resolved) {
+        binding.program = shader_cache.Get(binding.handle);
+        binding.uniforms = ProgramUniforms();
+        binding.resolved = true;
+        if (binding.program == 0) {
+            std::cout << "ERROR: Failed to create shader program!" << std::endl;
+        } else {
+            // Get uniform locations
+            binding.uniforms.view_matrix = glGetUniformLocation(binding.program, "uViewMatrix");
+            binding.uniforms.projection_matrix = glGetUniformLocation(binding.program, "uProjectionMatrix");
+            binding.uniforms.model_matrix = glGetUniformLocation(binding.program, "uModelMatrix");
+            binding.uniforms.viewport_size = glGetUniformLocation(binding.program, "uViewportSize");
+            binding.uniforms.line_width = glGetUniformLocation(binding.program, "uLineWidth");
+            if (binding.uniforms.view_matrix == -1 || binding.uniforms.projection_matrix == -1 || binding.uniforms.model_matrix == -1) {
+                std::cout << "Warning: Some uniform locations not found!" << std::endl;
+            }
+        }
+    }
+    gl_state.UseProgram(binding.program);
+    return binding.uniforms;
 }
 
 /**
  * @brief Cleans up shader OpenGL resources
  * @private
  * 
- * Deletes the OpenGL shader program and associated resources.
+ * Stops the file watcher and deletes the cached shader programs.
  */
 nil Renderer::__cleanup_shaders() {
-    if (shader_program) {
-        glDeleteProgram(shader_program);
-        shader_program = 0;
+    shader_watcher.Stop();
+    shader_cache.Clear();
+    basic_shader = ShaderBinding();
+    line_shaders[0] = ShaderBinding();
+    line_shaders[1] = ShaderBinding();
+    scene_line_shaders[0] = ShaderBinding();
+    scene_line_shaders[1] = ShaderBinding();
+    tile_shader = ShaderBinding();
+    line_uniforms = nullptr;
+    shaders_requested = false;
+}
+
+/**
+ * @brief Uploads buffer data and records the upload
+ * @private
+ * 
+ * @param target Buffer binding point
+ * @param size Bytes to upload
+ * @param data Source data
+ */
+nil Renderer::__buffer_data(GLenum target, size_t size, const void* data) {
+    glBufferData(target, static_cast<GLsizeiptr>(size), data, GL_STREAM_DRAW);
+    MentalEngine::MemoryTracker::AddGpuUpload(size);
+}
+
+/**
+ * @brief Uploads the pass's camera matrices
+ * @private
+ * 
+ * @param pass Viewport pass whose view and projection matrices are used
+ * @param uniforms Locations in the program currently in use
+ */
+nil Renderer::__set_matrices(const ViewportPass& pass, const ProgramUniforms& uniforms) {
+    if (uniforms.view_matrix != -1) {
+        glUniformMatrix4fv(uniforms.view_matrix, 1, GL_FALSE, pass.view.data());
+    }
+    if (uniforms.projection_matrix != -1) {
+        glUniformMatrix4fv(uniforms.projection_matrix, 1, GL_FALSE, pass.projection.data());
+    }
+    if (uniforms.model_matrix != -1) {
+        // Identity matrix for now
+        MentalEngine::Math::Matrix4 model_matrix;
+        glUniformMatrix4fv(uniforms.model_matrix, 1, GL_FALSE, model_matrix.data());
+    }
+}
+
+/**
+ * @brief Binds the line program with the pass's matrices and edge treatment
+ * @private
+ * 
+ * Smooth lines write their coverage to alpha and are blended over what is
+ * already drawn, accumulating coverage in the target's alpha so opaque
+ * targets stay opaque and transparent ones (tiles) end up premultiplied;
+ * hard-edged lines leave blending off.
+ * 
+ * @param pass Viewport pass being drawn
+ * @param variants Hard-edged [0] and anti-aliased [1] program of the vertex format to draw
+ */
+nil Renderer::__begin_lines(const ViewportPass& pass, ShaderBinding (&variants)[2]) {
+    line_uniforms = &__use_program(variants[pass.smooth_lines ? 1 : 0]);
+    line_width_set = -1.0f;
+    __set_matrices(pass, *line_uniforms);
+    if (line_uniforms->viewport_size != -1) {
+        glUniform2f(line_uniforms->viewport_size, static_cast<float>(pass.width), static_cast<float>(pass.height));
     }
+    gl_state.SetEnabled(GL_BLEND, pass.smooth_lines);
+    if (pass.smooth_lines) {
+        // Альфа накапливается как покрытие: прозрачные цели (тайлы) получают premultiplied цвет
+        gl_state.BlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+    }
+}
+
+/**
+ * @brief Sets the bound line program's width unless it already has it
+ * @private
+ * 
+ * Neighbouring commands of one material share the width, so after sorting
+ * most draws skip the uniform.
+ * 
+ * @param line_width Line width in pixels
+ */
+nil Renderer::__set_line_width(float line_width) {
+    if (!line_uniforms || line_uniforms->line_width == -1 || line_width == line_width_set) return;
+    glUniform1f(line_uniforms->line_width, line_width);
+    line_width_set = line_width;
 }
 
 /**
@@ -253,159 +832,62 @@ nil Renderer::__cleanup_shaders() {
  * @private
  * 
  * Renders the main viewport content including a gradient background,
- * a colored triangle, and the grid overlay. Uses modern OpenGL with
- * VAOs and VBOs for efficient rendering.
+ * the grid overlay, a colored triangle, the pass's cached tiles and its
+ * line batches, using the camera state captured in the pass.
+ * 
+ * @param pass Viewport pass being drawn
+ * @param packet Frame owning the batches
  */
-nil Renderer::__render_viewport_content() {
+nil Renderer::__render_viewport_content(const ViewportPass& pass, const FramePacket& packet) {
     // Очищаем экран
-    glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+    gl_state.ClearColor(0.2f, 0.3f, 0.3f, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
     
     // Используем наш shader program
-    glUseProgram(shader_program);
-    
-    // Update camera
-    if (camera) {
-        camera->Update(viewport_width, viewport_height);
-        
-        // Set uniform matrices
-        if (view_matrix_location != -1) {
-            glUniformMatrix4fv(view_matrix_location, 1, GL_FALSE, camera->GetViewMatrix().data());
-        }
-        if (projection_matrix_location != -1) {
-            glUniformMatrix4fv(projection_matrix_location, 1, GL_FALSE, camera->GetProjectionMatrix().data());
-        }
-        if (model_matrix_location != -1) {
-            // Identity matrix for now
-            MentalEngine::Math::Matrix4 model_matrix;
-            glUniformMatrix4fv(model_matrix_location, 1, GL_FALSE, model_matrix.data());
-        }
-    }
-    
-    // Простой рендеринг - градиентный фон (используем современный OpenGL)
-    // Вершины для фона (квадрат на весь экран)
-    float background_vertices[] = {
-        -1.0f, -1.0f, 0.0f,  // левый нижний
-         1.0f, -1.0f, 0.0f,  // правый нижний
-         1.0f,  1.0f, 0.0f,  // правый верхний
-        -1.0f,  1.0f, 0.0f   // левый верхний
-    };
-    
-    // Цвета для каждой вершины (градиент)
-    float background_colors[] = {
-        0.1f, 0.1f, 0.2f,  // темно-синий
-        0.2f, 0.1f, 0.3f,  // фиолетовый
-        0.1f, 0.2f, 0.4f,  // синий
-        0.0f, 0.1f, 0.3f   // темно-синий
-    };
-    
-    // Индексы для двух треугольников
-    unsigned int background_indices[] = {
-        0, 1, 2,  // первый треугольник
-        2, 3, 0   // второй треугольник
+    __set_matrices(pass, __use_program(basic_shader));
+    
+    // Простой рендеринг - градиентный фон (квадрат на весь экран)
+    // Позиция и цвет каждой вершины (градиент), веер из двух треугольников
+    const float background_vertices[] = {
+        -1.0f, -1.0f, 0.0f,  0.1f, 0.1f, 0.2f,  // левый нижний, темно-синий
+         1.0f, -1.0f, 0.0f,  0.2f, 0.1f, 0.3f,  // правый нижний, фиолетовый
+         1.0f,  1.0f, 0.0f,  0.1f, 0.2f, 0.4f,  // правый верхний, синий
+        -1.0f,  1.0f, 0.0f,  0.0f, 0.1f, 0.3f   // левый верхний, темно-синий
     };
-    
-    // Создаем VAO (обязательно в современном OpenGL)
-    GLuint VAO, VBO, colorVBO, EBO;
-    glGenVertexArrays(1, &VAO);
-    glGenBuffers(1, &VBO);
-    glGenBuffers(1, &colorVBO);
-    glGenBuffers(1, &EBO);
-    
-    // Привязываем VAO
-    glBindVertexArray(VAO);
-    
-    // Загружаем данные вершин
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(background_vertices), background_vertices, GL_STATIC_DRAW);
-    
-    // Загружаем данные цветов
-    glBindBuffer(GL_ARRAY_BUFFER, colorVBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(background_colors), background_colors, GL_STATIC_DRAW);
-    
-    // Загружаем индексы
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(background_indices), background_indices, GL_STATIC_DRAW);
-    
-    // Настраиваем атрибуты вершин
-    glEnableVertexAttribArray(0);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, (void*)0);
-    
-    glEnableVertexAttribArray(1);
-    glBindBuffer(GL_ARRAY_BUFFER, colorVBO);
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 0, (void*)0);
-    
-    // Рендерим фон
-    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
-    
-    // Отключаем атрибуты
-    glDisableVertexAttribArray(0);
-    glDisableVertexAttribArray(1);
-    
-    // Отвязываем VAO
-    glBindVertexArray(0);
-    
-    // Очищаем буферы
-    glDeleteVertexArrays(1, &VAO);
-    glDeleteBuffers(1, &VBO);
-    glDeleteBuffers(1, &colorVBO);
-    glDeleteBuffers(1, &EBO);
+    __draw_vertices(GL_TRIANGLE_FAN, background_vertices, 4);
     
     // Рендерим сетку
-    __render_grid();
+    __begin_lines(pass, line_shaders);
+    __render_grid(pass);
+    __use_program(basic_shader);
     
     // Рисуем простой треугольник в центре
-    float triangle_vertices[] = {
-         0.0f,  0.5f, 0.0f,  // верх
-        -0.5f, -0.5f, 0.0f,  // левый нижний
-         0.5f, -0.5f, 0.0f   // правый нижний
+    const float triangle_vertices[] = {
+         0.0f,  0.5f, 0.0f,  1.0f, 0.5f, 0.0f,  // верх, оранжевый
+        -0.5f, -0.5f, 0.0f,  0.0f, 1.0f, 0.5f,  // левый нижний, зеленый
+         0.5f, -0.5f, 0.0f,  0.5f, 0.0f, 1.0f   // правый нижний, фиолетовый
     };
-    
-    float triangle_colors[] = {
-        1.0f, 0.5f, 0.0f,  // оранжевый
-        0.0f, 1.0f, 0.5f,  // зеленый
-        0.5f, 0.0f, 1.0f   // фиолетовый
-    };
-    
-    // Создаем VAO для треугольника
-    glGenVertexArrays(1, &VAO);
-    glGenBuffers(1, &VBO);
-    glGenBuffers(1, &colorVBO);
-    
-    // Привязываем VAO
-    glBindVertexArray(VAO);
-    
-    // Загружаем данные треугольника
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(triangle_vertices), triangle_vertices, GL_STATIC_DRAW);
-    
-    glBindBuffer(GL_ARRAY_BUFFER, colorVBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(triangle_colors), triangle_colors, GL_STATIC_DRAW);
-    
-    // Настраиваем атрибуты
-    glEnableVertexAttribArray(0);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, (void*)0);
-    
-    glEnableVertexAttribArray(1);
-    glBindBuffer(GL_ARRAY_BUFFER, colorVBO);
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 0, (void*)0);
-    
-    // Рендерим треугольник
-    glDrawArrays(GL_TRIANGLES, 0, 3);
-    
-    // Отключаем атрибуты
-    glDisableVertexAttribArray(0);
-    glDisableVertexAttribArray(1);
-    
-    // Отвязываем VAO
-    glBindVertexArray(0);
-    
-    // Очищаем буферы
-    glDeleteVertexArrays(1, &VAO);
-    glDeleteBuffers(1, &VBO);
-    glDeleteBuffers(1, &colorVBO);
+    __draw_vertices(GL_TRIANGLES, triangle_vertices, 3);
+    
+    // Геометрия сцены поверх фона, в порядке ключей команд
+    // Треугольник оставил привязанной basic программу
+    RenderProgram program = RenderProgram::Basic;
+    if (pass.tile_count > 0) {
+        __composite_tiles(pass, packet);
+        program = RenderProgram::Tiles;
+    }
+    for (size_t i = pass.first_command; i < pass.first_command + pass.command_count; i++) {
+        const RenderCommand& command = packet.commands[i];
+        const RenderProgram wanted = RenderCommand::GetProgram(command.key);
+        if (wanted != program) {
+            // Программа меняется только на границе групп ключей
+            if (wanted == RenderProgram::Lines) __begin_lines(pass, line_shaders);
+            if (wanted == RenderProgram::SceneLines) __begin_lines(pass, scene_line_shaders);
+            program = wanted;
+        }
+        __draw_lines(packet.batches[command.batch]);
+    }
+    gl_state.SetEnabled(GL_BLEND, false);
 }
 
 /**
@@ -413,32 +895,14 @@ nil Renderer::__render_viewport_content() {
  * @private
  * 
  * Renders a configurable grid overlay on top of the viewport content.
- * Grid properties such as visibility, cell size, and color can be
- * controlled through the public interface methods.
+ * Grid visibility, line width and color come from the pass, which copied
+ * them from the public interface settings when the frame was recorded.
+ * Expects the line program to be bound by __begin_lines().
+ * 
+ * @param pass Viewport pass being drawn
  */
-nil Renderer::__render_grid() {
-    if (!show_grid) return;
-    
-    // Используем наш shader program
-    glUseProgram(shader_program);
-    
-    // Set uniform matrices for grid
-    if (camera) {
-        if (view_matrix_location != -1) {
-            glUniformMatrix4fv(view_matrix_location, 1, GL_FALSE, camera->GetViewMatrix().data());
-        }
-        if (projection_matrix_location != -1) {
-            glUniformMatrix4fv(projection_matrix_location, 1, GL_FALSE, camera->GetProjectionMatrix().data());
-        }
-        if (model_matrix_location != -1) {
-            // Identity matrix for grid
-            MentalEngine::Math::Matrix4 model_matrix;
-            glUniformMatrix4fv(model_matrix_location, 1, GL_FALSE, model_matrix.data());
-        }
-    }
-    
-    // Устанавливаем толщину линий сетки
-    glLineWidth(grid_line_width);
+nil Renderer::__render_grid(const ViewportPass& pass) {
+    if (!pass.show_grid) return;
     
     // Простая сетка с фиксированным размером
     float cell_size = 0.15f; // 15% от размера viewport
@@ -447,9 +911,10 @@ nil Renderer::__render_grid() {
     int num_vertical = (int)(2.0f / cell_size) + 1;
     int num_horizontal = (int)(2.0f / cell_size) + 1;
     
-    // Создаем массивы для вершин и цветов
-    std::vector<float> vertices;
-    std::vector<float> colors;
+    // Вершины с цветом подряд (память кадра, без обращений к куче)
+    MentalEngine::ArenaVector<float> vertices{MentalEngine::ArenaAllocator<float>(gl_arena)};
+    vertices.reserve(2 * STREAM_VERTEX_FLOATS * (num_vertical + num_horizontal));
+    const float* color = pass.grid_color;
     
     // Генерируем вертикальные линии
     for (int i = 0; i < num_vertical; i++) {
@@ -457,12 +922,8 @@ nil Renderer::__render_grid() {
         if (x > 1.0f) x = 1.0f;
         
         // Две вершины для линии
-        vertices.push_back(x); vertices.push_back(-1.0f); vertices.push_back(0.0f);
-        vertices.push_back(x); vertices.push_back(1.0f); vertices.push_back(0.0f);
-        
-        // Цвет для обеих вершин
-        colors.push_back(grid_color[0]); colors.push_back(grid_color[1]); colors.push_back(grid_color[2]);
-        colors.push_back(grid_color[0]); colors.push_back(grid_color[1]); colors.push_back(grid_color[2]);
+        vertices.insert(vertices.end(), {x, -1.0f, 0.0f, color[0], color[1], color[2]});
+        vertices.insert(vertices.end(), {x, 1.0f, 0.0f, color[0], color[1], color[2]});
     }
     
     // Генерируем горизонтальные линии
@@ -471,159 +932,692 @@ nil Renderer::__render_grid() {
         if (y > 1.0f) y = 1.0f;
         
         // Две вершины для линии
-        vertices.push_back(-1.0f); vertices.push_back(y); vertices.push_back(0.0f);
-        vertices.push_back(1.0f); vertices.push_back(y); vertices.push_back(0.0f);
-        
-        // Цвет для обеих вершин
-        colors.push_back(grid_color[0]); colors.push_back(grid_color[1]); colors.push_back(grid_color[2]);
-        colors.push_back(grid_color[0]); colors.push_back(grid_color[1]); colors.push_back(grid_color[2]);
+        vertices.insert(vertices.end(), {-1.0f, y, 0.0f, color[0], color[1], color[2]});
+        vertices.insert(vertices.end(), {1.0f, y, 0.0f, color[0], color[1], color[2]});
     }
     
-    // Создаем VAO для сетки
-    GLuint VAO, VBO, colorVBO;
-    glGenVertexArrays(1, &VAO);
-    glGenBuffers(1, &VBO);
-    glGenBuffers(1, &colorVBO);
+    __draw_line_vertices(vertices.data(), vertices.size() / STREAM_VERTEX_FLOATS, pass.grid_line_width);
+}
+
+/**
+ * @brief Records lines drawn into the viewport
+ * 
+ * Copies the points into a new batch of the recording packet. Each pair of
+ * points represents a line segment; the batch is drawn with the packet's
+ * camera matrices when the frame is executed.
+ * 
+ * @param points Vector of line points (pairs of start/end points)
+ * @param color Line color (RGB)
+ * @param line_width Line width in pixels
+ * @param layer Draw layer
+ */
+nil Renderer::RenderLines(const std::vector<MentalEngine::Math::Vector2>& points, const MentalEngine::Math::Vector3& color, float line_width, RenderLayer layer) {
+    RenderLines(points.data(), points.size(), color, line_width, layer);
+}
+
+/**
+ * @brief Records lines drawn into the viewport
+ * 
+ * Pointer-based overload for callers that keep points on the stack or in a
+ * frame arena.
+ * 
+ * @param points Line points (pairs of start/end points)
+ * @param count Number of points
+ * @param color Line color (RGB)
+ * @param line_width Line width in pixels
+ * @param layer Draw layer
+ */
+nil Renderer::RenderLines(const MentalEngine::Math::Vector2* points, size_t count, const MentalEngine::Math::Vector3& color, float line_width, RenderLayer layer) {
+    MentalEngine::MemoryTagScope tag(MentalEngine::MemoryTag::Renderer);
+    __record_lines(points, count, color, line_width, layer, 0.0f);
+}
+
+/**
+ * @brief Adds draws prepared in a command list to the current viewport pass
+ * 
+ * The list's points are copied into the packet, so the list can be cleared
+ * and refilled for the next frame right after this call.
+ * 
+ * @param list Draws built on any thread
+ */
+nil Renderer::Submit(const RenderCommandList& list) {
+    MentalEngine::MemoryTagScope tag(MentalEngine::MemoryTag::Renderer);
+    for (size_t i = 0; i < list.GetEntryCount(); i++) {
+        const RenderCommandList::Entry& entry = list.GetEntry(i);
+        __record_lines(list.GetPoints(entry), entry.point_count, entry.color, entry.width, entry.layer, entry.depth);
+    }
+}
+
+/**
+ * @brief Records a line batch into the current pass
+ * @private
+ * 
+ * Copies the points into a new batch of the recording packet and adds its
+ * command; does nothing outside a pass or for an odd point count.
+ * 
+ * @param points Line points (pairs of start/end points)
+ * @param count Number of points
+ * @param color Line color (RGB)
+ * @param line_width Line width in pixels
+ * @param layer Draw layer
+ * @param depth Normalized depth within the layer
+ */
+nil Renderer::__record_lines(const MentalEngine::Math::Vector2* points, size_t count, const MentalEngine::Math::Vector3& color, float line_width, RenderLayer layer, float depth) {
+    if (!recording || !current_pass || count == 0 || count % 2 != 0) return;
+    
+    LineBatch& batch = recording->NextBatch(count);
+    std::copy(points, points + count, batch.points);
+    batch.color = color;
+    batch.width = line_width;
+    batch.content_hash = __hash_bytes(__hash_style(color, line_width), points, count * sizeof(*points));
+    __add_to_pass(recording->batch_count - 1, layer, depth);
+}
+
+/**
+ * @brief Records the segments of one primitive drawn into the viewport
+ * 
+ * Writes the segments straight into the packet arena, without a temporary
+ * vector.
+ * 
+ * @param scene Scene containing the primitive
+ * @param id Primitive to draw; ignored if stale
+ * @param color Line color (RGB)
+ * @param line_width Line width in pixels
+ * @param layer Draw layer
+ */
+nil Renderer::RenderPrimitive(const MentalEngine::Scene& scene, MentalEngine::PrimitiveId id, const MentalEngine::Math::Vector3& color, float line_width, RenderLayer layer) {
+    MentalEngine::MemoryTagScope tag(MentalEngine::MemoryTag::Renderer);
+    if (!recording || !current_pass || !scene.Contains(id)) return;
+    
+    LineBatch& batch = recording->NextBatch(2 * scene.GetSegmentCount(id));
+    scene.WriteSegments(id, batch.points);
+    batch.color = color;
+    batch.width = line_width;
+    batch.content_hash = __hash_bytes(__hash_style(color, line_width), batch.points, batch.count * sizeof(*batch.points));
+    __add_to_pass(recording->batch_count - 1, layer);
+}
+
+/**
+ * @brief Draws one recorded line batch
+ * @private
+ * 
+ * Expects the line program matching the batch to be bound by
+ * __begin_lines(). Resident batches draw the scene buffers with the batch's
+ * color as a constant vertex attribute.
+ * 
+ * @param batch Line segments with their color and width
+ */
+nil Renderer::__draw_lines(const LineBatch& batch) {
+    if (batch.resident) {
+        __set_line_width(batch.width);
+        glVertexAttrib3f(1, batch.color.x, batch.color.y, batch.color.z);
+        gpu_scene.Draw();
+        return;
+    }
+    if (batch.count == 0) return;
+    const MentalEngine::Math::Vector2* points = batch.points;
+    const MentalEngine::Math::Vector3& color = batch.color;
     
-    // Привязываем VAO
-    glBindVertexArray(VAO);
+    // Вершины с цветом подряд (память кадра, без обращений к куче)
+    MentalEngine::ArenaVector<float> vertices{MentalEngine::ArenaAllocator<float>(gl_arena)};
+    vertices.reserve(STREAM_VERTEX_FLOATS * batch.count);
     
-    // Загружаем данные вершин
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
+    // Конвертируем 2D точки в 3D (Z = 0) и добавляем цвета
+    for (size_t i = 0; i < batch.count; i++) {
+        vertices.insert(vertices.end(), {points[i].x, points[i].y, 0.0f, color.x, color.y, color.z});
+    }
     
-    // Загружаем данные цветов
-    glBindBuffer(GL_ARRAY_BUFFER, colorVBO);
-    glBufferData(GL_ARRAY_BUFFER, colors.size() * sizeof(float), colors.data(), GL_STATIC_DRAW);
+    __draw_line_vertices(vertices.data(), batch.count, batch.width);
+}
+
+/**
+ * @brief Draws line segments given as interleaved vertices
+ * @private
+ * 
+ * Width goes to the line program as a uniform; the geometry shader widens
+ * each segment, so no glLineWidth() is needed.
+ * 
+ * @param vertices STREAM_VERTEX_FLOATS floats per vertex, two vertices per segment
+ * @param vertex_count Number of vertices
+ * @param line_width Line width in pixels
+ */
+nil Renderer::__draw_line_vertices(const float* vertices, size_t vertex_count, float line_width) {
+    __set_line_width(line_width);
+    // Рендерим линии; geometry shader превращает каждую в прямоугольник
+    __draw_vertices(GL_LINES, vertices, vertex_count);
+}
+
+/**
+ * @brief Creates the shaders and stream buffer on first use
+ * @private
+ * 
+ * Must run on the thread with the GL context, before anything is drawn.
+ */
+nil Renderer::__prepare_drawing() {
+    // Инициализируем шейдеры только один раз, на потоке с контекстом
+    if (!shaders_requested) {
+        std::cout << "Initializing shaders for the first time..." << std::endl;
+        __init_shaders();
+    }
+    if (!stream_vao) __init_stream_buffer();
+}
+
+/**
+ * @brief Creates the vertex array and buffer every draw streams through
+ * @private
+ * 
+ * Attribute 0 is the xyz position and attribute 1 the rgb color of
+ * interleaved vertices. The layout is set once here; draws only re-specify
+ * the buffer's contents, so they need no attribute or vertex array setup.
+ */
+nil Renderer::__init_stream_buffer() {
+    glGenVertexArrays(1, &stream_vao);
+    glGenBuffers(1, &stream_buffer);
     
-    // Настраиваем атрибуты
+    gl_state.BindVertexArray(stream_vao);
+    gl_state.BindBuffer(GL_ARRAY_BUFFER, stream_buffer);
+    const GLsizei stride = static_cast<GLsizei>(STREAM_VERTEX_FLOATS * sizeof(float));
     glEnableVertexAttribArray(0);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, (void*)0);
-    
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, (void*)0);
     glEnableVertexAttribArray(1);
-    glBindBuffer(GL_ARRAY_BUFFER, colorVBO);
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 0, (void*)0);
-    
-    // Рендерим линии
-    glDrawArrays(GL_LINES, 0, vertices.size() / 3);
-    
-    // Отключаем атрибуты
-    glDisableVertexAttribArray(0);
-    glDisableVertexAttribArray(1);
-    
-    // Отвязываем VAO
-    glBindVertexArray(0);
-    
-    // Очищаем буферы
-    glDeleteVertexArrays(1, &VAO);
-    glDeleteBuffers(1, &VBO);
-    glDeleteBuffers(1, &colorVBO);
-    
-    // Сбрасываем толщину линии
-    glLineWidth(1.0f);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, stride, (void*)(3 * sizeof(float)));
+}
+
+/**
+ * @brief Deletes the stream vertex array and buffer
+ * @private
+ */
+nil Renderer::__cleanup_stream_buffer() {
+    if (stream_vao) glDeleteVertexArrays(1, &stream_vao);
+    if (stream_buffer) glDeleteBuffers(1, &stream_buffer);
+    MentalEngine::MemoryTracker::AddGpuMemory(MentalEngine::GpuMemoryKind::Buffer, -static_cast<int64_t>(stream_bytes));
+    stream_vao = 0;
+    stream_buffer = 0;
+    stream_bytes = 0;
 }
 
 /**
- * @brief Renders lines from a list of points
+ * @brief Uploads interleaved vertices to the stream buffer and draws them
+ * @private
  * 
- * Renders lines using the provided points. Each pair of points represents
- * a line segment. Uses the current shader program and camera matrices.
+ * Re-specifying the whole buffer lets the driver hand out fresh storage
+ * instead of waiting for draws still reading the previous contents.
  * 
- * @param points Vector of line points (pairs of start/end points)
+ * @param mode Primitive type
+ * @param vertices STREAM_VERTEX_FLOATS floats per vertex
+ * @param vertex_count Number of vertices
+ */
+nil Renderer::__draw_vertices(GLenum mode, const float* vertices, size_t vertex_count) {
+    if (vertex_count == 0) return;
+    const size_t size = STREAM_VERTEX_FLOATS * vertex_count * sizeof(float);
+    gl_state.BindVertexArray(stream_vao);
+    gl_state.BindBuffer(GL_ARRAY_BUFFER, stream_buffer);
+    __buffer_data(GL_ARRAY_BUFFER, size, vertices);
+    if (size != stream_bytes) {
+        MentalEngine::MemoryTracker::AddGpuMemory(MentalEngine::GpuMemoryKind::Buffer, static_cast<int64_t>(size) - static_cast<int64_t>(stream_bytes));
+        stream_bytes = size;
+    }
+    gl_state.DrawArrays(mode, 0, static_cast<GLsizei>(vertex_count));
+}
+
+/**
+ * @brief Records all scene geometry drawn into the viewport
+ * 
+ * Adds a batch standing for the scene to the current pass. The batch is
+ * identified by the scene's revision, color and width, so the same scene
+ * recorded for several viewports in one frame is shared, and tessellation
+ * is deferred to EndPacket(), where it is skipped if no pass drawing it
+ * needs a redraw.
+ * 
+ * Zoomed out far enough, a large scene is drawn from the SceneLod level
+ * matching the pass's pixel size instead (see SetLevelOfDetail()); in a
+ * plan view it is composited from cached tiles (see SetTiledPlanViews()).
+ * 
+ * @param scene Scene whose lines and arcs are drawn; must not change before EndPacket()
  * @param color Line color (RGB)
  * @param line_width Line width in pixels
+ * @param layer Draw layer
  */
-nil Renderer::RenderLines(const std::vector<MentalEngine::Math::Vector2>& points, const MentalEngine::Math::Vector3& color, float line_width) {
-    if (points.empty() || points.size() % 2 != 0) return;
-    
-    // Используем наш shader program
-    glUseProgram(shader_program);
+nil Renderer::RenderScene(const MentalEngine::Scene& scene, const MentalEngine::Math::Vector3& color, float line_width, RenderLayer layer) {
+    MentalEngine::MemoryTagScope tag(MentalEngine::MemoryTag::Renderer);
+    if (!recording || !current_pass || scene.GetPrimitiveCount() == 0) return;
+    
+    const MentalEngine::Scene* source = &scene;
+    const MentalEngine::SceneLod::Level* lod = nullptr;
+    if (level_of_detail && scene.GetPrimitiveCount() >= LOD_MIN_PRIMITIVES) lod = scene_lod.GetLevel(scene, pass_pixel_size);
+    scene_level = lod ? lod->level : 0;
+    scene_level_impostors = lod ? lod->impostor_count : 0;
+    if (!lod && tiled_plans && pass_plan_view && __record_tiles(scene, color, line_width)) return;
+    
+    uint64_t hash = __hash_value(__hash_style(color, line_width), source);
+    hash = __hash_value(hash, scene.GetRevision());
+    hash = __hash_value(hash, scene_level);
+    for (const SceneBatch& shared : scene_batches) {
+        if (shared.scene == source && recording->batches[shared.batch].content_hash == hash) {
+            __add_to_pass(shared.batch, layer);
+            return;
+        }
+    }
     
-    // Set uniform matrices
-    if (camera) {
-        if (view_matrix_location != -1) {
-            glUniformMatrix4fv(view_matrix_location, 1, GL_FALSE, camera->GetViewMatrix().data());
+    LineBatch& batch = recording->NextBatch(0);
+    batch.color = color;
+    batch.width = line_width;
+    batch.content_hash = hash;
+    // Резидентные буферы держат одну сцену; остальные сцены кадра и упрощенные уровни идут потоком
+    batch.resident = !lod && resident_scene && (!resident_source || resident_source == source);
+    if (batch.resident) resident_source = source;
+    scene_batches.push_back(SceneBatch{source, recording->batch_count - 1, lod});
+    __add_to_pass(recording->batch_count - 1, layer);
+}
+
+/**
+ * @brief Tessellates scene batches referenced by passes that are drawn
+ * @private
+ * 
+ * Sizes each needed batch for lines and tessellated arcs up front and fills
+ * it in parallel on the job system, so a whole scene is drawn with a single
+ * draw call.
+ */
+nil Renderer::__tessellate_scenes() {
+    for (const SceneBatch& shared : scene_batches) {
+        bool needed = false;
+        for (size_t i = 0; i < recording->pass_count && !needed; i++) {
+            const ViewportPass& pass = recording->passes[i];
+            if (!pass.redraw) continue;
+            for (size_t c = pass.first_command; c < pass.first_command + pass.command_count && !needed; c++) {
+                needed = recording->commands[c].batch == shared.batch;
+            }
         }
-        if (projection_matrix_location != -1) {
-            glUniformMatrix4fv(projection_matrix_location, 1, GL_FALSE, camera->GetProjectionMatrix().data());
+        if (!needed) continue;
+        
+        const MentalEngine::Scene& scene = *shared.scene;
+        if (recording->batches[shared.batch].resident) {
+            __tessellate_resident(scene);
+            continue;
         }
-        if (model_matrix_location != -1) {
-            // Identity matrix for lines
-            MentalEngine::Math::Matrix4 model_matrix;
-            glUniformMatrix4fv(model_matrix_location, 1, GL_FALSE, model_matrix.data());
+        if (shared.lod) {
+            // Уровень уже упрощен; копия в арену живет, пока пакет не выполнен
+            LineBatch& batch = recording->batches[shared.batch];
+            batch.count = shared.lod->segments.size();
+            batch.points = recording->arena->AllocateArray<MentalEngine::Math::Vector2>(batch.count);
+            std::copy(shared.lod->segments.begin(), shared.lod->segments.end(), batch.points);
+            continue;
         }
-    }
-    
-    // Устанавливаем толщину линии
-    glLineWidth(line_width);
-    
-    // Создаем массивы для вершин и цветов
-    std::vector<float> vertices;
-    std::vector<float> colors;
-    
-    // Конвертируем 2D точки в 3D (Z = 0) и добавляем цвета
-    for (size_t i = 0; i < points.size(); i += 2) {
-        // Начальная точка линии
-        vertices.push_back(points[i].x);
-        vertices.push_back(points[i].y);
-        vertices.push_back(0.0f);
+        const MentalEngine::LineStorage& lines = scene.GetLines();
+        const MentalEngine::ArcStorage& arcs = scene.GetArcs();
         
-        // Конечная точка линии
-        vertices.push_back(points[i + 1].x);
-        vertices.push_back(points[i + 1].y);
-        vertices.push_back(0.0f);
+        // Смещение каждой дуги в общем буфере, чтобы потоки писали без синхронизации
+        MentalEngine::ArenaVector<size_t> arc_offsets(arcs.size() + 1, 0, MentalEngine::ArenaAllocator<size_t>(*recording->arena));
+        arc_offsets[0] = lines.size() * 2;
+        for (size_t i = 0; i < arcs.size(); i++) {
+            arc_offsets[i + 1] = arc_offsets[i] + 2 * scene.GetArcSegmentCount(static_cast<uint32_t>(i));
+        }
         
-        // Цвета для обеих точек
-        colors.push_back(color.x);
-        colors.push_back(color.y);
-        colors.push_back(color.z);
-        colors.push_back(color.x);
-        colors.push_back(color.y);
-        colors.push_back(color.z);
+        LineBatch& batch = recording->batches[shared.batch];
+        batch.count = arc_offsets.back();
+        batch.points = recording->arena->AllocateArray<MentalEngine::Math::Vector2>(batch.count);
+        MentalEngine::Math::Vector2* points = batch.points;
+        MentalEngine::JobSystem& jobs = MentalEngine::JobSystem::Instance();
+        jobs.ParallelFor(0, lines.size(), TESSELLATION_GRAIN, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) {
+                points[2 * i] = MentalEngine::Math::Vector2(lines.x0[i], lines.y0[i]);
+                points[2 * i + 1] = MentalEngine::Math::Vector2(lines.x1[i], lines.y1[i]);
+            }
+        });
+        jobs.ParallelFor(0, arcs.size(), TESSELLATION_GRAIN / 16, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) {
+                scene.WriteArcSegments(static_cast<uint32_t>(i), points + arc_offsets[i]);
+            }
+        });
+    }
+}
+
+/**
+ * @brief Builds the packet's resident geometry upload for a scene
+ * @private
+ * 
+ * Does nothing if the resident buffers already hold this scene revision or
+ * will once the queued packets have run. Edits that keep every object's
+ * vertex count, such as dragging primitives, are sent as vertex patches of
+ * the touched objects. Otherwise tessellates every primitive into the
+ * packet arena as its own object in parallel: a line is two vertices, an
+ * arc a strip of vertices, and each gets one draw command over its indices.
+ * 
+ * @param scene Scene to make resident
+ */
+nil Renderer::__tessellate_resident(const MentalEngine::Scene& scene) {
+    const MentalEngine::Scene* source = &scene;
+    const uint64_t geometry_hash = __hash_value(__hash_value(FNV_OFFSET, source), scene.GetRevision());
+    if (geometry_hash == resident_geometry) return;
+    const bool patched = resident_geometry != 0 && resident_uploaded == source && __patch_resident(scene);
+    resident_geometry = geometry_hash;
+    resident_uploaded = source;
+    resident_revision = scene.GetRevision();
+    if (patched) return;
+    
+    const MentalEngine::LineStorage& lines = scene.GetLines();
+    const MentalEngine::ArcStorage& arcs = scene.GetArcs();
+    MentalEngine::FrameArena& arena = *recording->arena;
+    
+    // Смещения сегментов каждой дуги, чтобы потоки писали без синхронизации; хранятся для патчей
+    std::vector<size_t>& arc_segments = resident_arc_segments;
+    arc_segments.assign(arcs.size() + 1, 0);
+    resident_lines = lines.size();
+    for (size_t i = 0; i < arcs.size(); i++) {
+        arc_segments[i + 1] = arc_segments[i] + scene.GetArcSegmentCount(static_cast<uint32_t>(i));
     }
     
-    // Создаем VAO для линий
-    GLuint VAO, VBO, colorVBO;
-    glGenVertexArrays(1, &VAO);
-    glGenBuffers(1, &VBO);
-    glGenBuffers(1, &colorVBO);
-    
-    // Привязываем VAO
-    glBindVertexArray(VAO);
-    
-    // Загружаем данные вершин
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
-    
-    // Загружаем данные цветов
-    glBindBuffer(GL_ARRAY_BUFFER, colorVBO);
-    glBufferData(GL_ARRAY_BUFFER, colors.size() * sizeof(float), colors.data(), GL_STATIC_DRAW);
-    
-    // Настраиваем атрибуты
-    glEnableVertexAttribArray(0);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, (void*)0);
-    
-    glEnableVertexAttribArray(1);
-    glBindBuffer(GL_ARRAY_BUFFER, colorVBO);
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 0, (void*)0);
-    
-    // Рендерим линии
-    glDrawArrays(GL_LINES, 0, vertices.size() / 3);
+    SceneGeometry& geometry = recording->scene_geometry;
+    geometry.geometry_hash = geometry_hash;
+    geometry.object_count = lines.size() + arcs.size();
+    geometry.vertex_count = 2 * lines.size() + arc_segments.back() + arcs.size();
+    geometry.index_count = 2 * lines.size() + 2 * arc_segments.back();
+    geometry.vertices = arena.AllocateArray<SceneVertex>(geometry.vertex_count);
+    geometry.indices = arena.AllocateArray<uint32_t>(geometry.index_count);
+    geometry.commands = arena.AllocateArray<SceneDrawCommand>(geometry.object_count);
+    MentalEngine::Math::Vector2* pairs = arena.AllocateArray<MentalEngine::Math::Vector2>(2 * arc_segments.back());
+    
+    SceneVertex* vertices = geometry.vertices;
+    uint32_t* indices = geometry.indices;
+    SceneDrawCommand* commands = geometry.commands;
+    MentalEngine::JobSystem& jobs = MentalEngine::JobSystem::Instance();
+    jobs.ParallelFor(0, lines.size(), TESSELLATION_GRAIN, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            vertices[2 * i] = SceneVertex{lines.x0[i], lines.y0[i]};
+            vertices[2 * i + 1] = SceneVertex{lines.x1[i], lines.y1[i]};
+            indices[2 * i] = static_cast<uint32_t>(2 * i);
+            indices[2 * i + 1] = static_cast<uint32_t>(2 * i + 1);
+            commands[i] = SceneDrawCommand{2, 1, static_cast<uint32_t>(2 * i), 0, 0};
+        }
+    });
+    const size_t arc_vertices = 2 * lines.size();
+    const size_t arc_indices = 2 * lines.size();
+    jobs.ParallelFor(0, arcs.size(), TESSELLATION_GRAIN / 16, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            const size_t segments = arc_segments[i + 1] - arc_segments[i];
+            
+            // Соседние сегменты дуги делят вершину: k сегментов - k + 1 вершин
+            const size_t first_vertex = arc_vertices + arc_segments[i] + i;
+            const size_t first_index = arc_indices + 2 * arc_segments[i];
+            __write_arc_vertices(scene, static_cast<uint32_t>(i), segments, pairs + 2 * arc_segments[i], vertices + first_vertex);
+            for (size_t k = 0; k < segments; k++) {
+                indices[first_index + 2 * k] = static_cast<uint32_t>(first_vertex + k);
+                indices[first_index + 2 * k + 1] = static_cast<uint32_t>(first_vertex + k + 1);
+            }
+            commands[lines.size() + i] = SceneDrawCommand{static_cast<uint32_t>(2 * segments), 1, static_cast<uint32_t>(first_index), 0, 0};
+        }
+    });
+}
+
+/**
+ * @brief Patches the resident geometry with the objects edited since it was built
+ * @private
+ * 
+ * Works while the scene has the same number of lines and arcs and every
+ * edited arc keeps its segment count, so indices and draw commands stay
+ * valid; each edited object's vertices are re-tessellated into the packet
+ * arena and rewritten in place. Bulk changes and edits touching a large
+ * part of the scene are left to a full upload.
+ * 
+ * @param scene Scene the resident geometry was built from
+ * @return bool False if the scene needs a full upload; nothing was recorded then
+ */
+bool Renderer::__patch_resident(const MentalEngine::Scene& scene) {
+    const MentalEngine::LineStorage& lines = scene.GetLines();
+    const MentalEngine::ArcStorage& arcs = scene.GetArcs();
+    if (lines.size() != resident_lines || arcs.size() + 1 != resident_arc_segments.size()) return false;
+    if (scene.GetRevision() < resident_revision) return false;
+    
+    resident_changes.clear();
+    if (!scene.GetChangedPrimitivesSince(resident_revision, resident_changes)) return false;
+    if (resident_changes.size() > scene.GetPrimitiveCount() / 4 + 1) return false;
+    
+    // Сначала проверяем, что слоты существуют и ни одна дуга не сменила число сегментов
+    for (const MentalEngine::PrimitiveId& id : resident_changes) {
+        const uint32_t i = id.GetIndex();
+        if (id.GetType() == MentalEngine::PrimitiveType::Line) {
+            if (i >= lines.size()) return false;
+        } else if (i >= arcs.size() || scene.GetArcSegmentCount(i) != resident_arc_segments[i + 1] - resident_arc_segments[i]) {
+            return false;
+        }
+    }
     
-    // Отключаем атрибуты
-    glDisableVertexAttribArray(0);
-    glDisableVertexAttribArray(1);
+    MentalEngine::FrameArena& arena = *recording->arena;
+    for (const MentalEngine::PrimitiveId& id : resident_changes) {
+        const uint32_t i = id.GetIndex();
+        SceneVertexPatch patch;
+        if (id.GetType() == MentalEngine::PrimitiveType::Line) {
+            patch.first_vertex = 2 * i;
+            patch.vertex_count = 2;
+            patch.vertices = arena.AllocateArray<SceneVertex>(2);
+            patch.vertices[0] = SceneVertex{lines.x0[i], lines.y0[i]};
+            patch.vertices[1] = SceneVertex{lines.x1[i], lines.y1[i]};
+        } else {
+            const size_t segments = resident_arc_segments[i + 1] - resident_arc_segments[i];
+            patch.first_vertex = 2 * resident_lines + resident_arc_segments[i] + i;
+            patch.vertex_count = segments + 1;
+            patch.vertices = arena.AllocateArray<SceneVertex>(patch.vertex_count);
+            MentalEngine::Math::Vector2* pairs = arena.AllocateArray<MentalEngine::Math::Vector2>(2 * segments);
+            __write_arc_vertices(scene, i, segments, pairs, patch.vertices);
+        }
+        recording->scene_patches.push_back(patch);
+    }
+    return true;
+}
+
+/**
+ * @brief Records the current plan view pass from cached tiles
+ * @private
+ * 
+ * Finds the tiles of the zoom level matching the pass's pixel size that
+ * cover the view, schedules the missing and dirty ones for rendering
+ * within the frame's budget, and adds a TileDraw per visible tile to the
+ * pass. A tile not rendered yet is stood in for by the part of a ready
+ * coarser tile covering it, or left empty for a frame or two.
+ * 
+ * @param scene Scene to draw
+ * @param color Line color (RGB)
+ * @param line_width Line width in pixels
+ * @return bool False if the view cannot use tiles and the scene must be drawn directly
+ */
+bool Renderer::__record_tiles(const MentalEngine::Scene& scene, const MentalEngine::Math::Vector3& color, float line_width) {
+    ViewportPass& pass = *current_pass;
+    uint64_t style = __hash_value(__hash_style(color, line_width), pass.smooth_lines);
+    style = __hash_value(style, shader_generation.load(std::memory_order_relaxed));
+    // Тайлы кадра рисуются одним стилем одной сцены; иначе они вытесняли бы друг друга
+    if (tile_source && (tile_source != &scene || tile_style != style)) return false;
+    
+    // Видимый прямоугольник: углы NDC обратно в координаты сцены
+    const MentalEngine::Math::Matrix4 inverse_view_projection = MentalEngine::Math::inverse(pass.view * pass.projection);
+    float min_x = 0.0f, min_y = 0.0f, max_x = 0.0f, max_y = 0.0f;
+    for (int corner = 0; corner < 4; corner++) {
+        const MentalEngine::Math::Vector4 point = MentalEngine::Math::transformColumnMajor(inverse_view_projection,
+            MentalEngine::Math::Vector4(corner & 1 ? 1.0f : -1.0f, corner & 2 ? 1.0f : -1.0f, 0.0f, 1.0f));
+        if (point.w == 0.0f) return false;
+        const float x = point.x / point.w;
+        const float y = point.y / point.w;
+        min_x = corner == 0 ? x : std::min(min_x, x);
+        min_y = corner == 0 ? y : std::min(min_y, y);
+        max_x = corner == 0 ? x : std::max(max_x, x);
+        max_y = corner == 0 ? y : std::max(max_y, y);
+    }
     
-    // Отвязываем VAO
-    glBindVertexArray(0);
+    const int zoom = TileCache::SelectZoom(pass_pixel_size);
+    const double tile_size = TileCache::GetTileWorldSize(zoom);
+    const double first_x = std::floor(min_x / tile_size), last_x = std::floor(max_x / tile_size);
+    const double first_y = std::floor(min_y / tile_size), last_y = std::floor(max_y / tile_size);
+    // Координаты тайла упаковываются в 28 бит со знаком
+    const double coord_limit = static_cast<double>(1 << 26);
+    if (!(std::fabs(first_x) < coord_limit && std::fabs(last_x) < coord_limit &&
+          std::fabs(first_y) < coord_limit && std::fabs(last_y) < coord_limit)) return false;
+    if ((last_x - first_x + 1.0) * (last_y - first_y + 1.0) > static_cast<double>(MAX_VISIBLE_TILES)) return false;
+    const int32_t x0 = static_cast<int32_t>(first_x), x1 = static_cast<int32_t>(last_x);
+    const int32_t y0 = static_cast<int32_t>(first_y), y1 = static_cast<int32_t>(last_y);
+    
+    tile_cache.Sync(scene, style, 0.5f * line_width + 1.0f);
+    tile_source = &scene;
+    tile_style = style;
+    
+    tile_queue.clear();
+    for (int32_t y = y0; y <= y1; y++) {
+        for (int32_t x = x0; x <= x1; x++) {
+            TileCache::Tile* tile = tile_cache.Acquire(zoom, x, y);
+            if (!tile) return false;
+            if (!tile->ready || tile->dirty) tile_queue.push_back(tile);
+        }
+    }
     
-    // Очищаем буферы
-    glDeleteVertexArrays(1, &VAO);
-    glDeleteBuffers(1, &VBO);
-    glDeleteBuffers(1, &colorVBO);
+    // Сначала правки уже видимых тайлов, затем ближайшие к центру вида
+    const float center_x = 0.5f * (min_x + max_x) / static_cast<float>(tile_size) - 0.5f;
+    const float center_y = 0.5f * (min_y + max_y) / static_cast<float>(tile_size) - 0.5f;
+    std::sort(tile_queue.begin(), tile_queue.end(), [&](const TileCache::Tile* a, const TileCache::Tile* b) {
+        if (a->ready != b->ready) return a->ready;
+        const float da = std::fabs(a->x - center_x) + std::fabs(a->y - center_y);
+        const float db = std::fabs(b->x - center_x) + std::fabs(b->y - center_y);
+        return da < db;
+    });
+    for (TileCache::Tile* tile : tile_queue) {
+        if (tiles_rendered >= MAX_TILE_RENDERS || tile_segments >= TILE_SEGMENT_BUDGET) {
+            tiles_pending = true;
+            break;
+        }
+        tile_segments += __record_tile_render(scene, *tile, color, line_width);
+        tiles_rendered++;
+    }
     
-    // Сбрасываем толщину линии
-    glLineWidth(1.0f);
+    for (int32_t y = y0; y <= y1; y++) {
+        for (int32_t x = x0; x <= x1; x++) {
+            const TileCache::Tile* tile = tile_cache.FindReady(zoom, x, y);
+            int level = 0;
+            for (int up = 1; !tile && up <= MAX_TILE_FALLBACK; up++) {
+                // Деление с округлением вниз и для отрицательных координат
+                tile = tile_cache.FindReady(zoom + up, x >> up, y >> up);
+                level = up;
+            }
+            if (!tile) continue;
+            
+            const MentalEngine::Bounds2D area = TileCache::GetBounds(zoom, x, y);
+            const int32_t span = 1 << level;
+            const float part = 1.0f / static_cast<float>(span);
+            TileDraw draw;
+            draw.slot = tile->slot;
+            draw.content_hash = tile->generation;
+            draw.min_x = area.min_x;
+            draw.min_y = area.min_y;
+            draw.max_x = area.max_x;
+            draw.max_y = area.max_y;
+            draw.u0 = static_cast<float>(x - tile->x * span) * part;
+            draw.v0 = static_cast<float>(y - tile->y * span) * part;
+            draw.u1 = draw.u0 + part;
+            draw.v1 = draw.v0 + part;
+            recording->tile_draws.push_back(draw);
+        }
+    }
+    pass.tile_count = recording->tile_draws.size() - pass.first_tile;
+    return true;
+}
+
+/**
+ * @brief Records the rendering of one tile
+ * @private
+ * 
+ * Copies the segments of every primitive whose bounds come within the
+ * stroke margin of the tile into a batch; the GL thread draws them into the
+ * tile's texture before the passes. The tile counts as rendered from here
+ * on, since packets are executed in recording order.
+ * 
+ * @param scene Scene to draw
+ * @param tile Tile to render
+ * @param color Line color (RGB)
+ * @param line_width Line width in pixels
+ * @return size_t Segments recorded
+ */
+size_t Renderer::__record_tile_render(const MentalEngine::Scene& scene, TileCache::Tile& tile,
+                                      const MentalEngine::Math::Vector3& color, float line_width) {
+    const MentalEngine::Bounds2D area = TileCache::GetBounds(tile.zoom, tile.x, tile.y);
+    const float margin = std::ldexp(0.5f * line_width + 1.0f, tile.zoom);
+    const MentalEngine::Bounds2D query(area.min_x - margin, area.min_y - margin, area.max_x + margin, area.max_y + margin);
+    
+    tile_primitives.clear();
+    size_t segments = 0;
+    scene.GetIndex().Query(query, [&](const MentalEngine::SpatialIndex::Entry& entry) {
+        tile_primitives.push_back(entry.id);
+        segments += scene.GetSegmentCount(entry.id);
+        return true;
+    });
+    
+    LineBatch& batch = recording->NextBatch(2 * segments);
+    MentalEngine::Math::Vector2* points = batch.points;
+    for (const MentalEngine::PrimitiveId& id : tile_primitives) {
+        scene.WriteSegments(id, points);
+        points += 2 * scene.GetSegmentCount(id);
+    }
+    batch.color = color;
+    batch.width = line_width;
+    
+    TileRender render;
+    render.slot = tile.slot;
+    render.min_x = area.min_x;
+    render.min_y = area.min_y;
+    render.max_x = area.max_x;
+    render.max_y = area.max_y;
+    render.batch = recording->batch_count - 1;
+    render.smooth_lines = current_pass->smooth_lines;
+    recording->tile_renders.push_back(render);
+    tile_cache.MarkRendered(tile);
+    return segments;
+}
+
+/**
+ * @brief Renders a recorded tile into its texture
+ * @private
+ * 
+ * Draws the tile's batch with an orthographic projection of its area onto
+ * the TILE_SIZE texture, so one texel covers 2^zoom world units.
+ * 
+ * @param render Tile to render
+ * @param packet Frame owning the batch
+ */
+nil Renderer::__render_tile(const TileRender& render, const FramePacket& packet) {
+    tile_cache.BeginRender(render.slot);
+    ViewportPass tile_pass;
+    tile_pass.width = TileCache::TILE_SIZE;
+    tile_pass.height = TileCache::TILE_SIZE;
+    tile_pass.projection = MentalEngine::Math::orthographic(render.min_x, render.max_x, render.min_y, render.max_y, -1.0f, 1.0f);
+    tile_pass.smooth_lines = render.smooth_lines;
+    __begin_lines(tile_pass, line_shaders);
+    __draw_lines(packet.batches[render.batch]);
+    gl_state.SetEnabled(GL_BLEND, false);
+}
+
+/**
+ * @brief Composites a pass's tiles
+ * @private
+ * 
+ * Draws each tile as a textured quad over its world area. Tile texels hold
+ * premultiplied color over a transparent background, so they are blended
+ * with (ONE, ONE_MINUS_SRC_ALPHA) onto the viewport background.
+ * 
+ * @param pass Viewport pass being drawn
+ * @param packet Frame owning the tile draws
+ */
+nil Renderer::__composite_tiles(const ViewportPass& pass, const FramePacket& packet) {
+    __set_matrices(pass, __use_program(tile_shader));
+    gl_state.SetEnabled(GL_BLEND, true);
+    gl_state.BlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+    for (size_t i = pass.first_tile; i < pass.first_tile + pass.tile_count; i++) {
+        const TileDraw& tile = packet.tile_draws[i];
+        const GLuint texture = tile_cache.GetTexture(tile.slot);
+        if (texture == 0) continue;
+        gl_state.BindTexture2D(texture);
+        // Цветовой атрибут несет координаты текстуры
+        const float vertices[] = {
+            tile.min_x, tile.min_y, 0.0f,  tile.u0, tile.v0, 0.0f,
+            tile.max_x, tile.min_y, 0.0f,  tile.u1, tile.v0, 0.0f,
+            tile.max_x, tile.max_y, 0.0f,  tile.u1, tile.v1, 0.0f,
+            tile.min_x, tile.max_y, 0.0f,  tile.u0, tile.v1, 0.0f
+        };
+        __draw_vertices(GL_TRIANGLE_FAN, vertices, 4);
+    }
+    gl_state.SetEnabled(GL_BLEND, false);
 }
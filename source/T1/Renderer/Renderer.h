@@ -18,7 +18,36 @@
 #include <GLFW/glfw3.h>
 #include "../../Core/Types.h"
 #include "../Camera/Camera.h"
-#include <functional>
+#include "../Scene/Scene.h"
+#include "../Scene/SceneLod.h"
+#include "FramePacket.h"
+#include "GLStateCache.h"
+#include "GpuScene.h"
+#include "RenderTargetPool.h"
+#include "ShaderCache.h"
+#include "ShaderWatcher.h"
+#include "TileCache.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @enum RenderQuality
+ * @brief Trade-off between image quality and fill cost of viewport passes
+ *
+ * Lines are always expanded to quads in a geometry shader, because
+ * glLineWidth() above 1.0 is not supported in the core profile on many
+ * drivers. The tiers differ in how their edges are treated.
+ */
+enum class RenderQuality : uint8_t {
+    Fast = 0,   ///< Hard-edged lines, no blending; cheapest on software rasterizers
+    Balanced,   ///< Analytically anti-aliased lines
+    High        ///< Anti-aliased lines drawn into a multisampled target and resolved
+};
 
 /**
  * @class Renderer
@@ -29,6 +58,32 @@
  * and grid rendering. It abstracts away the complexity of OpenGL setup and
  * provides a clean API for rendering operations.
  * 
+ * Drawing is split in two halves. RenderViewport(), RenderScene() and
+ * RenderLines() only record into the FramePacket passed to BeginPacket(),
+ * on the thread that owns the UI and camera. ExecutePacket() issues the GL
+ * calls on the thread that owns the context, which may be a render thread.
+ * 
+ * Each recorded draw becomes a RenderCommand whose key orders it by
+ * viewport, layer, stage, program and material. EndPacket() radix-sorts
+ * the frame's commands, so ExecutePacket() changes program state only
+ * where neighbouring keys differ. Draws may be prepared on worker threads
+ * in a RenderCommandList and handed over with Submit().
+ * 
+ * Scenes are kept resident on the GPU by default (see GpuScene): geometry
+ * is uploaded only when the scene revision changes and each frame draws it
+ * with a single multi-draw indirect call. Plan views composite the scene
+ * from cached world-space tiles instead (see TileCache), so panning and
+ * zooming re-render only the tiles that come into view or were edited.
+ * 
+ * Up to MAX_VIEWPORTS viewports (e.g. top, front, side and 3D views) are
+ * drawn per frame, each with its own camera and framebuffer. A pass whose
+ * camera, size and recorded content hash the same as what its target
+ * already shows is skipped, so an idle view costs nothing on the GPU.
+ * 
+ * Lines are expanded to screen-space quads and anti-aliased analytically
+ * in the fragment shader; RenderQuality selects hard edges, analytic
+ * anti-aliasing, or anti-aliasing plus MSAA.
+ * 
  * Key features:
  * - Viewport management with framebuffer support
  * - Automatic shader compilation and management
@@ -39,21 +94,144 @@
  */
 class Renderer {
 private:
-    // OpenGL Viewport variables
-    GLuint viewport_framebuffer = 0;    ///< OpenGL framebuffer object for viewport rendering
-    GLuint viewport_texture = 0;        ///< OpenGL texture object for viewport color buffer
-    GLuint viewport_renderbuffer = 0;   ///< OpenGL renderbuffer object for depth/stencil
-    int viewport_width = 800;           ///< Current viewport width in pixels
-    int viewport_height = 600;          ///< Current viewport height in pixels
-    bool viewport_initialized = false;  ///< Flag indicating if viewport is initialized
-    
-    // Shader variables
-    GLuint shader_program = 0;    ///< OpenGL shader program ID
-    GLuint vertex_shader = 0;     ///< OpenGL vertex shader ID
-    GLuint fragment_shader = 0;   ///< OpenGL fragment shader ID
-    GLint view_matrix_location = -1;      ///< View matrix uniform location
-    GLint projection_matrix_location = -1; ///< Projection matrix uniform location
-    GLint model_matrix_location = -1;     ///< Model matrix uniform location
+    /**
+     * @struct ViewportTarget
+     * @brief Framebuffer objects of one viewport (GL thread)
+     */
+    struct ViewportTarget {
+        GLuint framebuffer = 0;    ///< Framebuffer object
+        GLuint texture = 0;        ///< Color texture, stable for the renderer's lifetime
+        GLuint depth = 0;          ///< Pooled depth/stencil renderbuffer currently attached
+        int width = 0;             ///< Allocated (bucketed) width in pixels
+        int height = 0;            ///< Allocated (bucketed) height in pixels
+    };
+    
+    /**
+     * @struct ViewportSlot
+     * @brief Camera and redraw state of one viewport (UI thread)
+     */
+    struct ViewportSlot {
+        std::shared_ptr<MentalEngine::Camera> camera;  ///< Camera, nullptr while the slot is free
+        int width = 800;                               ///< Last requested width in pixels
+        int height = 600;                              ///< Last requested height in pixels
+        int target_width = 0;                          ///< Bucketed target width the passes ask for
+        int target_height = 0;                         ///< Bucketed target height the passes ask for
+        int shrink_width = 0;                          ///< Smaller bucket waiting out SHRINK_DELAY_SECONDS
+        int shrink_height = 0;                         ///< Smaller bucket waiting out SHRINK_DELAY_SECONDS
+        std::chrono::steady_clock::time_point shrink_since;  ///< When the smaller bucket was first requested
+        uint64_t presented_hash = 0;                   ///< Content hash of the last pass drawn into the target
+        bool presented = false;                        ///< presented_hash describes the target
+    };
+    
+    /**
+     * @struct SceneBatch
+     * @brief Scene geometry recorded this frame, tessellated by EndPacket()
+     */
+    struct SceneBatch {
+        const MentalEngine::Scene* scene = nullptr;  ///< Source; must stay unchanged until EndPacket()
+        size_t batch = 0;                            ///< Index in the packet's batches
+        const MentalEngine::SceneLod::Level* lod = nullptr;  ///< Simplified geometry to copy instead of tessellating, if any
+    };
+    
+    // OpenGL Viewport variables (GL thread)
+    std::vector<ViewportTarget> targets;  ///< One render target per viewport slot
+    RenderTargetPool target_pool;         ///< Depth buffers shared by targets of the same bucket
+    
+    // Recording state (UI thread)
+    std::vector<ViewportSlot> slots;    ///< Viewports; slot 0 is the main viewport and always in use
+    size_t active_viewport = 0;         ///< Viewport receiving camera input
+    uint32_t pending_releases = 0;      ///< Released viewports whose storage the next packet frees
+    FramePacket* recording = nullptr;   ///< Packet receiving draw calls, between BeginPacket() and EndPacket()
+    ViewportPass* current_pass = nullptr;  ///< Pass receiving batches, set by RenderViewport()
+    std::vector<SceneBatch> scene_batches;  ///< Scene geometry shared by this frame's passes
+    bool resident_scene = true;         ///< Draw scenes from GPU-resident buffers instead of streaming points
+    const MentalEngine::Scene* resident_source = nullptr;  ///< Scene drawn from the resident buffers this frame
+    uint64_t resident_geometry = 0;     ///< Geometry the resident buffers hold once queued packets have run
+    const MentalEngine::Scene* resident_uploaded = nullptr;  ///< Scene of resident_geometry
+    uint64_t resident_revision = 0;     ///< Revision of resident_geometry
+    size_t resident_lines = 0;          ///< Lines in the resident geometry; arcs follow them
+    std::vector<size_t> resident_arc_segments;  ///< Segment offset of each resident arc, plus the total
+    std::vector<MentalEngine::PrimitiveId> resident_changes;  ///< Scratch for edits since resident_revision
+    MentalEngine::SceneLod scene_lod;   ///< Simplified levels of the last scene drawn zoomed out
+    bool level_of_detail = true;        ///< Draw zoomed-out scenes from scene_lod
+    float pass_pixel_size = 0.0f;       ///< World units per pixel of the current pass, at the camera target
+    bool tiled_plans = true;            ///< Composite plan views from tile_cache
+    bool pass_plan_view = false;        ///< The current pass is orthographic and looks straight down the Z axis
+    const MentalEngine::Scene* tile_source = nullptr;  ///< Scene drawn from tiles this frame
+    uint64_t tile_style = 0;            ///< Style hash the tiles of this frame are rendered with
+    size_t tiles_rendered = 0;          ///< Tiles scheduled for rendering by the last recorded frame
+    size_t tile_segments = 0;           ///< Segments of those tiles
+    bool tiles_pending = false;         ///< The last recorded frame left visible tiles unrendered
+    std::vector<TileCache::Tile*> tile_queue;  ///< Visible tiles needing a render, reused across frames
+    std::vector<MentalEngine::PrimitiveId> tile_primitives;  ///< Primitives overlapping a tile, reused across frames
+    int scene_level = 0;                ///< Level the last scene batch was recorded at
+    size_t scene_level_impostors = 0;   ///< Impostor blocks of that level
+    size_t redrawn_passes = 0;          ///< Passes of the last recorded frame that needed drawing
+    size_t recorded_passes = 0;         ///< Passes of the last recorded frame
+    MentalEngine::DoubleBufferedArena packet_arenas;  ///< Batch points; a packet is executed at most one frame after recording
+    
+    // Transient GL-thread data
+    MentalEngine::FrameArena gl_arena;  ///< Vertex staging, reset by every ExecutePacket()
+    ImDrawData ui_draw_data;            ///< Reused to submit the packet's ImGui lists
+    
+    /**
+     * @struct ProgramUniforms
+     * @brief Uniform locations of one shader program; -1 when absent
+     */
+    struct ProgramUniforms {
+        GLint view_matrix = -1;        ///< uViewMatrix
+        GLint projection_matrix = -1;  ///< uProjectionMatrix
+        GLint model_matrix = -1;       ///< uModelMatrix
+        GLint viewport_size = -1;      ///< uViewportSize, line program only
+        GLint line_width = -1;         ///< uLineWidth, line program only
+    };
+    
+    /**
+     * @struct ShaderBinding
+     * @brief A program requested from the shader cache, resolved on first use
+     */
+    struct ShaderBinding {
+        const char* name = "";                                     ///< Name used in log messages
+        const char* stage_files[3] = {nullptr, nullptr, nullptr};  ///< Vertex, geometry, fragment file; nullptr when unused
+        const char* defines = "";                                  ///< Preprocessor lines of the variant
+        ShaderCache::Handle handle = ShaderCache::INVALID_HANDLE;  ///< Cache handle
+        ShaderCache::Handle pending = ShaderCache::INVALID_HANDLE; ///< Reloaded version still building
+        GLuint program = 0;                                        ///< Program, 0 until resolved
+        ProgramUniforms uniforms;                                  ///< Locations in program
+        bool resolved = false;                                     ///< program and uniforms are valid
+    };
+    
+    // Shader variables (GL thread)
+    ShaderCache shader_cache;          ///< Builds and persists the programs below
+    std::string shader_cache_directory = "shader_cache";  ///< Where program binaries are kept
+    std::string shader_directory = "resources/shaders";   ///< Where shader sources are loaded from
+    bool shader_hot_reload = true;     ///< Watch shader_directory and rebuild edited programs
+    ShaderWatcher shader_watcher;      ///< Reads edited shader files in the background
+    std::unordered_map<std::string, std::string> shader_files;  ///< Current source of each shader file
+    std::vector<ShaderFileChange> shader_changes;  ///< Reused to take changes from the watcher
+    bool shaders_requested = false;    ///< __init_shaders() ran
+    ShaderBinding basic_shader;        ///< Filled geometry (background, triangle)
+    ShaderBinding line_shaders[2];     ///< Lines expanded to screen-space quads; [1] anti-aliased, [0] hard-edged
+    ShaderBinding scene_line_shaders[2];  ///< The same for resident scene geometry (scene.vert)
+    ShaderBinding tile_shader;         ///< Textured quads compositing cached tiles
+    const ProgramUniforms* line_uniforms = nullptr;  ///< Uniforms of the line program bound by __begin_lines()
+    float line_width_set = -1.0f;      ///< uLineWidth of the bound line program; negative when unknown
+    GLint max_samples = 0;             ///< GL_MAX_SAMPLES, queried with the shaders
+    
+    // Draw state (GL thread)
+    GLStateCache gl_state;             ///< Elides redundant binds and state changes, counts GL calls
+    GLuint stream_vao = 0;             ///< Interleaved vertex layout, set up once
+    GLuint stream_buffer = 0;          ///< Re-specified by every draw
+    size_t stream_bytes = 0;           ///< Current size of stream_buffer, for GPU memory accounting
+    GpuScene gpu_scene{gl_state};      ///< Resident scene geometry, drawn with multi-draw indirect
+    TileCache tile_cache{gl_state};    ///< Plan view tiles; bookkeeping on the UI thread, textures on the GL thread
+    
+    // Shared with the UI thread
+    std::atomic<uint32_t> shader_generation{0};  ///< Bumped when a reloaded program is swapped in; forces redraws
+    std::atomic<bool> shaders_reloading{false};  ///< Reloaded programs are still building
+    
+    // Quality settings
+    RenderQuality quality = RenderQuality::Balanced;  ///< Tier applied to passes recorded from now on
     
     // Grid settings
     float grid_cell_size = 50.0f;  ///< Grid cell size in pixels
@@ -62,19 +240,110 @@ private:
     bool show_grid = true;  ///< Flag to show/hide grid
     
     // Camera system
-    std::shared_ptr<MentalEngine::Camera> camera;  ///< Camera instance
+    MentalEngine::Math::Vector3d scene_origin;     ///< World position the vertex data is relative to
 
     /**
-     * @brief Initializes the OpenGL viewport framebuffer
+     * @brief Creates the OpenGL framebuffer objects of every viewport slot
+     * @private
+     */
+    nil __init_viewports();
+    
+    /**
+     * @brief Reallocates a target's color storage, keeping the object names
      * @private
      */
-    nil __init_viewport();
+    nil __resize_viewport(ViewportTarget& target, int width, int height);
+    
+    /**
+     * @brief Attaches the pooled depth buffer matching the target's size
+     * @private
+     */
+    nil __attach_depth(ViewportTarget& target);
+    
+    /**
+     * @brief Picks the bucketed target size for a requested viewport size
+     * @private
+     */
+    nil __choose_target_size(ViewportSlot& slot);
     
     /**
      * @brief Cleans up viewport OpenGL resources
      * @private
      */
-    nil __cleanup_viewport();
+    nil __cleanup_viewports();
+    
+    /**
+     * @brief Decides whether the current pass must be drawn and closes it
+     * @private
+     */
+    nil __finish_pass();
+    
+    /**
+     * @brief Tessellates scene batches referenced by passes that are drawn
+     * @private
+     */
+    nil __tessellate_scenes();
+    
+    /**
+     * @brief Builds the packet's resident geometry upload for a scene
+     * @private
+     */
+    nil __tessellate_resident(const MentalEngine::Scene& scene);
+    
+    /**
+     * @brief Patches the resident geometry with the objects edited since it was built
+     * @private
+     */
+    bool __patch_resident(const MentalEngine::Scene& scene);
+    
+    /**
+     * @brief Records the current plan view pass from cached tiles
+     * @private
+     */
+    bool __record_tiles(const MentalEngine::Scene& scene, const MentalEngine::Math::Vector3& color, float line_width);
+    
+    /**
+     * @brief Records the rendering of one tile
+     * @private
+     */
+    size_t __record_tile_render(const MentalEngine::Scene& scene, TileCache::Tile& tile,
+                                const MentalEngine::Math::Vector3& color, float line_width);
+    
+    /**
+     * @brief Renders a recorded tile into its texture
+     * @private
+     */
+    nil __render_tile(const TileRender& render, const FramePacket& packet);
+    
+    /**
+     * @brief Composites a pass's tiles
+     * @private
+     */
+    nil __composite_tiles(const ViewportPass& pass, const FramePacket& packet);
+    
+    /**
+     * @brief Creates the shaders and stream buffer on first use
+     * @private
+     */
+    nil __prepare_drawing();
+    
+    /**
+     * @brief Adds a command drawing a recorded batch to the current pass
+     * @private
+     */
+    nil __add_to_pass(size_t batch, RenderLayer layer, float depth = 0.0f);
+    
+    /**
+     * @brief Records a line batch into the current pass
+     * @private
+     */
+    nil __record_lines(const MentalEngine::Math::Vector2* points, size_t count, const MentalEngine::Math::Vector3& color, float line_width, RenderLayer layer, float depth);
+    
+    /**
+     * @brief Drops commands of skipped passes and sorts the rest by key
+     * @private
+     */
+    nil __sort_commands();
     
     /**
      * @brief Initializes and compiles OpenGL shaders
@@ -82,6 +351,24 @@ private:
      */
     nil __init_shaders();
     
+    /**
+     * @brief Requests a binding's program from the shader cache with the current file sources
+     * @private
+     */
+    ShaderCache::Handle __request_program(const ShaderBinding& binding);
+    
+    /**
+     * @brief Applies edited shader files and swaps in programs that finished building
+     * @private
+     */
+    nil __reload_shaders();
+    
+    /**
+     * @brief Binds a program, waiting for the shader cache if it is still building
+     * @private
+     */
+    const ProgramUniforms& __use_program(ShaderBinding& binding);
+    
     /**
      * @brief Cleans up shader OpenGL resources
      * @private
@@ -92,15 +379,82 @@ private:
      * @brief Renders the main viewport content
      * @private
      */
-    nil __render_viewport_content();
+    nil __render_viewport_content(const ViewportPass& pass, const FramePacket& packet);
     
     /**
      * @brief Renders the grid overlay
      * @private
      */
-    nil __render_grid();
+    nil __render_grid(const ViewportPass& pass);
+    
+    /**
+     * @brief Uploads buffer data and records the upload
+     * @private
+     */
+    nil __buffer_data(GLenum target, size_t size, const void* data);
+    
+    /**
+     * @brief Uploads the pass's camera matrices
+     * @private
+     */
+    nil __set_matrices(const ViewportPass& pass, const ProgramUniforms& uniforms);
+    
+    /**
+     * @brief Binds the line program with the pass's matrices and edge treatment
+     * @private
+     */
+    nil __begin_lines(const ViewportPass& pass, ShaderBinding (&variants)[2]);
+    
+    /**
+     * @brief Sets the bound line program's width unless it already has it
+     * @private
+     */
+    nil __set_line_width(float line_width);
+    
+    /**
+     * @brief Draws line segments given as interleaved vertices
+     * @private
+     */
+    nil __draw_line_vertices(const float* vertices, size_t vertex_count, float line_width);
+    
+    /**
+     * @brief Creates the vertex array and buffer every draw streams through
+     * @private
+     */
+    nil __init_stream_buffer();
+    
+    /**
+     * @brief Deletes the stream vertex array and buffer
+     * @private
+     */
+    nil __cleanup_stream_buffer();
+    
+    /**
+     * @brief Uploads interleaved vertices to the stream buffer and draws them
+     * @private
+     */
+    nil __draw_vertices(GLenum mode, const float* vertices, size_t vertex_count);
+    
+    /**
+     * @brief Draws one recorded line batch
+     * @private
+     */
+    nil __draw_lines(const LineBatch& batch);
 
 public:
+    static constexpr size_t TESSELLATION_GRAIN = 16384;  ///< Lines per parallel range in RenderScene()
+    static constexpr size_t MAX_VIEWPORTS = 4;           ///< Viewport slots, including the main viewport
+    static constexpr size_t INVALID_VIEWPORT = static_cast<size_t>(-1);  ///< Returned when no slot is free
+    static constexpr double SHRINK_DELAY_SECONDS = 1.0;  ///< A viewport must stay smaller this long before its target shrinks
+    static constexpr int HIGH_QUALITY_SAMPLES = 4;       ///< MSAA samples of RenderQuality::High, clamped to GL_MAX_SAMPLES
+    static_assert(MAX_VIEWPORTS <= RenderCommand::MAX_VIEWPORTS, "viewport index must fit the sort key");
+    static constexpr size_t LOD_MIN_PRIMITIVES = 16384;  ///< Smaller scenes are always drawn at full detail
+    static constexpr size_t MAX_TILE_RENDERS = 8;        ///< Tiles rendered per frame at most; the rest follow in later frames
+    static constexpr size_t TILE_SEGMENT_BUDGET = 1u << 20;  ///< Segments per frame after which no further tile is rendered
+    static constexpr size_t MAX_VISIBLE_TILES = TileCache::MAX_TILES / 2;  ///< Views needing more tiles are drawn directly
+    static constexpr int MAX_TILE_FALLBACK = 2;          ///< Coarser levels searched for a stand-in of a missing tile
+    static constexpr size_t STREAM_VERTEX_FLOATS = 6;    ///< Floats per streamed vertex: xyz position, rgb color
+
     /**
      * @brief Constructor - initializes the renderer
      * 
@@ -111,11 +465,18 @@ public:
     Renderer() {
         glewExperimental = GL_TRUE;
         if (glewInit() != GLEW_OK) {return;}
-        // Shaders are not initialized here - they will be initialized on first RenderViewport call
-        shader_program = 0;  // Ensure shaders are not initialized
+        // Shaders are not initialized here - they will be initialized on first ExecutePacket call
+        shaders_requested = false;  // Ensure shaders are not initialized
+        
+        // Framebuffer names are created while the context is still current on
+        // the constructing thread, so the texture IDs can be shown by the UI
+        // before the first frame runs, even on a render thread
+        slots.resize(MAX_VIEWPORTS);
+        targets.resize(MAX_VIEWPORTS);
+        __init_viewports();
         
         // Initialize camera
-        camera = std::make_shared<MentalEngine::Camera>();
+        slots[0].camera = std::make_shared<MentalEngine::Camera>();
     }
     
     /**
@@ -125,64 +486,159 @@ public:
      * viewport framebuffers and shader programs.
      */
     ~Renderer() {
-        __cleanup_viewport();
+        __cleanup_viewports();
         __cleanup_shaders();
+        __cleanup_stream_buffer();
+        gpu_scene.Clear();
+        tile_cache.ClearTargets();
     }
     
     /**
-     * @brief Draws a single frame with the specified operation
+     * @brief Starts recording a frame
      * 
-     * Clears the screen, executes the provided operation, and sets the
-     * clear color for the next frame.
+     * Switches to the other packet arena, so points recorded for the
+     * previous frame stay valid while it may still be executing.
      * 
-     * @param operation Function to execute during frame rendering
+     * @param packet Packet to fill; cleared first
      */
-    nil DrawFrame(std::function<nil()> operation) {
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-        operation();
-        glClearColor(0.5f, 0.5f, 0.5f, 1.0f);
+    nil BeginPacket(FramePacket& packet) {
+        packet.Clear();
+        packet_arenas.Flip();
+        packet.arena = &packet_arenas.Current();
+        packet.released_viewports = pending_releases;
+        pending_releases = 0;
+        scene_batches.clear();
+        resident_source = nullptr;
+        tile_source = nullptr;
+        tiles_rendered = 0;
+        tile_segments = 0;
+        tiles_pending = false;
+        tile_cache.BeginFrame();
+        current_pass = nullptr;
+        recording = &packet;
     }
     
+    /**
+     * @brief Stops recording
+     * 
+     * Closes the last pass and tessellates scene geometry, skipping it when
+     * no viewport showing it has to be redrawn.
+     */
+    nil EndPacket();
+    
+    /**
+     * @brief Gets the packet being recorded
+     * @return FramePacket* Packet, or nullptr outside BeginPacket()/EndPacket()
+     */
+    FramePacket* GetRecordingPacket() const { return recording; }
+    
+    /**
+     * @brief Gets counters of the arena used by the frame being recorded
+     * @return MentalEngine::FrameArenaStats Usage of the current packet arena
+     */
+    MentalEngine::FrameArenaStats GetPacketArenaStats() const { return packet_arenas.Current().GetStats(); }
+    
+    /**
+     * @brief Draws a recorded frame
+     * 
+     * Renders every viewport pass that needs it into its framebuffer
+     * (reallocating it when the size bucket changed), then clears the window
+     * and draws the captured ImGui lists. Viewports whose content did not change keep last frame's
+     * image.
+     * 
+     * @param packet Recorded frame
+     * @note Must run on the thread that owns the GL context
+     */
+    nil ExecutePacket(FramePacket& packet);
+    
     // Viewport methods
     /**
-     * @brief Initializes the viewport with specified dimensions
+     * @brief Creates a viewport with its own camera and render target
      * 
-     * Creates and configures the OpenGL framebuffer for viewport rendering
-     * with the given width and height.
+     * Viewports share the shader program and the scene geometry recorded
+     * each frame; only the framebuffer is per viewport.
      * 
-     * @param width Viewport width in pixels
-     * @param height Viewport height in pixels
+     * @param camera Camera of the new viewport
+     * @return size_t Viewport index, or INVALID_VIEWPORT if all slots are used
+     */
+    size_t CreateViewport(std::shared_ptr<MentalEngine::Camera> camera);
+    
+    /**
+     * @brief Frees a viewport slot; its target storage is released by the next packet
+     * @param index Viewport index; the main viewport (0) cannot be released
      */
-    nil InitViewport(int width, int height);
+    nil ReleaseViewport(size_t index);
     
     /**
-     * @brief Renders the viewport content
+     * @brief Checks whether a viewport slot is in use
+     * @param index Viewport index
+     * @return bool True if the slot has a camera
+     */
+    bool IsViewportInUse(size_t index) const { return index < slots.size() && slots[index].camera != nullptr; }
+    
+    /**
+     * @brief Records the main viewport's pass
+     * @param width Desired viewport width in pixels
+     * @param height Desired viewport height in pixels
+     */
+    nil RenderViewport(int width, int height) { RenderViewport(0, width, height); }
+    
+    /**
+     * @brief Records a viewport pass
      * 
-     * Renders the current viewport content to the framebuffer. If the
-     * dimensions have changed, the viewport will be reinitialized.
+     * Updates the viewport's camera for the size and snapshots its matrices
+     * and the grid settings into the packet. Geometry recorded until the next
+     * RenderViewport() or EndPacket() is drawn into this viewport.
      * 
+     * @param index Viewport index
      * @param width Desired viewport width in pixels
      * @param height Desired viewport height in pixels
      */
-    nil RenderViewport(int width, int height);
+    nil RenderViewport(size_t index, int width, int height);
+    
+    /**
+     * @brief Gets a viewport's texture ID
+     * @param index Viewport index
+     * @return GLuint OpenGL texture ID, 0 for an invalid index
+     */
+    GLuint GetViewportTexture(size_t index = 0) const { return index < targets.size() ? targets[index].texture : 0; }
+    
+    /**
+     * @brief Gets the part of a viewport's texture holding the image
+     * 
+     * Targets are allocated in size buckets and the viewport is drawn into
+     * their lower-left corner; pass uv0 = (0, v) and uv1 = (u, 0) to
+     * ImGui::Image() to show it upright.
+     * 
+     * @param index Viewport index
+     * @param u Receives the used fraction of the texture width
+     * @param v Receives the used fraction of the texture height
+     */
+    nil GetViewportUV(size_t index, float& u, float& v) const;
     
     /**
-     * @brief Gets the viewport texture ID
-     * @return GLuint OpenGL texture ID for the viewport
+     * @brief Gets a viewport's last requested width
+     * @param index Viewport index
+     * @return int Width in pixels
      */
-    GLuint GetViewportTexture() const { return viewport_texture; }
+    int GetViewportWidth(size_t index = 0) const { return index < slots.size() ? slots[index].width : 0; }
     
     /**
-     * @brief Gets the current viewport width
-     * @return int Current viewport width in pixels
+     * @brief Gets a viewport's last requested height
+     * @param index Viewport index
+     * @return int Height in pixels
      */
-    int GetViewportWidth() const { return viewport_width; }
+    int GetViewportHeight(size_t index = 0) const { return index < slots.size() ? slots[index].height : 0; }
     
     /**
-     * @brief Gets the current viewport height
-     * @return int Current viewport height in pixels
+     * @brief Gets how many passes of the last recorded frame were drawn
+     * @param recorded Receives the number of passes recorded
+     * @return size_t Passes that needed drawing
      */
-    int GetViewportHeight() const { return viewport_height; }
+    size_t GetRedrawnViewportCount(size_t& recorded) const {
+        recorded = recorded_passes;
+        return redrawn_passes;
+    }
     
     // Grid methods
     /**
@@ -219,26 +675,240 @@ public:
      */
     float GetGridCellSize() const { return grid_cell_size; }
     
+    // Quality methods
+    /**
+     * @brief Sets the quality tier of viewport passes
+     * 
+     * Takes effect with the next recorded frame; every viewport is redrawn
+     * because the tier is part of each pass's content hash.
+     * 
+     * @param tier Quality tier
+     */
+    nil SetQuality(RenderQuality tier) { quality = tier; }
+    
+    /**
+     * @brief Gets the quality tier of viewport passes
+     * @return RenderQuality Current tier
+     */
+    RenderQuality GetQuality() const { return quality; }
+    
+    /**
+     * @brief Gets a display name
+     * @param tier Quality tier
+     * @return const char* Static name, e.g. "Balanced"
+     */
+    static const char* GetQualityName(RenderQuality tier);
+    
+    // Shader methods
+    /**
+     * @brief Sets the directory shader sources are loaded from
+     * @param directory Directory holding basic.vert, basic.frag, line.geom and line.frag
+     * @note Only takes effect before the first frame is executed
+     */
+    nil SetShaderDirectory(const std::string& directory) { shader_directory = directory; }
+    
+    /**
+     * @brief Enables rebuilding programs when their shader files are edited
+     * @param enabled True to watch the shader directory
+     * @note Only takes effect before the first frame is executed
+     */
+    nil SetShaderHotReload(bool enabled) { shader_hot_reload = enabled; }
+    
+    /**
+     * @brief Checks whether edited shaders are still being rebuilt
+     * @return bool True while frames are needed to swap in reloaded programs
+     */
+    bool IsReloadingShaders() const { return shaders_reloading.load(std::memory_order_relaxed); }
+    
+    /**
+     * @brief Sets where compiled program binaries are cached
+     * @param directory Directory, created if missing; empty disables the disk cache
+     * @note Only takes effect before the first frame is executed
+     */
+    nil SetShaderCacheDirectory(const std::string& directory) { shader_cache_directory = directory; }
+    
+    /**
+     * @brief Gets shader cache counters
+     * @return ShaderCacheStats Programs loaded from disk, compiled and failed
+     */
+    ShaderCacheStats GetShaderCacheStats() const { return shader_cache.GetStats(); }
+    
+    /**
+     * @brief Gets the GL call counters of the last executed frame
+     * @return GLStateStats State calls issued and elided, draw calls
+     */
+    GLStateStats GetGLStateStats() const { return gl_state.GetLastFrameStats(); }
+    
+    /**
+     * @brief Chooses how RenderScene() geometry reaches the GPU
+     * 
+     * Resident scenes are uploaded once per revision with one draw command
+     * per primitive, and drawn with glMultiDrawElementsIndirect (a single
+     * glDrawElements on GL 3.3); edits that keep object sizes are patched. Otherwise the scene is tessellated
+     * and streamed every frame it is redrawn.
+     * 
+     * @param enabled True to keep scene geometry resident
+     */
+    nil SetResidentScene(bool enabled) {
+        resident_scene = enabled;
+        resident_geometry = 0;
+    }
+    
+    /**
+     * @brief Chooses whether zoomed-out scenes are drawn simplified
+     * 
+     * Scenes of at least LOD_MIN_PRIMITIVES primitives are drawn from a
+     * SceneLod level once a block of spatial index cells is only a few
+     * pixels wide: Douglas-Peucker simplified polylines, and coverage-mask
+     * impostors for blocks too dense to draw as lines.
+     * 
+     * @param enabled True to use level-of-detail geometry
+     */
+    nil SetLevelOfDetail(bool enabled) { level_of_detail = enabled; }
+    bool GetLevelOfDetail() const { return level_of_detail; }
+    
+    /**
+     * @brief Gets the level the scene was last drawn at
+     * @param impostors Receives the level's blocks drawn as impostors
+     * @return int Level number; 0 means full detail
+     */
+    int GetSceneLevel(size_t& impostors) const {
+        impostors = scene_level_impostors;
+        return scene_level;
+    }
+    
+    /**
+     * @brief Chooses whether plan views are composited from cached tiles
+     * 
+     * Orthographic views looking straight down draw the scene from
+     * TileCache tiles of the zoom level closest to their pixel size. A tile
+     * is rendered when it first comes into view and again only when an edit
+     * touches it, at most MAX_TILE_RENDERS per frame; tiles still missing
+     * are stood in for by a coarser level. Panning and zooming then cost a
+     * few dozen textured quads, which suits software rasterizers.
+     * 
+     * @param enabled True to use tiles for plan views
+     */
+    nil SetTiledPlanViews(bool enabled) { tiled_plans = enabled; }
+    bool GetTiledPlanViews() const { return tiled_plans; }
+    
+    /**
+     * @brief Gets tile cache counters
+     * @param rendered Receives the tiles rendered by the last recorded frame
+     * @return size_t Tiles cached
+     */
+    size_t GetTileStats(size_t& rendered) const {
+        rendered = tiles_rendered;
+        return tile_cache.GetTileCount();
+    }
+    
+    /**
+     * @brief Checks whether visible tiles are still waiting for their render
+     * @return bool True while frames are needed to fill in a plan view
+     */
+    bool AreTilesPending() const { return tiles_pending; }
+    
     // Camera methods
     /**
-     * @brief Gets the camera instance
-     * @return std::shared_ptr<MentalEngine::Camera> Camera instance
+     * @brief Gets the camera of the active viewport
+     * @return std::shared_ptr<MentalEngine::Camera> Camera receiving input
      */
-    std::shared_ptr<MentalEngine::Camera> GetCamera() const { return camera; }
+    std::shared_ptr<MentalEngine::Camera> GetCamera() const { return slots[active_viewport].camera; }
     
     /**
-     * @brief Sets the camera instance
+     * @brief Sets the camera of the active viewport
      * @param cam Camera instance to set
      */
-    nil SetCamera(std::shared_ptr<MentalEngine::Camera> cam) { camera = cam; }
+    nil SetCamera(std::shared_ptr<MentalEngine::Camera> cam) { slots[active_viewport].camera = cam; }
+    
+    /**
+     * @brief Gets the camera of a viewport
+     * @param index Viewport index
+     * @return std::shared_ptr<MentalEngine::Camera> Camera, nullptr for a free slot
+     */
+    std::shared_ptr<MentalEngine::Camera> GetViewportCamera(size_t index) const {
+        return index < slots.size() ? slots[index].camera : nullptr;
+    }
     
     /**
-     * @brief Renders lines from a list of points
+     * @brief Selects the viewport whose camera receives input
+     * @param index Viewport index; ignored unless the slot is in use
+     */
+    nil SetActiveViewport(size_t index) {
+        if (IsViewportInUse(index)) active_viewport = index;
+    }
+    
+    /**
+     * @brief Gets the viewport whose camera receives input
+     * @return size_t Viewport index
+     */
+    size_t GetActiveViewport() const { return active_viewport; }
+    
+    /**
+     * @brief Advances the motion of every viewport camera
+     * @param delta_seconds Time since the last call
+     */
+    nil AdvanceCameras(float delta_seconds);
+    
+    /**
+     * @brief Checks whether any viewport camera is still moving
+     * @return bool True while a camera needs further frames
+     */
+    bool AreCamerasAnimating() const;
+    
+    /**
+     * @brief Sets the world position vertex coordinates are relative to
+     * 
+     * The difference to the camera origin is folded into the view matrix in
+     * double precision, so vertex data never has to be rewritten.
+     * 
+     * @param origin Scene origin in world coordinates
+     */
+    nil SetSceneOrigin(const MentalEngine::Math::Vector3d& origin) { scene_origin = origin; }
+    
+    /**
+     * @brief Records lines drawn into the viewport
      * @param points Vector of line points (pairs of start/end points)
      * @param color Line color (RGB)
      * @param line_width Line width in pixels
+     * @param layer Draw layer; later layers draw on top
+     */
+    nil RenderLines(const std::vector<MentalEngine::Math::Vector2>& points, const MentalEngine::Math::Vector3& color = MentalEngine::Math::Vector3(1.0f, 1.0f, 1.0f), float line_width = 2.0f, RenderLayer layer = RenderLayer::Scene);
+    
+    /**
+     * @brief Records lines drawn into the viewport
+     * @param points Line points (pairs of start/end points)
+     * @param count Number of points
+     * @param color Line color (RGB)
+     * @param line_width Line width in pixels
+     * @param layer Draw layer; later layers draw on top
+     */
+    nil RenderLines(const MentalEngine::Math::Vector2* points, size_t count, const MentalEngine::Math::Vector3& color = MentalEngine::Math::Vector3(1.0f, 1.0f, 1.0f), float line_width = 2.0f, RenderLayer layer = RenderLayer::Scene);
+    
+    /**
+     * @brief Records the segments of one primitive drawn into the viewport
+     * @param scene Scene containing the primitive
+     * @param id Primitive to draw; ignored if stale
+     * @param color Line color (RGB)
+     * @param line_width Line width in pixels
+     * @param layer Draw layer; later layers draw on top
+     */
+    nil RenderPrimitive(const MentalEngine::Scene& scene, MentalEngine::PrimitiveId id, const MentalEngine::Math::Vector3& color, float line_width = 2.0f, RenderLayer layer = RenderLayer::Highlight);
+    
+    /**
+     * @brief Records all scene geometry drawn into the viewport
+     * @param scene Scene whose lines and arcs are drawn; must not change before EndPacket()
+     * @param color Line color (RGB)
+     * @param line_width Line width in pixels
+     * @param layer Draw layer; later layers draw on top
+     */
+    nil RenderScene(const MentalEngine::Scene& scene, const MentalEngine::Math::Vector3& color = MentalEngine::Math::Vector3(1.0f, 1.0f, 1.0f), float line_width = 2.0f, RenderLayer layer = RenderLayer::Scene);
+    
+    /**
+     * @brief Adds draws prepared in a command list to the current viewport pass
+     * @param list Draws built on any thread; must not be modified during the call
      */
-    nil RenderLines(const std::vector<MentalEngine::Math::Vector2>& points, const MentalEngine::Math::Vector3& color = MentalEngine::Math::Vector3(1.0f, 1.0f, 1.0f), float line_width = 2.0f);
+    nil Submit(const RenderCommandList& list);
 };
 
 #endif // MENTAL_RENDERER_H
@@ -0,0 +1,333 @@
+/**
+ * @file ShaderCache.cpp
+ * @brief Implementation of the shader program cache
+ * @author MentalEngine Team
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#include "ShaderCache.h"
+#include "../../Core/MappedFile.h"
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+
+namespace {
+
+constexpr uint64_t FNV_OFFSET = 14695981039346656037ull;  ///< FNV-1a offset basis
+constexpr uint64_t FNV_PRIME = 1099511628211ull;          ///< FNV-1a prime
+constexpr size_t STAGE_COUNT = 3;                         ///< Vertex, geometry, fragment
+
+/**
+ * @struct BinaryHeader
+ * @brief Header of a program binary file, followed by the driver's blob
+ */
+struct BinaryHeader {
+    uint32_t magic;    ///< ShaderCache::BINARY_MAGIC
+    uint32_t version;  ///< ShaderCache::BINARY_VERSION
+    uint64_t key;      ///< Program key, guards against hash-named file collisions
+    uint32_t format;   ///< Binary format reported by glGetProgramBinary()
+    uint32_t length;   ///< Blob bytes
+};
+static_assert(sizeof(BinaryHeader) == 24, "binary header layout is part of the file format");
+
+uint64_t HashString(uint64_t hash, const char* text) {
+    // Отсутствующая стадия отличается от пустой строки
+    if (!text) return (hash ^ 0xFF) * FNV_PRIME;
+    for (const unsigned char* c = reinterpret_cast<const unsigned char*>(text); *c; c++) {
+        hash = (hash ^ *c) * FNV_PRIME;
+    }
+    return (hash ^ 0) * FNV_PRIME;
+}
+
+const char* GetGlString(GLenum name) {
+    const GLubyte* text = glGetString(name);
+    return text ? reinterpret_cast<const char*>(text) : "";
+}
+
+/**
+ * @brief Reads an info log of any length
+ */
+std::string GetInfoLog(GLuint object, bool program) {
+    GLint length = 0;
+    if (program) {
+        glGetProgramiv(object, GL_INFO_LOG_LENGTH, &length);
+    } else {
+        glGetShaderiv(object, GL_INFO_LOG_LENGTH, &length);
+    }
+    if (length <= 1) return std::string();
+    std::string log(static_cast<size_t>(length), '\0');
+    if (program) {
+        glGetProgramInfoLog(object, length, nullptr, &log[0]);
+    } else {
+        glGetShaderInfoLog(object, length, nullptr, &log[0]);
+    }
+    log.resize(std::strlen(log.c_str()));
+    return log;
+}
+
+bool ReplaceFile(const std::string& from, const std::string& to) {
+    if (std::rename(from.c_str(), to.c_str()) == 0) return true;
+    // Windows не заменяет существующий файл при rename
+    std::remove(to.c_str());
+    return std::rename(from.c_str(), to.c_str()) == 0;
+}
+
+} // namespace
+
+nil ShaderCache::Init(const std::string& binary_directory) {
+    directory = binary_directory;
+    driver_id = std::string(GetGlString(GL_VENDOR)) + "|" + GetGlString(GL_RENDERER) + "|" + GetGlString(GL_VERSION);
+
+    parallel = GLEW_KHR_parallel_shader_compile;
+    if (parallel) {
+        // 0xFFFFFFFF - число потоков выбирает драйвер
+        glMaxShaderCompilerThreadsKHR(0xFFFFFFFFu);
+    }
+
+    GLint formats = 0;
+    if (GLEW_ARB_get_program_binary) glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    binaries = formats > 0;
+    if (binaries && !directory.empty()) {
+        std::error_code error;
+        std::filesystem::create_directories(directory, error);
+        if (error) {
+            std::cerr << "Shader cache: cannot create " << directory << ": " << error.message() << std::endl;
+            directory.clear();
+        }
+    }
+    parallel_used.store(parallel, std::memory_order_relaxed);
+    disk_cache_used.store(binaries && !directory.empty(), std::memory_order_relaxed);
+    initialized = true;
+}
+
+ShaderCache::Handle ShaderCache::Request(const char* name, const ShaderSource& source, const std::string& defines) {
+    if (!initialized) Init(std::string());
+    const uint64_t key = Key(driver_id, source, defines);
+    for (size_t i = 0; i < programs.size(); i++) {
+        if (programs[i].key == key) return i;
+    }
+
+    // Освобожденные записи переиспользуются, чтобы перезагрузки не растили список
+    Handle handle = programs.size();
+    if (!free_slots.empty()) {
+        handle = free_slots.back();
+        free_slots.pop_back();
+        programs[handle] = Program();
+    } else {
+        programs.emplace_back();
+    }
+    Program& entry = programs[handle];
+    entry.key = key;
+    entry.name = name ? name : "?";
+    if (!__load_binary(entry)) __compile(entry, source, defines);
+    program_count.fetch_add(1, std::memory_order_relaxed);
+    return handle;
+}
+
+bool ShaderCache::IsReady(Handle handle) {
+    if (handle >= programs.size()) return false;
+    Program& entry = programs[handle];
+    if (entry.state != ProgramState::Compiling) return true;
+    if (parallel) {
+        GLint done = GL_FALSE;
+        glGetProgramiv(entry.program, GL_COMPLETION_STATUS_KHR, &done);
+        if (!done) return false;
+    }
+    // Без расширения статус читается синхронно - драйвер доделает компиляцию здесь
+    __finish(entry);
+    return true;
+}
+
+GLuint ShaderCache::Get(Handle handle) {
+    if (handle >= programs.size()) return 0;
+    Program& entry = programs[handle];
+    if (entry.state == ProgramState::Compiling) __finish(entry);
+    return entry.state == ProgramState::Ready ? entry.program : 0;
+}
+
+nil ShaderCache::Poll() {
+    if (!parallel) return;
+    for (size_t i = 0; i < programs.size(); i++) {
+        if (programs[i].state == ProgramState::Compiling) IsReady(i);
+    }
+}
+
+nil ShaderCache::Release(Handle handle) {
+    if (handle >= programs.size() || programs[handle].key == 0) return;
+    Program& entry = programs[handle];
+    for (GLuint& shader : entry.shaders) {
+        if (shader) glDeleteShader(shader);
+        shader = 0;
+    }
+    if (entry.program) glDeleteProgram(entry.program);
+    // Запись остается, чтобы не сдвигать handles, и уходит в список свободных
+    entry.program = 0;
+    entry.key = 0;
+    entry.state = ProgramState::Failed;
+    free_slots.push_back(handle);
+    program_count.fetch_sub(1, std::memory_order_relaxed);
+}
+
+nil ShaderCache::Clear() {
+    for (Program& entry : programs) {
+        for (GLuint& shader : entry.shaders) {
+            if (shader) glDeleteShader(shader);
+            shader = 0;
+        }
+        if (entry.program) glDeleteProgram(entry.program);
+    }
+    programs.clear();
+    free_slots.clear();
+    program_count.store(0, std::memory_order_relaxed);
+}
+
+ShaderCacheStats ShaderCache::GetStats() const {
+    ShaderCacheStats stats;
+    stats.programs = program_count.load(std::memory_order_relaxed);
+    stats.binary_hits = binary_hits.load(std::memory_order_relaxed);
+    stats.compiled = compiled.load(std::memory_order_relaxed);
+    stats.failed = failed.load(std::memory_order_relaxed);
+    stats.parallel = parallel_used.load(std::memory_order_relaxed);
+    stats.binaries = disk_cache_used.load(std::memory_order_relaxed);
+    return stats;
+}
+
+uint64_t ShaderCache::Key(const std::string& driver_id, const ShaderSource& source, const std::string& defines) {
+    uint64_t hash = HashString(FNV_OFFSET, driver_id.c_str());
+    hash = HashString(hash, source.vertex);
+    hash = HashString(hash, source.geometry);
+    hash = HashString(hash, source.fragment);
+    return HashString(hash, defines.c_str());
+}
+
+nil ShaderCache::__compile(Program& entry, const ShaderSource& source, const std::string& defines) {
+    const struct { GLenum type; const char* source; } stages[STAGE_COUNT] = {
+        {GL_VERTEX_SHADER, source.vertex},
+        {GL_GEOMETRY_SHADER, source.geometry},
+        {GL_FRAGMENT_SHADER, source.fragment},
+    };
+
+    entry.program = glCreateProgram();
+    for (size_t i = 0; i < STAGE_COUNT; i++) {
+        if (!stages[i].source) continue;
+
+        // #define допустимы только после #version - вставляем следующей строкой
+        std::string text(stages[i].source);
+        size_t insert_at = 0;
+        const size_t version = text.find("#version");
+        if (version != std::string::npos) {
+            const size_t line_end = text.find('\n', version);
+            if (line_end == std::string::npos) text += '\n';
+            insert_at = line_end == std::string::npos ? text.size() : line_end + 1;
+        }
+        text.insert(insert_at, defines);
+
+        const char* text_data = text.c_str();
+        GLuint shader = glCreateShader(stages[i].type);
+        glShaderSource(shader, 1, &text_data, nullptr);
+        glCompileShader(shader);
+        glAttachShader(entry.program, shader);
+        entry.shaders[i] = shader;
+    }
+    if (binaries) glProgramParameteri(entry.program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+
+    // С GL_KHR_parallel_shader_compile вызов возвращается сразу, статус читаем позже
+    glLinkProgram(entry.program);
+}
+
+nil ShaderCache::__finish(Program& entry) {
+    static const char* const STAGE_NAMES[STAGE_COUNT] = {"VERTEX", "GEOMETRY", "FRAGMENT"};
+    GLint success = GL_FALSE;
+    for (size_t i = 0; i < STAGE_COUNT; i++) {
+        if (!entry.shaders[i]) continue;
+        glGetShaderiv(entry.shaders[i], GL_COMPILE_STATUS, &success);
+        if (!success) {
+            std::cout << "ERROR::SHADER::" << entry.name << "::" << STAGE_NAMES[i] << "::COMPILATION_FAILED\n"
+                      << GetInfoLog(entry.shaders[i], false) << std::endl;
+        }
+    }
+
+    glGetProgramiv(entry.program, GL_LINK_STATUS, &success);
+    if (!success) {
+        std::cout << "ERROR::SHADER::" << entry.name << "::LINKING_FAILED\n" << GetInfoLog(entry.program, true) << std::endl;
+    }
+
+    // Стадии больше не нужны: программа слинкована (или не будет использоваться)
+    for (GLuint& shader : entry.shaders) {
+        if (!shader) continue;
+        glDetachShader(entry.program, shader);
+        glDeleteShader(shader);
+        shader = 0;
+    }
+
+    if (!success) {
+        glDeleteProgram(entry.program);
+        entry.program = 0;
+        entry.state = ProgramState::Failed;
+        failed.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    entry.state = ProgramState::Ready;
+    compiled.fetch_add(1, std::memory_order_relaxed);
+    __store_binary(entry);
+}
+
+bool ShaderCache::__load_binary(Program& entry) {
+    if (!binaries || directory.empty()) return false;
+    MentalEngine::MappedFile file;
+    if (!file.Open(__binary_path(entry.key))) return false;
+
+    BinaryHeader header;
+    if (file.GetSize() < sizeof(header)) return false;
+    std::memcpy(&header, file.GetData(), sizeof(header));
+    if (header.magic != BINARY_MAGIC || header.version != BINARY_VERSION || header.key != entry.key ||
+        header.length != file.GetSize() - sizeof(header)) {
+        return false;
+    }
+
+    GLuint program = glCreateProgram();
+    glProgramBinary(program, header.format, file.GetData() + sizeof(header), static_cast<GLsizei>(header.length));
+    GLint success = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (!success) {
+        // Драйвер вправе отвергнуть бинарник - тогда компилируем и перезаписываем файл
+        glDeleteProgram(program);
+        return false;
+    }
+    entry.program = program;
+    entry.state = ProgramState::Ready;
+    binary_hits.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+nil ShaderCache::__store_binary(const Program& entry) {
+    if (!binaries || directory.empty()) return;
+    GLint length = 0;
+    glGetProgramiv(entry.program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) return;
+
+    std::vector<unsigned char> blob(static_cast<size_t>(length));
+    GLsizei written = 0;
+    GLenum format = 0;
+    glGetProgramBinary(entry.program, length, &written, &format, blob.data());
+    if (written <= 0) return;
+
+    BinaryHeader header = {BINARY_MAGIC, BINARY_VERSION, entry.key, format, static_cast<uint32_t>(written)};
+    const std::string path = __binary_path(entry.key);
+    const std::string temp_path = path + ".tmp";
+    FILE* file = std::fopen(temp_path.c_str(), "wb");
+    if (!file) return;
+    bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1;
+    ok = std::fwrite(blob.data(), 1, static_cast<size_t>(written), file) == static_cast<size_t>(written) && ok;
+    ok = std::fclose(file) == 0 && ok;
+    // Частично записанный файл не должен попасть под настоящим именем
+    if (!ok || !ReplaceFile(temp_path, path)) std::remove(temp_path.c_str());
+}
+
+std::string ShaderCache::__binary_path(uint64_t key) const {
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.bin", static_cast<unsigned long long>(key));
+    return directory + "/" + name;
+}
@@ -0,0 +1,209 @@
+/**
+ * @file ShaderCache.h
+ * @brief Shader program cache with on-disk program binaries for MentalEngine
+ * @author MentalEngine Team
+ * @version 1.0.0
+ * @date 2024
+ *
+ * This file defines the ShaderCache class, which builds shader programs
+ * from GLSL sources and preprocessor defines, reuses programs requested
+ * more than once, and stores linked program binaries on disk so later runs
+ * skip compilation.
+ */
+
+#ifndef MENTAL_SHADER_CACHE_H
+#define MENTAL_SHADER_CACHE_H
+
+#define GL_SILENCE_DEPRECATION
+#include <GL/glew.h>
+#include "../../Core/Types.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @struct ShaderSource
+ * @brief GLSL sources of the stages of one program
+ *
+ * Each source starts with its #version line; defines are inserted right
+ * after it.
+ */
+struct ShaderSource {
+    const char* vertex = nullptr;    ///< Vertex stage
+    const char* geometry = nullptr;  ///< Geometry stage, nullptr when unused
+    const char* fragment = nullptr;  ///< Fragment stage
+};
+
+/**
+ * @struct ShaderCacheStats
+ * @brief Counters of a ShaderCache
+ */
+struct ShaderCacheStats {
+    size_t programs = 0;         ///< Live programs, not counting released ones
+    uint64_t binary_hits = 0;    ///< Programs loaded from a disk binary
+    uint64_t compiled = 0;       ///< Programs compiled from source
+    uint64_t failed = 0;         ///< Programs that failed to compile or link
+    bool parallel = false;       ///< GL_KHR_parallel_shader_compile is used
+    bool binaries = false;       ///< Program binaries are read and written
+};
+
+/**
+ * @class ShaderCache
+ * @brief Builds, shares and persists shader programs
+ *
+ * A program is identified by a hash of its stage sources, its defines and
+ * the GL vendor, renderer and version strings, so a driver update never
+ * loads a stale binary. Request() returns at once: the program is loaded
+ * from "<directory>/<key>.bin" when a binary is present and accepted by
+ * the driver, and otherwise compiled and linked. With
+ * GL_KHR_parallel_shader_compile the driver compiles on its own threads,
+ * so variants that are not needed yet can be requested early and polled;
+ * Get() waits only for the program asked for. Newly linked programs are
+ * written back to disk.
+ *
+ * @note All methods except GetStats() need the GL context
+ */
+class ShaderCache {
+public:
+    using Handle = size_t;                                            ///< Index of a requested program
+    static constexpr Handle INVALID_HANDLE = static_cast<size_t>(-1);  ///< Returned when nothing was requested
+    static constexpr uint32_t BINARY_MAGIC = 0x42485353;              ///< "SSHB" in little-endian order
+    static constexpr uint32_t BINARY_VERSION = 1;                     ///< Binary file layout version
+
+private:
+    /**
+     * @enum ProgramState
+     * @brief Build progress of a program
+     */
+    enum class ProgramState : uint8_t {
+        Compiling = 0,  ///< Compile and link were issued; status not yet read
+        Ready,          ///< Linked successfully
+        Failed          ///< Compile or link failed; program is 0
+    };
+
+    /**
+     * @struct Program
+     * @brief One cached program
+     */
+    struct Program {
+        uint64_t key = 0;                 ///< Hash of driver, sources and defines
+        std::string name;                 ///< Name used in log messages
+        GLuint program = 0;               ///< Program object
+        GLuint shaders[3] = {0, 0, 0};    ///< Stage objects until the link status is read
+        ProgramState state = ProgramState::Compiling;
+    };
+
+    std::vector<Program> programs;  ///< Requested programs; handles index this
+    std::vector<Handle> free_slots; ///< Released entries the next Request() reuses
+    std::string directory;          ///< Where binaries are stored; empty disables them
+    std::string driver_id;          ///< Vendor, renderer and version strings
+    bool initialized = false;       ///< Init() ran
+    bool parallel = false;          ///< GL_KHR_parallel_shader_compile available
+    bool binaries = false;          ///< Program binaries supported by the driver
+    std::atomic<bool> parallel_used{false};  ///< Copies for GetStats(), read from other threads
+    std::atomic<bool> disk_cache_used{false};
+    std::atomic<uint64_t> binary_hits{0};
+    std::atomic<uint64_t> compiled{0};
+    std::atomic<uint64_t> failed{0};
+    std::atomic<size_t> program_count{0};
+
+    /**
+     * @brief Issues compilation and linking of a program
+     * @private
+     */
+    nil __compile(Program& entry, const ShaderSource& source, const std::string& defines);
+
+    /**
+     * @brief Reads compile and link status, logs errors, stores the binary
+     * @private
+     */
+    nil __finish(Program& entry);
+
+    /**
+     * @brief Loads a program from its disk binary
+     * @private
+     */
+    bool __load_binary(Program& entry);
+
+    /**
+     * @brief Writes a linked program's binary to disk
+     * @private
+     */
+    nil __store_binary(const Program& entry);
+
+    /**
+     * @brief Gets the binary file path of a key
+     * @private
+     */
+    std::string __binary_path(uint64_t key) const;
+
+public:
+    ShaderCache() = default;
+    ~ShaderCache() = default;
+    ShaderCache(const ShaderCache&) = delete;
+    ShaderCache& operator=(const ShaderCache&) = delete;
+
+    /**
+     * @brief Queries driver capabilities and prepares the binary directory
+     * @param binary_directory Directory for program binaries; empty disables disk caching
+     */
+    nil Init(const std::string& binary_directory);
+
+    /**
+     * @brief Requests a program, starting its build if it is not cached
+     * @param name Name used in log messages
+     * @param source Stage sources
+     * @param defines Preprocessor lines inserted after #version, e.g. "#define HARD_EDGES\n"
+     * @return Handle Program handle; the same handle for the same sources and defines
+     */
+    Handle Request(const char* name, const ShaderSource& source, const std::string& defines = std::string());
+
+    /**
+     * @brief Checks without blocking whether a program has finished building
+     * @param handle Program handle
+     * @return bool True once Get() would not wait
+     */
+    bool IsReady(Handle handle);
+
+    /**
+     * @brief Gets a program, waiting for its build to finish
+     * @param handle Program handle
+     * @return GLuint Linked program, 0 if the build failed or the handle is invalid
+     */
+    GLuint Get(Handle handle);
+
+    /**
+     * @brief Finishes background builds that completed since the last call
+     */
+    nil Poll();
+
+    /**
+     * @brief Deletes one program, e.g. after a reloaded version replaced it
+     * @param handle Program handle; Get() returns 0 for it until a later Request() reuses it
+     */
+    nil Release(Handle handle);
+
+    /**
+     * @brief Deletes every cached program; handles become invalid
+     */
+    nil Clear();
+
+    /**
+     * @brief Gets counters; safe to call from any thread
+     * @return ShaderCacheStats Counters
+     */
+    ShaderCacheStats GetStats() const;
+
+    /**
+     * @brief Hashes the inputs of a program
+     * @param driver_id Driver identification string
+     * @param source Stage sources
+     * @param defines Preprocessor lines
+     * @return uint64_t 64-bit FNV-1a hash
+     */
+    static uint64_t Key(const std::string& driver_id, const ShaderSource& source, const std::string& defines);
+};
+
+#endif // MENTAL_SHADER_CACHE_H
@@ -0,0 +1,176 @@
+/**
+ * @file ShaderWatcher.cpp
+ * @brief Implementation of the shader file watcher
+ * @author MentalEngine Team
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#include "ShaderWatcher.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#else
+#include <map>
+#endif
+
+namespace {
+
+nil AddUnique(std::vector<std::string>& names, const std::string& name) {
+    if (std::find(names.begin(), names.end(), name) == names.end()) names.push_back(name);
+}
+
+#ifdef __linux__
+
+/**
+ * @brief Waits for inotify events and collects the names of changed files
+ * @return int Events read, 0 on timeout, -1 if reading the descriptor failed
+ */
+int ReadEvents(int fd, int timeout_ms, std::vector<std::string>& names) {
+    pollfd request = {fd, POLLIN, 0};
+    if (poll(&request, 1, timeout_ms) <= 0) return 0;
+
+    alignas(inotify_event) char buffer[4096];
+    const ssize_t length = read(fd, buffer, sizeof(buffer));
+    if (length <= 0) return -1;
+    int count = 0;
+    for (ssize_t offset = 0; offset < length; count++) {
+        const inotify_event* event = reinterpret_cast<const inotify_event*>(buffer + offset);
+        if (event->len > 0 && !(event->mask & IN_ISDIR)) AddUnique(names, event->name);
+        offset += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+    }
+    return count;
+}
+
+#endif
+
+} // namespace
+
+bool ShaderWatcher::Start(const std::string& path, std::function<nil()> callback) {
+    if (IsRunning()) return true;
+    std::error_code error;
+    if (!std::filesystem::is_directory(path, error)) return false;
+    directory = path;
+    on_change = std::move(callback);
+    stopping = false;
+    thread = std::thread(&ShaderWatcher::__loop, this);
+    return true;
+}
+
+nil ShaderWatcher::Stop() {
+    if (!IsRunning()) return;
+    stopping = true;
+    thread.join();
+    std::lock_guard<std::mutex> lock(mutex);
+    changes.clear();
+}
+
+bool ShaderWatcher::TakeChanges(std::vector<ShaderFileChange>& out) {
+    out.clear();
+    std::lock_guard<std::mutex> lock(mutex);
+    if (changes.empty()) return false;
+    std::swap(out, changes);
+    return true;
+}
+
+bool ShaderWatcher::ReadFile(const std::string& path, std::string& text) {
+    FILE* file = std::fopen(path.c_str(), "rb");
+    if (!file) return false;
+    text.clear();
+    char buffer[4096];
+    size_t read = 0;
+    while ((read = std::fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        text.append(buffer, read);
+    }
+    const bool ok = !std::ferror(file);
+    std::fclose(file);
+    return ok;
+}
+
+nil ShaderWatcher::__publish(const std::vector<std::string>& names) {
+    // Файлы читаются здесь, чтобы поток рендера получил готовый текст
+    std::vector<ShaderFileChange> read;
+    for (const std::string& name : names) {
+        ShaderFileChange change;
+        change.name = name;
+        if (ReadFile(directory + "/" + name, change.text)) read.push_back(std::move(change));
+    }
+    if (read.empty()) return;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (ShaderFileChange& change : read) {
+            // Повторное изменение файла заменяет еще не забранное
+            auto same = std::find_if(changes.begin(), changes.end(), [&](const ShaderFileChange& queued) { return queued.name == change.name; });
+            if (same != changes.end()) {
+                same->text = std::move(change.text);
+            } else {
+                changes.push_back(std::move(change));
+            }
+        }
+    }
+    if (on_change) on_change();
+}
+
+#ifdef __linux__
+
+nil ShaderWatcher::__loop() {
+    const int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (fd < 0 || inotify_add_watch(fd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+        std::cerr << "Shader watcher: cannot watch " << directory << std::endl;
+        if (fd >= 0) close(fd);
+        return;
+    }
+
+    std::vector<std::string> names;
+    while (!stopping) {
+        names.clear();
+        // Таймаут нужен только для проверки stopping
+        int events = ReadEvents(fd, POLL_MILLISECONDS, names);
+        // Собираем остальные события того же сохранения
+        while (events > 0 && !stopping) {
+            events = ReadEvents(fd, DEBOUNCE_MILLISECONDS, names);
+        }
+        if (events < 0) break;
+        if (!names.empty()) __publish(names);
+    }
+    close(fd);
+}
+
+#else
+
+nil ShaderWatcher::__loop() {
+    namespace fs = std::filesystem;
+    std::map<std::string, fs::file_time_type> times;
+    bool first = true;
+    std::vector<std::string> names;
+    while (!stopping) {
+        names.clear();
+        std::error_code error;
+        for (const fs::directory_entry& entry : fs::directory_iterator(directory, error)) {
+            if (!entry.is_regular_file(error)) continue;
+            const std::string name = entry.path().filename().string();
+            const fs::file_time_type time = entry.last_write_time(error);
+            auto known = times.find(name);
+            if (known == times.end() || known->second != time) {
+                times[name] = time;
+                // Первый проход только запоминает времена
+                if (!first) AddUnique(names, name);
+            }
+        }
+        first = false;
+        if (!names.empty()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(DEBOUNCE_MILLISECONDS));
+            __publish(names);
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(POLL_MILLISECONDS));
+    }
+}
+
+#endif
@@ -0,0 +1,111 @@
+/**
+ * @file ShaderWatcher.h
+ * @brief Background watcher of shader source files for MentalEngine
+ * @author MentalEngine Team
+ * @version 1.0.0
+ * @date 2024
+ *
+ * This file defines the ShaderWatcher class, which notices edits to the
+ * files of a shader directory and reads the new sources on its own thread,
+ * so the renderer can rebuild programs without a restart.
+ */
+
+#ifndef MENTAL_SHADER_WATCHER_H
+#define MENTAL_SHADER_WATCHER_H
+
+#include "../../Core/Types.h"
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @struct ShaderFileChange
+ * @brief New contents of an edited shader file
+ */
+struct ShaderFileChange {
+    std::string name;  ///< File name inside the watched directory, e.g. "line.frag"
+    std::string text;  ///< Full file contents
+};
+
+/**
+ * @class ShaderWatcher
+ * @brief Reports edited shader files with their new contents
+ *
+ * On Linux the thread blocks on inotify and reacts to files being closed
+ * after writing or renamed into the directory, which covers editors that
+ * save through a temporary file. Elsewhere it compares modification times
+ * every POLL_MILLISECONDS. Events for the same file within DEBOUNCE_MILLISECONDS
+ * are merged, so a save written in several steps is read once.
+ *
+ * @note Start(), Stop() and the destructor must be called from one thread;
+ *       TakeChanges() may be called from any thread
+ */
+class ShaderWatcher {
+private:
+    std::string directory;                 ///< Watched directory
+    std::function<nil()> on_change;        ///< Called on the watcher thread after changes were queued
+    std::thread thread;                    ///< Watcher thread
+    std::atomic<bool> stopping{false};     ///< Asks the thread to exit
+    std::mutex mutex;                      ///< Guards changes
+    std::vector<ShaderFileChange> changes; ///< Read but not yet taken
+
+    /**
+     * @brief Thread body
+     * @private
+     */
+    nil __loop();
+
+    /**
+     * @brief Reads changed files and queues them
+     * @private
+     */
+    nil __publish(const std::vector<std::string>& names);
+
+public:
+    static constexpr int POLL_MILLISECONDS = 250;     ///< Wake-up period; also the polling interval off Linux
+    static constexpr int DEBOUNCE_MILLISECONDS = 50;  ///< Time to collect events of one save
+
+    ShaderWatcher() = default;
+    ~ShaderWatcher() { Stop(); }
+    ShaderWatcher(const ShaderWatcher&) = delete;
+    ShaderWatcher& operator=(const ShaderWatcher&) = delete;
+
+    /**
+     * @brief Starts watching a directory
+     * @param path Directory holding the shader files
+     * @param callback Called on the watcher thread when changes are queued, e.g. to wake the UI loop
+     * @return bool False if the directory cannot be watched
+     */
+    bool Start(const std::string& path, std::function<nil()> callback);
+
+    /**
+     * @brief Stops the thread and drops queued changes
+     */
+    nil Stop();
+
+    /**
+     * @brief Checks whether the watcher thread runs
+     * @return bool True between Start() and Stop()
+     */
+    bool IsRunning() const { return thread.joinable(); }
+
+    /**
+     * @brief Moves queued changes to the caller
+     * @param out Receives the changes, oldest first; cleared first
+     * @return bool True if there was at least one change
+     */
+    bool TakeChanges(std::vector<ShaderFileChange>& out);
+
+    /**
+     * @brief Reads a whole text file
+     * @param path File path
+     * @param text Receives the contents
+     * @return bool False if the file cannot be read
+     */
+    static bool ReadFile(const std::string& path, std::string& text);
+};
+
+#endif // MENTAL_SHADER_WATCHER_H
@@ -0,0 +1,158 @@
+/**
+ * @file TileCache.cpp
+ * @brief Implementation of the plan view tile cache
+ * @author MentalEngine Team
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#include "TileCache.h"
+#include "../../Core/MemoryTracker.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+constexpr int64_t TILE_BYTES = static_cast<int64_t>(TileCache::TILE_SIZE) * TileCache::TILE_SIZE * 4;  ///< RGBA8 storage of one tile
+
+} // namespace
+
+int TileCache::SelectZoom(float pixel_size) {
+    // Ближайший по логарифму размер текселя: тайл масштабируется не более чем в sqrt(2) раз
+    return static_cast<int>(std::lround(std::log2(std::max(pixel_size, 1.0e-20f))));
+}
+
+float TileCache::GetTileWorldSize(int zoom) {
+    return std::ldexp(static_cast<float>(TILE_SIZE), zoom);
+}
+
+MentalEngine::Bounds2D TileCache::GetBounds(int zoom, int32_t x, int32_t y) {
+    const float size = GetTileWorldSize(zoom);
+    return MentalEngine::Bounds2D(x * size, y * size, (x + 1) * size, (y + 1) * size);
+}
+
+nil TileCache::__invalidate_all() {
+    for (auto& entry : tiles) {
+        entry.second.ready = false;
+        entry.second.dirty = true;
+    }
+}
+
+nil TileCache::Sync(const MentalEngine::Scene& scene, uint64_t tile_style, float margin_texels) {
+    if (source != &scene || style != tile_style) {
+        if (source != &scene) ForgetTiles();
+        __invalidate_all();
+        source = &scene;
+        style = tile_style;
+        revision = scene.GetRevision();
+        return;
+    }
+    if (revision == scene.GetRevision()) return;
+
+    changes.clear();
+    if (!scene.GetChangesSince(revision, changes)) {
+        // Загрузка или очистка: старое содержимое тайлов неверно целиком
+        __invalidate_all();
+    } else {
+        // Правка: тайлы остаются видимыми, пока не перерисованы
+        for (auto& entry : tiles) {
+            Tile& tile = entry.second;
+            if (tile.dirty) continue;
+            const float margin = std::ldexp(margin_texels, tile.zoom);
+            MentalEngine::Bounds2D area = GetBounds(tile.zoom, tile.x, tile.y);
+            area = MentalEngine::Bounds2D(area.min_x - margin, area.min_y - margin, area.max_x + margin, area.max_y + margin);
+            for (const MentalEngine::Bounds2D& change : changes) {
+                if (!change.Intersects(area)) continue;
+                tile.dirty = true;
+                break;
+            }
+        }
+    }
+    revision = scene.GetRevision();
+}
+
+TileCache::Tile* TileCache::Acquire(int zoom, int32_t x, int32_t y) {
+    const uint64_t key = __key(zoom, x, y);
+    auto found = tiles.find(key);
+    if (found != tiles.end()) {
+        found->second.last_used = frame;
+        return &found->second;
+    }
+
+    uint32_t slot = 0;
+    if (!free_slots.empty()) {
+        slot = free_slots.back();
+        free_slots.pop_back();
+    } else if (slot_count < MAX_TILES) {
+        slot = slot_count++;
+    } else {
+        // Вытесняем самый давно использованный тайл, кроме нужных в этом кадре
+        auto victim = tiles.end();
+        for (auto it = tiles.begin(); it != tiles.end(); ++it) {
+            if (it->second.last_used == frame) continue;
+            if (victim == tiles.end() || it->second.last_used < victim->second.last_used) victim = it;
+        }
+        if (victim == tiles.end()) return nullptr;
+        slot = victim->second.slot;
+        tiles.erase(victim);
+    }
+
+    Tile& tile = tiles[key];
+    tile = Tile();
+    tile.zoom = zoom;
+    tile.x = x;
+    tile.y = y;
+    tile.slot = slot;
+    tile.last_used = frame;
+    return &tile;
+}
+
+const TileCache::Tile* TileCache::FindReady(int zoom, int32_t x, int32_t y) {
+    auto found = tiles.find(__key(zoom, x, y));
+    if (found == tiles.end() || !found->second.ready) return nullptr;
+    // Замещающий тайл показывается в этом кадре: его слот нельзя отдать другому
+    found->second.last_used = frame;
+    return &found->second;
+}
+
+nil TileCache::ForgetTiles() {
+    tiles.clear();
+    free_slots.clear();
+    slot_count = 0;
+    source = nullptr;
+    revision = 0;
+    style = 0;
+}
+
+nil TileCache::BeginRender(uint32_t slot) {
+    if (framebuffer == 0) glGenFramebuffers(1, &framebuffer);
+    if (slot >= textures.size()) textures.resize(slot + 1, 0);
+    if (textures[slot] == 0) {
+        glGenTextures(1, &textures[slot]);
+        state.BindTexture2D(textures[slot]);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, TILE_SIZE, TILE_SIZE, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        MentalEngine::MemoryTracker::AddGpuMemory(MentalEngine::GpuMemoryKind::Texture, TILE_BYTES);
+    }
+
+    state.BindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, textures[slot], 0);
+    state.Viewport(0, 0, TILE_SIZE, TILE_SIZE);
+    // Прозрачный фон: тайлы накладываются на фон viewport с premultiplied alpha
+    state.ClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+}
+
+nil TileCache::ClearTargets() {
+    for (GLuint& texture : textures) {
+        if (texture == 0) continue;
+        glDeleteTextures(1, &texture);
+        MentalEngine::MemoryTracker::AddGpuMemory(MentalEngine::GpuMemoryKind::Texture, -TILE_BYTES);
+    }
+    textures.clear();
+    if (framebuffer != 0) glDeleteFramebuffers(1, &framebuffer);
+    framebuffer = 0;
+}
@@ -0,0 +1,194 @@
+/**
+ * @file TileCache.h
+ * @brief Cache of rasterized world-space tiles for plan views in MentalEngine
+ * @author MentalEngine Team
+ * @version 1.0.0
+ * @date 2024
+ *
+ * This file defines the TileCache class, which keeps the scene rendered
+ * into fixed-size textures covering a world-space grid per zoom level, so a
+ * plan view that pans or zooms composites a few dozen textured quads
+ * instead of drawing every primitive again.
+ */
+
+#ifndef MENTAL_TILE_CACHE_H
+#define MENTAL_TILE_CACHE_H
+
+#define GL_SILENCE_DEPRECATION
+#include <GL/glew.h>
+#include "../../Core/Types.h"
+#include "../Scene/Scene.h"
+#include "GLStateCache.h"
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @class TileCache
+ * @brief World-space tiles of the scene, rendered once and composited every frame
+ *
+ * Zoom level z has texels of 2^z world units, and its tiles cover
+ * TILE_SIZE texels on each side, aligned to multiples of the tile size. A
+ * view uses the level whose texel is closest to its pixel size, so a tile is
+ * shown scaled by at most sqrt(2).
+ *
+ * The UI thread half maps tile coordinates to texture slots, evicts the
+ * least recently used tile when all MAX_TILES slots are taken, and marks
+ * tiles dirty from the areas Scene::GetChangesSince() reports, so an edit
+ * re-renders only the tiles it touched. The GL thread half owns one texture
+ * per slot and a framebuffer to render into them.
+ */
+class TileCache {
+public:
+    static constexpr int TILE_SIZE = 256;     ///< Tile edge in texels
+    static constexpr uint32_t MAX_TILES = 128;  ///< Texture slots; RGBA8, 256 KB each
+
+    /**
+     * @struct Tile
+     * @brief A cached tile
+     */
+    struct Tile {
+        int zoom = 0;               ///< Zoom level
+        int32_t x = 0, y = 0;       ///< Tile coordinates at that level
+        uint32_t slot = 0;          ///< Texture slot
+        uint64_t generation = 0;    ///< Changes each time the tile is rendered
+        uint64_t last_used = 0;     ///< Frame of the last Acquire()
+        bool ready = false;         ///< The texture holds the tile's content, possibly stale
+        bool dirty = false;         ///< An edit touched the tile since it was rendered
+    };
+
+private:
+    // Bookkeeping (UI thread)
+    std::unordered_map<uint64_t, Tile> tiles;    ///< Cached tiles by packed zoom and coordinates
+    std::vector<uint32_t> free_slots;            ///< Slots without a tile
+    uint32_t slot_count = 0;                     ///< Slots handed out so far
+    const MentalEngine::Scene* source = nullptr; ///< Scene the tiles show
+    uint64_t revision = 0;                       ///< Revision of source the dirty flags are up to date with
+    uint64_t style = 0;                          ///< Hash of everything else that affects tile content
+    uint64_t frame = 0;                          ///< Frame counter for LRU eviction
+    uint64_t generation = 0;                     ///< Last generation handed out
+    std::vector<MentalEngine::Bounds2D> changes; ///< Scratch for Scene::GetChangesSince()
+
+    // Textures (GL thread)
+    GLStateCache& state;                         ///< Binds go through the renderer's state cache
+    GLuint framebuffer = 0;                      ///< Renders into the slot textures
+    std::vector<GLuint> textures;                ///< Texture per slot, 0 until first rendered
+
+    /**
+     * @brief Packs a zoom level and tile coordinates into a map key
+     * @private
+     */
+    static uint64_t __key(int zoom, int32_t x, int32_t y) {
+        return (static_cast<uint64_t>(static_cast<uint8_t>(zoom)) << 56) |
+               (static_cast<uint64_t>(static_cast<uint32_t>(x) & 0x0FFFFFFFu) << 28) |
+               (static_cast<uint32_t>(y) & 0x0FFFFFFFu);
+    }
+
+    /**
+     * @brief Marks every tile as needing a render; none is shown until rendered again
+     * @private
+     */
+    nil __invalidate_all();
+
+public:
+    /**
+     * @brief Constructor
+     * @param state State cache of the context the textures are used in
+     */
+    explicit TileCache(GLStateCache& state) : state(state) {}
+    ~TileCache() = default;
+    TileCache(const TileCache&) = delete;
+    TileCache& operator=(const TileCache&) = delete;
+
+    /**
+     * @brief Picks the zoom level for a pixel size
+     * @param pixel_size World units per pixel
+     * @return int Zoom level
+     */
+    static int SelectZoom(float pixel_size);
+
+    /**
+     * @brief Gets the world size of one tile
+     * @param zoom Zoom level
+     * @return float Tile edge in world units
+     */
+    static float GetTileWorldSize(int zoom);
+
+    /**
+     * @brief Gets the world bounds of a tile
+     * @param zoom Zoom level
+     * @param x Tile column
+     * @param y Tile row
+     * @return MentalEngine::Bounds2D Tile area
+     */
+    static MentalEngine::Bounds2D GetBounds(int zoom, int32_t x, int32_t y);
+
+    /**
+     * @brief Starts a frame of acquisitions
+     */
+    nil BeginFrame() { frame++; }
+
+    /**
+     * @brief Brings the dirty flags up to date with a scene
+     * @param scene Scene the tiles show
+     * @param tile_style Hash of line color, width, quality and shaders; a change invalidates every tile
+     * @param margin_texels How far strokes reach past primitive bounds, in texels
+     */
+    nil Sync(const MentalEngine::Scene& scene, uint64_t tile_style, float margin_texels);
+
+    /**
+     * @brief Finds a tile or assigns it a slot, evicting a tile not used this frame
+     * @param zoom Zoom level
+     * @param x Tile column
+     * @param y Tile row
+     * @return Tile* Tile, not ready if newly assigned; nullptr if every slot is in use this frame
+     */
+    Tile* Acquire(int zoom, int32_t x, int32_t y);
+
+    /**
+     * @brief Finds a ready tile and keeps it from being evicted this frame
+     * @return const Tile* Tile, or nullptr if it is not cached or not ready; never assigns a slot
+     */
+    const Tile* FindReady(int zoom, int32_t x, int32_t y);
+
+    /**
+     * @brief Marks a tile as rendered
+     * @param tile Tile from Acquire()
+     */
+    nil MarkRendered(Tile& tile) {
+        tile.ready = true;
+        tile.dirty = false;
+        tile.generation = ++generation;
+    }
+
+    size_t GetTileCount() const { return tiles.size(); }
+
+    /**
+     * @brief Binds a slot's texture as the render target and clears it
+     * @param slot Texture slot
+     * @note GL thread only
+     */
+    nil BeginRender(uint32_t slot);
+
+    /**
+     * @brief Gets a slot's texture
+     * @param slot Texture slot
+     * @return GLuint Texture, 0 if the slot was never rendered
+     * @note GL thread only
+     */
+    GLuint GetTexture(uint32_t slot) const { return slot < textures.size() ? textures[slot] : 0; }
+
+    /**
+     * @brief Deletes the textures and framebuffer
+     * @note GL thread only; call ForgetTiles() as well if the cache stays in use
+     */
+    nil ClearTargets();
+
+    /**
+     * @brief Drops every cached tile
+     * @note UI thread only
+     */
+    nil ForgetTiles();
+};
+
+#endif // MENTAL_TILE_CACHE_H
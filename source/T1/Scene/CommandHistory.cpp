@@ -0,0 +1,97 @@
+/**
+ * @file CommandHistory.cpp
+ * @brief Implementation of the CommandHistory class
+ * @author MentalEngine Team
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#include "CommandHistory.h"
+
+namespace MentalEngine {
+
+nil CommandHistory::Execute(Scene& scene, std::unique_ptr<SceneCommand> command) {
+    if (!command) return;
+    command->Apply(scene);
+    if (listener) listener(*command, true);
+    __clear_redo();
+
+    if (coalescing && merge_target_open && !undo_stack.empty()) {
+        SceneCommand& top = *undo_stack.back();
+        size_t before = top.GetMemoryUsage();
+        if (top.MergeWith(*command)) {
+            memory_usage = memory_usage - before + top.GetMemoryUsage();
+            return;
+        }
+    }
+
+    memory_usage += command->GetMemoryUsage();
+    undo_stack.push_back(std::move(command));
+    merge_target_open = coalescing;
+    __enforce_limits();
+}
+
+bool CommandHistory::Undo(Scene& scene) {
+    if (undo_stack.empty()) return false;
+    merge_target_open = false;
+
+    std::unique_ptr<SceneCommand> command = std::move(undo_stack.back());
+    undo_stack.pop_back();
+    memory_usage -= command->GetMemoryUsage();
+
+    command->Revert(scene);
+    if (listener) listener(*command, false);
+    memory_usage += command->GetMemoryUsage();
+    redo_stack.push_back(std::move(command));
+    return true;
+}
+
+bool CommandHistory::Redo(Scene& scene) {
+    if (redo_stack.empty()) return false;
+    merge_target_open = false;
+
+    std::unique_ptr<SceneCommand> command = std::move(redo_stack.back());
+    redo_stack.pop_back();
+    memory_usage -= command->GetMemoryUsage();
+
+    command->Apply(scene);
+    if (listener) listener(*command, true);
+    memory_usage += command->GetMemoryUsage();
+    undo_stack.push_back(std::move(command));
+    return true;
+}
+
+nil CommandHistory::BeginCoalescing() {
+    coalescing = true;
+    merge_target_open = false;
+}
+
+nil CommandHistory::EndCoalescing() {
+    coalescing = false;
+    merge_target_open = false;
+}
+
+nil CommandHistory::Clear() {
+    undo_stack.clear();
+    redo_stack.clear();
+    memory_usage = 0;
+    merge_target_open = false;
+}
+
+nil CommandHistory::__enforce_limits() {
+    // Always keep the newest step, even if it alone exceeds the budget
+    while (undo_stack.size() > 1 &&
+           (memory_usage > memory_budget || undo_stack.size() > max_commands)) {
+        memory_usage -= undo_stack.front()->GetMemoryUsage();
+        undo_stack.pop_front();
+    }
+}
+
+nil CommandHistory::__clear_redo() {
+    for (const auto& command : redo_stack) {
+        memory_usage -= command->GetMemoryUsage();
+    }
+    redo_stack.clear();
+}
+
+} // namespace MentalEngine
@@ -0,0 +1,141 @@
+/**
+ * @file CommandHistory.h
+ * @brief Undo/redo stack for scene edits
+ * @author MentalEngine Team
+ * @version 1.0.0
+ * @date 2024
+ *
+ * This file defines the CommandHistory class, which executes SceneCommand
+ * objects and keeps a memory-bounded undo/redo stack of them.
+ */
+
+#ifndef MENTAL_COMMAND_HISTORY_H
+#define MENTAL_COMMAND_HISTORY_H
+
+#include "../../Core/Types.h"
+#include "SceneCommand.h"
+#include <deque>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace MentalEngine {
+
+/**
+ * @class CommandHistory
+ * @brief Memory-bounded undo/redo stack
+ *
+ * Every edit goes through Execute(), which applies the command and pushes it
+ * on the undo stack. Undo and redo cost whatever the command's delta costs,
+ * independent of scene size. When the combined memory of stored commands
+ * exceeds the budget, the oldest commands are dropped.
+ *
+ * Continuous interactions (dragging a primitive) are bracketed with
+ * BeginCoalescing()/EndCoalescing(); commands executed in between merge into
+ * one undo step when the command type supports it.
+ */
+class CommandHistory {
+public:
+    /**
+     * @brief Observer called after every Apply()/Revert() of a command
+     *
+     * The command passed is the one that just touched the scene, even if it
+     * is then merged into the previous undo step.
+     */
+    using Listener = std::function<nil(const SceneCommand& command, bool forward)>;
+
+private:
+    Listener listener;                                      ///< Optional change observer
+    std::deque<std::unique_ptr<SceneCommand>> undo_stack;   ///< Applied commands, oldest first
+    std::vector<std::unique_ptr<SceneCommand>> redo_stack;  ///< Reverted commands, newest last
+    size_t memory_usage = 0;                                ///< Bytes held by both stacks
+    size_t memory_budget = 64 * 1024 * 1024;                ///< Maximum bytes to keep
+    size_t max_commands = 1000;                             ///< Maximum undo steps
+    bool coalescing = false;                                ///< Merge consecutive commands
+    bool merge_target_open = false;                         ///< Top of undo stack may absorb the next command
+
+    /**
+     * @brief Drops oldest commands until limits are met
+     * @private
+     */
+    nil __enforce_limits();
+
+    /**
+     * @brief Releases the redo stack
+     * @private
+     */
+    nil __clear_redo();
+
+public:
+    /**
+     * @brief Applies a command and records it
+     * @param scene Target scene
+     * @param command Command to execute
+     */
+    nil Execute(Scene& scene, std::unique_ptr<SceneCommand> command);
+
+    /**
+     * @brief Reverts the most recent command
+     * @param scene Target scene
+     * @return bool True if something was undone
+     */
+    bool Undo(Scene& scene);
+
+    /**
+     * @brief Re-applies the most recently undone command
+     * @param scene Target scene
+     * @return bool True if something was redone
+     */
+    bool Redo(Scene& scene);
+
+    /**
+     * @brief Starts merging consecutive commands into one undo step
+     */
+    nil BeginCoalescing();
+
+    /**
+     * @brief Stops merging; the next command starts a new undo step
+     */
+    nil EndCoalescing();
+
+    /**
+     * @brief Drops all history
+     */
+    nil Clear();
+
+    bool CanUndo() const { return !undo_stack.empty(); }
+    bool CanRedo() const { return !redo_stack.empty(); }
+
+    /**
+     * @brief Gets the name of the command Undo() would revert
+     * @return const char* Name, or nullptr if nothing to undo
+     */
+    const char* GetUndoName() const { return undo_stack.empty() ? nullptr : undo_stack.back()->GetName(); }
+
+    /**
+     * @brief Gets the name of the command Redo() would apply
+     * @return const char* Name, or nullptr if nothing to redo
+     */
+    const char* GetRedoName() const { return redo_stack.empty() ? nullptr : redo_stack.back()->GetName(); }
+
+    /**
+     * @brief Sets the change observer
+     * @param callback Observer, or an empty function to remove it
+     */
+    nil SetListener(Listener callback) { listener = std::move(callback); }
+
+    size_t GetUndoCount() const { return undo_stack.size(); }
+    size_t GetRedoCount() const { return redo_stack.size(); }
+    size_t GetMemoryUsage() const { return memory_usage; }
+
+    /**
+     * @brief Sets the memory budget
+     * @param bytes Maximum bytes held by the history
+     */
+    nil SetMemoryBudget(size_t bytes) { memory_budget = bytes; __enforce_limits(); }
+    size_t GetMemoryBudget() const { return memory_budget; }
+};
+
+} // namespace MentalEngine
+
+#endif // MENTAL_COMMAND_HISTORY_H
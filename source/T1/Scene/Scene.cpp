@@ -0,0 +1,407 @@
+/**
+ * @file Scene.cpp
+ * @brief Implementation of the Scene class
+ * @author MentalEngine Team
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#include "Scene.h"
+#include <cmath>
+#include <limits>
+#include <utility>
+
+namespace MentalEngine {
+
+namespace {
+
+const float TWO_PI = 6.28318530717958647692f;
+
+/**
+ * @brief Distance from a point to a segment
+ */
+float __distance_to_segment(float px, float py, float ax, float ay, float bx, float by) {
+    float dx = bx - ax;
+    float dy = by - ay;
+    float length_sq = dx * dx + dy * dy;
+    float t = 0.0f;
+    if (length_sq > 0.0f) {
+        t = ((px - ax) * dx + (py - ay) * dy) / length_sq;
+        t = std::max(0.0f, std::min(1.0f, t));
+    }
+    float cx = ax + dx * t - px;
+    float cy = ay + dy * t - py;
+    return std::sqrt(cx * cx + cy * cy);
+}
+
+/**
+ * @brief Checks whether an angle lies inside an arc's sweep
+ */
+bool __angle_in_sweep(float angle, float start, float sweep) {
+    if (sweep >= TWO_PI) return true;
+    float offset = std::fmod(angle - start, TWO_PI);
+    if (offset < 0.0f) offset += TWO_PI;
+    return offset <= sweep;
+}
+
+} // namespace
+
+PrimitiveId Scene::AddLine(const Math::Vector2& start, const Math::Vector2& end) {
+    revision++;
+    PrimitiveId id(PrimitiveType::Line, static_cast<uint32_t>(lines.size()));
+    lines.x0.push_back(start.x);
+    lines.y0.push_back(start.y);
+    lines.x1.push_back(end.x);
+    lines.y1.push_back(end.y);
+    __index_insert(id);
+    return id;
+}
+
+PrimitiveId Scene::AddArc(const Math::Vector2& center, float radius, float start_angle, float sweep_angle) {
+    revision++;
+    PrimitiveId id(PrimitiveType::Arc, static_cast<uint32_t>(arcs.size()));
+    arcs.cx.push_back(center.x);
+    arcs.cy.push_back(center.y);
+    arcs.radius.push_back(std::fabs(radius));
+    arcs.start_angle.push_back(start_angle);
+    arcs.sweep_angle.push_back(std::min(std::fabs(sweep_angle), TWO_PI));
+    __index_insert(id);
+    return id;
+}
+
+PrimitiveId Scene::AddCircle(const Math::Vector2& center, float radius) {
+    return AddArc(center, radius, 0.0f, TWO_PI);
+}
+
+PrimitiveId Scene::AddLine(const LineData& line) {
+    return AddLine(Math::Vector2(line.x0, line.y0), Math::Vector2(line.x1, line.y1));
+}
+
+PrimitiveId Scene::AddArc(const ArcData& arc) {
+    return AddArc(Math::Vector2(arc.cx, arc.cy), arc.radius, arc.start_angle, arc.sweep_angle);
+}
+
+LineData Scene::GetLine(uint32_t i) const {
+    return LineData{lines.x0[i], lines.y0[i], lines.x1[i], lines.y1[i]};
+}
+
+ArcData Scene::GetArc(uint32_t i) const {
+    return ArcData{arcs.cx[i], arcs.cy[i], arcs.radius[i], arcs.start_angle[i], arcs.sweep_angle[i]};
+}
+
+nil Scene::SetLine(uint32_t i, const LineData& line) {
+    revision++;
+    PrimitiveId id(PrimitiveType::Line, i);
+    __index_remove(id);
+    lines.x0[i] = line.x0;
+    lines.y0[i] = line.y0;
+    lines.x1[i] = line.x1;
+    lines.y1[i] = line.y1;
+    __index_insert(id);
+}
+
+nil Scene::SetArc(uint32_t i, const ArcData& arc) {
+    revision++;
+    PrimitiveId id(PrimitiveType::Arc, i);
+    __index_remove(id);
+    arcs.cx[i] = arc.cx;
+    arcs.cy[i] = arc.cy;
+    arcs.radius[i] = std::fabs(arc.radius);
+    arcs.start_angle[i] = arc.start_angle;
+    arcs.sweep_angle[i] = std::min(std::fabs(arc.sweep_angle), TWO_PI);
+    __index_insert(id);
+}
+
+nil Scene::Remove(PrimitiveId id) {
+    if (!Contains(id)) return;
+    __index_remove(id);
+    __move_last_into(id.GetType(), id.GetIndex());
+}
+
+nil Scene::ReinsertLine(uint32_t i, const LineData& line) {
+    PrimitiveId appended = AddLine(line);
+    __swap(PrimitiveType::Line, i, appended.GetIndex());
+}
+
+nil Scene::ReinsertArc(uint32_t i, const ArcData& arc) {
+    PrimitiveId appended = AddArc(arc);
+    __swap(PrimitiveType::Arc, i, appended.GetIndex());
+}
+
+nil Scene::PopBack(PrimitiveType type, size_t count) {
+    revision++;
+    size_t size = type == PrimitiveType::Line ? lines.size() : arcs.size();
+    count = std::min(count, size);
+    for (size_t n = 0; n < count; n++) {
+        PrimitiveId id(type, static_cast<uint32_t>(size - 1 - n));
+        __index_remove(id);
+    }
+    if (type == PrimitiveType::Line) {
+        size_t new_size = lines.size() - count;
+        lines.x0.resize(new_size);
+        lines.y0.resize(new_size);
+        lines.x1.resize(new_size);
+        lines.y1.resize(new_size);
+    } else {
+        size_t new_size = arcs.size() - count;
+        arcs.cx.resize(new_size);
+        arcs.cy.resize(new_size);
+        arcs.radius.resize(new_size);
+        arcs.start_angle.resize(new_size);
+        arcs.sweep_angle.resize(new_size);
+    }
+}
+
+bool Scene::GetChangesSince(uint64_t since, std::vector<Bounds2D>& out) const {
+    if (since < changes_floor) return false;
+    // Записи упорядочены по ревизии - новые в конце
+    for (auto it = changes.rbegin(); it != changes.rend() && it->revision > since; ++it) {
+        out.push_back(it->bounds);
+    }
+    return true;
+}
+
+bool Scene::GetChangedPrimitivesSince(uint64_t since, std::vector<PrimitiveId>& out) const {
+    if (since < changes_floor) return false;
+    for (auto it = changes.rbegin(); it != changes.rend() && it->revision > since; ++it) {
+        out.push_back(it->id);
+    }
+    return true;
+}
+
+nil Scene::TakeAll(LineStorage& out_lines, ArcStorage& out_arcs) {
+    out_lines = std::move(lines);
+    out_arcs = std::move(arcs);
+    Clear();
+}
+
+nil Scene::PutAll(LineStorage&& in_lines, ArcStorage&& in_arcs) {
+    Clear();
+    lines = std::move(in_lines);
+    arcs = std::move(in_arcs);
+    // Индекс строится при первом запросе, поэтому загрузка не ждет его
+    index_stale = GetPrimitiveCount() > 0;
+}
+
+nil Scene::AppendAll(LineStorage&& in_lines, ArcStorage&& in_arcs) {
+    revision++;
+    if (in_lines.size() == 0 && in_arcs.size() == 0) return;
+    if (GetPrimitiveCount() == 0) {
+        PutAll(std::move(in_lines), std::move(in_arcs));
+        return;
+    }
+    auto append = [](std::vector<float>& to, const std::vector<float>& from) {
+        to.insert(to.end(), from.begin(), from.end());
+    };
+    append(lines.x0, in_lines.x0);
+    append(lines.y0, in_lines.y0);
+    append(lines.x1, in_lines.x1);
+    append(lines.y1, in_lines.y1);
+    append(arcs.cx, in_arcs.cx);
+    append(arcs.cy, in_arcs.cy);
+    append(arcs.radius, in_arcs.radius);
+    append(arcs.start_angle, in_arcs.start_angle);
+    append(arcs.sweep_angle, in_arcs.sweep_angle);
+    index_stale = true;
+    __record_all_changed();
+}
+
+nil Scene::Clear() {
+    revision++;
+    __record_all_changed();
+    lines = LineStorage();
+    arcs = ArcStorage();
+    index.Clear();
+    index_stale = false;
+}
+
+nil Scene::BuildIndex() const {
+    if (!index_stale) return;
+    index.Clear();
+    for (size_t i = 0; i < lines.size(); i++) {
+        PrimitiveId id(PrimitiveType::Line, static_cast<uint32_t>(i));
+        index.Insert(id, GetBounds(id));
+    }
+    for (size_t i = 0; i < arcs.size(); i++) {
+        PrimitiveId id(PrimitiveType::Arc, static_cast<uint32_t>(i));
+        index.Insert(id, GetBounds(id));
+    }
+    index_stale = false;
+}
+
+nil Scene::__index_insert(PrimitiveId id) {
+    __record_change(id);
+    // While the index is stale the next rebuild picks up the change
+    if (!index_stale) index.Insert(id, GetBounds(id));
+}
+
+nil Scene::__index_remove(PrimitiveId id) {
+    __record_change(id);
+    if (!index_stale) index.Remove(id, GetBounds(id));
+}
+
+nil Scene::__record_change(PrimitiveId id) {
+    if (changes.size() >= MAX_RECORDED_CHANGES) {
+        __record_all_changed();
+        return;
+    }
+    changes.push_back(ChangeRecord{revision, GetBounds(id), id});
+}
+
+bool Scene::Contains(PrimitiveId id) const {
+    if (!id.IsValid()) return false;
+    if (id.GetType() == PrimitiveType::Line) return id.GetIndex() < lines.size();
+    return id.GetIndex() < arcs.size();
+}
+
+Bounds2D Scene::GetBounds(PrimitiveId id) const {
+    const uint32_t i = id.GetIndex();
+    if (id.GetType() == PrimitiveType::Line) {
+        return Bounds2D(std::min(lines.x0[i], lines.x1[i]), std::min(lines.y0[i], lines.y1[i]),
+                        std::max(lines.x0[i], lines.x1[i]), std::max(lines.y0[i], lines.y1[i]));
+    }
+    // Conservative: the full circle bounds the arc
+    const float r = arcs.radius[i];
+    return Bounds2D(arcs.cx[i] - r, arcs.cy[i] - r, arcs.cx[i] + r, arcs.cy[i] + r);
+}
+
+float Scene::DistanceTo(PrimitiveId id, const Math::Vector2& point) const {
+    const uint32_t i = id.GetIndex();
+    if (id.GetType() == PrimitiveType::Line) {
+        return __distance_to_segment(point.x, point.y, lines.x0[i], lines.y0[i], lines.x1[i], lines.y1[i]);
+    }
+
+    const float dx = point.x - arcs.cx[i];
+    const float dy = point.y - arcs.cy[i];
+    const float r = arcs.radius[i];
+    const float start = arcs.start_angle[i];
+    const float sweep = arcs.sweep_angle[i];
+
+    if (__angle_in_sweep(std::atan2(dy, dx), start, sweep)) {
+        return std::fabs(std::sqrt(dx * dx + dy * dy) - r);
+    }
+
+    // Outside the sweep the nearest point is one of the arc ends
+    const float ex0 = arcs.cx[i] + r * std::cos(start) - point.x;
+    const float ey0 = arcs.cy[i] + r * std::sin(start) - point.y;
+    const float ex1 = arcs.cx[i] + r * std::cos(start + sweep) - point.x;
+    const float ey1 = arcs.cy[i] + r * std::sin(start + sweep) - point.y;
+    return std::sqrt(std::min(ex0 * ex0 + ey0 * ey0, ex1 * ex1 + ey1 * ey1));
+}
+
+PrimitiveId Scene::Pick(const Math::Vector2& point, float tolerance) const {
+    PrimitiveId best;
+    float best_distance = std::numeric_limits<float>::max();
+
+    GetIndex().Query(Bounds2D::Around(point, tolerance), [&](const SpatialIndex::Entry& entry) {
+        float distance = DistanceTo(entry.id, point);
+        if (distance <= tolerance && distance < best_distance) {
+            best_distance = distance;
+            best = entry.id;
+        }
+        return true;
+    });
+
+    return best;
+}
+
+nil Scene::AppendSegments(PrimitiveId id, std::vector<Math::Vector2>& out) const {
+    const size_t first = out.size();
+    out.resize(first + 2 * GetSegmentCount(id));
+    if (out.size() > first) WriteSegments(id, out.data() + first);
+}
+
+size_t Scene::GetSegmentCount(PrimitiveId id) const {
+    if (!Contains(id)) return 0;
+    return id.GetType() == PrimitiveType::Line ? 1 : GetArcSegmentCount(id.GetIndex());
+}
+
+nil Scene::WriteSegments(PrimitiveId id, Math::Vector2* out) const {
+    const uint32_t i = id.GetIndex();
+    if (id.GetType() == PrimitiveType::Line) {
+        out[0] = Math::Vector2(lines.x0[i], lines.y0[i]);
+        out[1] = Math::Vector2(lines.x1[i], lines.y1[i]);
+        return;
+    }
+    WriteArcSegments(i, out);
+}
+
+size_t Scene::GetArcSegmentCount(uint32_t index) const {
+    return static_cast<size_t>(std::max(1, static_cast<int>(std::ceil(ARC_SEGMENTS_PER_TURN * arcs.sweep_angle[index] / TWO_PI))));
+}
+
+nil Scene::WriteArcSegments(uint32_t index, Math::Vector2* out) const {
+    const size_t segments = GetArcSegmentCount(index);
+    const float step = arcs.sweep_angle[index] / static_cast<float>(segments);
+    const float cx = arcs.cx[index], cy = arcs.cy[index], radius = arcs.radius[index];
+    float angle = arcs.start_angle[index];
+    Math::Vector2 previous(cx + radius * std::cos(angle), cy + radius * std::sin(angle));
+    for (size_t s = 1; s <= segments; s++) {
+        angle += step;
+        Math::Vector2 current(cx + radius * std::cos(angle), cy + radius * std::sin(angle));
+        *out++ = previous;
+        *out++ = current;
+        previous = current;
+    }
+}
+
+nil Scene::__move_last_into(PrimitiveType type, uint32_t slot) {
+    revision++;
+    if (type == PrimitiveType::Line) {
+        const uint32_t last = static_cast<uint32_t>(lines.size() - 1);
+        if (slot != last) {
+            PrimitiveId moved(PrimitiveType::Line, last);
+            __index_remove(moved);
+            lines.x0[slot] = lines.x0[last];
+            lines.y0[slot] = lines.y0[last];
+            lines.x1[slot] = lines.x1[last];
+            lines.y1[slot] = lines.y1[last];
+            __index_insert(PrimitiveId(PrimitiveType::Line, slot));
+        }
+        lines.x0.pop_back();
+        lines.y0.pop_back();
+        lines.x1.pop_back();
+        lines.y1.pop_back();
+    } else {
+        const uint32_t last = static_cast<uint32_t>(arcs.size() - 1);
+        if (slot != last) {
+            PrimitiveId moved(PrimitiveType::Arc, last);
+            __index_remove(moved);
+            arcs.cx[slot] = arcs.cx[last];
+            arcs.cy[slot] = arcs.cy[last];
+            arcs.radius[slot] = arcs.radius[last];
+            arcs.start_angle[slot] = arcs.start_angle[last];
+            arcs.sweep_angle[slot] = arcs.sweep_angle[last];
+            __index_insert(PrimitiveId(PrimitiveType::Arc, slot));
+        }
+        arcs.cx.pop_back();
+        arcs.cy.pop_back();
+        arcs.radius.pop_back();
+        arcs.start_angle.pop_back();
+        arcs.sweep_angle.pop_back();
+    }
+}
+
+nil Scene::__swap(PrimitiveType type, uint32_t a, uint32_t b) {
+    revision++;
+    if (a == b) return;
+    PrimitiveId id_a(type, a), id_b(type, b);
+    __index_remove(id_a);
+    __index_remove(id_b);
+    if (type == PrimitiveType::Line) {
+        std::swap(lines.x0[a], lines.x0[b]);
+        std::swap(lines.y0[a], lines.y0[b]);
+        std::swap(lines.x1[a], lines.x1[b]);
+        std::swap(lines.y1[a], lines.y1[b]);
+    } else {
+        std::swap(arcs.cx[a], arcs.cx[b]);
+        std::swap(arcs.cy[a], arcs.cy[b]);
+        std::swap(arcs.radius[a], arcs.radius[b]);
+        std::swap(arcs.start_angle[a], arcs.start_angle[b]);
+        std::swap(arcs.sweep_angle[a], arcs.sweep_angle[b]);
+    }
+    __index_insert(id_a);
+    __index_insert(id_b);
+}
+
+} // namespace MentalEngine
@@ -0,0 +1,485 @@
+/**
+ * @file Scene.h
+ * @brief Drawing geometry storage for MentalEngine
+ * @author MentalEngine Team
+ * @version 1.0.0
+ * @date 2024
+ *
+ * This file defines the Scene class, which owns all 2D drawing geometry in
+ * structure-of-arrays form together with a spatial index used for picking
+ * and other proximity queries.
+ */
+
+#ifndef MENTAL_SCENE_H
+#define MENTAL_SCENE_H
+
+#include "../../Core/Types.h"
+#include "../../Core/Math.h"
+#include "SpatialIndex.h"
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+namespace MentalEngine {
+
+/**
+ * @struct LineData
+ * @brief Geometry of a single line segment
+ */
+struct LineData {
+    float x0, y0;  ///< Start point
+    float x1, y1;  ///< End point
+};
+
+/**
+ * @struct ArcData
+ * @brief Geometry of a single arc
+ */
+struct ArcData {
+    float cx, cy;         ///< Center
+    float radius;         ///< Radius
+    float start_angle;    ///< Start angle in radians
+    float sweep_angle;    ///< Counter-clockwise sweep in radians
+};
+
+/**
+ * @struct LineStorage
+ * @brief Structure-of-arrays storage for line segments
+ */
+struct LineStorage {
+    std::vector<float> x0;  ///< Start point X
+    std::vector<float> y0;  ///< Start point Y
+    std::vector<float> x1;  ///< End point X
+    std::vector<float> y1;  ///< End point Y
+
+    size_t size() const { return x0.size(); }
+};
+
+/**
+ * @struct ArcStorage
+ * @brief Structure-of-arrays storage for circular arcs and circles
+ *
+ * Angles are in radians, counter-clockwise from +X. A circle is stored as an
+ * arc with a sweep of 2*pi.
+ */
+struct ArcStorage {
+    std::vector<float> cx;           ///< Center X
+    std::vector<float> cy;           ///< Center Y
+    std::vector<float> radius;       ///< Radius
+    std::vector<float> start_angle;  ///< Start angle
+    std::vector<float> sweep_angle;  ///< Counter-clockwise sweep
+
+    size_t size() const { return cx.size(); }
+};
+
+/**
+ * @class Scene
+ * @brief Owner of drawing geometry and its spatial index
+ *
+ * The Scene class keeps every primitive of the drawing in tightly packed
+ * per-attribute arrays so renderers and exporters can stream through them,
+ * and mirrors each primitive into a SpatialIndex so proximity queries only
+ * touch nearby geometry.
+ *
+ * Key features:
+ * - Structure-of-arrays storage for lines and arcs
+ * - Spatial index kept in sync with storage
+ * - Nearest-primitive picking with a world-space tolerance
+ * - Tessellation of primitives into line segments for rendering
+ *
+ * Coordinates are stored in float relative to a double-precision origin,
+ * so drawings in survey coordinates (hundreds of kilometers from zero) keep
+ * sub-millimeter precision as long as the drawing itself is local. All
+ * methods take and return local coordinates; ToWorld()/ToLocal() convert.
+ */
+class Scene {
+private:
+    LineStorage lines;    ///< Line segment storage
+    ArcStorage arcs;      ///< Arc and circle storage
+    Math::Vector2d origin;  ///< World position of local (0, 0)
+    uint64_t revision = 0;  ///< Bumped by every change of geometry or origin
+    mutable SpatialIndex index;        ///< Spatial index over all primitives, built lazily after PutAll()
+    mutable bool index_stale = false;  ///< Index must be rebuilt before the next query
+    /**
+     * @struct ChangeRecord
+     * @brief One primitive slot touched by an edit
+     */
+    struct ChangeRecord {
+        uint64_t revision;  ///< Revision of the edit
+        Bounds2D bounds;    ///< Bounds of the slot's contents when recorded
+        PrimitiveId id;     ///< Slot
+    };
+
+    std::vector<ChangeRecord> changes;  ///< Changed primitives, oldest first
+    uint64_t changes_floor = 0;        ///< Changes up to this revision are not described by changes
+
+    /**
+     * @brief Records the bounds of a primitive about to change or just changed
+     * @private
+     */
+    nil __record_change(PrimitiveId id);
+
+    /**
+     * @brief Records that everything changed at the current revision
+     * @private
+     */
+    nil __record_all_changed() {
+        changes.clear();
+        changes_floor = revision;
+    }
+
+    /**
+     * @brief Moves the last primitive of a type into a slot, keeping the index in sync
+     * @private
+     */
+    nil __move_last_into(PrimitiveType type, uint32_t slot);
+
+    /**
+     * @brief Swaps two primitives of the same type, keeping the index in sync
+     * @private
+     */
+    nil __swap(PrimitiveType type, uint32_t a, uint32_t b);
+
+    /**
+     * @brief Registers a primitive in the index unless a rebuild is pending
+     * @private
+     */
+    nil __index_insert(PrimitiveId id);
+
+    /**
+     * @brief Unregisters a primitive from the index unless a rebuild is pending
+     * @private
+     */
+    nil __index_remove(PrimitiveId id);
+
+public:
+    static constexpr int ARC_SEGMENTS_PER_TURN = 64;  ///< Tessellation density for arcs
+    static constexpr size_t MAX_RECORDED_CHANGES = 4096;  ///< More changes are reported as "everything changed"
+
+    /**
+     * @brief Constructor
+     * @param cell_size Spatial index cell size in world units
+     */
+    explicit Scene(float cell_size = 1.0f) : index(cell_size) {}
+
+    /**
+     * @brief Adds a line segment
+     * @param start Start point
+     * @param end End point
+     * @return PrimitiveId Handle of the new line
+     */
+    PrimitiveId AddLine(const Math::Vector2& start, const Math::Vector2& end);
+
+    /**
+     * @brief Adds a circular arc
+     * @param center Arc center
+     * @param radius Arc radius
+     * @param start_angle Start angle in radians
+     * @param sweep_angle Counter-clockwise sweep in radians
+     * @return PrimitiveId Handle of the new arc
+     */
+    PrimitiveId AddArc(const Math::Vector2& center, float radius, float start_angle, float sweep_angle);
+
+    /**
+     * @brief Adds a full circle
+     * @param center Circle center
+     * @param radius Circle radius
+     * @return PrimitiveId Handle of the new circle
+     */
+    PrimitiveId AddCircle(const Math::Vector2& center, float radius);
+
+    /**
+     * @brief Adds a line segment from raw geometry
+     * @param line Line geometry
+     * @return PrimitiveId Handle of the new line
+     */
+    PrimitiveId AddLine(const LineData& line);
+
+    /**
+     * @brief Adds an arc from raw geometry
+     * @param arc Arc geometry
+     * @return PrimitiveId Handle of the new arc
+     */
+    PrimitiveId AddArc(const ArcData& arc);
+
+    /**
+     * @brief Gets the geometry of a line
+     * @param index Line index
+     * @return LineData Line geometry
+     */
+    LineData GetLine(uint32_t index) const;
+
+    /**
+     * @brief Gets the geometry of an arc
+     * @param index Arc index
+     * @return ArcData Arc geometry
+     */
+    ArcData GetArc(uint32_t index) const;
+
+    /**
+     * @brief Replaces the geometry of a line
+     * @param index Line index
+     * @param line New geometry
+     */
+    nil SetLine(uint32_t index, const LineData& line);
+
+    /**
+     * @brief Replaces the geometry of an arc
+     * @param index Arc index
+     * @param arc New geometry
+     */
+    nil SetArc(uint32_t index, const ArcData& arc);
+
+    /**
+     * @brief Removes a primitive by moving the last primitive of its type into its slot
+     *
+     * O(1) apart from index maintenance. The handle of the moved primitive
+     * changes; ReinsertLine()/ReinsertArc() with the same slot undo the
+     * removal exactly.
+     *
+     * @param id Primitive handle
+     */
+    nil Remove(PrimitiveId id);
+
+    /**
+     * @brief Reverses Remove(): puts a line back into its original slot
+     * @param index Slot the line was removed from
+     * @param line Removed geometry
+     */
+    nil ReinsertLine(uint32_t index, const LineData& line);
+
+    /**
+     * @brief Reverses Remove(): puts an arc back into its original slot
+     * @param index Slot the arc was removed from
+     * @param arc Removed geometry
+     */
+    nil ReinsertArc(uint32_t index, const ArcData& arc);
+
+    /**
+     * @brief Removes the most recently added primitives of a type
+     * @param type Primitive type
+     * @param count Number of primitives to drop from the end
+     */
+    nil PopBack(PrimitiveType type, size_t count);
+
+    /**
+     * @brief Moves all geometry out of the scene, leaving it empty
+     * @param out_lines Receives the line storage
+     * @param out_arcs Receives the arc storage
+     */
+    nil TakeAll(LineStorage& out_lines, ArcStorage& out_arcs);
+
+    /**
+     * @brief Replaces all geometry with the given storage
+     *
+     * The spatial index is not rebuilt here but on the first query, so bulk
+     * loads can display geometry before the index exists.
+     *
+     * @param in_lines Line storage to adopt
+     * @param in_arcs Arc storage to adopt
+     */
+    nil PutAll(LineStorage&& in_lines, ArcStorage&& in_arcs);
+
+    /**
+     * @brief Appends a batch of geometry after the existing primitives
+     *
+     * Existing handles stay valid. Like PutAll(), the spatial index is
+     * rebuilt on the next query instead of per primitive.
+     *
+     * @param in_lines Lines to append
+     * @param in_arcs Arcs to append
+     */
+    nil AppendAll(LineStorage&& in_lines, ArcStorage&& in_arcs);
+
+    /**
+     * @brief Removes all geometry
+     */
+    nil Clear();
+
+    /**
+     * @brief Gets the world position of local (0, 0)
+     * @return const Math::Vector2d& Origin in double precision
+     */
+    const Math::Vector2d& GetOrigin() const { return origin; }
+
+    /**
+     * @brief Sets the origin without moving stored coordinates
+     *
+     * Existing geometry moves in world space; meant for loaders and empty
+     * scenes. Clear() keeps the origin, so an undone clear comes back in place.
+     *
+     * @param world World position of local (0, 0)
+     */
+    nil SetOrigin(const Math::Vector2d& world) {
+        if (origin != world) {
+            revision++;
+            __record_all_changed();
+        }
+        origin = world;
+    }
+
+    /**
+     * @brief Converts a local point to world coordinates
+     * @param local Point relative to the origin
+     * @return Math::Vector2d World point
+     */
+    Math::Vector2d ToWorld(const Math::Vector2& local) const { return origin + Math::Vector2d(local); }
+
+    /**
+     * @brief Converts a world point to local coordinates
+     * @param world World point
+     * @return Math::Vector2 Point relative to the origin
+     */
+    Math::Vector2 ToLocal(const Math::Vector2d& world) const { return (world - origin).toFloat(); }
+
+    /**
+     * @brief Gets line storage
+     * @return const LineStorage& Line arrays
+     */
+    const LineStorage& GetLines() const { return lines; }
+
+    /**
+     * @brief Gets arc storage
+     * @return const ArcStorage& Arc arrays
+     */
+    const ArcStorage& GetArcs() const { return arcs; }
+
+    /**
+     * @brief Gets the spatial index, building it first if it is stale
+     * @return const SpatialIndex& Index over all primitives
+     * @note Not thread-safe while a rebuild is pending
+     */
+    const SpatialIndex& GetIndex() const { BuildIndex(); return index; }
+
+    /**
+     * @brief Rebuilds the spatial index if PutAll() left it stale
+     */
+    nil BuildIndex() const;
+
+    /**
+     * @brief Checks whether the spatial index is up to date
+     * @return bool False if the next query will rebuild it
+     */
+    bool IsIndexReady() const { return !index_stale; }
+
+    /**
+     * @brief Gets the total number of primitives
+     * @return size_t Number of lines plus arcs
+     */
+    size_t GetPrimitiveCount() const { return lines.size() + arcs.size(); }
+
+    /**
+     * @brief Gets the change counter
+     *
+     * Differs whenever geometry or the origin changed since an earlier call,
+     * so consumers can cache anything derived from the scene.
+     *
+     * @return uint64_t Revision
+     */
+    uint64_t GetRevision() const { return revision; }
+
+    /**
+     * @brief Gets the areas changed after a revision
+     *
+     * Reports the old and new bounds of every primitive added, removed or
+     * modified since, so consumers caching rendered areas can refresh only
+     * what an edit touched. Bulk changes (loads, Clear(), origin moves) and
+     * long edit sequences are not described area by area.
+     *
+     * @param since Revision the caller is up to date with
+     * @param out Receives the changed bounds; appended to
+     * @return bool False if the changes cannot be described and everything must be treated as changed
+     */
+    bool GetChangesSince(uint64_t since, std::vector<Bounds2D>& out) const;
+
+    /**
+     * @brief Gets the primitive slots changed after a revision
+     *
+     * Same log as GetChangesSince(), reported by handle, so consumers
+     * holding per-primitive data can refresh only the touched slots. A slot
+     * may be reported more than once; one at or past the end of storage was
+     * removed.
+     *
+     * @param since Revision the caller is up to date with
+     * @param out Receives the changed handles; appended to
+     * @return bool False if the changes cannot be described and everything must be treated as changed
+     */
+    bool GetChangedPrimitivesSince(uint64_t since, std::vector<PrimitiveId>& out) const;
+
+    /**
+     * @brief Checks whether a handle refers to existing geometry
+     * @param id Primitive handle
+     * @return bool True if the handle is valid for this scene
+     */
+    bool Contains(PrimitiveId id) const;
+
+    /**
+     * @brief Computes a primitive's bounding box
+     * @param id Primitive handle
+     * @return Bounds2D Axis-aligned bounds
+     */
+    Bounds2D GetBounds(PrimitiveId id) const;
+
+    /**
+     * @brief Computes the distance from a point to a primitive
+     * @param id Primitive handle
+     * @param point Query point
+     * @return float Euclidean distance
+     */
+    float DistanceTo(PrimitiveId id, const Math::Vector2& point) const;
+
+    /**
+     * @brief Finds the primitive nearest to a point
+     *
+     * Only primitives whose bounds overlap the tolerance box are examined,
+     * so the cost depends on local density rather than scene size.
+     *
+     * @param point Query point in world units
+     * @param tolerance Maximum distance in world units
+     * @return PrimitiveId Nearest primitive, or an invalid handle if none is in range
+     */
+    PrimitiveId Pick(const Math::Vector2& point, float tolerance) const;
+
+    /**
+     * @brief Appends a primitive as line segment pairs
+     * @param id Primitive handle
+     * @param out Output list receiving start/end pairs
+     */
+    nil AppendSegments(PrimitiveId id, std::vector<Math::Vector2>& out) const;
+
+    /**
+     * @brief Gets the number of segments a primitive is drawn with
+     * @param id Primitive handle
+     * @return size_t Segment count, 0 for stale handles
+     */
+    size_t GetSegmentCount(PrimitiveId id) const;
+
+    /**
+     * @brief Writes a primitive's segments as start/end pairs into preallocated memory
+     * @param id Primitive handle; must be valid
+     * @param out Receives 2 * GetSegmentCount(id) points
+     */
+    nil WriteSegments(PrimitiveId id, Math::Vector2* out) const;
+
+    /**
+     * @brief Gets the number of segments an arc tessellates into
+     * @param index Arc index
+     * @return size_t Segment count (output points are twice this)
+     */
+    size_t GetArcSegmentCount(uint32_t index) const;
+
+    /**
+     * @brief Writes an arc's segments as start/end pairs into preallocated memory
+     *
+     * Lets callers size one buffer up front and tessellate arcs in parallel.
+     *
+     * @param index Arc index
+     * @param out Receives 2 * GetArcSegmentCount(index) points
+     */
+    nil WriteArcSegments(uint32_t index, Math::Vector2* out) const;
+};
+
+} // namespace MentalEngine
+
+#endif // MENTAL_SCENE_H
@@ -0,0 +1,164 @@
+/**
+ * @file SceneCommand.cpp
+ * @brief Implementation of undoable scene edits
+ * @author MentalEngine Team
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#include "SceneCommand.h"
+#include <algorithm>
+#include <functional>
+
+namespace MentalEngine {
+
+// AddGeometryCommand
+
+nil AddGeometryCommand::Apply(Scene& scene) {
+    for (const LineData& line : lines) scene.AddLine(line);
+    for (const ArcData& arc : arcs) scene.AddArc(arc);
+}
+
+nil AddGeometryCommand::Revert(Scene& scene) {
+    scene.PopBack(PrimitiveType::Line, lines.size());
+    scene.PopBack(PrimitiveType::Arc, arcs.size());
+}
+
+bool AddGeometryCommand::EncodeDelta(SceneDeltaWriter& out, bool forward) const {
+    if (forward) {
+        out.AddLines(lines);
+        out.AddArcs(arcs);
+    } else {
+        out.PopBack(PrimitiveType::Line, lines.size());
+        out.PopBack(PrimitiveType::Arc, arcs.size());
+    }
+    return true;
+}
+
+size_t AddGeometryCommand::GetMemoryUsage() const {
+    return sizeof(*this) + lines.capacity() * sizeof(LineData) + arcs.capacity() * sizeof(ArcData);
+}
+
+// RemoveGeometryCommand
+
+RemoveGeometryCommand::RemoveGeometryCommand(const std::vector<PrimitiveId>& ids) {
+    for (PrimitiveId id : ids) {
+        if (!id.IsValid()) continue;
+        (id.GetType() == PrimitiveType::Line ? line_indices : arc_indices).push_back(id.GetIndex());
+    }
+    std::sort(line_indices.begin(), line_indices.end(), std::greater<uint32_t>());
+    std::sort(arc_indices.begin(), arc_indices.end(), std::greater<uint32_t>());
+    line_indices.erase(std::unique(line_indices.begin(), line_indices.end()), line_indices.end());
+    arc_indices.erase(std::unique(arc_indices.begin(), arc_indices.end()), arc_indices.end());
+}
+
+nil RemoveGeometryCommand::Apply(Scene& scene) {
+    removed_lines.clear();
+    removed_arcs.clear();
+    removed_lines.reserve(line_indices.size());
+    removed_arcs.reserve(arc_indices.size());
+
+    for (uint32_t index : line_indices) {
+        removed_lines.push_back(scene.GetLine(index));
+        scene.Remove(PrimitiveId(PrimitiveType::Line, index));
+    }
+    for (uint32_t index : arc_indices) {
+        removed_arcs.push_back(scene.GetArc(index));
+        scene.Remove(PrimitiveId(PrimitiveType::Arc, index));
+    }
+}
+
+nil RemoveGeometryCommand::Revert(Scene& scene) {
+    for (size_t i = arc_indices.size(); i-- > 0;) {
+        scene.ReinsertArc(arc_indices[i], removed_arcs[i]);
+    }
+    for (size_t i = line_indices.size(); i-- > 0;) {
+        scene.ReinsertLine(line_indices[i], removed_lines[i]);
+    }
+}
+
+bool RemoveGeometryCommand::EncodeDelta(SceneDeltaWriter& out, bool forward) const {
+    // Same order as Apply()/Revert(), so replay relocates the same primitives
+    if (forward) {
+        for (uint32_t index : line_indices) out.Remove(PrimitiveId(PrimitiveType::Line, index));
+        for (uint32_t index : arc_indices) out.Remove(PrimitiveId(PrimitiveType::Arc, index));
+    } else {
+        for (size_t i = arc_indices.size(); i-- > 0;) out.ReinsertArc(arc_indices[i], removed_arcs[i]);
+        for (size_t i = line_indices.size(); i-- > 0;) out.ReinsertLine(line_indices[i], removed_lines[i]);
+    }
+    return true;
+}
+
+size_t RemoveGeometryCommand::GetMemoryUsage() const {
+    return sizeof(*this) +
+           (line_indices.capacity() + arc_indices.capacity()) * sizeof(uint32_t) +
+           removed_lines.capacity() * sizeof(LineData) + removed_arcs.capacity() * sizeof(ArcData);
+}
+
+// ClearSceneCommand
+
+nil ClearSceneCommand::Apply(Scene& scene) {
+    scene.TakeAll(lines, arcs);
+}
+
+nil ClearSceneCommand::Revert(Scene& scene) {
+    scene.PutAll(std::move(lines), std::move(arcs));
+    lines = LineStorage();
+    arcs = ArcStorage();
+}
+
+bool ClearSceneCommand::EncodeDelta(SceneDeltaWriter& out, bool forward) const {
+    if (!forward) return false;
+    out.Clear();
+    return true;
+}
+
+size_t ClearSceneCommand::GetMemoryUsage() const {
+    return sizeof(*this) +
+           (lines.x0.capacity() + lines.y0.capacity() + lines.x1.capacity() + lines.y1.capacity() +
+            arcs.cx.capacity() + arcs.cy.capacity() + arcs.radius.capacity() +
+            arcs.start_angle.capacity() + arcs.sweep_angle.capacity()) * sizeof(float);
+}
+
+// ModifyGeometryCommand
+
+ModifyGeometryCommand::ModifyGeometryCommand(uint32_t index, const LineData& before, const LineData& after)
+    : id(PrimitiveType::Line, index), line_before(before), line_after(after) {}
+
+ModifyGeometryCommand::ModifyGeometryCommand(uint32_t index, const ArcData& before, const ArcData& after)
+    : id(PrimitiveType::Arc, index), arc_before(before), arc_after(after) {}
+
+nil ModifyGeometryCommand::Apply(Scene& scene) {
+    if (id.GetType() == PrimitiveType::Line) {
+        scene.SetLine(id.GetIndex(), line_after);
+    } else {
+        scene.SetArc(id.GetIndex(), arc_after);
+    }
+}
+
+nil ModifyGeometryCommand::Revert(Scene& scene) {
+    if (id.GetType() == PrimitiveType::Line) {
+        scene.SetLine(id.GetIndex(), line_before);
+    } else {
+        scene.SetArc(id.GetIndex(), arc_before);
+    }
+}
+
+bool ModifyGeometryCommand::EncodeDelta(SceneDeltaWriter& out, bool forward) const {
+    if (id.GetType() == PrimitiveType::Line) {
+        out.SetLine(id.GetIndex(), forward ? line_after : line_before);
+    } else {
+        out.SetArc(id.GetIndex(), forward ? arc_after : arc_before);
+    }
+    return true;
+}
+
+bool ModifyGeometryCommand::MergeWith(const SceneCommand& other) {
+    const ModifyGeometryCommand* next = dynamic_cast<const ModifyGeometryCommand*>(&other);
+    if (!next || next->id != id) return false;
+    line_after = next->line_after;
+    arc_after = next->arc_after;
+    return true;
+}
+
+} // namespace MentalEngine
@@ -0,0 +1,200 @@
+/**
+ * @file SceneCommand.h
+ * @brief Undoable scene edits for MentalEngine
+ * @author MentalEngine Team
+ * @version 1.0.0
+ * @date 2024
+ *
+ * This file defines the SceneCommand interface and the concrete commands used
+ * by the drawing tools. Each command stores only the delta it needs to apply
+ * and revert itself, never a snapshot of the scene.
+ */
+
+#ifndef MENTAL_SCENE_COMMAND_H
+#define MENTAL_SCENE_COMMAND_H
+
+#include "../../Core/Types.h"
+#include "Scene.h"
+#include "SceneDelta.h"
+#include <vector>
+#include <cstddef>
+#include <utility>
+
+namespace MentalEngine {
+
+/**
+ * @class SceneCommand
+ * @brief Base class for undoable scene edits
+ *
+ * Commands are applied once when executed and then alternate between
+ * Revert() and Apply() as the user undoes and redoes. History relies on
+ * strict LIFO order, so a command may assume the scene is exactly in the
+ * state it left it.
+ */
+class SceneCommand {
+public:
+    virtual ~SceneCommand() = default;
+
+    /**
+     * @brief Applies (or re-applies) the edit
+     * @param scene Target scene
+     */
+    virtual nil Apply(Scene& scene) = 0;
+
+    /**
+     * @brief Reverts the edit
+     * @param scene Target scene
+     */
+    virtual nil Revert(Scene& scene) = 0;
+
+    /**
+     * @brief Gets heap and object memory held by the command
+     * @return size_t Bytes
+     */
+    virtual size_t GetMemoryUsage() const = 0;
+
+    /**
+     * @brief Gets a short name for menus
+     * @return const char* Command name
+     */
+    virtual const char* GetName() const = 0;
+
+    /**
+     * @brief Tries to absorb a following command of the same drag
+     *
+     * Called only while the history is coalescing. On success the other
+     * command has already been applied and is discarded.
+     *
+     * @param other Command executed right after this one
+     * @return bool True if the command was merged
+     */
+    virtual bool MergeWith(const SceneCommand& other) { (void)other; return false; }
+
+    /**
+     * @brief Encodes the scene mutations of Apply() or Revert()
+     *
+     * Used to journal edits. Must be called right after the corresponding
+     * Apply()/Revert(), while any captured state is current.
+     *
+     * @param out Delta stream receiving the mutations
+     * @param forward True for Apply(), false for Revert()
+     * @return bool False if the edit cannot be expressed compactly
+     */
+    virtual bool EncodeDelta(SceneDeltaWriter& out, bool forward) const { (void)out; (void)forward; return false; }
+};
+
+/**
+ * @class AddGeometryCommand
+ * @brief Appends lines and arcs to the scene
+ *
+ * Undo drops the appended primitives from the end of storage, so both
+ * directions cost O(added primitives).
+ */
+class AddGeometryCommand : public SceneCommand {
+private:
+    std::vector<LineData> lines;  ///< Lines to append
+    std::vector<ArcData> arcs;    ///< Arcs to append
+
+public:
+    AddGeometryCommand() = default;
+    AddGeometryCommand(std::vector<LineData> lines, std::vector<ArcData> arcs)
+        : lines(std::move(lines)), arcs(std::move(arcs)) {}
+
+    nil Apply(Scene& scene) override;
+    nil Revert(Scene& scene) override;
+    size_t GetMemoryUsage() const override;
+    const char* GetName() const override { return "Add"; }
+    bool EncodeDelta(SceneDeltaWriter& out, bool forward) const override;
+};
+
+/**
+ * @class RemoveGeometryCommand
+ * @brief Removes a set of primitives
+ *
+ * Removal uses the scene's swap-and-pop, processing indices from highest to
+ * lowest so no pending index is relocated; undo reinserts in reverse order,
+ * which restores the exact original layout.
+ */
+class RemoveGeometryCommand : public SceneCommand {
+private:
+    std::vector<uint32_t> line_indices;  ///< Line slots, descending
+    std::vector<uint32_t> arc_indices;   ///< Arc slots, descending
+    std::vector<LineData> removed_lines; ///< Captured line geometry
+    std::vector<ArcData> removed_arcs;   ///< Captured arc geometry
+
+public:
+    /**
+     * @brief Constructor
+     * @param ids Primitives to remove
+     */
+    explicit RemoveGeometryCommand(const std::vector<PrimitiveId>& ids);
+
+    nil Apply(Scene& scene) override;
+    nil Revert(Scene& scene) override;
+    size_t GetMemoryUsage() const override;
+    const char* GetName() const override { return "Delete"; }
+    bool EncodeDelta(SceneDeltaWriter& out, bool forward) const override;
+};
+
+/**
+ * @class ClearSceneCommand
+ * @brief Removes every primitive
+ *
+ * Storage is moved into the command rather than copied, so clearing and
+ * undoing are O(1) for geometry and O(n) only for the index rebuild. Undoing
+ * a clear restores the whole drawing, which has no compact delta.
+ */
+class ClearSceneCommand : public SceneCommand {
+private:
+    LineStorage lines;  ///< Geometry taken from the scene
+    ArcStorage arcs;    ///< Geometry taken from the scene
+
+public:
+    nil Apply(Scene& scene) override;
+    nil Revert(Scene& scene) override;
+    size_t GetMemoryUsage() const override;
+    const char* GetName() const override { return "Clear All"; }
+    bool EncodeDelta(SceneDeltaWriter& out, bool forward) const override;
+};
+
+/**
+ * @class ModifyGeometryCommand
+ * @brief Replaces the geometry of one primitive
+ *
+ * Consecutive modifications of the same primitive during a drag merge into
+ * one command holding the first "before" and the last "after" state.
+ */
+class ModifyGeometryCommand : public SceneCommand {
+private:
+    PrimitiveId id;     ///< Modified primitive
+    LineData line_before{}, line_after{};  ///< Line states (if id is a line)
+    ArcData arc_before{}, arc_after{};     ///< Arc states (if id is an arc)
+
+public:
+    /**
+     * @brief Creates a line modification
+     * @param index Line index
+     * @param before Geometry before the edit
+     * @param after Geometry after the edit
+     */
+    ModifyGeometryCommand(uint32_t index, const LineData& before, const LineData& after);
+
+    /**
+     * @brief Creates an arc modification
+     * @param index Arc index
+     * @param before Geometry before the edit
+     * @param after Geometry after the edit
+     */
+    ModifyGeometryCommand(uint32_t index, const ArcData& before, const ArcData& after);
+
+    nil Apply(Scene& scene) override;
+    nil Revert(Scene& scene) override;
+    size_t GetMemoryUsage() const override { return sizeof(*this); }
+    const char* GetName() const override { return "Move"; }
+    bool MergeWith(const SceneCommand& other) override;
+    bool EncodeDelta(SceneDeltaWriter& out, bool forward) const override;
+};
+
+} // namespace MentalEngine
+
+#endif // MENTAL_SCENE_COMMAND_H
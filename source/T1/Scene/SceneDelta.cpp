@@ -0,0 +1,168 @@
+/**
+ * @file SceneDelta.cpp
+ * @brief Implementation of the scene delta encoding
+ * @author MentalEngine Team
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#include "SceneDelta.h"
+#include <cstring>
+
+namespace MentalEngine {
+
+namespace {
+
+/**
+ * @brief Bounds-checked reader over an operation stream
+ */
+struct DeltaReader {
+    const uint8_t* p;
+    const uint8_t* end;
+
+    template <typename Value>
+    bool Get(Value& value) {
+        if (static_cast<size_t>(end - p) < sizeof(Value)) return false;
+        std::memcpy(&value, p, sizeof(Value));
+        p += sizeof(Value);
+        return true;
+    }
+};
+
+} // namespace
+
+// SceneDeltaWriter
+
+nil SceneDeltaWriter::__put(const void* data, size_t size) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    out.insert(out.end(), bytes, bytes + size);
+}
+
+nil SceneDeltaWriter::AddLines(const std::vector<LineData>& lines) {
+    if (lines.empty()) return;
+    uint32_t count = static_cast<uint32_t>(lines.size());
+    __op(DeltaOp::AddLines);
+    __put(&count, sizeof(count));
+    __put(lines.data(), lines.size() * sizeof(LineData));
+}
+
+nil SceneDeltaWriter::AddArcs(const std::vector<ArcData>& arcs) {
+    if (arcs.empty()) return;
+    uint32_t count = static_cast<uint32_t>(arcs.size());
+    __op(DeltaOp::AddArcs);
+    __put(&count, sizeof(count));
+    __put(arcs.data(), arcs.size() * sizeof(ArcData));
+}
+
+nil SceneDeltaWriter::PopBack(PrimitiveType type, size_t count) {
+    if (count == 0) return;
+    uint8_t type_code = static_cast<uint8_t>(type);
+    uint32_t count32 = static_cast<uint32_t>(count);
+    __op(DeltaOp::PopBack);
+    __put(&type_code, 1);
+    __put(&count32, sizeof(count32));
+}
+
+nil SceneDeltaWriter::Remove(PrimitiveId id) {
+    uint8_t type_code = static_cast<uint8_t>(id.GetType());
+    uint32_t index = id.GetIndex();
+    __op(DeltaOp::Remove);
+    __put(&type_code, 1);
+    __put(&index, sizeof(index));
+}
+
+nil SceneDeltaWriter::ReinsertLine(uint32_t index, const LineData& line) {
+    __op(DeltaOp::ReinsertLine);
+    __put(&index, sizeof(index));
+    __put(&line, sizeof(line));
+}
+
+nil SceneDeltaWriter::ReinsertArc(uint32_t index, const ArcData& arc) {
+    __op(DeltaOp::ReinsertArc);
+    __put(&index, sizeof(index));
+    __put(&arc, sizeof(arc));
+}
+
+nil SceneDeltaWriter::SetLine(uint32_t index, const LineData& line) {
+    __op(DeltaOp::SetLine);
+    __put(&index, sizeof(index));
+    __put(&line, sizeof(line));
+}
+
+nil SceneDeltaWriter::SetArc(uint32_t index, const ArcData& arc) {
+    __op(DeltaOp::SetArc);
+    __put(&index, sizeof(index));
+    __put(&arc, sizeof(arc));
+}
+
+nil SceneDeltaWriter::Clear() {
+    __op(DeltaOp::Clear);
+}
+
+// SceneDelta
+
+bool SceneDelta::Replay(const uint8_t* data, size_t size, Scene& scene) {
+    DeltaReader in{data, data + size};
+    while (in.p < in.end) {
+        uint8_t op = 0;
+        in.Get(op);
+        uint32_t count = 0, index = 0;
+        uint8_t type_code = 0;
+        LineData line{};
+        ArcData arc{};
+
+        switch (static_cast<DeltaOp>(op)) {
+            case DeltaOp::AddLines:
+                if (!in.Get(count)) return false;
+                for (uint32_t i = 0; i < count; i++) {
+                    if (!in.Get(line)) return false;
+                    scene.AddLine(line);
+                }
+                break;
+            case DeltaOp::AddArcs:
+                if (!in.Get(count)) return false;
+                for (uint32_t i = 0; i < count; i++) {
+                    if (!in.Get(arc)) return false;
+                    scene.AddArc(arc);
+                }
+                break;
+            case DeltaOp::PopBack:
+                if (!in.Get(type_code) || !in.Get(count) || type_code > 1) return false;
+                if (count > (type_code == static_cast<uint8_t>(PrimitiveType::Line)
+                                 ? scene.GetLines().size() : scene.GetArcs().size())) return false;
+                scene.PopBack(static_cast<PrimitiveType>(type_code), count);
+                break;
+            case DeltaOp::Remove: {
+                if (!in.Get(type_code) || !in.Get(index) || type_code > 1) return false;
+                PrimitiveId id(static_cast<PrimitiveType>(type_code), index);
+                if (!scene.Contains(id)) return false;
+                scene.Remove(id);
+                break;
+            }
+            case DeltaOp::ReinsertLine:
+                if (!in.Get(index) || !in.Get(line) || index > scene.GetLines().size()) return false;
+                scene.ReinsertLine(index, line);
+                break;
+            case DeltaOp::ReinsertArc:
+                if (!in.Get(index) || !in.Get(arc) || index > scene.GetArcs().size()) return false;
+                scene.ReinsertArc(index, arc);
+                break;
+            case DeltaOp::SetLine:
+                if (!in.Get(index) || !in.Get(line) || index >= scene.GetLines().size()) return false;
+                scene.SetLine(index, line);
+                break;
+            case DeltaOp::SetArc:
+                if (!in.Get(index) || !in.Get(arc) || index >= scene.GetArcs().size()) return false;
+                scene.SetArc(index, arc);
+                break;
+            case DeltaOp::Clear:
+                scene.Clear();
+                break;
+            default:
+                return false;
+        }
+    }
+    return true;
+}
+
+} // namespace MentalEngine
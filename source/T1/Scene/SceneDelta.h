@@ -0,0 +1,104 @@
+/**
+ * @file SceneDelta.h
+ * @brief Binary encoding of scene edits for MentalEngine
+ * @author MentalEngine Team
+ * @version 1.0.0
+ * @date 2024
+ *
+ * This file defines a compact byte encoding of the Scene mutation calls used
+ * by scene commands, so edits can be written to a journal and replayed onto
+ * a saved drawing later.
+ */
+
+#ifndef MENTAL_SCENE_DELTA_H
+#define MENTAL_SCENE_DELTA_H
+
+#include "../../Core/Types.h"
+#include "Scene.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace MentalEngine {
+
+/**
+ * @enum DeltaOp
+ * @brief Operation codes of the delta stream
+ */
+enum class DeltaOp : uint8_t {
+    AddLines = 1,   ///< u32 count, LineData[count]
+    AddArcs,        ///< u32 count, ArcData[count]
+    PopBack,        ///< u8 type, u32 count
+    Remove,         ///< u8 type, u32 index
+    ReinsertLine,   ///< u32 index, LineData
+    ReinsertArc,    ///< u32 index, ArcData
+    SetLine,        ///< u32 index, LineData
+    SetArc,         ///< u32 index, ArcData
+    Clear           ///< no payload
+};
+
+/**
+ * @class SceneDeltaWriter
+ * @brief Appends encoded Scene mutations to a byte buffer
+ *
+ * Each method mirrors the Scene call of the same name. Values are stored in
+ * native byte order; journals are local crash-recovery data, not an
+ * interchange format.
+ */
+class SceneDeltaWriter {
+private:
+    std::vector<uint8_t>& out;  ///< Destination buffer
+
+    /**
+     * @brief Appends raw bytes
+     * @private
+     */
+    nil __put(const void* data, size_t size);
+
+    /**
+     * @brief Appends an opcode
+     * @private
+     */
+    nil __op(DeltaOp op) { uint8_t code = static_cast<uint8_t>(op); __put(&code, 1); }
+
+public:
+    /**
+     * @brief Constructor
+     * @param out Buffer receiving the encoded operations
+     */
+    explicit SceneDeltaWriter(std::vector<uint8_t>& out) : out(out) {}
+
+    nil AddLines(const std::vector<LineData>& lines);
+    nil AddArcs(const std::vector<ArcData>& arcs);
+    nil PopBack(PrimitiveType type, size_t count);
+    nil Remove(PrimitiveId id);
+    nil ReinsertLine(uint32_t index, const LineData& line);
+    nil ReinsertArc(uint32_t index, const ArcData& arc);
+    nil SetLine(uint32_t index, const LineData& line);
+    nil SetArc(uint32_t index, const ArcData& arc);
+    nil Clear();
+};
+
+/**
+ * @class SceneDelta
+ * @brief Applies encoded operations to a scene
+ */
+class SceneDelta {
+public:
+    /**
+     * @brief Replays an operation stream
+     *
+     * Stops at the first malformed operation or at an index that does not
+     * exist in the scene, which means the stream does not belong to it.
+     *
+     * @param data Encoded operations
+     * @param size Number of bytes
+     * @param scene Scene to modify
+     * @return bool True if the whole stream was applied
+     */
+    static bool Replay(const uint8_t* data, size_t size, Scene& scene);
+};
+
+} // namespace MentalEngine
+
+#endif // MENTAL_SCENE_DELTA_H
@@ -0,0 +1,375 @@
+/**
+ * @file SceneLod.cpp
+ * @brief Implementation of the SceneLod class
+ * @author MentalEngine Team
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#include "SceneLod.h"
+#include "../../Core/JobSystem.h"
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
+#include <utility>
+
+namespace MentalEngine {
+
+namespace {
+
+constexpr size_t BLOCK_GRAIN = 16;  ///< Blocks per job when a level is built
+constexpr size_t MAX_UPDATED_CHANGES = 1024;  ///< More changed areas rebuild the whole level
+
+/**
+ * @brief Divides a cell coordinate by 2^shift, rounding toward negative infinity
+ */
+int32_t __block_coord(int32_t cell, int shift) {
+    return cell >= 0 ? cell >> shift : -((-(cell + 1)) >> shift) - 1;
+}
+
+uint64_t __block_key(int32_t x, int32_t y) {
+    return (static_cast<uint64_t>(static_cast<uint32_t>(x)) << 32) | static_cast<uint32_t>(y);
+}
+
+/**
+ * @brief Grows a box to include another
+ */
+nil __include(Bounds2D& content, const Bounds2D& bounds) {
+    content.min_x = std::min(content.min_x, bounds.min_x);
+    content.min_y = std::min(content.min_y, bounds.min_y);
+    content.max_x = std::max(content.max_x, bounds.max_x);
+    content.max_y = std::max(content.max_y, bounds.max_y);
+}
+
+/**
+ * @brief Computes the distance from a point to a segment
+ */
+float __distance_to_segment(const Math::Vector2& point, const Math::Vector2& a, const Math::Vector2& b) {
+    const Math::Vector2 ab = b - a;
+    const float length_squared = ab.dot(ab);
+    if (length_squared == 0.0f) return (point - a).length();
+    const float t = std::min(std::max((point - a).dot(ab) / length_squared, 0.0f), 1.0f);
+    return (point - (a + ab * t)).length();
+}
+
+/**
+ * @brief Simplifies a polyline with Douglas-Peucker and appends it as segments
+ *
+ * Iterative, so long chains cannot overflow the stack. Endpoints are always
+ * kept; a point is kept if dropping it would move the polyline by more than
+ * the tolerance.
+ */
+nil __simplify(const std::vector<Math::Vector2>& points, float tolerance, std::vector<uint8_t>& keep,
+               std::vector<std::pair<size_t, size_t>>& stack, std::vector<Math::Vector2>& out) {
+    const size_t count = points.size();
+    if (count < 2) return;
+    keep.assign(count, 0);
+    keep[0] = 1;
+    keep[count - 1] = 1;
+    stack.clear();
+    stack.emplace_back(0, count - 1);
+    while (!stack.empty()) {
+        const std::pair<size_t, size_t> range = stack.back();
+        stack.pop_back();
+        float worst = 0.0f;
+        size_t split = range.first;
+        for (size_t i = range.first + 1; i < range.second; i++) {
+            const float distance = __distance_to_segment(points[i], points[range.first], points[range.second]);
+            if (distance > worst) {
+                worst = distance;
+                split = i;
+            }
+        }
+        if (worst > tolerance) {
+            keep[split] = 1;
+            stack.emplace_back(range.first, split);
+            stack.emplace_back(split, range.second);
+        }
+    }
+
+    size_t previous = 0;
+    for (size_t i = 1; i < count; i++) {
+        if (!keep[i]) continue;
+        out.push_back(points[previous]);
+        out.push_back(points[i]);
+        previous = i;
+    }
+}
+
+} // namespace
+
+int SceneLod::SelectLevel(const Scene& scene, float pixel_size) {
+    const float cell_size = scene.GetIndex().GetCellSize();
+    if (!(pixel_size > 0.0f)) return 0;
+    // Уровень L годится, пока блок cell_size * 2^L не больше IMPOSTOR_RESOLUTION пикселей
+    const float blocks = IMPOSTOR_RESOLUTION * pixel_size / cell_size;
+    if (blocks < 2.0f) return 0;
+    const int level = static_cast<int>(std::floor(std::log2(blocks)));
+    return std::min(level, MAX_LEVELS - 1);
+}
+
+const SceneLod::Level* SceneLod::GetLevel(const Scene& scene, float pixel_size) {
+    if (source != &scene) {
+        for (Level& level : levels) {
+            level.segments.clear();
+            level.built = false;
+        }
+        source = &scene;
+    }
+
+    const int number = SelectLevel(scene, pixel_size);
+    if (number == 0) return nullptr;
+    Level& level = levels[number];
+    if (!level.built) {
+        level.level = number;
+        __build(scene, level);
+    } else if (level.revision != scene.GetRevision()) {
+        // Правка трогает несколько блоков - перестраиваем только их
+        changes.clear();
+        if (scene.GetChangesSince(level.revision, changes) && changes.size() <= MAX_UPDATED_CHANGES) {
+            __update(scene, level);
+        } else {
+            __build(scene, level);
+        }
+    }
+    level.revision = scene.GetRevision();
+    return &level;
+}
+
+nil SceneLod::Clear() {
+    for (Level& level : levels) level = Level();
+    for (LevelBlocks& output : outputs) output = LevelBlocks();
+    blocks.clear();
+    blocks.shrink_to_fit();
+    changes.clear();
+    changes.shrink_to_fit();
+    source = nullptr;
+}
+
+nil SceneLod::__build(const Scene& scene, Level& level) {
+    const SpatialIndex& index = scene.GetIndex();
+    const int shift = level.level;
+    LevelBlocks& output = outputs[level.level];
+    output.grid.clear();
+    output.oversized = BlockOutput();
+
+    // Каждый примитив попадает в блок ячейки с его минимальным углом
+    std::unordered_map<uint64_t, size_t> block_of;
+    size_t used = 0;
+    index.ForEachCell([&](int32_t cx, int32_t cy, const std::vector<SpatialIndex::Entry>& bucket) {
+        const int32_t bx = __block_coord(cx, shift);
+        const int32_t by = __block_coord(cy, shift);
+        const uint64_t key = __block_key(bx, by);
+        for (const SpatialIndex::Entry& entry : bucket) {
+            if (index.GetCellCoord(entry.bounds.min_x) != cx || index.GetCellCoord(entry.bounds.min_y) != cy) continue;
+            auto found = block_of.find(key);
+            if (found == block_of.end()) {
+                found = block_of.emplace(key, used).first;
+                __add_block(used, bx, by, entry.bounds);
+            }
+            Block& block = blocks[found->second];
+            __include(block.content, entry.bounds);
+            block.primitives.push_back(entry.id);
+        }
+    });
+    const size_t grid_blocks = used;
+
+    // Крупные примитивы упрощаются, но в маску не сворачиваются
+    if (!index.GetOversized().empty()) {
+        Block& block = __add_block(used, 0, 0, Bounds2D());
+        for (const SpatialIndex::Entry& entry : index.GetOversized()) block.primitives.push_back(entry.id);
+    }
+    __build_blocks(scene, level, used, grid_blocks);
+}
+
+nil SceneLod::__update(const Scene& scene, Level& level) {
+    const SpatialIndex& index = scene.GetIndex();
+    const int shift = level.level;
+    const float block_size = index.GetCellSize() * static_cast<float>(1u << shift);
+    LevelBlocks& output = outputs[level.level];
+
+    // Журнал хранит старые и новые границы, так что задеты и блок, откуда примитив ушел, и куда пришел
+    std::vector<uint64_t> dirty;
+    bool oversized_dirty = false;
+    for (const Bounds2D& area : changes) {
+        if (index.IsOversized(area)) {
+            oversized_dirty = true;
+            continue;
+        }
+        dirty.push_back(__block_key(__block_coord(index.GetCellCoord(area.min_x), shift),
+                                    __block_coord(index.GetCellCoord(area.min_y), shift)));
+    }
+    std::sort(dirty.begin(), dirty.end());
+    dirty.erase(std::unique(dirty.begin(), dirty.end()), dirty.end());
+
+    size_t used = 0;
+    for (uint64_t key : dirty) {
+        const int32_t bx = static_cast<int32_t>(static_cast<uint32_t>(key >> 32));
+        const int32_t by = static_cast<int32_t>(static_cast<uint32_t>(key & 0xFFFFFFFFu));
+        const Bounds2D area(static_cast<float>(bx) * block_size, static_cast<float>(by) * block_size,
+                            static_cast<float>(bx + 1) * block_size, static_cast<float>(by + 1) * block_size);
+        Block& block = __add_block(used, bx, by, Bounds2D());
+        index.Query(area, [&](const SpatialIndex::Entry& entry) {
+            if (index.IsOversized(entry.bounds)) return true;
+            if (__block_coord(index.GetCellCoord(entry.bounds.min_x), shift) != bx ||
+                __block_coord(index.GetCellCoord(entry.bounds.min_y), shift) != by) return true;
+            if (block.primitives.empty()) block.content = entry.bounds;
+            else __include(block.content, entry.bounds);
+            block.primitives.push_back(entry.id);
+            return true;
+        });
+        if (block.primitives.empty()) {
+            output.grid.erase(key);
+            used--;
+        }
+    }
+    const size_t grid_blocks = used;
+
+    if (oversized_dirty) {
+        output.oversized = BlockOutput();
+        if (!index.GetOversized().empty()) {
+            Block& block = __add_block(used, 0, 0, Bounds2D());
+            for (const SpatialIndex::Entry& entry : index.GetOversized()) block.primitives.push_back(entry.id);
+        }
+    }
+    __build_blocks(scene, level, used, grid_blocks);
+}
+
+SceneLod::Block& SceneLod::__add_block(size_t& used, int32_t x, int32_t y, const Bounds2D& content) {
+    if (used == blocks.size()) blocks.emplace_back();
+    Block& block = blocks[used++];
+    block.key = __block_key(x, y);
+    block.x = x;
+    block.y = y;
+    block.content = content;
+    block.primitives.clear();
+    block.output.clear();
+    block.impostor = false;
+    return block;
+}
+
+nil SceneLod::__build_blocks(const Scene& scene, Level& level, size_t used, size_t grid_blocks) {
+    const float block_size = scene.GetIndex().GetCellSize() * static_cast<float>(1u << level.level);
+    JobSystem::Instance().ParallelFor(0, used, BLOCK_GRAIN, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            __build_block(scene, blocks[i], block_size, i < grid_blocks);
+        }
+    });
+
+    LevelBlocks& output = outputs[level.level];
+    for (size_t i = 0; i < used; i++) {
+        Block& block = blocks[i];
+        BlockOutput& kept = i < grid_blocks ? output.grid[block.key] : output.oversized;
+        kept.segments.assign(block.output.begin(), block.output.end());
+        kept.impostor = block.impostor;
+    }
+    __assemble(level);
+}
+
+nil SceneLod::__assemble(Level& level) {
+    const LevelBlocks& output = outputs[level.level];
+    size_t total = output.oversized.segments.size();
+    level.impostor_count = 0;
+    for (const auto& block : output.grid) {
+        total += block.second.segments.size();
+        if (block.second.impostor) level.impostor_count++;
+    }
+    level.segments.clear();
+    level.segments.reserve(total);
+    for (const auto& block : output.grid) {
+        level.segments.insert(level.segments.end(), block.second.segments.begin(), block.second.segments.end());
+    }
+    level.segments.insert(level.segments.end(), output.oversized.segments.begin(), output.oversized.segments.end());
+    level.block_count = output.grid.size();
+    level.built = true;
+}
+
+nil SceneLod::__build_block(const Scene& scene, Block& block, float block_size, bool allow_impostor) {
+    const float texel = block_size / IMPOSTOR_RESOLUTION;
+    std::sort(block.primitives.begin(), block.primitives.end(),
+              [](const PrimitiveId& a, const PrimitiveId& b) { return a.value < b.value; });
+
+    // Линии, идущие подряд в хранилище и стыкующиеся концами, - одна полилиния
+    std::vector<Math::Vector2> chain;
+    std::vector<Math::Vector2> arc_points;
+    std::vector<uint8_t> keep;
+    std::vector<std::pair<size_t, size_t>> stack;
+    uint32_t previous_line = PrimitiveId::INVALID;
+    for (const PrimitiveId& id : block.primitives) {
+        const uint32_t index = id.GetIndex();
+        if (id.GetType() == PrimitiveType::Line) {
+            const LineData line = scene.GetLine(index);
+            const bool continues = !chain.empty() && previous_line + 1 == index &&
+                                   chain.back().x == line.x0 && chain.back().y == line.y0;
+            if (!continues) {
+                __simplify(chain, texel, keep, stack, block.output);
+                chain.clear();
+                chain.emplace_back(line.x0, line.y0);
+            }
+            chain.emplace_back(line.x1, line.y1);
+            previous_line = index;
+            continue;
+        }
+
+        __simplify(chain, texel, keep, stack, block.output);
+        chain.clear();
+        const size_t segments = scene.GetArcSegmentCount(index);
+        arc_points.resize(2 * segments);
+        scene.WriteArcSegments(index, arc_points.data());
+        chain.push_back(arc_points[0]);
+        for (size_t s = 0; s < segments; s++) chain.push_back(arc_points[2 * s + 1]);
+        __simplify(chain, texel, keep, stack, block.output);
+        chain.clear();
+    }
+    __simplify(chain, texel, keep, stack, block.output);
+    if (!allow_impostor || block.output.empty()) return;
+
+    // Маска покрытия в текселях блока; примитивы могут выходить за блок вправо и вверх
+    const float origin_x = static_cast<float>(block.x) * block_size;
+    const float origin_y = static_cast<float>(block.y) * block_size;
+    const int width = std::max(1, static_cast<int>(std::ceil((block.content.max_x - origin_x) / texel)));
+    const int height = std::max(1, static_cast<int>(std::ceil((block.content.max_y - origin_y) / texel)));
+    if (width > MAX_IMPOSTOR_TEXELS || height > MAX_IMPOSTOR_TEXELS) return;
+
+    std::vector<uint8_t> mask(static_cast<size_t>(width) * height, 0);
+    for (size_t i = 0; i + 1 < block.output.size(); i += 2) {
+        const Math::Vector2& a = block.output[i];
+        const Math::Vector2 delta = block.output[i + 1] - a;
+        const int steps = std::max(1, static_cast<int>(std::ceil(2.0f * delta.length() / texel)));
+        for (int k = 0; k <= steps; k++) {
+            const Math::Vector2 p = a + delta * (static_cast<float>(k) / steps);
+            const int tx = std::min(std::max(static_cast<int>(std::floor((p.x - origin_x) / texel)), 0), width - 1);
+            const int ty = std::min(std::max(static_cast<int>(std::floor((p.y - origin_y) / texel)), 0), height - 1);
+            mask[static_cast<size_t>(ty) * width + tx] = 1;
+        }
+    }
+
+    size_t runs = 0;
+    for (int ty = 0; ty < height; ty++) {
+        const uint8_t* row = &mask[static_cast<size_t>(ty) * width];
+        for (int tx = 0; tx < width; tx++) {
+            if (row[tx] && (tx == 0 || !row[tx - 1])) runs++;
+        }
+    }
+    if (runs >= block.output.size() / 2) return;
+
+    // Импостор дешевле: по отрезку на каждую серию покрытых текселей строки
+    block.output.clear();
+    for (int ty = 0; ty < height; ty++) {
+        const uint8_t* row = &mask[static_cast<size_t>(ty) * width];
+        const float y = origin_y + (static_cast<float>(ty) + 0.5f) * texel;
+        for (int tx = 0; tx < width;) {
+            if (!row[tx]) {
+                tx++;
+                continue;
+            }
+            const int first = tx;
+            while (tx < width && row[tx]) tx++;
+            block.output.emplace_back(origin_x + first * texel, y);
+            block.output.emplace_back(origin_x + tx * texel, y);
+        }
+    }
+    block.impostor = true;
+}
+
+} // namespace MentalEngine
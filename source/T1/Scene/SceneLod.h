@@ -0,0 +1,169 @@
+/**
+ * @file SceneLod.h
+ * @brief Level-of-detail geometry for zoomed-out drawings
+ * @author MentalEngine Team
+ * @version 1.0.0
+ * @date 2024
+ *
+ * This file defines the SceneLod class, which aggregates the scene's
+ * spatial index cells into coarser levels and keeps simplified line
+ * geometry per level, so a zoomed-out view draws roughly one segment per
+ * pixel instead of every primitive of the drawing.
+ */
+
+#ifndef MENTAL_SCENE_LOD_H
+#define MENTAL_SCENE_LOD_H
+
+#include "../../Core/Types.h"
+#include "../../Core/Math.h"
+#include "Scene.h"
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace MentalEngine {
+
+/**
+ * @class SceneLod
+ * @brief Hierarchy of simplified scene geometry over the spatial index
+ *
+ * Level L groups the index cells into blocks of 2^L by 2^L cells; each
+ * primitive belongs to the block containing its minimum corner. A level is
+ * used once its block spans at most IMPOSTOR_RESOLUTION pixels, which makes
+ * one texel of the block, block / IMPOSTOR_RESOLUTION, no larger than a
+ * pixel. Within a block:
+ * - consecutive lines that share endpoints are joined into polylines and
+ *   arcs are tessellated, then both are simplified with Douglas-Peucker to
+ *   a tolerance of one texel;
+ * - if the result still has more segments than the block has covered texel
+ *   runs, the block is replaced by an impostor: its geometry rasterized
+ *   into a coverage mask at texel resolution, drawn as one segment per run
+ *   of covered texels in a row.
+ * Oversized primitives are simplified but never turned into impostors.
+ *
+ * Levels are built on first use, in parallel over blocks. Each block's
+ * output is kept, so after an edit only the blocks whose primitives the
+ * scene's change log reports are rebuilt; bulk changes rebuild the level.
+ *
+ * @note Not thread-safe; builds the scene's spatial index if it is stale
+ */
+class SceneLod {
+public:
+    static constexpr int MAX_LEVELS = 16;           ///< Deepest level is cell size * 2^(MAX_LEVELS - 1)
+    static constexpr int IMPOSTOR_RESOLUTION = 8;   ///< Texels per block edge; also the block size in pixels where a level starts
+    static constexpr int MAX_IMPOSTOR_TEXELS = 64;  ///< Blocks whose content needs a larger mask per axis are only simplified
+
+    /**
+     * @struct Level
+     * @brief Simplified geometry of one level
+     */
+    struct Level {
+        int level = 0;                          ///< Level number, 1 or more
+        std::vector<Math::Vector2> segments;    ///< Start/end pairs of the whole scene
+        size_t block_count = 0;                 ///< Non-empty blocks
+        size_t impostor_count = 0;              ///< Blocks drawn as coverage masks
+        uint64_t revision = 0;                  ///< Scene revision the segments match
+        bool built = false;                     ///< Segments were built for the current scene
+    };
+
+private:
+    /**
+     * @struct Block
+     * @brief Primitives of one block of a level being built
+     */
+    struct Block {
+        uint64_t key = 0;                   ///< Packed block coordinates
+        int32_t x = 0, y = 0;               ///< Block coordinates
+        Bounds2D content;                   ///< Union of the primitives' bounds
+        std::vector<PrimitiveId> primitives;
+        std::vector<Math::Vector2> output;  ///< Segments produced for the block
+        bool impostor = false;              ///< Output is a coverage mask
+    };
+
+    /**
+     * @struct BlockOutput
+     * @brief Kept result of one block
+     */
+    struct BlockOutput {
+        std::vector<Math::Vector2> segments;  ///< Start/end pairs
+        bool impostor = false;                ///< Segments are a coverage mask
+    };
+
+    /**
+     * @struct LevelBlocks
+     * @brief Kept results of every block of a level
+     */
+    struct LevelBlocks {
+        std::unordered_map<uint64_t, BlockOutput> grid;  ///< Grid blocks by packed coordinates
+        BlockOutput oversized;                           ///< Primitives too large for the grid
+    };
+
+    const Scene* source = nullptr;     ///< Scene the levels were built for
+    Level levels[MAX_LEVELS];          ///< Level 0 is full detail and stays empty
+    LevelBlocks outputs[MAX_LEVELS];   ///< Block results behind each level's segments
+    std::vector<Block> blocks;         ///< Blocks being built, kept for their capacity
+    std::vector<Bounds2D> changes;     ///< Scratch for areas changed since a level was built
+
+    /**
+     * @brief Builds all blocks of a level
+     * @private
+     */
+    nil __build(const Scene& scene, Level& level);
+
+    /**
+     * @brief Rebuilds the blocks of a level that contain changed areas
+     * @private
+     */
+    nil __update(const Scene& scene, Level& level);
+
+    /**
+     * @brief Takes a recycled block for the next build
+     * @private
+     */
+    Block& __add_block(size_t& used, int32_t x, int32_t y, const Bounds2D& content);
+
+    /**
+     * @brief Builds blocks in parallel and stores their results
+     * @private
+     */
+    nil __build_blocks(const Scene& scene, Level& level, size_t used, size_t grid_blocks);
+
+    /**
+     * @brief Joins the stored block results into a level's segments
+     * @private
+     */
+    nil __assemble(Level& level);
+
+    /**
+     * @brief Simplifies a block's primitives and picks the impostor if it is smaller
+     * @private
+     */
+    static nil __build_block(const Scene& scene, Block& block, float block_size, bool allow_impostor);
+
+public:
+    /**
+     * @brief Picks the level for a pixel size
+     * @param scene Scene to draw
+     * @param pixel_size World units per pixel
+     * @return int Level number; 0 means full detail
+     */
+    static int SelectLevel(const Scene& scene, float pixel_size);
+
+    /**
+     * @brief Gets the geometry to draw a scene at a pixel size
+     * @param scene Scene to draw
+     * @param pixel_size World units per pixel
+     * @return const Level* Level geometry, built if needed; nullptr when full detail is needed
+     */
+    const Level* GetLevel(const Scene& scene, float pixel_size);
+
+    /**
+     * @brief Drops all levels and their memory
+     */
+    nil Clear();
+};
+
+} // namespace MentalEngine
+
+#endif // MENTAL_SCENE_LOD_H
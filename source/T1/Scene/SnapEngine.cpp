@@ -0,0 +1,177 @@
+/**
+ * @file SnapEngine.cpp
+ * @brief Implementation of the SnapEngine class
+ * @author MentalEngine Team
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#include "SnapEngine.h"
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cmath>
+#include <limits>
+
+namespace MentalEngine {
+
+namespace {
+
+const float TWO_PI = 6.28318530717958647692f;
+
+/**
+ * @brief Intersects two segments
+ * @return bool True if the segments cross, with the point in out
+ */
+bool __segment_intersection(float ax, float ay, float bx, float by,
+                            float cx, float cy, float dx, float dy, Math::Vector2& out) {
+    float rx = bx - ax, ry = by - ay;
+    float sx = dx - cx, sy = dy - cy;
+    float denom = rx * sy - ry * sx;
+    if (std::fabs(denom) < 1e-12f) return false;  // parallel or degenerate
+
+    float qx = cx - ax, qy = cy - ay;
+    float t = (qx * sy - qy * sx) / denom;
+    float u = (qx * ry - qy * rx) / denom;
+    if (t < 0.0f || t > 1.0f || u < 0.0f || u > 1.0f) return false;
+
+    out = Math::Vector2(ax + rx * t, ay + ry * t);
+    return true;
+}
+
+/**
+ * @brief Squared distance from a point to a box, zero inside it
+ */
+float __distance_sq(const Bounds2D& bounds, const Math::Vector2& point) {
+    float dx = std::max(std::max(bounds.min_x - point.x, point.x - bounds.max_x), 0.0f);
+    float dy = std::max(std::max(bounds.min_y - point.y, point.y - bounds.max_y), 0.0f);
+    return dx * dx + dy * dy;
+}
+
+} // namespace
+
+nil SnapEngine::__consider(SnapResult& best, float& best_distance, const Math::Vector2& cursor,
+                           const Math::Vector2& candidate, SnapType type, float tolerance) {
+    float distance = (candidate - cursor).length();
+    if (distance <= tolerance && distance < best_distance) {
+        best_distance = distance;
+        best.point = candidate;
+        best.type = type;
+    }
+}
+
+SnapResult SnapEngine::Snap(const Scene& scene, const Math::Vector2& cursor, float tolerance) {
+    using Clock = std::chrono::steady_clock;
+    const Clock::time_point start_time = Clock::now();
+    const auto budget = std::chrono::duration<double, std::milli>(settings.time_budget_ms);
+    auto out_of_time = [&]() { return Clock::now() - start_time > budget; };
+
+    SnapResult best;
+    best.point = cursor;
+    float best_distance = std::numeric_limits<float>::max();
+    last_query_capped = false;
+    last_query_out_of_time = false;
+
+    // Gather nearby primitives through the spatial index
+    ranked.clear();
+    scene.GetIndex().Query(Bounds2D::Around(cursor, tolerance), [&](const SpatialIndex::Entry& entry) {
+        ranked.emplace_back(__distance_sq(entry.bounds, cursor), entry.id);
+        return true;
+    });
+
+    // Over the cap keep the primitives closest to the cursor, not the first ones the index reported
+    if (ranked.size() > settings.max_candidates) {
+        last_query_capped = true;
+        auto cap = ranked.begin() + static_cast<std::ptrdiff_t>(settings.max_candidates);
+        std::nth_element(ranked.begin(), cap, ranked.end(),
+                         [](const std::pair<float, PrimitiveId>& a, const std::pair<float, PrimitiveId>& b) {
+                             return a.first < b.first;
+                         });
+        ranked.erase(cap, ranked.end());
+    }
+
+    nearby.clear();
+    for (const auto& candidate : ranked) nearby.push_back(candidate.second);
+
+    const LineStorage& lines = scene.GetLines();
+    const ArcStorage& arcs = scene.GetArcs();
+
+    // Point snaps: linear in the number of nearby primitives
+    for (PrimitiveId id : nearby) {
+        const uint32_t i = id.GetIndex();
+        if (id.GetType() == PrimitiveType::Line) {
+            Math::Vector2 a(lines.x0[i], lines.y0[i]);
+            Math::Vector2 b(lines.x1[i], lines.y1[i]);
+            if (settings.endpoint) {
+                __consider(best, best_distance, cursor, a, SnapType::Endpoint, tolerance);
+                __consider(best, best_distance, cursor, b, SnapType::Endpoint, tolerance);
+            }
+            if (settings.midpoint) {
+                __consider(best, best_distance, cursor, (a + b) * 0.5f, SnapType::Midpoint, tolerance);
+            }
+        } else {
+            Math::Vector2 center(arcs.cx[i], arcs.cy[i]);
+            const float r = arcs.radius[i];
+            const float start = arcs.start_angle[i];
+            const float sweep = arcs.sweep_angle[i];
+            const bool full_circle = sweep >= TWO_PI;
+            if (settings.endpoint && !full_circle) {
+                __consider(best, best_distance, cursor, center + Math::Vector2(std::cos(start), std::sin(start)) * r, SnapType::Endpoint, tolerance);
+                __consider(best, best_distance, cursor, center + Math::Vector2(std::cos(start + sweep), std::sin(start + sweep)) * r, SnapType::Endpoint, tolerance);
+            }
+            if (settings.midpoint && !full_circle) {
+                float mid = start + sweep * 0.5f;
+                __consider(best, best_distance, cursor, center + Math::Vector2(std::cos(mid), std::sin(mid)) * r, SnapType::Midpoint, tolerance);
+            }
+            if (settings.center) {
+                __consider(best, best_distance, cursor, center, SnapType::Center, tolerance);
+            }
+        }
+    }
+
+    // Line-line intersections: quadratic, so watch the budget
+    // Урезанный набор кандидатов тоже проверяется: в плотном месте пересечения не пропадают
+    if (settings.intersection) {
+        for (size_t a = 0; a < nearby.size() && !last_query_out_of_time; a++) {
+            if (nearby[a].GetType() != PrimitiveType::Line) continue;
+            const uint32_t i = nearby[a].GetIndex();
+            for (size_t b = a + 1; b < nearby.size(); b++) {
+                if (nearby[b].GetType() != PrimitiveType::Line) continue;
+                const uint32_t j = nearby[b].GetIndex();
+                Math::Vector2 point;
+                if (__segment_intersection(lines.x0[i], lines.y0[i], lines.x1[i], lines.y1[i],
+                                           lines.x0[j], lines.y0[j], lines.x1[j], lines.y1[j], point)) {
+                    __consider(best, best_distance, cursor, point, SnapType::Intersection, tolerance);
+                }
+            }
+            if ((a & 15) == 15 && out_of_time()) {
+                last_query_out_of_time = true;
+            }
+        }
+    }
+
+    // Grid is the fallback when no object snap is in range
+    if (best.type == SnapType::None && settings.grid && settings.grid_spacing > 0.0f) {
+        Math::Vector2 local = cursor - settings.grid_origin;
+        Math::Vector2 node(std::round(local.x / settings.grid_spacing) * settings.grid_spacing,
+                           std::round(local.y / settings.grid_spacing) * settings.grid_spacing);
+        __consider(best, best_distance, cursor, node + settings.grid_origin, SnapType::Grid, tolerance);
+    }
+
+    last_query_ms = std::chrono::duration<double, std::milli>(Clock::now() - start_time).count();
+    return best;
+}
+
+const char* SnapEngine::GetSnapTypeName(SnapType type) {
+    switch (type) {
+        case SnapType::Endpoint: return "Endpoint";
+        case SnapType::Midpoint: return "Midpoint";
+        case SnapType::Center: return "Center";
+        case SnapType::Intersection: return "Intersection";
+        case SnapType::Grid: return "Grid";
+        case SnapType::None: break;
+    }
+    return "None";
+}
+
+} // namespace MentalEngine
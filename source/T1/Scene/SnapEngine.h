@@ -0,0 +1,145 @@
+/**
+ * @file SnapEngine.h
+ * @brief Object snapping for CAD drawing tools
+ * @author MentalEngine Team
+ * @version 1.0.0
+ * @date 2024
+ *
+ * This file defines the SnapEngine class, which finds precise snap points
+ * (endpoints, midpoints, centers, intersections, grid points) near the cursor
+ * by querying the scene's spatial index.
+ */
+
+#ifndef MENTAL_SNAP_ENGINE_H
+#define MENTAL_SNAP_ENGINE_H
+
+#include "../../Core/Types.h"
+#include "../../Core/Math.h"
+#include "Scene.h"
+#include <utility>
+#include <vector>
+
+namespace MentalEngine {
+
+/**
+ * @enum SnapType
+ * @brief Kind of point the cursor snapped to
+ */
+enum class SnapType {
+    None,           ///< No snap, raw cursor position
+    Endpoint,       ///< Line or arc end
+    Midpoint,       ///< Line or arc midpoint
+    Center,         ///< Arc or circle center
+    Intersection,   ///< Intersection of two lines
+    Grid            ///< Grid node
+};
+
+/**
+ * @struct SnapSettings
+ * @brief Enabled snap modes and limits
+ */
+struct SnapSettings {
+    bool endpoint = true;                 ///< Snap to endpoints
+    bool midpoint = true;                 ///< Snap to midpoints
+    bool center = true;                   ///< Snap to centers
+    bool intersection = true;             ///< Snap to line-line intersections
+    bool grid = false;                    ///< Fall back to grid nodes
+    Math::Vector2 grid_origin = Math::Vector2(-1.0f, -1.0f);  ///< Grid origin (matches the renderer grid)
+    float grid_spacing = 0.15f;           ///< Grid spacing in world units (matches the renderer grid)
+    size_t max_candidates = 256;          ///< Nearby primitives considered per query
+    float time_budget_ms = 1.0f;          ///< Soft time limit per query
+};
+
+/**
+ * @struct SnapResult
+ * @brief Outcome of a snap query
+ */
+struct SnapResult {
+    Math::Vector2 point;            ///< Snapped (or raw) position
+    SnapType type = SnapType::None; ///< Snap kind
+};
+
+/**
+ * @class SnapEngine
+ * @brief Computes snap points around the cursor
+ *
+ * Each query collects primitives from the scene's spatial index inside the
+ * snap tolerance, evaluates the enabled snap candidates and returns the one
+ * closest to the cursor. Intersections are quadratic in the number of nearby
+ * lines, so the candidate count is capped and the intersection pass stops
+ * early once its time budget is spent; the best point found so far is
+ * returned. A capped query keeps the candidates whose bounds lie closest to
+ * the cursor and still looks for intersections among them.
+ *
+ * Key features:
+ * - Only nearby geometry is examined
+ * - Candidate cap and time budget keep mouse moves responsive
+ * - Scratch buffers are reused across queries
+ */
+class SnapEngine {
+private:
+    SnapSettings settings;                  ///< Active settings
+    std::vector<std::pair<float, PrimitiveId>> ranked; ///< Scratch list of candidates with squared bounds distance
+    std::vector<PrimitiveId> nearby;        ///< Scratch list of nearby primitives
+    double last_query_ms = 0.0;             ///< Duration of the last query
+    bool last_query_capped = false;         ///< Last query found more than max_candidates primitives
+    bool last_query_out_of_time = false;    ///< Last query stopped its intersection pass on the time budget
+
+    /**
+     * @brief Keeps a candidate if it beats the current best
+     * @private
+     */
+    static nil __consider(SnapResult& best, float& best_distance, const Math::Vector2& cursor,
+                          const Math::Vector2& candidate, SnapType type, float tolerance);
+
+public:
+    /**
+     * @brief Finds the best snap point near the cursor
+     * @param scene Scene to snap against
+     * @param cursor Cursor position in world units
+     * @param tolerance Snap radius in world units
+     * @return SnapResult Snapped point, or the cursor with SnapType::None
+     */
+    SnapResult Snap(const Scene& scene, const Math::Vector2& cursor, float tolerance);
+
+    /**
+     * @brief Gets mutable snap settings
+     * @return SnapSettings& Settings
+     */
+    SnapSettings& GetSettings() { return settings; }
+
+    /**
+     * @brief Gets the duration of the last query
+     * @return double Milliseconds
+     */
+    double GetLastQueryTime() const { return last_query_ms; }
+
+    /**
+     * @brief Checks whether the last query was cut short
+     * @return bool True if the candidate cap or time budget was reached
+     */
+    bool WasLastQueryTruncated() const { return last_query_capped || last_query_out_of_time; }
+
+    /**
+     * @brief Checks whether the last query dropped nearby primitives
+     * @return bool True if more than max_candidates primitives were in range
+     */
+    bool WasLastQueryCapped() const { return last_query_capped; }
+
+    /**
+     * @brief Checks whether the last query ran out of time
+     * @return bool True if the intersection pass stopped on the time budget
+     */
+    bool WasLastQueryOutOfTime() const { return last_query_out_of_time; }
+
+    /**
+     * @brief Gets a display name for a snap type
+     * @param type Snap type
+     * @return const char* Name
+     */
+    static const char* GetSnapTypeName(SnapType type);
+};
+
+} // namespace MentalEngine
+
+#endif // MENTAL_SNAP_ENGINE_H
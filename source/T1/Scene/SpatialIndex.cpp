@@ -0,0 +1,87 @@
+/**
+ * @file SpatialIndex.cpp
+ * @brief Implementation of the SpatialIndex class
+ * @author MentalEngine Team
+ * @version 1.0.0
+ * @date 2024
+ */
+
+#include "SpatialIndex.h"
+
+namespace MentalEngine {
+
+SpatialIndex::SpatialIndex(float cell_size)
+    : cell_size(cell_size > 0.0f ? cell_size : 1.0f)
+    , inv_cell_size(1.0f / (cell_size > 0.0f ? cell_size : 1.0f))
+{
+}
+
+nil SpatialIndex::Insert(PrimitiveId id, const Bounds2D& bounds) {
+    Entry entry{id, bounds};
+    entry_count++;
+    
+    if (__is_oversized(bounds)) {
+        oversized.push_back(entry);
+        return;
+    }
+    
+    const int32_t x0 = __cell_coord(bounds.min_x);
+    const int32_t y0 = __cell_coord(bounds.min_y);
+    const int32_t x1 = __cell_coord(bounds.max_x);
+    const int32_t y1 = __cell_coord(bounds.max_y);
+    for (int32_t cy = y0; cy <= y1; cy++) {
+        for (int32_t cx = x0; cx <= x1; cx++) {
+            cells[__cell_key(cx, cy)].push_back(entry);
+        }
+    }
+}
+
+bool SpatialIndex::Remove(PrimitiveId id, const Bounds2D& bounds) {
+    bool found = false;
+    
+    if (__is_oversized(bounds)) {
+        found = __erase_from(oversized, id);
+    } else {
+        const int32_t x0 = __cell_coord(bounds.min_x);
+        const int32_t y0 = __cell_coord(bounds.min_y);
+        const int32_t x1 = __cell_coord(bounds.max_x);
+        const int32_t y1 = __cell_coord(bounds.max_y);
+        for (int32_t cy = y0; cy <= y1; cy++) {
+            for (int32_t cx = x0; cx <= x1; cx++) {
+                auto it = cells.find(__cell_key(cx, cy));
+                if (it == cells.end()) continue;
+                found = __erase_from(it->second, id) || found;
+                if (it->second.empty()) cells.erase(it);
+            }
+        }
+    }
+    
+    if (found) entry_count--;
+    return found;
+}
+
+nil SpatialIndex::Clear() {
+    cells.clear();
+    oversized.clear();
+    entry_count = 0;
+}
+
+bool SpatialIndex::__is_oversized(const Bounds2D& bounds) const {
+    float span_x = (bounds.max_x - bounds.min_x) * inv_cell_size;
+    float span_y = (bounds.max_y - bounds.min_y) * inv_cell_size;
+    return span_x > MAX_CELLS_PER_AXIS || span_y > MAX_CELLS_PER_AXIS;
+}
+
+bool SpatialIndex::__erase_from(std::vector<Entry>& bucket, PrimitiveId id) {
+    for (size_t i = 0; i < bucket.size(); i++) {
+        if (bucket[i].id == id) {
+            // Order inside a cell is irrelevant, so swap-and-pop
+            bucket[i] = bucket.back();
+            bucket.pop_back();
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace MentalEngine
@@ -0,0 +1,298 @@
+/**
+ * @file SpatialIndex.h
+ * @brief Uniform-grid spatial index for scene primitives
+ * @author MentalEngine Team
+ * @version 1.0.0
+ * @date 2024
+ *
+ * This file defines the SpatialIndex class, a hashed uniform grid that maps
+ * 2D bounding boxes of scene primitives to grid cells. It is used for
+ * picking, snapping and any other query that needs "what is near this point"
+ * without scanning the whole scene.
+ */
+
+#ifndef MENTAL_SPATIAL_INDEX_H
+#define MENTAL_SPATIAL_INDEX_H
+
+#include "../../Core/Types.h"
+#include "../../Core/Math.h"
+#include <cstdint>
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+
+namespace MentalEngine {
+
+/**
+ * @enum PrimitiveType
+ * @brief Kinds of geometry stored in the scene
+ */
+enum class PrimitiveType : uint8_t {
+    Line,   ///< Straight line segment
+    Arc     ///< Circular arc (a circle is an arc with a full sweep)
+};
+
+/**
+ * @struct PrimitiveId
+ * @brief Compact handle to a primitive in scene storage
+ *
+ * Packs the primitive type into the top bit and the storage index into the
+ * remaining 31 bits, so index cells stay 4 bytes per reference.
+ */
+struct PrimitiveId {
+    static constexpr uint32_t INVALID = 0xFFFFFFFFu;   ///< Value of an empty handle
+    static constexpr uint32_t TYPE_BIT = 0x80000000u;  ///< Bit storing the primitive type
+
+    uint32_t value = INVALID;  ///< Packed type and index
+
+    PrimitiveId() = default;
+    PrimitiveId(PrimitiveType type, uint32_t index)
+        : value((type == PrimitiveType::Arc ? TYPE_BIT : 0u) | (index & ~TYPE_BIT)) {}
+
+    bool IsValid() const { return value != INVALID; }
+    PrimitiveType GetType() const { return (value & TYPE_BIT) ? PrimitiveType::Arc : PrimitiveType::Line; }
+    uint32_t GetIndex() const { return value & ~TYPE_BIT; }
+
+    bool operator==(const PrimitiveId& other) const { return value == other.value; }
+    bool operator!=(const PrimitiveId& other) const { return value != other.value; }
+};
+
+/**
+ * @struct Bounds2D
+ * @brief Axis-aligned 2D bounding box
+ */
+struct Bounds2D {
+    float min_x = 0.0f, min_y = 0.0f;
+    float max_x = 0.0f, max_y = 0.0f;
+
+    Bounds2D() = default;
+    Bounds2D(float min_x, float min_y, float max_x, float max_y)
+        : min_x(min_x), min_y(min_y), max_x(max_x), max_y(max_y) {}
+
+    /**
+     * @brief Builds a square box around a point
+     * @param center Box center
+     * @param radius Half extent
+     * @return Bounds2D Box around the point
+     */
+    static Bounds2D Around(const Math::Vector2& center, float radius) {
+        return Bounds2D(center.x - radius, center.y - radius, center.x + radius, center.y + radius);
+    }
+
+    bool Intersects(const Bounds2D& other) const {
+        return min_x <= other.max_x && max_x >= other.min_x &&
+               min_y <= other.max_y && max_y >= other.min_y;
+    }
+};
+
+/**
+ * @class SpatialIndex
+ * @brief Hashed uniform grid over primitive bounding boxes
+ *
+ * Every primitive is registered in each grid cell its bounding box overlaps.
+ * Cells keep a copy of the bounding box next to the handle, so queries can
+ * reject candidates without touching scene storage, and a primitive that
+ * spans several cells is reported exactly once per query.
+ *
+ * Primitives whose bounding box covers more than MAX_CELLS_PER_AXIS cells on
+ * either axis are kept in a separate list that every query scans; this keeps
+ * a few huge entities (site outlines, construction lines) from flooding the
+ * grid.
+ *
+ * Key features:
+ * - O(1) insertion and removal per covered cell
+ * - Query cost proportional to the queried area, not scene size
+ * - Duplicate-free results without per-query scratch memory
+ */
+class SpatialIndex {
+public:
+    static constexpr int MAX_CELLS_PER_AXIS = 64;  ///< Larger primitives go to the oversized list
+
+    /**
+     * @struct Entry
+     * @brief Primitive reference with its cached bounds
+     */
+    struct Entry {
+        PrimitiveId id;   ///< Primitive handle
+        Bounds2D bounds;  ///< Bounding box at insertion time
+    };
+
+private:
+    float cell_size;                                         ///< Grid cell size in world units
+    float inv_cell_size;                                     ///< 1 / cell_size
+    std::unordered_map<uint64_t, std::vector<Entry>> cells;  ///< Non-empty cells keyed by packed coordinates
+    std::vector<Entry> oversized;                            ///< Primitives too large for the grid
+    size_t entry_count = 0;                                  ///< Number of indexed primitives
+
+    /**
+     * @brief Converts a world coordinate to a cell coordinate
+     * @private
+     */
+    int32_t __cell_coord(float value) const {
+        // Clamp so far-away coordinates cannot overflow the cell key
+        float cell = std::floor(value * inv_cell_size);
+        return static_cast<int32_t>(std::max(-1.0e9f, std::min(1.0e9f, cell)));
+    }
+
+    /**
+     * @brief Packs two cell coordinates into a hash key
+     * @private
+     */
+    static uint64_t __cell_key(int32_t cx, int32_t cy) {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(cx)) << 32) | static_cast<uint32_t>(cy);
+    }
+
+    /**
+     * @brief Checks whether a box is too large for the grid
+     * @private
+     */
+    bool __is_oversized(const Bounds2D& bounds) const;
+
+    /**
+     * @brief Removes an entry with the given id from a bucket
+     * @private
+     */
+    static bool __erase_from(std::vector<Entry>& bucket, PrimitiveId id);
+
+public:
+    /**
+     * @brief Constructor
+     * @param cell_size Grid cell size in world units
+     */
+    explicit SpatialIndex(float cell_size = 1.0f);
+
+    /**
+     * @brief Adds a primitive to the index
+     * @param id Primitive handle
+     * @param bounds Primitive bounding box
+     */
+    nil Insert(PrimitiveId id, const Bounds2D& bounds);
+
+    /**
+     * @brief Removes a primitive from the index
+     * @param id Primitive handle
+     * @param bounds Bounding box the primitive was inserted with
+     * @return bool True if the primitive was found
+     */
+    bool Remove(PrimitiveId id, const Bounds2D& bounds);
+
+    /**
+     * @brief Removes every primitive and releases cell memory
+     */
+    nil Clear();
+
+    /**
+     * @brief Gets the grid cell size
+     * @return float Cell size in world units
+     */
+    float GetCellSize() const { return cell_size; }
+
+    /**
+     * @brief Gets the number of indexed primitives
+     * @return size_t Primitive count
+     */
+    size_t GetEntryCount() const { return entry_count; }
+
+    /**
+     * @brief Gets the number of non-empty grid cells
+     * @return size_t Cell count
+     */
+    size_t GetCellCount() const { return cells.size(); }
+
+    /**
+     * @brief Converts a world coordinate to the coordinate of the cell containing it
+     * @param value World coordinate
+     * @return int32_t Cell coordinate
+     */
+    int32_t GetCellCoord(float value) const { return __cell_coord(value); }
+
+    /**
+     * @brief Checks whether a box would go to the oversized list
+     * @param bounds Bounding box
+     * @return bool True if the box spans too many cells for the grid
+     */
+    bool IsOversized(const Bounds2D& bounds) const { return __is_oversized(bounds); }
+
+    /**
+     * @brief Gets the primitives too large for the grid
+     * @return const std::vector<Entry>& Oversized entries
+     */
+    const std::vector<Entry>& GetOversized() const { return oversized; }
+
+    /**
+     * @brief Visits every non-empty grid cell in unspecified order
+     *
+     * A primitive appears in every cell its bounds overlap; the first of
+     * them is the cell containing its minimum corner.
+     *
+     * @tparam Visitor Callable as nil(int32_t cx, int32_t cy, const std::vector<Entry>&)
+     * @param visitor Callback invoked per cell
+     */
+    template <typename Visitor>
+    nil ForEachCell(Visitor&& visitor) const {
+        for (const auto& cell : cells) {
+            int32_t cx = static_cast<int32_t>(static_cast<uint32_t>(cell.first >> 32));
+            int32_t cy = static_cast<int32_t>(static_cast<uint32_t>(cell.first & 0xFFFFFFFFu));
+            visitor(cx, cy, cell.second);
+        }
+    }
+
+    /**
+     * @brief Visits every primitive whose bounds overlap the query box
+     *
+     * Each primitive is reported once. The visitor may return false to stop
+     * the query early.
+     *
+     * @tparam Visitor Callable as bool(const Entry&)
+     * @param area Query box in world units
+     * @param visitor Callback invoked per overlapping primitive
+     */
+    template <typename Visitor>
+    nil Query(const Bounds2D& area, Visitor&& visitor) const {
+        for (const Entry& entry : oversized) {
+            if (entry.bounds.Intersects(area) && !visitor(entry)) return;
+        }
+
+        const int32_t qx0 = __cell_coord(area.min_x);
+        const int32_t qy0 = __cell_coord(area.min_y);
+        const int32_t qx1 = __cell_coord(area.max_x);
+        const int32_t qy1 = __cell_coord(area.max_y);
+
+        // Report a multi-cell primitive only from the first cell where its
+        // box and the query box overlap
+        auto visit_cell = [&](int32_t cx, int32_t cy, const std::vector<Entry>& bucket) {
+            for (const Entry& entry : bucket) {
+                if (!entry.bounds.Intersects(area)) continue;
+                int32_t first_x = std::max(__cell_coord(entry.bounds.min_x), qx0);
+                int32_t first_y = std::max(__cell_coord(entry.bounds.min_y), qy0);
+                if (first_x != cx || first_y != cy) continue;
+                if (!visitor(entry)) return false;
+            }
+            return true;
+        };
+
+        // Zoomed-out queries can span more cells than exist; walk the map then
+        double query_cells = (static_cast<double>(qx1) - qx0 + 1.0) * (static_cast<double>(qy1) - qy0 + 1.0);
+        if (query_cells > static_cast<double>(cells.size())) {
+            for (const auto& cell : cells) {
+                int32_t cx = static_cast<int32_t>(static_cast<uint32_t>(cell.first >> 32));
+                int32_t cy = static_cast<int32_t>(static_cast<uint32_t>(cell.first & 0xFFFFFFFFu));
+                if (cx < qx0 || cx > qx1 || cy < qy0 || cy > qy1) continue;
+                if (!visit_cell(cx, cy, cell.second)) return;
+            }
+            return;
+        }
+
+        for (int32_t cy = qy0; cy <= qy1; cy++) {
+            for (int32_t cx = qx0; cx <= qx1; cx++) {
+                auto it = cells.find(__cell_key(cx, cy));
+                if (it == cells.end()) continue;
+                if (!visit_cell(cx, cy, it->second)) return;
+            }
+        }
+    }
+};
+
+} // namespace MentalEngine
+
+#endif // MENTAL_SPATIAL_INDEX_H
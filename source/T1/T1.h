@@ -61,6 +61,18 @@ public:
      */
     inline nil Run() const { this->ptrWindowManager->Run(); }
     
+    /**
+     * @brief Enables rendering on a separate thread
+     * @param enabled True to decouple rendering from event polling
+     */
+    inline nil SetThreadedRendering(bool enabled) { this->ptrWindowManager->SetThreadedRendering(enabled); }
+    
+    /**
+     * @brief Chooses between on-demand and continuous redraw
+     * @param enabled True to draw frames only while something changes
+     */
+    inline nil SetOnDemandRedraw(bool enabled) { this->ptrWindowManager->SetOnDemandRedraw(enabled); }
+    
     /**
      * @brief Destructor
      * 
@@ -16,13 +16,24 @@
 #include <iostream>
 #include <cstdio>
 #include <cstring>
+#include <algorithm>
 #include <vector>
 #include <string>
 #include <sstream>
 #include <mutex>
+#include <chrono>
 
 #include "../../Core/Types.h"
+#include "../../Core/JobSystem.h"
+#include "../../Core/MemoryTracker.h"
 #include "../Renderer/Renderer.h"
+#include "../Scene/Scene.h"
+#include "../Scene/SnapEngine.h"
+#include "../Scene/CommandHistory.h"
+#include "../IO/DrawingFile.h"
+#include "../IO/DxfImporter.h"
+#include "../IO/SvgExporter.h"
+#include "../IO/Autosave.h"
 
 #include <GLFW/glfw3.h>
 #include "imgui.h"
@@ -38,14 +49,44 @@ class ConsoleRedirectBuffer;
  * @brief Available drawing tools
  */
 enum class ToolType {
-    None,       ///< No tool selected
+    None,       ///< Selection tool (click to select, hover to highlight)
     Line,       ///< Line drawing tool
     Rectangle,  ///< Rectangle drawing tool
     Circle      ///< Circle drawing tool
 };
 
+/**
+ * @struct ViewportMapping
+ * @brief Per-frame cache for mapping window pixels into the viewport's world space
+ * 
+ * Filled once per frame while the Viewport panel is drawn, then used by every
+ * mouse event until the next frame, so input handling needs neither platform
+ * calls nor matrix inversions.
+ */
+struct ViewportMapping {
+    float x = 0.0f;       ///< Panel image left edge in window pixels
+    float y = 0.0f;       ///< Panel image top edge in window pixels
+    float width = 0.0f;   ///< Panel image width in pixels
+    float height = 0.0f;  ///< Panel image height in pixels
+    MentalEngine::Math::Matrix4 inverse_view_projection;  ///< Camera inverse view-projection for this frame
+    bool valid = false;   ///< Set once the panel has been drawn with a camera
+};
+
+/**
+ * @struct ExtraView
+ * @brief Optional orthographic view shown next to the main viewport
+ */
+struct ExtraView {
+    static constexpr float QUARTER_TURN = 1.57079632679f;  ///< 90 degrees in radians
+
+    const char* title;                                     ///< Panel title
+    MentalEngine::Math::Quaternion orientation;            ///< Fixed view direction
+    size_t viewport = Renderer::INVALID_VIEWPORT;          ///< Renderer viewport while open
+    bool open = false;                                     ///< Panel is shown
+};
+
 // Forward declaration for method
-template <typename T> void __add_console_output_impl(void* ui, const std::string& text);
+template <typename T> void __add_console_output_impl(void* ui, const char* text, size_t count);
 
 /**
  * @class ConsoleRedirectBuffer
@@ -76,7 +117,7 @@ protected:
     virtual int_type overflow(int_type c) override {
         if (c != EOF) {
             char ch = static_cast<char>(c);
-            __add_console_output_impl<GLFWwindow>(ui, std::string(1, ch));
+            __add_console_output_impl<GLFWwindow>(ui, &ch, 1);
         }
         return c;
     }
@@ -89,7 +130,7 @@ protected:
      * @protected
      */
     virtual std::streamsize xsputn(const char* s, std::streamsize count) override {
-        __add_console_output_impl<GLFWwindow>(ui, std::string(s, count));
+        __add_console_output_impl<GLFWwindow>(ui, s, static_cast<size_t>(count));
         return count;
     }
 };
@@ -125,18 +166,73 @@ private:
     class Renderer* pRenderer = nullptr;    ///< Pointer to the renderer
 
     bool show_demo_window = true;           ///< Flag to show/hide ImGui demo window
-    bool mouse_over_viewport = false;       ///< Flag indicating if mouse is over viewport
+    bool show_memory_window = true;         ///< Flag to show/hide the memory panel
+    bool mouse_over_viewport = false;       ///< Flag indicating if mouse is over any viewport panel
+    ViewportMapping viewport_mappings[Renderer::MAX_VIEWPORTS];  ///< Cached rect and camera inverse per renderer viewport
+    ExtraView extra_views[3] = {
+        {"Top", MentalEngine::Math::Quaternion()},
+        {"Front", MentalEngine::Math::angleAxis(ExtraView::QUARTER_TURN, MentalEngine::Math::Vector3(1.0f, 0.0f, 0.0f))},
+        {"Right", MentalEngine::Math::angleAxis(ExtraView::QUARTER_TURN, MentalEngine::Math::Vector3(0.0f, 0.0f, 1.0f)) *
+                  MentalEngine::Math::angleAxis(ExtraView::QUARTER_TURN, MentalEngine::Math::Vector3(1.0f, 0.0f, 0.0f))},
+    };                                      ///< Orthographic views opened from View > Viewports
 
     // Drawing tools
     ToolType current_tool = ToolType::None; ///< Currently selected tool
     bool is_drawing = false;                ///< Currently drawing
     MentalEngine::Math::Vector2 line_start;               ///< Line start point
     MentalEngine::Math::Vector2 line_end;                 ///< Line end point
-    std::vector<MentalEngine::Math::Vector2> line_points; ///< All line points for rendering
+    MentalEngine::Scene scene;                            ///< Drawing geometry
+    MentalEngine::CommandHistory history;                 ///< Undo/redo stack for scene edits
+
+    // Selection
+    MentalEngine::PrimitiveId hovered_primitive;          ///< Primitive under the cursor
+    MentalEngine::PrimitiveId selected_primitive;         ///< Primitive picked by the last click
+    float pick_tolerance_px = 6.0f;                       ///< Picking tolerance in screen pixels
+    bool is_dragging = false;                             ///< Moving the selected primitive
+    MentalEngine::Math::Vector2 drag_last;                ///< World point of the previous drag event
+    MentalEngine::Math::Vector2d view_origin;             ///< Scene origin the camera was last synced to
+
+    // Snapping
+    MentalEngine::SnapEngine snap_engine;                 ///< Object snap engine
+    MentalEngine::SnapResult last_snap;                   ///< Snap result of the last mouse event
+    float snap_tolerance_px = 10.0f;                      ///< Snap radius in screen pixels
+    float snap_marker_size = 0.0f;                        ///< Snap marker half size in world units
+
+    // File dialogs
+    char drawing_path[512] = "drawing.mdrw";              ///< Path used by File > Open / Save
+    bool open_dialog_requested = false;                   ///< Open the "Open Drawing" popup next frame
+    bool save_dialog_requested = false;                   ///< Open the "Save Drawing" popup next frame
+    char import_path[512] = "drawing.dxf";                ///< Path used by File > Import DXF
+    bool import_dialog_requested = false;                 ///< Open the "Import DXF" popup next frame
+    MentalEngine::DxfImporter dxf_importer;               ///< Background DXF import
+    MentalEngine::DrawingFileLoader drawing_loader;       ///< Background File > Open
+    std::chrono::steady_clock::time_point open_start;     ///< When the running open started
+    char export_path[512] = "drawing.svg";                ///< Path used by File > Export SVG
+    bool export_dialog_requested = false;                 ///< Open the "Export SVG" popup next frame
+
+    // Autosave
+    MentalEngine::Autosave autosave;                      ///< Background journal of scene edits
+    std::string autosave_prefix = "mentalengine_autosave"; ///< Path prefix of the autosave files
+    bool recovery_available = false;                      ///< Files from an unclean exit were found
+
+    // Job system profiling
+    std::vector<MentalEngine::JobWorkerStats> job_stats_sample;  ///< Counters at the last sample
+    std::vector<float> job_utilization;                   ///< Busy fraction per thread over the last interval
+    std::chrono::steady_clock::time_point job_sample_time;  ///< Time of the last sample
+    std::vector<MentalEngine::JobWorkerStats> job_stats_scratch;  ///< Reused buffer for the next sample
+
+    // Frame memory profiling
+    uint64_t frame_allocation_mark = 0;                   ///< Allocation count at the start of the last frame
+    uint64_t frame_allocations = 0;                       ///< Heap allocations during the previous frame, all threads
+    uint64_t tag_allocation_mark[static_cast<size_t>(MentalEngine::MemoryTag::Count)] = {};  ///< Per-tag counts at the last frame start
+    uint64_t tag_frame_allocations[static_cast<size_t>(MentalEngine::MemoryTag::Count)] = {};  ///< Per-tag allocations during the previous frame
+    uint64_t gpu_upload_mark = 0;                         ///< Uploaded bytes at the last frame start
+    uint64_t gpu_frame_uploads = 0;                       ///< Bytes uploaded during the previous frame
 
     // Console system
     std::vector<std::string> console_output;        ///< Console output buffer
     std::string console_input;                      ///< Console input buffer
+    std::string console_partial;                    ///< Redirected output not terminated by a newline yet
     bool console_scroll_to_bottom = true;           ///< Auto-scroll flag
     std::mutex console_mutex;                       ///< Console thread safety mutex
     static const size_t MAX_CONSOLE_LINES = 1000;  ///< Maximum console lines
@@ -161,6 +257,174 @@ private:
      */
     nil __cleanup_console_redirect();
 
+    /**
+     * @brief Maps a cursor position onto the drawing plane
+     * @param x Cursor x coordinate in window pixels
+     * @param y Cursor y coordinate in window pixels
+     * @param out World-space point on the Z = 0 plane
+     * @return bool False if the cursor cannot be mapped
+     * @private
+     */
+    bool __cursor_to_world(float x, float y, MentalEngine::Math::Vector2& out);
+
+    /**
+     * @brief Follows changes of the scene origin with the camera
+     * @private
+     */
+    nil __sync_world_origin();
+
+    /**
+     * @brief Renders one viewport panel
+     * @private
+     */
+    nil __viewport_panel(size_t index, const char* title, bool* open);
+
+    /**
+     * @brief Creates the camera of an extra view
+     * @private
+     */
+    std::shared_ptr<MentalEngine::Camera> __create_view_camera(const MentalEngine::Math::Quaternion& orientation);
+
+    /**
+     * @brief Converts a screen-space distance at the cursor to world units
+     * @param x Cursor x coordinate in window pixels
+     * @param y Cursor y coordinate in window pixels
+     * @param pixels Distance in pixels
+     * @return float Distance in world units, or 0 if the cursor cannot be mapped
+     * @private
+     */
+    float __pixels_to_world(float x, float y, float pixels);
+
+    /**
+     * @brief Maps a cursor position onto the drawing plane and applies snapping
+     * @param x Cursor x coordinate in window pixels
+     * @param y Cursor y coordinate in window pixels
+     * @param out Snapped world-space point
+     * @return bool False if the cursor cannot be mapped
+     * @private
+     */
+    bool __snapped_cursor(float x, float y, MentalEngine::Math::Vector2& out);
+
+    /**
+     * @brief Picks the primitive under the cursor
+     * @param x Cursor x coordinate in window pixels
+     * @param y Cursor y coordinate in window pixels
+     * @return MentalEngine::PrimitiveId Nearest primitive within the pixel tolerance
+     * @private
+     */
+    MentalEngine::PrimitiveId __pick_at_cursor(float x, float y);
+
+    /**
+     * @brief Describes a primitive for display
+     * @param id Primitive handle
+     * @return std::string Human-readable label
+     * @private
+     */
+    std::string __describe_primitive(MentalEngine::PrimitiveId id) const;
+
+    /**
+     * @brief Runs a command through the history and drops stale handles
+     * @param command Command to execute
+     * @private
+     */
+    nil __execute(std::unique_ptr<MentalEngine::SceneCommand> command);
+
+    /**
+     * @brief Moves the selected primitive by a world-space offset
+     * @param offset Translation in world units
+     * @private
+     */
+    nil __move_selected(const MentalEngine::Math::Vector2& offset);
+
+    /**
+     * @brief Forgets hovered/selected handles after the scene layout changed
+     * @private
+     */
+    nil __reset_selection();
+
+    /**
+     * @brief Renders the Open/Save path popups
+     * @private
+     */
+    nil __file_dialogs();
+
+    /**
+     * @brief Loads a drawing, replacing the scene
+     * @param path Source path
+     * @private
+     */
+    nil __open_drawing(const std::string& path);
+
+    /**
+     * @brief Saves the scene
+     * @param path Destination path
+     * @private
+     */
+    nil __save_drawing(const std::string& path);
+
+    /**
+     * @brief Starts a background DXF import into the scene
+     * @param path Source path
+     * @private
+     */
+    nil __import_dxf(const std::string& path);
+
+    /**
+     * @brief Exports the scene as SVG
+     * @param path Destination path
+     * @private
+     */
+    nil __export_svg(const std::string& path);
+
+    /**
+     * @brief Appends finished DXF batches to the scene
+     * @private
+     */
+    nil __poll_import();
+
+    /**
+     * @brief Replaces the scene once a background open has finished
+     * @private
+     */
+    nil __poll_open();
+
+    /**
+     * @brief Checks whether a background import or open owns the scene
+     * @return bool True while editing must stay disabled
+     * @private
+     */
+    bool __is_busy() const { return dxf_importer.IsRunning() || drawing_loader.IsRunning(); }
+
+    /**
+     * @brief Flushes journaled edits and reports autosave errors
+     * @private
+     */
+    nil __update_autosave();
+
+    /**
+     * @brief Replaces the scene with the drawing recovered from autosave
+     * @private
+     */
+    nil __recover_autosave();
+
+    /**
+     * @brief Shows per-thread utilization of the job system
+     * @private
+     */
+    nil __job_stats();
+
+    /**
+     * @brief Appends one console line, dropping the oldest when full
+     * @private
+     */
+    nil __push_console_line(const char* begin, const char* end);
+
+    /**
+     * @brief Shows heap allocations per frame and frame arena usage
+     * @private
+     */
+    nil __frame_memory_stats();
+
 public:
     /**
      * @brief Adds text to console output
@@ -168,6 +432,17 @@ public:
      */
     nil __add_console_output(const std::string& text);
     
+    /**
+     * @brief Adds redirected stream output to the console
+     * 
+     * Text is split at newlines; an unterminated tail is kept until the
+     * rest of its line arrives.
+     * 
+     * @param text Characters written to the stream
+     * @param count Number of characters
+     */
+    nil __add_console_stream(const char* text, size_t count);
+    
     /**
      * @brief Constructor - initializes the user interface
      * @param pWindow Pointer to the window
@@ -185,6 +460,15 @@ public:
      */
     nil EndFrame();
     
+    /**
+     * @brief Prepares ImGui for drawing on a separate render thread
+     * 
+     * Creates the OpenGL3 backend objects while the context is still current
+     * on the calling thread and turns off platform windows, which need the
+     * context on the main thread.
+     */
+    nil PrepareForRenderThread();
+    
     /**
      * @brief Creates the main docking space
      */
@@ -215,20 +499,32 @@ public:
      */
     nil Console(); 
     
+    /**
+     * @brief Renders the memory panel
+     */
+    nil MemoryPanel();
+    
     /**
      * @brief Checks if mouse is over the viewport area
      * @return true if mouse is over viewport, false otherwise
      */
     bool IsMouseOverViewport();
     
+    /**
+     * @brief Checks whether the UI needs frames without input
+     * @return bool True while a background import reports progress
+     */
+    bool NeedsContinuousRedraw() const { return __is_busy(); }
+    
     /**
      * @brief Handles mouse input for drawing tools
      * @param button Mouse button
      * @param action Button action (press/release)
      * @param x Mouse x coordinate
      * @param y Mouse y coordinate
+     * @return bool True if the press was consumed and should not reach the camera
      */
-    nil HandleDrawingInput(int button, int action, float x, float y);
+    bool HandleDrawingInput(int button, int action, float x, float y);
     
     /**
      * @brief Handles mouse movement for drawing tools
@@ -237,6 +533,34 @@ public:
      */
     nil HandleDrawingMouseMove(float x, float y);
     
+    /**
+     * @brief Ends a move of the selected primitive, if one is in progress
+     * 
+     * Called for a left release anywhere in the window and when the window
+     * loses focus, so a drag never outlives the button and its coalesced
+     * undo step is always closed.
+     */
+    nil EndDrag();
+    
+    /**
+     * @brief Handles editing shortcuts (undo, redo, delete)
+     * @param key GLFW key code
+     * @param action Key action
+     * @param mods Modifier bits
+     * @return bool True if the key was consumed
+     */
+    bool HandleKey(int key, int action, int mods);
+    
+    /**
+     * @brief Reverts the last scene edit
+     */
+    nil Undo();
+    
+    /**
+     * @brief Re-applies the last undone scene edit
+     */
+    nil Redo();
+    
     /**
      * @brief Destructor - cleans up resources
      */
@@ -301,6 +625,8 @@ nil UserInterface<T>::Toolbox() {
     switch (current_tool) {
         case ToolType::None:
             ImGui::Text("Select Tool");
+            ImGui::Text("Hover: %s", __describe_primitive(hovered_primitive).c_str());
+            ImGui::Text("Selected: %s", __describe_primitive(selected_primitive).c_str());
             break;
         case ToolType::Line:
             ImGui::Text("Line Tool");
@@ -318,12 +644,48 @@ nil UserInterface<T>::Toolbox() {
     
     ImGui::Separator();
     
+    // Snap settings
+    ImGui::Text("Snapping");
+    MentalEngine::SnapSettings& snap = snap_engine.GetSettings();
+    ImGui::Checkbox("Endpoint", &snap.endpoint);
+    ImGui::Checkbox("Midpoint", &snap.midpoint);
+    ImGui::Checkbox("Center", &snap.center);
+    ImGui::Checkbox("Intersection", &snap.intersection);
+    ImGui::Checkbox("Grid", &snap.grid);
+    ImGui::Text("Snap: %s", MentalEngine::SnapEngine::GetSnapTypeName(last_snap.type));
+    const MentalEngine::Math::Vector2d cursor = scene.ToWorld(last_snap.point);
+    ImGui::Text("World: %.3f, %.3f", cursor.x, cursor.y);
+    ImGui::Text("Query: %.3f ms%s%s", snap_engine.GetLastQueryTime(), snap_engine.WasLastQueryCapped() ? " (capped)" : "",
+                snap_engine.WasLastQueryOutOfTime() ? " (out of time)" : "");
+    
+    ImGui::Separator();
+    
+    // Прогресс импорта DXF
+    if (dxf_importer.IsRunning()) {
+        ImGui::Text("Importing DXF");
+        ImGui::ProgressBar(dxf_importer.GetProgress(), ImVec2(-1, 0));
+        if (ImGui::Button("Cancel Import", ImVec2(-1, 0))) {
+            dxf_importer.Cancel();
+        }
+        ImGui::Separator();
+    }
+    if (drawing_loader.IsRunning()) {
+        ImGui::Text("Opening %s", drawing_loader.GetPath().c_str());
+        if (ImGui::Button("Cancel Open", ImVec2(-1, 0))) {
+            drawing_loader.Cancel();
+        }
+        ImGui::Separator();
+    }
+    
     // Clear button
-    if (ImGui::Button("Clear All", ImVec2(80, 30))) {
-        line_points.clear();
+    if (ImGui::Button("Clear All", ImVec2(80, 30)) && scene.GetPrimitiveCount() > 0 && !__is_busy()) {
+        __execute(std::make_unique<MentalEngine::ClearSceneCommand>());
         is_drawing = false;
     }
     
+    ImGui::Text("History: %zu undo / %zu redo", history.GetUndoCount(), history.GetRedoCount());
+    ImGui::Text("History memory: %.1f KB", history.GetMemoryUsage() / 1024.0);
+    
     ImGui::End();
 }
 
@@ -387,7 +749,20 @@ nil UserInterface<T>::Console() {
                 __add_console_output("Доступные команды:");
                 __add_console_output("  clear - очистить консоль");
                 __add_console_output("  help - показать эту справку");
+                __add_console_output("  memory [file] - отчет о памяти (в консоль или в файл)");
                 __add_console_output("  quit - выйти из приложения");
+            } else if (command == "memory" || command.compare(0, 7, "memory ") == 0) {
+                std::string report = MentalEngine::MemoryTracker::FormatReport();
+                std::string path = command.size() > 7 ? command.substr(7) : std::string();
+                if (path.empty()) {
+                    __add_console_output(report);
+                } else if (std::FILE* file = std::fopen(path.c_str(), "w")) {
+                    bool written = std::fwrite(report.data(), 1, report.size(), file) == report.size();
+                    written = std::fclose(file) == 0 && written;
+                    __add_console_output(written ? "Отчет о памяти записан в " + path : "Ошибка записи " + path);
+                } else {
+                    __add_console_output("Не удалось открыть " + path);
+                }
             } else if (command == "quit") {
                 __add_console_output("Выход из приложения...");
                 // Здесь можно добавить логику выхода
@@ -410,56 +785,225 @@ nil UserInterface<T>::Console() {
 }
 
 /**
- * @brief Renders the viewport panel
+ * @brief Renders the memory panel
  * @tparam T Window type
  * 
- * Creates a viewport panel that displays the rendered content from the
- * renderer. Integrates with the Renderer class to show the current
- * viewport texture in the ImGui interface.
+ * Shows heap usage per subsystem tag and GPU memory created by the
+ * renderer. The same numbers are available as text through the console
+ * command "memory".
  */
 template <typename T>
-nil UserInterface<T>::Viewport() {
-    ImGui::Begin("Viewport");
+nil UserInterface<T>::MemoryPanel() {
+    ImGui::Begin("Memory", &show_memory_window);
     
-    // Устанавливаем флаг, если мышь находится над viewport
-    mouse_over_viewport = ImGui::IsWindowHovered();
+    if (!MentalEngine::MemoryTracker::IsEnabled()) {
+        ImGui::TextWrapped("Per-subsystem tracking is disabled; rebuild with -Dmemory_tracking=true.");
+    } else if (ImGui::BeginTable("MemoryTags", 5, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg)) {
+        ImGui::TableSetupColumn("Subsystem");
+        ImGui::TableSetupColumn("Live KB");
+        ImGui::TableSetupColumn("Peak KB");
+        ImGui::TableSetupColumn("Allocs/frame");
+        ImGui::TableSetupColumn("Allocs total");
+        ImGui::TableHeadersRow();
+        
+        const size_t tag_count = static_cast<size_t>(MentalEngine::MemoryTag::Count);
+        for (size_t i = 0; i <= tag_count; i++) {
+            const bool total = i == tag_count;
+            const MentalEngine::MemoryTag tag = static_cast<MentalEngine::MemoryTag>(i);
+            MentalEngine::MemoryTagStats stats = total ? MentalEngine::MemoryTracker::GetTotalStats()
+                                                       : MentalEngine::MemoryTracker::GetTagStats(tag);
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(total ? "Total" : MentalEngine::MemoryTracker::GetTagName(tag));
+            ImGui::TableNextColumn();
+            ImGui::Text("%.1f", stats.live_bytes / 1024.0);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.1f", stats.peak_bytes / 1024.0);
+            ImGui::TableNextColumn();
+            ImGui::Text("%llu", static_cast<unsigned long long>(total ? frame_allocations : tag_frame_allocations[i]));
+            ImGui::TableNextColumn();
+            ImGui::Text("%llu", static_cast<unsigned long long>(stats.allocations));
+        }
+        ImGui::EndTable();
+    }
     
+    ImGui::Separator();
+    MentalEngine::GpuMemoryStats gpu = MentalEngine::MemoryTracker::GetGpuStats();
+    ImGui::Text("GPU textures: %.1f KB", gpu.texture_bytes / 1024.0);
+    ImGui::Text("GPU renderbuffers: %.1f KB", gpu.renderbuffer_bytes / 1024.0);
+    ImGui::Text("GPU buffers: %.1f KB", gpu.buffer_bytes / 1024.0);
+    ImGui::Text("Uploads/frame: %.1f KB", gpu_frame_uploads / 1024.0);
     if (pRenderer) {
-        // Получаем размер доступной области
-        ImVec2 viewport_panel_size = ImGui::GetContentRegionAvail();
-        int width = static_cast<int>(viewport_panel_size.x);
-        int height = static_cast<int>(viewport_panel_size.y);
-        
-        // Рендерим viewport через Renderer
-        pRenderer->RenderViewport(width, height);
-        
-        // Рендерим нарисованные линии
-        if (!line_points.empty() && line_points.size() % 2 == 0) {
-            pRenderer->RenderLines(line_points, MentalEngine::Math::Vector3(1.0f, 0.0f, 0.0f), 2.0f);
+        size_t recorded = 0;
+        const size_t redrawn = pRenderer->GetRedrawnViewportCount(recorded);
+        ImGui::Text("Viewports redrawn: %zu / %zu", redrawn, recorded);
+        const ShaderCacheStats shaders = pRenderer->GetShaderCacheStats();
+        ImGui::Text("Shaders: %zu programs, %llu from disk, %llu compiled, %llu failed%s", shaders.programs,
+                    static_cast<unsigned long long>(shaders.binary_hits), static_cast<unsigned long long>(shaders.compiled),
+                    static_cast<unsigned long long>(shaders.failed), shaders.parallel ? " (parallel)" : "");
+        const GLStateStats gl_calls = pRenderer->GetGLStateStats();
+        ImGui::Text("GL state calls/frame: %u issued, %u elided; %u draws", gl_calls.issued, gl_calls.elided, gl_calls.draws);
+        size_t impostors = 0;
+        const int level = pRenderer->GetSceneLevel(impostors);
+        ImGui::Text("Scene LOD: level %d, %zu impostor blocks", level, impostors);
+        size_t tiles_rendered = 0;
+        const size_t tiles = pRenderer->GetTileStats(tiles_rendered);
+        ImGui::Text("Plan tiles: %zu cached, %zu rendered", tiles, tiles_rendered);
+    }
+    
+    ImGui::End();
+}
+
+/**
+ * @brief Renders the viewport panels
+ * @tparam T Window type
+ * 
+ * Draws the main viewport and every extra view the user opened from
+ * View > Viewports. Extra views get a renderer viewport of their own when
+ * opened and give it back when closed.
+ */
+template <typename T>
+nil UserInterface<T>::Viewport() {
+    mouse_over_viewport = false;
+    if (!pRenderer) {
+        ImGui::Begin("Viewport");
+        ImGui::Text("Renderer не инициализирован");
+        ImGui::End();
+        return;
+    }
+    
+    __sync_world_origin();
+    __viewport_panel(0, "Viewport", nullptr);
+    for (ExtraView& view : extra_views) {
+        if (view.open && view.viewport == Renderer::INVALID_VIEWPORT) {
+            view.viewport = pRenderer->CreateViewport(__create_view_camera(view.orientation));
+            if (view.viewport == Renderer::INVALID_VIEWPORT) view.open = false;
         }
-        
-        // Рендерим текущую линию, если рисуем
-        if (is_drawing && current_tool == ToolType::Line) {
-            std::vector<MentalEngine::Math::Vector2> current_line = {line_start, line_end};
-            pRenderer->RenderLines(current_line, MentalEngine::Math::Vector3(0.0f, 1.0f, 0.0f), 2.0f);
+        if (view.open) __viewport_panel(view.viewport, view.title, &view.open);
+        if (!view.open && view.viewport != Renderer::INVALID_VIEWPORT) {
+            pRenderer->ReleaseViewport(view.viewport);
+            viewport_mappings[view.viewport].valid = false;
+            view.viewport = Renderer::INVALID_VIEWPORT;
         }
+    }
+}
+
+/**
+ * @brief Renders one viewport panel
+ * @tparam T Window type
+ * @param index Renderer viewport shown in the panel
+ * @param title Panel title
+ * @param open Close flag for ImGui::Begin(), nullptr for a panel that cannot be closed
+ * @private
+ * 
+ * Records the viewport's pass with the scene and the tool overlays, shows
+ * its texture, and caches the mapping from window pixels to the scene for
+ * input handling. Hovering a panel makes its camera the one receiving
+ * input, unless the current camera is in the middle of a drag.
+ */
+template <typename T>
+nil UserInterface<T>::__viewport_panel(size_t index, const char* title, bool* open) {
+    ImGui::Begin(title, open);
+    ViewportMapping& mapping = viewport_mappings[index];
+    
+    // Устанавливаем флаг, если мышь находится над viewport
+    if (ImGui::IsWindowHovered()) {
+        mouse_over_viewport = true;
+        auto active = pRenderer->GetCamera();
+        if (!active || !active->IsCapturingInput()) pRenderer->SetActiveViewport(index);
+    }
+    
+    // Получаем размер доступной области
+    ImVec2 viewport_panel_size = ImGui::GetContentRegionAvail();
+    int width = static_cast<int>(viewport_panel_size.x);
+    int height = static_cast<int>(viewport_panel_size.y);
+    
+    // Рендерим viewport через Renderer; координаты сцены заданы относительно ее origin
+    const MentalEngine::Math::Vector2d& origin = scene.GetOrigin();
+    const MentalEngine::Math::Vector3d frame_origin(origin.x, origin.y, 0.0);
+    pRenderer->SetSceneOrigin(frame_origin);
+    pRenderer->RenderViewport(index, width, height);
+    
+    // Рендерим геометрию сцены; тесселяция общая для всех viewport кадра
+    pRenderer->RenderScene(scene, MentalEngine::Math::Vector3(1.0f, 0.0f, 0.0f), 2.0f);
+    
+    // Подсветка выбранного и наведенного примитива
+    pRenderer->RenderPrimitive(scene, selected_primitive, MentalEngine::Math::Vector3(0.0f, 0.8f, 1.0f), 3.0f);
+    if (hovered_primitive != selected_primitive) {
+        pRenderer->RenderPrimitive(scene, hovered_primitive, MentalEngine::Math::Vector3(1.0f, 1.0f, 0.0f), 3.0f);
+    }
+    
+    // Рендерим текущую линию, если рисуем
+    if (is_drawing && current_tool == ToolType::Line) {
+        const MentalEngine::Math::Vector2 current_line[] = {line_start, line_end};
+        pRenderer->RenderLines(current_line, 2, MentalEngine::Math::Vector3(0.0f, 1.0f, 0.0f), 2.0f, RenderLayer::Tool);
+    }
+    
+    // Маркер точки привязки
+    if (current_tool != ToolType::None && last_snap.type != MentalEngine::SnapType::None) {
+        const MentalEngine::Math::Vector2& p = last_snap.point;
+        const float h = snap_marker_size;
+        const MentalEngine::Math::Vector2 marker[] = {
+            {p.x - h, p.y - h}, {p.x + h, p.y - h},
+            {p.x + h, p.y - h}, {p.x + h, p.y + h},
+            {p.x + h, p.y + h}, {p.x - h, p.y + h},
+            {p.x - h, p.y + h}, {p.x - h, p.y - h}
+        };
+        pRenderer->RenderLines(marker, 8, MentalEngine::Math::Vector3(1.0f, 0.6f, 0.0f), 1.0f, RenderLayer::Overlay);
+    }
+    
+    // Отображаем texture в ImGui
+    GLuint texture = pRenderer->GetViewportTexture(index);
+    auto camera = pRenderer->GetViewportCamera(index);
+    if (texture != 0) {
+        // Viewport занимает левый нижний угол texture размером с bucket
+        float u = 1.0f, v = 1.0f;
+        pRenderer->GetViewportUV(index, u, v);
+        ImGui::Image((void*)(intptr_t)texture, 
+                     ImVec2(width, height), 
+                     ImVec2(0, v), ImVec2(u, 0));
         
-        // Отображаем texture в ImGui
-        GLuint texture = pRenderer->GetViewportTexture();
-        if (texture != 0) {
-            ImGui::Image((void*)(intptr_t)texture, 
-                         ImVec2(width, height), 
-                         ImVec2(0, 1), ImVec2(1, 0));
-        } else {
-            ImGui::Text("Viewport texture не создан");
+        // Кэшируем прямоугольник viewport и обратную матрицу камеры на кадр.
+        // ImGui работает в экранных координатах, GLFW - в координатах окна
+        ImVec2 image_min = ImGui::GetItemRectMin();
+        ImVec2 window_origin = ImGui::GetMainViewport()->Pos;
+        mapping.x = image_min.x - window_origin.x;
+        mapping.y = image_min.y - window_origin.y;
+        mapping.width = static_cast<float>(width);
+        mapping.height = static_cast<float>(height);
+        mapping.valid = width > 0 && height > 0 && camera;
+        if (mapping.valid) {
+            mapping.inverse_view_projection =
+                MentalEngine::Math::inverse(camera->GetViewProjectionMatrix(frame_origin));
         }
     } else {
-        ImGui::Text("Renderer не инициализирован");
+        mapping.valid = false;
+        ImGui::Text("Viewport texture не создан");
     }
     
     ImGui::End();
 }
 
+/**
+ * @brief Creates the camera of an extra view
+ * @tparam T Window type
+ * @param orientation Fixed view direction
+ * @return std::shared_ptr<MentalEngine::Camera> Orthographic camera looking at the main camera's target
+ * @private
+ */
+template <typename T>
+std::shared_ptr<MentalEngine::Camera> UserInterface<T>::__create_view_camera(const MentalEngine::Math::Quaternion& orientation) {
+    auto camera = std::make_shared<MentalEngine::Camera>();
+    camera->SetProjection(MentalEngine::CameraProjection::Orthographic);
+    if (auto main = pRenderer->GetViewportCamera(0)) {
+        camera->SetOrigin(main->GetOrigin());
+        camera->SetHome(main->GetHome());
+        camera->SetTarget(main->GetTarget());
+    }
+    camera->SetOrientation(orientation);
+    return camera;
+}
+
 /**
  * @brief Renders the main UI frame
  * @tparam T Window type
@@ -470,12 +1014,32 @@ nil UserInterface<T>::Viewport() {
  */
 template <typename T>
 nil UserInterface<T>::DrawFrame() {
+    MentalEngine::MemoryTagScope tag(MentalEngine::MemoryTag::UI);
+    
+    const uint64_t allocation_count = MentalEngine::MemoryTracker::GetAllocationCount();
+    frame_allocations = allocation_count - frame_allocation_mark;
+    frame_allocation_mark = allocation_count;
+    for (size_t i = 0; i < static_cast<size_t>(MentalEngine::MemoryTag::Count); i++) {
+        uint64_t count = MentalEngine::MemoryTracker::GetTagStats(static_cast<MentalEngine::MemoryTag>(i)).allocations;
+        tag_frame_allocations[i] = count - tag_allocation_mark[i];
+        tag_allocation_mark[i] = count;
+    }
+    const uint64_t uploaded = MentalEngine::MemoryTracker::GetGpuStats().uploaded_bytes;
+    gpu_frame_uploads = uploaded - gpu_upload_mark;
+    gpu_upload_mark = uploaded;
+    
+    this->__poll_import();
+    this->__poll_open();
+    this->__update_autosave();
     this->NewFrame();
     this->Dockspace();
     this->MainMenu();
     this->Viewport();
     this->Toolbox();
     this->Console();
+    if (show_memory_window) {
+        this->MemoryPanel();
+    }
     // Демонстрационное окно
     if (show_demo_window) {
         ImGui::ShowDemoWindow(&show_demo_window);
@@ -487,6 +1051,10 @@ nil UserInterface<T>::DrawFrame() {
     ImGui::Text("FPS: %.1f", this->pIO->Framerate);
     ImGui::Text("Frame time: %.3f ms", 1000.0f / this->pIO->Framerate);
     ImGui::Separator();
+    __frame_memory_stats();
+    ImGui::Separator();
+    __job_stats();
+    ImGui::Separator();
     if (ImGui::Button("Toggle Demo")) {
         this->show_demo_window = !this->show_demo_window;
     }
@@ -545,6 +1113,67 @@ nil UserInterface<T>::DrawFrame() {
     this->EndFrame();
 }
 
+/**
+ * @brief Shows per-thread utilization of the job system
+ * @tparam T Window type
+ * @private
+ * 
+ * Counters are sampled twice a second; utilization is busy time divided by
+ * wall time over the last interval. The "main" row covers jobs run by
+ * threads outside the pool while they wait.
+ */
+template <typename T>
+nil UserInterface<T>::__job_stats() {
+    MentalEngine::JobSystem& jobs = MentalEngine::JobSystem::Instance();
+    auto now = std::chrono::steady_clock::now();
+    double interval = std::chrono::duration<double>(now - job_sample_time).count();
+    if (job_stats_sample.empty() || interval >= 0.5) {
+        std::vector<MentalEngine::JobWorkerStats>& stats = job_stats_scratch;
+        jobs.GetStats(stats);
+        job_utilization.assign(stats.size(), 0.0f);
+        if (job_stats_sample.size() == stats.size()) {
+            for (size_t i = 0; i < stats.size(); i++) {
+                double busy = (stats[i].busy_ns - job_stats_sample[i].busy_ns) * 1e-9;
+                job_utilization[i] = static_cast<float>(std::min(1.0, busy / interval));
+            }
+        }
+        job_stats_sample.swap(stats);
+        job_sample_time = now;
+    }
+    
+    ImGui::Text("Jobs: %zu workers", jobs.GetWorkerCount());
+    for (size_t i = 0; i < job_stats_sample.size(); i++) {
+        char label[64];
+        bool external = i + 1 == job_stats_sample.size();
+        std::snprintf(label, sizeof(label), "%s %llu jobs, %llu stolen", external ? "main" : "worker",
+                      static_cast<unsigned long long>(job_stats_sample[i].jobs_executed),
+                      static_cast<unsigned long long>(job_stats_sample[i].jobs_stolen));
+        ImGui::ProgressBar(job_utilization[i], ImVec2(-1, 0), label);
+    }
+}
+
+/**
+ * @brief Shows heap allocations per frame and frame arena usage
+ * @tparam T Window type
+ * @private
+ * 
+ * A steady-state frame should report zero allocations; anything else
+ * points at per-frame temporaries that belong in a frame arena.
+ */
+template <typename T>
+nil UserInterface<T>::__frame_memory_stats() {
+    if (MentalEngine::MemoryTracker::IsEnabled()) {
+        ImGui::Text("Heap allocations/frame: %llu", static_cast<unsigned long long>(frame_allocations));
+    } else {
+        ImGui::TextDisabled("Heap allocations/frame: not counted (memory_tracking off)");
+    }
+    if (pRenderer) {
+        MentalEngine::FrameArenaStats arena = pRenderer->GetPacketArenaStats();
+        ImGui::Text("Frame arena: %.1f / %.1f KB (peak %.1f KB)",
+                    arena.used / 1024.0, arena.capacity / 1024.0, arena.peak / 1024.0);
+    }
+}
+
 /**
  * @brief Starts a new ImGui frame
  * @tparam T Window type
@@ -571,10 +1200,19 @@ nil UserInterface<T>::MainMenu() {
     if (ImGui::BeginMainMenuBar()) {
         if (ImGui::BeginMenu("File")) {
             if (ImGui::MenuItem("Open")) {
-                // Логика открытия файла
+                open_dialog_requested = true;
             }
             if (ImGui::MenuItem("Save")) {
-                // Логика сохранения
+                save_dialog_requested = true;
+            }
+            if (ImGui::MenuItem("Import DXF", nullptr, false, !__is_busy())) {
+                import_dialog_requested = true;
+            }
+            if (ImGui::MenuItem("Export SVG")) {
+                export_dialog_requested = true;
+            }
+            if (ImGui::MenuItem("Recover Autosave", nullptr, false, recovery_available)) {
+                __recover_autosave();
             }
             ImGui::Separator();
             if (ImGui::MenuItem("Exit")) {
@@ -583,15 +1221,302 @@ nil UserInterface<T>::MainMenu() {
             ImGui::EndMenu();
         }
 
+        if (ImGui::BeginMenu("Edit")) {
+            std::string undo_label = std::string("Undo ") + (history.CanUndo() ? history.GetUndoName() : "");
+            std::string redo_label = std::string("Redo ") + (history.CanRedo() ? history.GetRedoName() : "");
+            if (ImGui::MenuItem(undo_label.c_str(), "Ctrl+Z", false, history.CanUndo())) {
+                Undo();
+            }
+            if (ImGui::MenuItem(redo_label.c_str(), "Ctrl+Y", false, history.CanRedo())) {
+                Redo();
+            }
+            ImGui::Separator();
+            if (ImGui::MenuItem("Delete", "Del", false, scene.Contains(selected_primitive))) {
+                __execute(std::make_unique<MentalEngine::RemoveGeometryCommand>(
+                    std::vector<MentalEngine::PrimitiveId>{selected_primitive}));
+            }
+            ImGui::EndMenu();
+        }
+
         if (ImGui::BeginMenu("View")) {
             if (ImGui::MenuItem("Demo window", nullptr, &show_demo_window)) {
                 // Переключение демо окна
             }
+            ImGui::MenuItem("Memory", nullptr, &show_memory_window);
+            if (ImGui::BeginMenu("Viewports")) {
+                for (ExtraView& view : extra_views) {
+                    ImGui::MenuItem(view.title, nullptr, &view.open);
+                }
+                ImGui::EndMenu();
+            }
+            // Качество: Fast для программных растеризаторов, High добавляет MSAA
+            if (pRenderer && ImGui::BeginMenu("Quality")) {
+                for (RenderQuality tier : {RenderQuality::Fast, RenderQuality::Balanced, RenderQuality::High}) {
+                    if (ImGui::MenuItem(Renderer::GetQualityName(tier), nullptr, pRenderer->GetQuality() == tier)) {
+                        pRenderer->SetQuality(tier);
+                    }
+                }
+                ImGui::Separator();
+                // Упрощенная геометрия для крупных чертежей при отдалении
+                bool level_of_detail = pRenderer->GetLevelOfDetail();
+                if (ImGui::MenuItem("Level of detail", nullptr, &level_of_detail)) {
+                    pRenderer->SetLevelOfDetail(level_of_detail);
+                }
+                // Виды сверху собираются из закэшированных тайлов
+                bool tiled_plans = pRenderer->GetTiledPlanViews();
+                if (ImGui::MenuItem("Tiled plan views", nullptr, &tiled_plans)) {
+                    pRenderer->SetTiledPlanViews(tiled_plans);
+                }
+                ImGui::EndMenu();
+            }
+            ImGui::Separator();
+            // Режим вращения камеры
+            if (pRenderer && pRenderer->GetCamera() && ImGui::BeginMenu("Navigation")) {
+                auto camera = pRenderer->GetCamera();
+                const struct { const char* name; MentalEngine::CameraRotationMode mode; } modes[] = {
+                    {"Orbit", MentalEngine::CameraRotationMode::Orbit},
+                    {"Turntable", MentalEngine::CameraRotationMode::Turntable},
+                    {"Trackball", MentalEngine::CameraRotationMode::Trackball},
+                    {"Free Fly (WASD)", MentalEngine::CameraRotationMode::FreeFly},
+                };
+                for (const auto& entry : modes) {
+                    if (ImGui::MenuItem(entry.name, nullptr, camera->GetRotationMode() == entry.mode)) {
+                        camera->SetRotationMode(entry.mode);
+                    }
+                }
+                ImGui::Separator();
+                if (ImGui::MenuItem("Reset View", "R")) {
+                    camera->AnimateTo(MentalEngine::CameraState(), MentalEngine::Camera::DEFAULT_TRANSITION_SECONDS);
+                }
+                ImGui::EndMenu();
+            }
             ImGui::EndMenu();
         }
 
         ImGui::EndMainMenuBar();
     }
+    
+    __file_dialogs();
+}
+
+/**
+ * @brief Renders the Open/Save path popups
+ * @tparam T Window type
+ * @private
+ * 
+ * Popups are opened outside the menu so they share the root ID stack.
+ */
+template <typename T>
+nil UserInterface<T>::__file_dialogs() {
+    struct FileDialog {
+        const char* title;
+        const char* action;
+        bool* requested;
+        char* path;
+        size_t path_size;
+    };
+    FileDialog dialogs[] = {
+        {"Open Drawing", "Open", &open_dialog_requested, drawing_path, sizeof(drawing_path)},
+        {"Save Drawing", "Save", &save_dialog_requested, drawing_path, sizeof(drawing_path)},
+        {"Import DXF", "Import", &import_dialog_requested, import_path, sizeof(import_path)},
+        {"Export SVG", "Export", &export_dialog_requested, export_path, sizeof(export_path)},
+    };
+    
+    for (int i = 0; i < 4; i++) {
+        FileDialog& dialog = dialogs[i];
+        if (*dialog.requested) {
+            ImGui::OpenPopup(dialog.title);
+            *dialog.requested = false;
+        }
+        if (!ImGui::BeginPopupModal(dialog.title, nullptr, ImGuiWindowFlags_AlwaysAutoResize)) continue;
+        
+        ImGui::InputText("Path", dialog.path, dialog.path_size);
+        if (ImGui::Button(dialog.action, ImVec2(80, 0))) {
+            switch (i) {
+                case 0: __open_drawing(dialog.path); break;
+                case 1: __save_drawing(dialog.path); break;
+                case 2: __import_dxf(dialog.path); break;
+                default: __export_svg(dialog.path); break;
+            }
+            ImGui::CloseCurrentPopup();
+        }
+        ImGui::SameLine();
+        if (ImGui::Button("Cancel", ImVec2(80, 0))) {
+            ImGui::CloseCurrentPopup();
+        }
+        ImGui::EndPopup();
+    }
+}
+
+/**
+ * @brief Starts loading a drawing that will replace the scene
+ * @tparam T Window type
+ * @param path Source path
+ * @private
+ * 
+ * The file is verified and read on a worker; __poll_open() swaps it in.
+ * Editing stays disabled meanwhile, since the edits would be lost.
+ */
+template <typename T>
+nil UserInterface<T>::__open_drawing(const std::string& path) {
+    dxf_importer.Cancel();
+    EndDrag();
+    is_drawing = false;
+    open_start = std::chrono::steady_clock::now();
+    drawing_loader.Start(path);
+}
+
+/**
+ * @brief Replaces the scene once a background open has finished
+ * @tparam T Window type
+ * @private
+ * 
+ * Loading replaces every primitive handle, so the undo history is dropped.
+ */
+template <typename T>
+nil UserInterface<T>::__poll_open() {
+    MentalEngine::MemoryTagScope tag(MentalEngine::MemoryTag::Scene);
+    const std::string path = drawing_loader.GetPath();
+    std::string error;
+    if (!drawing_loader.Poll(scene, error)) return;
+    if (!error.empty()) {
+        std::cerr << "Ошибка открытия " << path << ": " << error << std::endl;
+        return;
+    }
+    history.Clear();
+    // Писатель автосохранения перечитает файл сам, без копии сцены в этом кадре
+    autosave.RequestCompactionFromFile(path);
+    __reset_selection();
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - open_start).count();
+    std::cout << "Открыт " << path << ": " << scene.GetPrimitiveCount() << " примитивов за " << ms << " мс" << std::endl;
+}
+
+/**
+ * @brief Saves the scene
+ * @tparam T Window type
+ * @param path Destination path
+ * @private
+ */
+template <typename T>
+nil UserInterface<T>::__save_drawing(const std::string& path) {
+    std::string error;
+    if (!MentalEngine::DrawingFile::Save(scene, path, error)) {
+        std::cerr << "Ошибка сохранения " << path << ": " << error << std::endl;
+        return;
+    }
+    std::cout << "Сохранен " << path << ": " << scene.GetPrimitiveCount() << " примитивов" << std::endl;
+}
+
+/**
+ * @brief Exports the scene as SVG
+ * @tparam T Window type
+ * @param path Destination path
+ * @private
+ */
+template <typename T>
+nil UserInterface<T>::__export_svg(const std::string& path) {
+    auto start = std::chrono::steady_clock::now();
+    std::string error;
+    if (!MentalEngine::SvgExporter::Export(scene, path, error)) {
+        std::cerr << "Ошибка экспорта " << path << ": " << error << std::endl;
+        return;
+    }
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Экспортирован " << path << ": " << scene.GetPrimitiveCount() << " примитивов за " << ms << " мс" << std::endl;
+}
+
+/**
+ * @brief Starts a background DXF import into the scene
+ * @tparam T Window type
+ * @param path Source path
+ * @private
+ * 
+ * Imported geometry is appended to the current drawing. Undo steps recorded
+ * before the import would pop the wrong primitives, so history is dropped,
+ * and editing stays disabled until the import finishes.
+ */
+template <typename T>
+nil UserInterface<T>::__import_dxf(const std::string& path) {
+    std::string error;
+    if (!dxf_importer.Start(path, error)) {
+        std::cerr << "Ошибка импорта " << path << ": " << error << std::endl;
+        return;
+    }
+    history.Clear();
+    autosave.RequestCompaction();
+    __reset_selection();
+    is_drawing = false;
+    is_dragging = false;
+    std::cout << "Импорт " << path << "..." << std::endl;
+}
+
+/**
+ * @brief Appends finished DXF batches to the scene
+ * @tparam T Window type
+ * @private
+ * 
+ * Called once per frame, so geometry shows up in the viewport while the
+ * rest of the file is still being parsed.
+ */
+template <typename T>
+nil UserInterface<T>::__poll_import() {
+    if (!dxf_importer.IsRunning()) return;
+    {
+        MentalEngine::MemoryTagScope tag(MentalEngine::MemoryTag::Scene);
+        dxf_importer.Poll(scene);
+    }
+    if (dxf_importer.IsRunning()) return;
+    
+    if (!dxf_importer.GetError().empty()) {
+        std::cerr << "Ошибка импорта: " << dxf_importer.GetError() << std::endl;
+    }
+    const MentalEngine::DxfImportStats& stats = dxf_importer.GetStats();
+    std::cout << "Импорт завершен: " << stats.lines << " LINE, " << stats.polylines << " LWPOLYLINE, "
+              << stats.circles << " CIRCLE, " << stats.arcs << " ARC, пропущено " << stats.skipped << std::endl;
+}
+
+/**
+ * @brief Flushes journaled edits and reports autosave errors
+ * @tparam T Window type
+ * @private
+ * 
+ * Skipped while a DXF import is appending batches or a drawing is being
+ * opened; both request a compaction, which snapshots the finished drawing
+ * once they complete.
+ */
+template <typename T>
+nil UserInterface<T>::__update_autosave() {
+    if (__is_busy()) return;
+    autosave.Update(scene);
+    std::string error = autosave.TakeError();
+    if (!error.empty()) {
+        std::cerr << "Ошибка автосохранения: " << error << std::endl;
+    }
+}
+
+/**
+ * @brief Replaces the scene with the drawing recovered from autosave
+ * @tparam T Window type
+ * @private
+ */
+template <typename T>
+nil UserInterface<T>::__recover_autosave() {
+    MentalEngine::MemoryTagScope tag(MentalEngine::MemoryTag::Scene);
+    dxf_importer.Cancel();
+    drawing_loader.Cancel();
+    std::string error;
+    size_t records = 0;
+    if (!MentalEngine::Autosave::Recover(MentalEngine::Autosave::RecoveryPrefix(autosave_prefix), scene, error, &records)) {
+        std::cerr << "Ошибка восстановления: " << error << std::endl;
+        return;
+    }
+    history.Clear();
+    autosave.RequestCompaction();
+    __reset_selection();
+    is_drawing = false;
+    is_dragging = false;
+    std::cout << "Восстановлено автосохранение: " << scene.GetPrimitiveCount() << " примитивов, "
+              << records << " записей журнала" << std::endl;
 }
 
 /**
@@ -640,13 +1565,16 @@ nil UserInterface<T>::Dockspace() {
  * @brief Ends the current ImGui frame
  * @tparam T Window type
  * 
- * Finalizes the current ImGui frame by rendering all ImGui draw data
- * and handling multi-viewport updates if enabled.
+ * Finalizes the current ImGui frame and copies the draw data into the
+ * renderer's recording packet, which draws it when the packet is executed.
+ * Handles multi-viewport updates if enabled.
  */
 template <typename T>
 nil UserInterface<T>::EndFrame() {
     ImGui::Render();
-    ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+    if (pRenderer && pRenderer->GetRecordingPacket()) {
+        pRenderer->GetRecordingPacket()->CaptureDrawData(ImGui::GetDrawData());
+    }
 
     // Обновление viewports (для поддержки множественных окон)
     if (pIO->ConfigFlags & ImGuiConfigFlags_ViewportsEnable) {
@@ -657,6 +1585,21 @@ nil UserInterface<T>::EndFrame() {
     }
 }
 
+/**
+ * @brief Prepares ImGui for drawing on a separate render thread
+ * @tparam T Window type
+ * 
+ * ImGui_ImplOpenGL3_NewFrame() only touches GL the first time, to create
+ * its shaders and font texture, so calling it once here keeps every later
+ * NewFrame() on the main thread free of GL calls.
+ */
+template <typename T>
+nil UserInterface<T>::PrepareForRenderThread() {
+    ImGui_ImplOpenGL3_NewFrame();
+    // Платформенные окна рисуются в своих контекстах на главном потоке
+    pIO->ConfigFlags &= ~ImGuiConfigFlags_ViewportsEnable;
+}
+
 /**
  * @brief Constructor - initializes the user interface
  * @tparam T Window type
@@ -670,6 +1613,10 @@ nil UserInterface<T>::EndFrame() {
 template <typename T>
 UserInterface<T>::UserInterface(T* pWindow, class Renderer* pRenderer) {
     IMGUI_CHECKVERSION();
+    // Все выделения ImGui учитываются как UI, в каком бы потоке ни освобождались
+    ImGui::SetAllocatorFunctions(
+        [](size_t size, void*) { return MentalEngine::MemoryTracker::Allocate(size, MentalEngine::MemoryTag::UI); },
+        [](void* memory, void*) { MentalEngine::MemoryTracker::Free(memory); });
     pCTX = ImGui::CreateContext();
     pIO = &ImGui::GetIO();
     (void)pIO;
@@ -709,9 +1656,18 @@ UserInterface<T>::UserInterface(T* pWindow, class Renderer* pRenderer) {
     this->pWindow = pWindow;
     this->pRenderer = pRenderer;
     
-    // Добавляем тестовую линию для проверки рендеринга
-    line_points.push_back(MentalEngine::Math::Vector2(-0.5f, -0.5f));
-    line_points.push_back(MentalEngine::Math::Vector2(0.5f, 0.5f));
+    // Добавляем тестовую линию для проверки рендеринга (вне истории - не отменяется)
+    scene.AddLine(MentalEngine::Math::Vector2(-0.5f, -0.5f), MentalEngine::Math::Vector2(0.5f, 0.5f));
+    
+    // Автосохранение: каждая правка из истории пишется в журнал
+    history.SetListener([this](const MentalEngine::SceneCommand& command, bool forward) {
+        autosave.Record(command, forward);
+    });
+    autosave.Start(autosave_prefix);
+    recovery_available = MentalEngine::Autosave::HasRecovery(autosave_prefix);
+    if (recovery_available) {
+        std::cout << "Найдено автосохранение после аварийного завершения: File > Recover Autosave" << std::endl;
+    }
     
     return;
 }
@@ -725,6 +1681,9 @@ UserInterface<T>::UserInterface(T* pWindow, class Renderer* pRenderer) {
  */
 template <typename T>
 UserInterface<T>::~UserInterface() {
+    // Штатный выход: файлы автосохранения больше не нужны
+    autosave.Stop(true);
+    
     // Очищаем перенаправление консоли
     __cleanup_console_redirect();
     
@@ -847,35 +1806,89 @@ nil UserInterface<T>::__cleanup_console_redirect() {
  */
 template <typename T>
 nil UserInterface<T>::__add_console_output(const std::string& text) {
+    MentalEngine::MemoryTagScope tag(MentalEngine::MemoryTag::Console);
     std::lock_guard<std::mutex> lock(console_mutex);
     
     // Разбиваем текст на строки
-    std::istringstream iss(text);
-    std::string line;
-    while (std::getline(iss, line)) {
-        console_output.push_back(line);
-        
-        // Ограничиваем количество строк
-        if (console_output.size() > MAX_CONSOLE_LINES) {
-            console_output.erase(console_output.begin());
+    const char* begin = text.data();
+    const char* end = begin + text.size();
+    while (begin < end) {
+        const char* newline = std::find(begin, end, '\n');
+        __push_console_line(begin, newline);
+        begin = newline + 1;
+    }
+    
+    console_scroll_to_bottom = true;
+}
+
+/**
+ * @brief Adds redirected stream output to the console
+ * @tparam T Window type
+ * @param text Characters written to the stream
+ * @param count Number of characters
+ * 
+ * Streams deliver text in arbitrary pieces (std::endl arrives as a single
+ * character), so lines are assembled in console_partial and only complete
+ * lines are added.
+ */
+template <typename T>
+nil UserInterface<T>::__add_console_stream(const char* text, size_t count) {
+    MentalEngine::MemoryTagScope tag(MentalEngine::MemoryTag::Console);
+    std::lock_guard<std::mutex> lock(console_mutex);
+    
+    const char* end = text + count;
+    while (text < end) {
+        const char* newline = std::find(text, end, '\n');
+        if (newline == end) {
+            console_partial.append(text, end);
+            break;
         }
+        console_partial.append(text, newline);
+        __push_console_line(console_partial.data(), console_partial.data() + console_partial.size());
+        console_partial.clear();
+        text = newline + 1;
     }
     
     console_scroll_to_bottom = true;
 }
 
+/**
+ * @brief Appends one console line, dropping the oldest when full
+ * @tparam T Window type
+ * @private
+ * 
+ * Once the console is full, the dropped line's buffer is reused for the
+ * new one. Caller holds console_mutex.
+ * 
+ * @param begin First character of the line
+ * @param end One past the last character
+ */
+template <typename T>
+nil UserInterface<T>::__push_console_line(const char* begin, const char* end) {
+    if (console_output.size() < MAX_CONSOLE_LINES) {
+        console_output.emplace_back(begin, end);
+        return;
+    }
+    
+    std::string line = std::move(console_output.front());
+    console_output.erase(console_output.begin());
+    line.assign(begin, end);
+    console_output.push_back(std::move(line));
+}
+
 /**
  * @brief Implementation function for console output redirection
  * @tparam T Window type
  * @param ui Pointer to UserInterface instance
- * @param text Text to add to console
+ * @param text Characters written to the stream
+ * @param count Number of characters
  * 
  * Helper function used by ConsoleRedirectBuffer to add text
  * to the console output in a thread-safe manner.
  */
 template <typename T>
-void __add_console_output_impl(void* ui, const std::string& text) {
-    static_cast<UserInterface<T>*>(ui)->__add_console_output(text);
+void __add_console_output_impl(void* ui, const char* text, size_t count) {
+    static_cast<UserInterface<T>*>(ui)->__add_console_stream(text, count);
 }
 
 /**
@@ -903,42 +1916,48 @@ bool UserInterface<T>::IsMouseOverViewport() {
  * @param y Mouse y coordinate
  * 
  * Handles mouse button presses and releases for drawing operations.
- * Supports line drawing with left mouse button.
+ * Supports line drawing with left mouse button. With the selection tool,
+ * pressing on a primitive selects it and starts a move; the whole drag is
+ * recorded as a single undo step.
  */
 template <typename T>
-nil UserInterface<T>::HandleDrawingInput(int button, int action, float x, float y) {
-    if (current_tool == ToolType::None) return;
+bool UserInterface<T>::HandleDrawingInput(int button, int action, float x, float y) {
+    if (button != GLFW_MOUSE_BUTTON_LEFT || __is_busy()) return false;
     
-    if (button == GLFW_MOUSE_BUTTON_LEFT) {
+    if (current_tool == ToolType::None) {
         if (action == GLFW_PRESS) {
-            // Start drawing
-            is_drawing = true;
-            // Безопасное преобразование координат мыши в координаты viewport
-            // Используем размеры окна GLFW вместо ImGui API
-            if (pWindow) {
-                int window_width, window_height;
-                glfwGetWindowSize(pWindow, &window_width, &window_height);
-                
-                if (window_width > 0 && window_height > 0) {
-                    // Преобразуем координаты мыши в нормализованные координаты (-1 до 1)
-                    float viewport_x = (x / window_width) * 2.0f - 1.0f;
-                    float viewport_y = 1.0f - (y / window_height) * 2.0f;
-                    
-                    
-                    line_start = MentalEngine::Math::Vector2(viewport_x, viewport_y);
-                    line_end = MentalEngine::Math::Vector2(viewport_x, viewport_y);
-                }
-            }
-        } else if (action == GLFW_RELEASE) {
-            // Finish drawing
-            if (is_drawing && current_tool == ToolType::Line) {
-                // Add line to the list of drawn lines
-                line_points.push_back(line_start);
-                line_points.push_back(line_end);
+            // Select tool: click picks the nearest primitive, drag moves it
+            selected_primitive = __pick_at_cursor(x, y);
+            if (scene.Contains(selected_primitive) && __cursor_to_world(x, y, drag_last)) {
+                is_dragging = true;
+                history.BeginCoalescing();
+                return true;
             }
-            is_drawing = false;
+        } else if (action == GLFW_RELEASE && is_dragging) {
+            EndDrag();
+            return true;
+        }
+        return false;
+    }
+    
+    if (action == GLFW_PRESS) {
+        // Start drawing
+        MentalEngine::Math::Vector2 world;
+        if (__snapped_cursor(x, y, world)) {
+            is_drawing = true;
+            line_start = world;
+            line_end = world;
+        }
+    } else if (action == GLFW_RELEASE) {
+        // Finish drawing
+        if (is_drawing && current_tool == ToolType::Line) {
+            // Add line to the scene through the history so it can be undone
+            std::vector<MentalEngine::LineData> lines = {{line_start.x, line_start.y, line_end.x, line_end.y}};
+            __execute(std::make_unique<MentalEngine::AddGeometryCommand>(std::move(lines), std::vector<MentalEngine::ArcData>()));
         }
+        is_drawing = false;
     }
+    return true;
 }
 
 /**
@@ -948,28 +1967,285 @@ nil UserInterface<T>::HandleDrawingInput(int button, int action, float x, float
  * @param y Mouse y coordinate
  * 
  * Handles mouse movement during drawing operations.
- * Updates the current line being drawn.
+ * Updates the current line being drawn, or the hovered primitive
+ * when the selection tool is active.
  */
 template <typename T>
 nil UserInterface<T>::HandleDrawingMouseMove(float x, float y) {
-    (void)x; (void)y; // Suppress unused parameter warnings
-    if (current_tool == ToolType::None || !is_drawing) return;
-    
-    // Безопасное преобразование координат мыши в координаты viewport
-    // Используем размеры окна GLFW вместо ImGui API
-    if (pWindow) {
-        int window_width, window_height;
-        glfwGetWindowSize(pWindow, &window_width, &window_height);
-        
-        if (window_width > 0 && window_height > 0) {
-            // Преобразуем координаты мыши в нормализованные координаты (-1 до 1)
-            float viewport_x = (x / window_width) * 2.0f - 1.0f;
-            float viewport_y = 1.0f - (y / window_height) * 2.0f;
-            
-            // Update the end point of the current line being drawn
-            line_end = MentalEngine::Math::Vector2(viewport_x, viewport_y);
+    // Пока идет импорт, индекс перестраивался бы на каждый батч
+    if (__is_busy()) return;
+    
+    if (current_tool == ToolType::None) {
+        if (is_dragging) {
+            MentalEngine::Math::Vector2 world;
+            if (__cursor_to_world(x, y, world)) {
+                __move_selected(world - drag_last);
+                drag_last = world;
+            }
+            return;
+        }
+        hovered_primitive = __pick_at_cursor(x, y);
+        return;
+    }
+    
+    // Snap on every move so the marker previews the next click
+    MentalEngine::Math::Vector2 world;
+    if (__snapped_cursor(x, y, world) && is_drawing) {
+        // Update the end point of the current line being drawn
+        line_end = world;
+    }
+}
+
+/**
+ * @brief Ends a move of the selected primitive, if one is in progress
+ * @tparam T Window type
+ */
+template <typename T>
+nil UserInterface<T>::EndDrag() {
+    if (!is_dragging) return;
+    is_dragging = false;
+    history.EndCoalescing();
+}
+
+/**
+ * @brief Handles editing shortcuts (undo, redo, delete)
+ * @tparam T Window type
+ * @param key GLFW key code
+ * @param action Key action
+ * @param mods Modifier bits
+ * @return bool True if the key was consumed
+ * 
+ * Ctrl+Z undoes, Ctrl+Y and Ctrl+Shift+Z redo, Delete removes the
+ * selected primitive. Super is accepted in place of Ctrl for macOS.
+ */
+template <typename T>
+bool UserInterface<T>::HandleKey(int key, int action, int mods) {
+    if (action == GLFW_RELEASE || is_dragging || __is_busy()) return false;
+    
+    const bool command = (mods & (GLFW_MOD_CONTROL | GLFW_MOD_SUPER)) != 0;
+    const bool shift = (mods & GLFW_MOD_SHIFT) != 0;
+    
+    if (command && key == GLFW_KEY_Z) {
+        if (shift) Redo(); else Undo();
+        return true;
+    }
+    if (command && key == GLFW_KEY_Y) {
+        Redo();
+        return true;
+    }
+    if ((key == GLFW_KEY_DELETE || key == GLFW_KEY_BACKSPACE) && action == GLFW_PRESS &&
+        scene.Contains(selected_primitive)) {
+        __execute(std::make_unique<MentalEngine::RemoveGeometryCommand>(
+            std::vector<MentalEngine::PrimitiveId>{selected_primitive}));
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Reverts the last scene edit
+ * @tparam T Window type
+ */
+template <typename T>
+nil UserInterface<T>::Undo() {
+    MentalEngine::MemoryTagScope tag(MentalEngine::MemoryTag::Scene);
+    if (is_dragging || __is_busy() || !history.Undo(scene)) return;
+    __reset_selection();
+}
+
+/**
+ * @brief Re-applies the last undone scene edit
+ * @tparam T Window type
+ */
+template <typename T>
+nil UserInterface<T>::Redo() {
+    MentalEngine::MemoryTagScope tag(MentalEngine::MemoryTag::Scene);
+    if (is_dragging || __is_busy() || !history.Redo(scene)) return;
+    __reset_selection();
+}
+
+/**
+ * @brief Runs a command through the history and drops stale handles
+ * @tparam T Window type
+ * @param command Command to execute
+ * @private
+ * 
+ * Additions keep existing handles valid; removals relocate primitives, so
+ * the selection is cleared for everything else.
+ */
+template <typename T>
+nil UserInterface<T>::__execute(std::unique_ptr<MentalEngine::SceneCommand> command) {
+    MentalEngine::MemoryTagScope tag(MentalEngine::MemoryTag::Scene);
+    const bool keeps_handles = dynamic_cast<MentalEngine::AddGeometryCommand*>(command.get()) != nullptr;
+    history.Execute(scene, std::move(command));
+    if (!keeps_handles) __reset_selection();
+}
+
+/**
+ * @brief Moves the selected primitive by a world-space offset
+ * @tparam T Window type
+ * @param offset Translation in world units
+ * @private
+ * 
+ * Each call executes a ModifyGeometryCommand; while a drag is in progress the
+ * history merges them, so only the first and last states are kept.
+ */
+template <typename T>
+nil UserInterface<T>::__move_selected(const MentalEngine::Math::Vector2& offset) {
+    if (!scene.Contains(selected_primitive)) return;
+    const uint32_t index = selected_primitive.GetIndex();
+    
+    if (selected_primitive.GetType() == MentalEngine::PrimitiveType::Line) {
+        MentalEngine::LineData before = scene.GetLine(index);
+        MentalEngine::LineData after = {before.x0 + offset.x, before.y0 + offset.y,
+                                        before.x1 + offset.x, before.y1 + offset.y};
+        history.Execute(scene, std::make_unique<MentalEngine::ModifyGeometryCommand>(index, before, after));
+    } else {
+        MentalEngine::ArcData before = scene.GetArc(index);
+        MentalEngine::ArcData after = before;
+        after.cx += offset.x;
+        after.cy += offset.y;
+        history.Execute(scene, std::make_unique<MentalEngine::ModifyGeometryCommand>(index, before, after));
+    }
+}
+
+/**
+ * @brief Forgets hovered/selected handles after the scene layout changed
+ * @tparam T Window type
+ * @private
+ */
+template <typename T>
+nil UserInterface<T>::__reset_selection() {
+    hovered_primitive = MentalEngine::PrimitiveId();
+    selected_primitive = MentalEngine::PrimitiveId();
+}
+
+/**
+ * @brief Maps a cursor position onto the drawing plane
+ * @tparam T Window type
+ * @param x Cursor x coordinate in window pixels
+ * @param y Cursor y coordinate in window pixels
+ * @param out World-space point on the Z = 0 plane
+ * @return bool False if the cursor cannot be mapped
+ * @private
+ * 
+ * Converts the cursor to normalized device coordinates relative to the
+ * Viewport panel image and unprojects it onto the drawing plane, using the
+ * rect and inverse view-projection cached by Viewport() this frame for the
+ * viewport receiving input.
+ */
+template <typename T>
+bool UserInterface<T>::__cursor_to_world(float x, float y, MentalEngine::Math::Vector2& out) {
+    const ViewportMapping& viewport_mapping = viewport_mappings[pRenderer ? pRenderer->GetActiveViewport() : 0];
+    if (!viewport_mapping.valid) return false;
+    
+    // Преобразуем координаты мыши в нормализованные координаты panel (-1 до 1)
+    MentalEngine::Math::Vector2 ndc(((x - viewport_mapping.x) / viewport_mapping.width) * 2.0f - 1.0f,
+                                    1.0f - ((y - viewport_mapping.y) / viewport_mapping.height) * 2.0f);
+    
+    MentalEngine::Math::Vector3 world;
+    if (!MentalEngine::Camera::UnprojectToPlane(viewport_mapping.inverse_view_projection, ndc, 0.0f, world)) return false;
+    out = MentalEngine::Math::Vector2(world.x, world.y);
+    return true;
+}
+
+/**
+ * @brief Follows changes of the scene origin with the camera
+ * @tparam T Window type
+ * @private
+ * 
+ * Loading a drawing or importing DXF into an empty scene moves the scene
+ * origin. The origin of every viewport camera is moved by the same amount, so the view stays
+ * on the same scene coordinates instead of jumping by the offset; the
+ * cameras' home points move along, so Reset() keeps returning to the scene
+ * origin.
+ */
+template <typename T>
+nil UserInterface<T>::__sync_world_origin() {
+    const MentalEngine::Math::Vector2d& origin = scene.GetOrigin();
+    if (origin == view_origin) return;
+    const MentalEngine::Math::Vector2d delta = origin - view_origin;
+    view_origin = origin;
+    if (!pRenderer) return;
+    for (size_t i = 0; i < Renderer::MAX_VIEWPORTS; i++) {
+        if (auto camera = pRenderer->GetViewportCamera(i)) {
+            camera->TranslateOrigin(MentalEngine::Math::Vector3d(delta.x, delta.y, 0.0));
         }
     }
 }
 
+/**
+ * @brief Picks the primitive under the cursor
+ * @tparam T Window type
+ * @param x Cursor x coordinate in window pixels
+ * @param y Cursor y coordinate in window pixels
+ * @return MentalEngine::PrimitiveId Nearest primitive within the pixel tolerance
+ * @private
+ * 
+ * The pixel tolerance is converted to world units by unprojecting a second
+ * point offset by the tolerance, so picking feels the same at any zoom level.
+ * The query itself goes through the scene's spatial index.
+ */
+template <typename T>
+MentalEngine::PrimitiveId UserInterface<T>::__pick_at_cursor(float x, float y) {
+    MentalEngine::Math::Vector2 world;
+    if (!__cursor_to_world(x, y, world)) return MentalEngine::PrimitiveId();
+    return scene.Pick(world, __pixels_to_world(x, y, pick_tolerance_px));
+}
+
+/**
+ * @brief Converts a screen-space distance at the cursor to world units
+ * @tparam T Window type
+ * @param x Cursor x coordinate in window pixels
+ * @param y Cursor y coordinate in window pixels
+ * @param pixels Distance in pixels
+ * @return float Distance in world units, or 0 if the cursor cannot be mapped
+ * @private
+ */
+template <typename T>
+float UserInterface<T>::__pixels_to_world(float x, float y, float pixels) {
+    MentalEngine::Math::Vector2 world, offset;
+    if (!__cursor_to_world(x, y, world) || !__cursor_to_world(x + pixels, y, offset)) return 0.0f;
+    return (offset - world).length();
+}
+
+/**
+ * @brief Maps a cursor position onto the drawing plane and applies snapping
+ * @tparam T Window type
+ * @param x Cursor x coordinate in window pixels
+ * @param y Cursor y coordinate in window pixels
+ * @param out Snapped world-space point
+ * @return bool False if the cursor cannot be mapped
+ * @private
+ * 
+ * Stores the result in last_snap so the viewport can draw a marker.
+ */
+template <typename T>
+bool UserInterface<T>::__snapped_cursor(float x, float y, MentalEngine::Math::Vector2& out) {
+    MentalEngine::Math::Vector2 world;
+    if (!__cursor_to_world(x, y, world)) {
+        last_snap = MentalEngine::SnapResult();
+        return false;
+    }
+    float tolerance = __pixels_to_world(x, y, snap_tolerance_px);
+    last_snap = snap_engine.Snap(scene, world, tolerance);
+    snap_marker_size = tolerance * 0.5f;
+    out = last_snap.point;
+    return true;
+}
+
+/**
+ * @brief Describes a primitive for display
+ * @tparam T Window type
+ * @param id Primitive handle
+ * @return std::string Human-readable label
+ * @private
+ */
+template <typename T>
+std::string UserInterface<T>::__describe_primitive(MentalEngine::PrimitiveId id) const {
+    if (!scene.Contains(id)) return "-";
+    const char* type = id.GetType() == MentalEngine::PrimitiveType::Line ? "Line" : "Arc";
+    return std::string(type) + " #" + std::to_string(id.GetIndex());
+}
+
 #endif // MENTAL_USER_INTERFACE_H
@@ -15,6 +15,7 @@
 
 #include "../../Core/Types.h"
 #include "../Renderer/Renderer.h"
+#include "../Renderer/RenderThread.h"
 #include "source/T1/UserInterface/UserInterface.h"
 #include <GLFW/glfw3.h>
 #include <memory>
@@ -48,6 +49,16 @@ private:
     T* pWindow = nullptr;                                    ///< Pointer to the GLFW window
     std::shared_ptr<Renderer> pRenderer = nullptr;          ///< Shared pointer to the renderer
     std::shared_ptr<UserInterface<T>> pUI = nullptr;        ///< Shared pointer to the user interface
+    bool threaded_rendering = false;                         ///< Execute frames on a separate render thread
+    RenderThread render_thread;                              ///< GL thread used when threaded_rendering is set
+    FramePacket packet;                                      ///< Frame being recorded by the main loop
+    bool on_demand_redraw = true;                            ///< Sleep until input while nothing on screen changes
+    int redraw_frames = 0;                                   ///< Frames still to draw after the last input
+    uint64_t input_events = 0;                               ///< Input and window events seen by the callbacks
+    double last_frame_time = 0.0;                            ///< glfwGetTime() at the previous frame
+
+    static constexpr int REDRAW_FRAMES_AFTER_INPUT = 3;      ///< Frames ImGui needs to settle after an event
+    static constexpr double IDLE_WAIT_SECONDS = 0.5;         ///< Longest sleep; keeps autosave and caret blink ticking
 
     /**
      * @brief Initializes the GLFW library
@@ -103,7 +114,36 @@ public:
      * 
      * @return nil This function does not return until the application exits
      */
-    nil Run() const;
+    nil Run();
+    
+    /**
+     * @brief Selects single- or multi-threaded rendering for Run()
+     * 
+     * With threaded rendering the GL context moves to a render thread that
+     * executes the previous frame while the main thread polls events and
+     * records the next one. Must be set before Run().
+     * 
+     * @param enabled True to render on a separate thread
+     */
+    nil SetThreadedRendering(bool enabled) { threaded_rendering = enabled; }
+    
+    /**
+     * @brief Selects on-demand or continuous redraw for Run()
+     * 
+     * On demand, the loop sleeps in glfwWaitEventsTimeout() unless input
+     * arrived in the last few frames, the camera is still moving or the UI
+     * has work in progress. Continuous redraw polls and draws every frame.
+     * 
+     * @param enabled True to draw only while something changes
+     */
+    nil SetOnDemandRedraw(bool enabled) { on_demand_redraw = enabled; }
+    
+    /**
+     * @brief Polls events, or sleeps until one arrives when nothing is animating
+     * @tparam T Window type
+     * @private
+     */
+    nil __wait_for_frame();
     
     /**
      * @brief Sets up input callbacks for camera control
@@ -173,15 +213,85 @@ nil WindowManager<T>::__load_ui() {
  * @brief Runs the main application loop
  * @tparam T Window type
  * 
- * Main application loop that handles events, renders frames, and updates UI
+ * Main application loop that handles events, records frames, and updates UI
  * until the window is closed by the user.
+ * 
+ * Single-threaded, each recorded packet is executed and swapped right away.
+ * Threaded, the loop waits for events until the render thread has taken the
+ * previous packet, so input keeps being handled while the GPU is busy, then
+ * submits the new one.
+ * 
+ * Before recording, the camera is advanced by the time since the previous
+ * frame, so smoothing, inertia and transitions run at the same speed at any
+ * frame rate.
  */
 template <typename T>
-nil WindowManager<T>::Run() const {
+nil WindowManager<T>::Run() {
+    if (threaded_rendering) {
+        pUI->PrepareForRenderThread();
+        render_thread.Start(this->pWindow, [this](FramePacket& frame) { pRenderer->ExecutePacket(frame); });
+    }
+    
+    redraw_frames = REDRAW_FRAMES_AFTER_INPUT;
+    last_frame_time = glfwGetTime();
     while (!glfwWindowShouldClose(this->pWindow)) {
+        this->__wait_for_frame();
+        if (threaded_rendering) {
+            // Обрабатываем ввод, пока поток рендера занят предыдущим кадром
+            while (!render_thread.CanSubmit() && !glfwWindowShouldClose(this->pWindow)) {
+                glfwWaitEvents();
+            }
+        }
+        
+        const double now = glfwGetTime();
+        pRenderer->AdvanceCameras(static_cast<float>(now - last_frame_time));
+        last_frame_time = now;
+        
+        pRenderer->BeginPacket(packet);
+        pUI->DrawFrame();
+        pRenderer->EndPacket();
+        
+        if (threaded_rendering) {
+            render_thread.Submit(packet);
+        } else {
+            pRenderer->ExecutePacket(packet);
+            glfwSwapBuffers(this->pWindow);
+        }
+    }
+    
+    // Контекст возвращается главному потоку до удаления GL-ресурсов
+    render_thread.Stop();
+}
+
+/**
+ * @brief Polls events, or sleeps until one arrives when nothing is animating
+ * @tparam T Window type
+ * @private
+ * 
+ * Input callbacks count events; a frame that saw any keeps the loop drawing
+ * for REDRAW_FRAMES_AFTER_INPUT more frames so hover and layout changes in
+ * ImGui settle. After that the loop sleeps unless the camera is moving,
+ * the UI asks for frames, edited shaders are still being rebuilt or plan
+ * view tiles are still being filled in. The
+ * timeout, and the empty event the shader watcher posts when a file
+ * changes, still wake it for periodic work; such a wake-up draws one frame.
+ */
+template <typename T>
+nil WindowManager<T>::__wait_for_frame() {
+    const uint64_t seen = input_events;
+    bool animating = pRenderer->AreCamerasAnimating() || pRenderer->IsReloadingShaders() ||
+                     pRenderer->AreTilesPending() || pUI->NeedsContinuousRedraw();
+    
+    if (on_demand_redraw && redraw_frames == 0 && !animating) {
+        glfwWaitEventsTimeout(IDLE_WAIT_SECONDS);
+    } else {
         glfwPollEvents();
-        pRenderer->DrawFrame([&]() { return pUI->DrawFrame(); });
-        glfwSwapBuffers(this->pWindow);
+    }
+    
+    if (input_events != seen) {
+        redraw_frames = REDRAW_FRAMES_AFTER_INPUT;
+    } else if (redraw_frames > 0) {
+        redraw_frames--;
     }
 }
 
@@ -249,6 +359,8 @@ nil WindowManager<T>::__initialize_glfw_library() const {
  * Sets up GLFW input callbacks for mouse and keyboard input to control the camera.
  * This includes mouse button presses, mouse movement, scroll wheel, and keyboard input.
  * ImGui has priority over camera input - if ImGui wants to capture input, camera won't receive it.
+ * Key events always reach ImGui first. A left release anywhere, or losing
+ * focus, ends a primitive drag.
  */
 template <typename T>
 nil WindowManager<T>::__setup_input_callbacks() {
@@ -257,33 +369,39 @@ nil WindowManager<T>::__setup_input_callbacks() {
         (void)mods; // Suppress unused parameter warning
         WindowManager* wm = static_cast<WindowManager*>(glfwGetWindowUserPointer(window));
         if (!wm || !wm->pUI) return;
+        wm->input_events++;
         
         // Проверяем, хочет ли ImGui захватить ввод
         ImGuiIO& io = ImGui::GetIO();
         if (io.WantCaptureMouse) {
             // Проверяем, находится ли мышь над viewport
             if (wm->pUI && wm->pUI->IsMouseOverViewport()) {
-                // Мышь над viewport - передаем в камеру и в ImGui
+                // Мышь над viewport - передаем в ImGui, инструментам рисования и камере
                 ImGui_ImplGlfw_MouseButtonCallback(window, button, action, mods);
-                if (wm->pRenderer && wm->pRenderer->GetCamera()) {
-                    double x, y;
-                    glfwGetCursorPos(window, &x, &y);
+                double x, y;
+                glfwGetCursorPos(window, &x, &y);
+                // Инструмент забирает нажатие себе - камера его не получает
+                bool consumed = wm->pUI->HandleDrawingInput(button, action, static_cast<float>(x), static_cast<float>(y));
+                if (!consumed && wm->pRenderer && wm->pRenderer->GetCamera()) {
                     wm->pRenderer->GetCamera()->HandleMouseButton(button, action, static_cast<float>(x), static_cast<float>(y));
                 }
-                // Также передаем в UserInterface для рисования
-                if (wm->pUI) {
-                    double x, y;
-                    glfwGetCursorPos(window, &x, &y);
-                    wm->pUI->HandleDrawingInput(button, action, static_cast<float>(x), static_cast<float>(y));
-                }
             } else {
                 // Мышь не над viewport - только ImGui
                 ImGui_ImplGlfw_MouseButtonCallback(window, button, action, mods);
+                // Перетаскивание примитива заканчивается при любом отпускании, иначе история останется открытой
+                if (button == GLFW_MOUSE_BUTTON_LEFT && action == GLFW_RELEASE) wm->pUI->EndDrag();
+                // Отпускание все равно доходит до камеры, иначе она останется в режиме перетаскивания
+                if (action == GLFW_RELEASE && wm->pRenderer && wm->pRenderer->GetCamera()) {
+                    double x, y;
+                    glfwGetCursorPos(window, &x, &y);
+                    wm->pRenderer->GetCamera()->HandleMouseButton(button, action, static_cast<float>(x), static_cast<float>(y));
+                }
             }
             return;
         }
         
         // ImGui не хочет ввод, передаем в камеру
+        if (button == GLFW_MOUSE_BUTTON_LEFT && action == GLFW_RELEASE) wm->pUI->EndDrag();
         if (wm->pRenderer && wm->pRenderer->GetCamera()) {
             double x, y;
             glfwGetCursorPos(window, &x, &y);
@@ -295,6 +413,7 @@ nil WindowManager<T>::__setup_input_callbacks() {
     glfwSetCursorPosCallback(this->pWindow, [](GLFWwindow* window, double x, double y) {
         WindowManager* wm = static_cast<WindowManager*>(glfwGetWindowUserPointer(window));
         if (!wm || !wm->pUI) return;
+        wm->input_events++;
         
         // Проверяем, хочет ли ImGui захватить ввод
         ImGuiIO& io = ImGui::GetIO();
@@ -327,6 +446,7 @@ nil WindowManager<T>::__setup_input_callbacks() {
     glfwSetScrollCallback(this->pWindow, [](GLFWwindow* window, double xoffset, double yoffset) {
         WindowManager* wm = static_cast<WindowManager*>(glfwGetWindowUserPointer(window));
         if (!wm || !wm->pUI) return;
+        wm->input_events++;
         
         // Проверяем, хочет ли ImGui захватить ввод
         ImGuiIO& io = ImGui::GetIO();
@@ -354,23 +474,31 @@ nil WindowManager<T>::__setup_input_callbacks() {
     // Keyboard callback
     glfwSetKeyCallback(this->pWindow, [](GLFWwindow* window, int key, int scancode, int action, int mods) {
         (void)scancode; // Suppress unused parameter warning
-        (void)mods; // Suppress unused parameter warning
         WindowManager* wm = static_cast<WindowManager*>(glfwGetWindowUserPointer(window));
         if (!wm || !wm->pUI) return;
+        wm->input_events++;
         
-        // Проверяем, хочет ли ImGui захватить ввод
+        // ImGui видит каждое событие, даже съеденное горячей клавишей, иначе у него залипнут клавиши
+        ImGui_ImplGlfw_KeyCallback(window, key, scancode, action, mods);
+        
+        // Горячие клавиши редактирования работают, пока не идет ввод текста
         ImGuiIO& io = ImGui::GetIO();
+        if (!io.WantTextInput && wm->pUI->HandleKey(key, action, mods)) return;
+        
+        // Проверяем, хочет ли ImGui захватить ввод
         if (io.WantCaptureKeyboard) {
             // Проверяем, находится ли мышь над viewport
             if (wm->pUI && wm->pUI->IsMouseOverViewport()) {
-                // Мышь над viewport - передаем в камеру, но также передаем в ImGui
-                ImGui_ImplGlfw_KeyCallback(window, key, scancode, action, mods);
+                // Мышь над viewport - ImGui уже получил событие, передаем и в камеру
                 if (wm->pRenderer && wm->pRenderer->GetCamera()) {
                     wm->pRenderer->GetCamera()->HandleKey(key, action);
                 }
             } else {
                 // Мышь не над viewport - только ImGui
-                ImGui_ImplGlfw_KeyCallback(window, key, scancode, action, mods);
+                // Удерживаемые клавиши камеры должны отпуститься
+                if (action == GLFW_RELEASE && wm->pRenderer && wm->pRenderer->GetCamera()) {
+                    wm->pRenderer->GetCamera()->HandleKey(key, action);
+                }
             }
             return;
         }
@@ -385,6 +513,7 @@ nil WindowManager<T>::__setup_input_callbacks() {
     glfwSetCharCallback(this->pWindow, [](GLFWwindow* window, unsigned int codepoint) {
         WindowManager* wm = static_cast<WindowManager*>(glfwGetWindowUserPointer(window));
         if (!wm || !wm->pUI) return;
+        wm->input_events++;
         
         // Проверяем, хочет ли ImGui захватить ввод
         ImGuiIO& io = ImGui::GetIO();
@@ -394,6 +523,27 @@ nil WindowManager<T>::__setup_input_callbacks() {
         }
     });
     
+    // Потеря фокуса: отпускание кнопки придет уже другому окну
+    glfwSetWindowFocusCallback(this->pWindow, [](GLFWwindow* window, int focused) {
+        ImGui_ImplGlfw_WindowFocusCallback(window, focused);
+        WindowManager* wm = static_cast<WindowManager*>(glfwGetWindowUserPointer(window));
+        if (!wm || !wm->pUI) return;
+        wm->input_events++;
+        if (focused == GLFW_FALSE) wm->pUI->EndDrag();
+    });
+    
+    // Изменение размера и перерисовка окна тоже требуют новых кадров
+    glfwSetFramebufferSizeCallback(this->pWindow, [](GLFWwindow* window, int width, int height) {
+        (void)width;
+        (void)height;
+        WindowManager* wm = static_cast<WindowManager*>(glfwGetWindowUserPointer(window));
+        if (wm) wm->input_events++;
+    });
+    glfwSetWindowRefreshCallback(this->pWindow, [](GLFWwindow* window) {
+        WindowManager* wm = static_cast<WindowManager*>(glfwGetWindowUserPointer(window));
+        if (wm) wm->input_events++;
+    });
+    
     // Set window user pointer for callbacks
     glfwSetWindowUserPointer(this->pWindow, this);
 }
@@ -11,6 +11,7 @@
  */
 
 #include "T1/T1.h"
+#include <cstring>
 
 /**
  * @brief Main entry point of the MentalEngine application
@@ -19,12 +20,21 @@
  * the main application loop. The T1 layer handles all the core functionality
  * including window management, rendering, and user interface.
  * 
+ * Pass --render-thread to execute frames on a separate render thread and
+ * --continuous to draw every frame instead of only while something changes.
+ * 
+ * @param argc Argument count
+ * @param argv Argument values
  * @return int Exit status code (0 for success)
  * 
  * @note This function will run until the user closes the application window
  *       or the application is terminated by other means.
  */
-int main() {
+int main(int argc, char** argv) {
     MentalT1Layer t1;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--render-thread") == 0) t1.SetThreadedRendering(true);
+        if (std::strcmp(argv[i], "--continuous") == 0) t1.SetOnDemandRedraw(false);
+    }
     t1.Run();
 }